@@ -0,0 +1,739 @@
+/***************************************************************************************************************************************
+ * FILE NAME: bench_sha.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-10
+ *
+ * CONTENT: Micro-benchmark of the hash functions contained in sha1.c, sha256.c and sha512.c. Every API is timed over a range
+ *          of message sizes, including the sizes around the pad boundaries, and for every kernel available on the processor.
+ *          For each measurement a number of warm-up calls is followed by repeated timed calls, and the median and 99th
+ *          percentile are reported in nanoseconds, cycles per byte and GB/s. The output is a single JSON document written
+ *          to standard output, so that results can be stored and compared between commits.
+ *
+ *          Cycles are read from the time stamp counter on x86 processors. On other processors they are estimated as
+ *          nanoseconds, and the reported tsc_ghz is then 1.
+ *
+ *          Usage: benchmark [--max-size BYTES] [--api NAME] [--quick]
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_TSC
+#endif
+
+#include "shalib.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "shabatch.h"
+#include "shaqueue.h"
+#include "shahasher.h"
+#include "shahex.h"
+#include "shaotp.h"
+#include "shauuid.h"
+#include "shaalg.h"
+#include "shaset.h"
+#include "shacolumn.h"
+#include "shahmac.h"
+#include "shachain.h"
+
+#define MiB (1024*1024)
+#define TARGET_BYTES (64*MiB)       /* the number of bytes to hash per measurement, which determines the repetitions    */
+#define MIN_REPS 7                  /* the minimum number of timed repetitions per measurement                          */
+#define MAX_REPS 2001               /* the maximum number of timed repetitions per measurement                          */
+#define WARMUP_REPS 3               /* the number of untimed calls preceding each measurement                           */
+
+
+/* Message sizes in bytes: the pad edges of the 64- and 128-byte blocks followed by powers of two up to 64 MiB */
+
+static const uint64_t SIZES[] = {0, 1, 55, 56, 63, 64, 65, 111, 112, 119, 120, 128, 256, 1024, 4096, 16384, 65536,
+                                 262144, 1*MiB, 4*MiB, 16*MiB, 64*MiB};
+
+static const uint64_t FILE_SIZES[] = {0, 4096, 65536, 1*MiB, 16*MiB, 64*MiB};
+
+static const uint64_t CONCAT_SEGMENTS[] = {1, 2, 3, 8, 64};
+
+#define BATCH_TEXTS 256             /* the number of texts hashed per call of SHA1_Batch and per SHA1_Queue round       */
+#define BATCH_MAX_SIZE 65536        /* the largest text size of the batch measurements                                  */
+#define HEX_HASHES 4096             /* the number of SHA1 hashes formatted per call of SHA_Hex_Encode_Batch             */
+#define OTP_USERS 1024              /* the number of codes verified per call of SHA_HOTP_Verify_Batch                   */
+#define SHORT_CALLS 100             /* the number of calls timed together per short-message measurement                 */
+#define UUID_NAMES 4096             /* the number of names per call of SHA_UUID5_Batch                                  */
+#define SET_HASHES (1 << 22)        /* the number of hashes of the set file of the SHA_Set_Contains measurements        */
+#define SET_QUERIES 4096            /* the number of hashes looked up per SHA_Set_Contains measurement                  */
+#define COLUMN_ROWS 10000000        /* the number of rows of the SHA1_Column64 measurements, a tenth with --quick       */
+#define HMAC_MESSAGES 4096          /* the number of messages, each with its own key, per call of SHA_HMAC_Verify_Batch */
+#define CHAIN_STEPS 100000          /* the number of steps of the hash chains of the SHA1_Chain measurements            */
+#define CHAIN_LANES_CHAINS 64       /* the number of chains computed side by side per call of SHA1_Chain_Batch          */
+
+
+/************************************************************************************************************/
+
+static uint64_t Read_Nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static uint64_t Read_Cycles(void)
+{
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return Read_Nanoseconds();
+#endif
+}
+
+/* The function Estimate_TSC_GHz returns the number of cycles counted by Read_Cycles per nanosecond */
+
+static double Estimate_TSC_GHz(void)
+{
+    uint64_t ns0, ns1, c0, c1;
+
+    ns0 = Read_Nanoseconds();
+    c0 = Read_Cycles();
+    do
+        ns1 = Read_Nanoseconds();
+    while (ns1 - ns0 < 50000000);
+    c1 = Read_Cycles();
+
+    return (double) (c1 - c0)/(ns1 - ns0);
+}
+
+/* The result of one measurement */
+
+struct Measurement
+{
+    std::string api;
+    std::string kernel;
+    uint64_t size;
+    uint64_t segments;
+    std::vector<double> ns;
+    std::vector<double> cycles;
+};
+
+static double Percentile(std::vector<double> v, double q)
+{
+    std::sort(v.begin(), v.end());
+    return v[(size_t) (q*(v.size() - 1) + 0.5)];
+}
+
+/* The function Measure times the call f() for a message of the given size. The function before() is called
+   untimed ahead of every call, for example to evict a file from the page cache */
+
+template <class F, class B>
+static Measurement Measure(const std::string &api, const std::string &kernel, uint64_t size, uint64_t segments, F f, B before)
+{
+    Measurement m;
+    uint64_t reps, i, ns0, c0;
+
+    m.api = api;
+    m.kernel = kernel;
+    m.size = size;
+    m.segments = segments;
+
+    reps = TARGET_BYTES/(size > 64 ? size : 64);
+    reps = std::max<uint64_t>(MIN_REPS, std::min<uint64_t>(MAX_REPS, reps));
+
+    for (i = 0; i < WARMUP_REPS; i++)
+    {
+        before();
+        f();
+    }
+
+    for (i = 0; i < reps; i++)
+    {
+        before();
+        ns0 = Read_Nanoseconds();
+        c0 = Read_Cycles();
+        f();
+        m.cycles.push_back((double) (Read_Cycles() - c0));
+        m.ns.push_back((double) (Read_Nanoseconds() - ns0));
+    }
+
+    return m;
+}
+
+template <class F>
+static Measurement Measure(const std::string &api, const std::string &kernel, uint64_t size, uint64_t segments, F f)
+{
+    return Measure(api, kernel, size, segments, f, [] {});
+}
+
+/* The function Print_Measurement writes one measurement as a JSON object */
+
+static void Print_Measurement(const Measurement &m, int first)
+{
+    double median_ns = Percentile(m.ns, 0.5);
+    double p99_ns = Percentile(m.ns, 0.99);
+    double median_cycles = Percentile(m.cycles, 0.5);
+    double p99_cycles = Percentile(m.cycles, 0.99);
+
+    printf("%s    {\"api\": \"%s\", \"kernel\": \"%s\", \"size\": %llu, \"segments\": %llu, \"reps\": %llu, "
+           "\"median_ns\": %.1f, \"p99_ns\": %.1f, \"median_cycles\": %.0f, \"p99_cycles\": %.0f, ",
+           first ? "" : ",\n", m.api.c_str(), m.kernel.c_str(), (unsigned long long) m.size, (unsigned long long) m.segments,
+           (unsigned long long) m.ns.size(), median_ns, p99_ns, median_cycles, p99_cycles);
+
+    if (m.size > 0)
+        printf("\"cycles_per_byte\": %.3f, \"p99_cycles_per_byte\": %.3f, \"gb_per_s\": %.3f}",
+               median_cycles/m.size, p99_cycles/m.size, m.size/median_ns);
+    else
+        printf("\"cycles_per_byte\": null, \"p99_cycles_per_byte\": null, \"gb_per_s\": null}");
+
+    fflush(stdout);
+}
+
+/* The function Evict_File drops the pages of a file from the page cache, so that the next read is cold */
+
+static void Evict_File(const char *filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return;
+#ifdef POSIX_FADV_DONTNEED
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+}
+
+static const char *Kernel_Name(int kernel)
+{
+    switch (kernel)
+    {
+        case SHA_KERNEL_PORTABLE: return "portable";
+        case SHA_KERNEL_SHANI: return "shani";
+        default: return "auto";
+    }
+}
+
+/* The function Measure_Fixed times sha::sha1_fixed<N> for every length N of the index sequence and reports each
+   measurement through report */
+
+template <class R, size_t... N>
+static void Measure_Fixed(char *data, R report, std::index_sequence<N...>)
+{
+    (report(Measure("SHA1_Short", "sha1_fixed", N*SHORT_CALLS, SHORT_CALLS, [&]
+    {
+        for (int i = 0; i < SHORT_CALLS; i++)
+            sha::sha1_fixed<N>(data);
+    })), ...);
+}
+
+
+/************************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint64_t max_size = 64*MiB;
+    std::string only_api;
+    char *data;
+    char key[] = {"benchmark key"};
+    char filename[] = {"bench_sha.tmp"};
+    uint32_t hash32[8];
+    uint64_t hash64[8];
+    size_t s, k, i;
+    int first = 1;
+
+    for (i = 1; i < (size_t) argc; i++)
+    {
+        if (strcmp(argv[i], "--max-size") == 0 && i + 1 < (size_t) argc)
+            max_size = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--api") == 0 && i + 1 < (size_t) argc)
+            only_api = argv[++i];
+        else if (strcmp(argv[i], "--quick") == 0)
+            max_size = 1*MiB;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--max-size BYTES] [--api NAME] [--quick]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    data = (char*) malloc(max_size > 0 ? max_size : 1);
+    for (i = 0; i < max_size; i++)
+        data[i] = (char) (i*2654435761u >> 24);
+
+    #define WANTED(api) (only_api.empty() || only_api == api)
+
+    auto Report = [&](const Measurement &m) { Print_Measurement(m, first); first = 0; };
+
+    printf("{\n  \"tsc_ghz\": %.3f,\n  \"results\": [\n", Estimate_TSC_GHz());
+
+    /* In-memory APIs over all message sizes */
+
+    for (s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]) && SIZES[s] <= max_size; s++)
+    {
+        uint64_t size = SIZES[s];
+
+        if (WANTED("SHA1"))
+            Report(Measure("SHA1", "portable", size, 1, [&] { SHA1(data, size, hash32); }));
+
+        if (WANTED("HMAC_SHA1") && size <= 1*MiB)
+            Report(Measure("HMAC_SHA1", "portable", size, 1,
+                                      [&] { HMAC_SHA1(key, strlen(key), data, size, hash32); }));
+
+        for (k = SHA_KERNEL_PORTABLE; k <= SHA_KERNEL_SHANI; k++)
+            if (WANTED("SHA256") && SHA256_Set_Kernel(k) == EXIT_SUCCESS)
+                Report(Measure("SHA256", Kernel_Name(k), size, 1, [&] { SHA256(data, size, hash32); }));
+        SHA256_Set_Kernel(SHA_KERNEL_AUTO);
+
+        if (WANTED("SHA512"))
+            Report(Measure("SHA512", "portable", size, 1, [&] { SHA512(data, size, hash64); }));
+
+        /* The C++ front end of shahasher.h, to be compared with the C entry points above */
+
+        if (WANTED("Hasher<Sha1>"))
+            Report(Measure("Hasher<Sha1>", "portable", size, 1, [&] { sha::Hasher<sha::Sha1>::hash(data, size); }));
+
+        if (WANTED("HMAC<Sha1>") && size <= 1*MiB)
+            Report(Measure("HMAC<Sha1>", "portable", size, 1,
+                           [&] { sha::HMAC<sha::Hasher<sha::Sha1> >::mac(key, strlen(key), data, size); }));
+
+        if (WANTED("Hasher<Sha256>"))
+            Report(Measure("Hasher<Sha256>", Kernel_Name(SHA256_Get_Kernel()), size, 1,
+                           [&] { sha::Hasher<sha::Sha256>::hash(data, size); }));
+
+        if (WANTED("Hasher<Sha512>"))
+            Report(Measure("Hasher<Sha512>", "portable", size, 1, [&] { sha::Hasher<sha::Sha512>::hash(data, size); }));
+
+        if (WANTED("SHA512_256"))
+            Report(Measure("SHA512_256", "portable", size, 1, [&] { SHA512_256(data, size, hash64); }));
+    }
+
+    /* The short-message path of SHA1 for every length from 0 to 119 bytes, compared with the word pointer path of
+       SHA1_Concat and with sha::sha1_fixed. Each measurement times SHORT_CALLS calls, given as the segments, and the
+       reported size is the total number of bytes hashed */
+
+    if (WANTED("SHA1_Short"))
+    {
+        for (s = 0; s <= SHA1_SHORT_MAX_SIZE; s++)
+        {
+            uint64_t size = s;
+
+            Report(Measure("SHA1_Short", "SHA1", size*SHORT_CALLS, SHORT_CALLS, [&]
+            {
+                for (i = 0; i < SHORT_CALLS; i++)
+                    SHA1(data, size, hash32);
+            }));
+
+            Report(Measure("SHA1_Short", "SHA1_Concat", size*SHORT_CALLS, SHORT_CALLS, [&]
+            {
+                for (i = 0; i < SHORT_CALLS; i++)
+                    SHA1_Concat(&data, 1, &size, hash32);
+            }));
+        }
+
+        Measure_Fixed(data, Report, std::make_index_sequence<SHA1_SHORT_MAX_SIZE + 1>());
+    }
+
+    /* SHA1_Batch per kernel and SHA1_Queue, hashing BATCH_TEXTS texts of the given size. The reported size is the
+       total number of bytes and the segments the number of texts */
+
+    for (s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]) && SIZES[s] <= BATCH_MAX_SIZE && SIZES[s] <= max_size; s++)
+    {
+        uint64_t size = SIZES[s];
+        std::vector<char*> texts(BATCH_TEXTS);
+        std::vector<uint64_t> sizes(BATCH_TEXTS, size);
+        std::vector<uint32_t> hashes(5*BATCH_TEXTS);
+        const struct sha1_kernel *kernels;
+        unsigned int nr_of_kernels;
+
+        for (i = 0; i < BATCH_TEXTS; i++)
+            texts[i] = data + (size*i) % (max_size - size + 1);
+
+        kernels = SHA1_Kernels(&nr_of_kernels);
+        for (k = 0; k < nr_of_kernels && WANTED("SHA1_Batch"); k++)
+            Report(Measure("SHA1_Batch", kernels[k].name, size*BATCH_TEXTS, BATCH_TEXTS,
+                           [&] { SHA1_Batch_Kernel(&kernels[k], &texts[0], &sizes[0], BATCH_TEXTS, &hashes[0]); }));
+
+        if (WANTED("SHA1_Queue"))
+        {
+            SHA1_Queue queue(100);
+            std::vector<std::future<SHA1_Queue::Digest> > futures(BATCH_TEXTS);
+
+            Report(Measure("SHA1_Queue", SHA1_Default_Kernel()->name, size*BATCH_TEXTS, BATCH_TEXTS, [&]
+            {
+                for (i = 0; i < BATCH_TEXTS; i++)
+                    futures[i] = queue.Submit(texts[i], size);
+                for (i = 0; i < BATCH_TEXTS; i++)
+                    futures[i].get();
+            }));
+        }
+    }
+
+    /* SHA_Hex_Encode_Batch per kernel, compared with sprintf, writing HEX_HASHES SHA1 hashes one per line. The
+       reported size is the number of characters written and the segments the number of hashes */
+
+    if (WANTED("SHA_Hex_Encode_Batch"))
+    {
+        const char *hex_kernels[] = {"sprintf", "scalar", "ssse3", "avx2"};
+        std::vector<uint32_t> hashes(5*HEX_HASHES);
+        std::vector<char> hex(41*HEX_HASHES + 1);
+
+        for (i = 0; i < 5*HEX_HASHES; i++)
+            hashes[i] = (uint32_t) (i*2654435761u);
+
+        Report(Measure("SHA_Hex_Encode_Batch", hex_kernels[0], 41*HEX_HASHES, HEX_HASHES, [&]
+        {
+            for (i = 0; i < HEX_HASHES; i++)
+                sprintf(&hex[41*i], "%08x%08x%08x%08x%08x\n", hashes[5*i], hashes[5*i + 1], hashes[5*i + 2],
+                        hashes[5*i + 3], hashes[5*i + 4]);
+        }));
+
+        for (k = 1; k < sizeof(hex_kernels)/sizeof(hex_kernels[0]); k++)
+            if (SHA_Hex_Set_Kernel(hex_kernels[k]) == EXIT_SUCCESS)
+                Report(Measure("SHA_Hex_Encode_Batch", hex_kernels[k], 41*HEX_HASHES, HEX_HASHES,
+                               [&] { SHA_Hex_Encode_Batch(&hashes[0], HEX_HASHES, 5, &hex[0], '\n', SHA_HEX_LOWERCASE); }));
+        SHA_Hex_Set_Kernel(NULL);
+    }
+
+    /* SHA_HOTP_Verify of one code against a window of counters, compared with one HMAC_SHA1 per counter, and
+       SHA_HOTP_Verify_Batch of OTP_USERS codes. The reported size is the number of counters tried */
+
+    if (WANTED("SHA_HOTP_Verify"))
+    {
+        const unsigned int windows[] = {1, 3, 10};
+        std::vector<struct sha_otp_key> otp_keys(OTP_USERS);
+        std::vector<struct sha_otp_check> checks(OTP_USERS);
+
+        for (i = 0; i < OTP_USERS; i++)
+        {
+            SHA_OTP_Set_Key(data + i % 64, 20, &otp_keys[i]);
+            checks[i].key = &otp_keys[i];
+            checks[i].counter = 50000000 + i;
+            checks[i].code = (uint32_t) i;
+        }
+
+        for (k = 0; k < sizeof(windows)/sizeof(windows[0]); k++)
+        {
+            unsigned int window = windows[k];
+
+            Report(Measure("SHA_HOTP_Verify", "HMAC_SHA1", 2*window + 1, 1, [&]
+            {
+                char counter[8] = {0};
+                for (i = 0; i <= 2*window; i++)
+                {
+                    counter[7] = (char) i;
+                    HMAC_SHA1(data, 20, counter, 8, hash32);
+                }
+            }));
+
+            Report(Measure("SHA_HOTP_Verify", SHA1_Default_Kernel()->name, 2*window + 1, 1,
+                           [&] { SHA_HOTP_Verify(&otp_keys[0], 50000000, window, 6, 123456, NULL); }));
+
+            Report(Measure("SHA_HOTP_Verify_Batch", SHA1_Default_Kernel()->name, (2*window + 1)*OTP_USERS, OTP_USERS,
+                           [&] { SHA_HOTP_Verify_Batch(&checks[0], OTP_USERS, window, 6); }));
+        }
+    }
+
+    /* SHA_UUID5_Batch per kernel writing bytes and text, compared with SHA1_Concat of the namespace and each name,
+       for UUID_NAMES names of the given size. The reported size is the total size of the names */
+
+    for (k = 0; k < 3 && WANTED("SHA_UUID5_Batch"); k++)
+    {
+        const uint64_t name_sizes[] = {8, 16, 39};
+        uint64_t size = name_sizes[k];
+        struct sha_uuid_namespace ns;
+        std::vector<char*> names(UUID_NAMES);
+        std::vector<uint64_t> sizes(UUID_NAMES, size);
+        std::vector<unsigned char> uuids(SHA_UUID_SIZE*UUID_NAMES);
+        std::vector<char> texts(SHA_UUID_TEXT_SIZE*UUID_NAMES);
+        const struct sha1_kernel *kernels;
+        unsigned int nr_of_kernels, j;
+
+        SHA_UUID_Set_Namespace(SHA_UUID_NAMESPACE_DNS, &ns);
+        for (i = 0; i < UUID_NAMES; i++)
+            names[i] = data + (size*i) % (max_size - size + 1);
+
+        Report(Measure("SHA_UUID5_Batch", "SHA1_Concat", size*UUID_NAMES, UUID_NAMES, [&]
+        {
+            for (i = 0; i < UUID_NAMES; i++)
+            {
+                char *strings[] = {(char*) ns.bytes, names[i]};
+                uint64_t string_sizes[] = {SHA_UUID_SIZE, size};
+                SHA1_Concat(strings, 2, string_sizes, hash32);
+            }
+        }));
+
+        kernels = SHA1_Kernels(&nr_of_kernels);
+        for (j = 0; j < nr_of_kernels; j++)
+            Report(Measure("SHA_UUID5_Batch", kernels[j].name, size*UUID_NAMES, UUID_NAMES, [&]
+            {
+                SHA_UUID5_Batch_Kernel(&kernels[j], &ns, &names[0], &sizes[0], UUID_NAMES, &uuids[0], &texts[0]);
+            }));
+    }
+
+    /* SHA_HMAC_Verify_Batch per kernel of HMAC_MESSAGES messages of the given size, each with a key of its own of 20
+       bytes or, hashed first, of 100 bytes, compared with HMAC_SHA1 and memcmp per message. The reported size is the
+       total size of the messages */
+
+    for (k = 0; k < 4 && WANTED("SHA_HMAC_Verify_Batch"); k++)
+    {
+        const uint64_t text_sizes[] = {64, 1024, 64, 1024};
+        const uint64_t key_sizes[] = {20, 20, 100, 100};
+        uint64_t size = text_sizes[k], key_size = key_sizes[k];
+        std::vector<struct sha_hmac_check> checks(HMAC_MESSAGES);
+        std::vector<unsigned char> tags(SHA_HMAC_TAG_SIZE*HMAC_MESSAGES);
+        std::vector<uint64_t> matches((HMAC_MESSAGES + 63)/64);
+        std::string label = "key" + std::to_string(key_size);
+        const struct sha1_kernel *kernels;
+        unsigned int nr_of_kernels, j;
+
+        for (i = 0; i < HMAC_MESSAGES; i++)
+        {
+            checks[i].key = data + (7*i) % (max_size - key_size + 1);
+            checks[i].key_byte_size = key_size;
+            checks[i].text = data + (size*i) % (max_size - size + 1);
+            checks[i].text_byte_size = size;
+            checks[i].tag = &tags[SHA_HMAC_TAG_SIZE*i];
+        }
+
+        Report(Measure("SHA_HMAC_Verify_Batch", "HMAC_SHA1/" + label, size*HMAC_MESSAGES, HMAC_MESSAGES, [&]
+        {
+            unsigned char tag[SHA_HMAC_TAG_SIZE];
+            for (i = 0; i < HMAC_MESSAGES; i++)
+            {
+                HMAC_SHA1((char*) checks[i].key, (unsigned int) key_size, (char*) checks[i].text, size, hash32);
+                for (j = 0; j < SHA_HMAC_TAG_SIZE; j++)
+                    tag[j] = (unsigned char) (hash32[j/4] >> 8*(3 - j % 4));
+                matches[i/64] |= (uint64_t) (memcmp(tag, checks[i].tag, SHA_HMAC_TAG_SIZE) == 0) << (i % 64);
+            }
+        }));
+
+        kernels = SHA1_Kernels(&nr_of_kernels);
+        for (j = 0; j < nr_of_kernels; j++)
+            Report(Measure("SHA_HMAC_Verify_Batch", std::string(kernels[j].name) + "/" + label, size*HMAC_MESSAGES,
+                           HMAC_MESSAGES, [&] { SHA_HMAC_Verify_Batch_Kernel(&kernels[j], &checks[0], HMAC_MESSAGES, &matches[0]); }));
+    }
+
+    /* SHA1_Chain of one chain of CHAIN_STEPS steps, compared with SHA1 of the bytes of the previous hash, and
+       SHA1_Chain_Batch per kernel of CHAIN_LANES_CHAINS chains. The reported size is the number of bytes hashed, 20 per
+       step */
+
+    if (WANTED("SHA1_Chain"))
+    {
+        std::vector<uint32_t> chains(5*CHAIN_LANES_CHAINS);
+        const struct sha1_kernel *kernels;
+        unsigned int nr_of_kernels, j;
+
+        for (i = 0; i < 5*CHAIN_LANES_CHAINS; i++)
+            chains[i] = (uint32_t) i;
+
+        Report(Measure("SHA1_Chain", "SHA1", 20*CHAIN_STEPS, 1, [&]
+        {
+            char bytes[20] = {0};
+            for (i = 0; i < CHAIN_STEPS; i++)
+            {
+                SHA1(bytes, 20, hash32);
+                for (j = 0; j < 5; j++)
+                    Conv_32Int_To_Word(hash32[j], &bytes[4*j]);
+            }
+        }));
+
+        Report(Measure("SHA1_Chain", "scalar", 20*CHAIN_STEPS, 1, [&] { SHA1_Chain(&chains[0], CHAIN_STEPS, 0, NULL, hash32); }));
+
+        kernels = SHA1_Kernels(&nr_of_kernels);
+        for (j = 0; j < nr_of_kernels; j++)
+            Report(Measure("SHA1_Chain_Batch", kernels[j].name, 20*CHAIN_STEPS/16*CHAIN_LANES_CHAINS, CHAIN_LANES_CHAINS, [&]
+            {
+                SHA1_Chain_Batch_Kernel(&kernels[j], &chains[0], CHAIN_LANES_CHAINS, CHAIN_STEPS/16, 0, NULL, &chains[0]);
+            }));
+    }
+
+    /* SHA_Set_Contains one hash at a time and SHA_Set_Contains_Batch of SET_QUERIES hashes, half of them in the set,
+       against a set of SET_HASHES random hashes with and without a Bloom filter. The reported size is the number of
+       hashes looked up */
+
+    if (WANTED("SHA_Set_Contains"))
+    {
+        const char set_filename[] = "bench_sha.set";
+        const unsigned int bloom_bits[] = {0, SHA_SET_DEFAULT_BLOOM_BITS};
+        std::vector<uint32_t> set_hashes(5*(uint64_t) SET_HASHES);
+        std::vector<uint32_t> queries(5*SET_QUERIES);
+        std::vector<unsigned char> results(SET_QUERIES);
+        uint64_t x = 0x9E3779B97F4A7C15ull;
+        struct sha_set set;
+
+        for (i = 0; i < 5*(uint64_t) SET_HASHES; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            set_hashes[i] = (uint32_t) (x >> 32);
+        }
+        for (i = 0; i < SET_QUERIES; i++)
+            memcpy(&queries[5*i], i % 2 == 0 ? &set_hashes[5*((i*2654435761u) % SET_HASHES)] : &set_hashes[5*i], 20);
+        for (i = 1; i < SET_QUERIES; i += 2)
+            queries[5*i] ^= 0x5A5A5A5A;
+
+        for (k = 0; k < 2; k++)
+        {
+            if (SHA_Set_Build(set_filename, &set_hashes[0], SET_HASHES, bloom_bits[k]) != EXIT_SUCCESS ||
+                SHA_Set_Open(&set, set_filename) != EXIT_SUCCESS)
+                continue;
+
+            Report(Measure("SHA_Set_Contains", bloom_bits[k] == 0 ? "index" : "bloom", SET_QUERIES, SET_QUERIES, [&]
+            {
+                for (i = 0; i < SET_QUERIES; i++)
+                    results[i] = (unsigned char) SHA_Set_Contains(&set, &queries[5*i]);
+            }));
+
+            Report(Measure("SHA_Set_Contains_Batch", bloom_bits[k] == 0 ? "index" : "bloom", SET_QUERIES, SET_QUERIES,
+                           [&] { SHA_Set_Contains_Batch(&set, &queries[0], SET_QUERIES, &results[0]); }));
+
+            SHA_Set_Close(&set);
+        }
+        remove(set_filename);
+    }
+
+    /* SHA1_Column64 of a column of COLUMN_ROWS rows of skewed lengths, 90% of 1 to 32 bytes, 9% of 33 to 512 bytes and
+       1% of 513 to 2048 bytes, on one thread and on one thread per processor, compared with SHA1 per row and with
+       SHA1_Batch of the rows in column order. The reported size is the size of the data of the column */
+
+    if (WANTED("SHA1_Column64"))
+    {
+        uint64_t nr_of_rows = max_size >= 64*MiB ? COLUMN_ROWS : COLUMN_ROWS/10;
+        std::vector<int64_t> offsets(nr_of_rows + 1);
+        std::vector<char*> texts(nr_of_rows);
+        std::vector<uint64_t> texts_byte_size(nr_of_rows);
+        std::vector<uint32_t> hashes(5*nr_of_rows);
+        std::vector<char> column;
+        uint32_t x = 12345;
+        unsigned int nr_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        offsets[0] = 0;
+        for (i = 0; i < nr_of_rows; i++)
+        {
+            x = x*1103515245 + 12345;
+            if ((x >> 16) % 100 == 0)
+                offsets[i + 1] = offsets[i] + 513 + (x >> 4) % 1536;
+            else if ((x >> 16) % 10 == 0)
+                offsets[i + 1] = offsets[i] + 33 + (x >> 4) % 480;
+            else
+                offsets[i + 1] = offsets[i] + 1 + (x >> 4) % 32;
+        }
+        column.resize(offsets[nr_of_rows]);
+        for (i = 0; i < column.size(); i++)
+            column[i] = data[i % max_size];
+        for (i = 0; i < nr_of_rows; i++)
+        {
+            texts[i] = &column[offsets[i]];
+            texts_byte_size[i] = offsets[i + 1] - offsets[i];
+        }
+
+        Report(Measure("SHA1_Column64", "SHA1", column.size(), nr_of_rows, [&]
+        {
+            for (i = 0; i < nr_of_rows; i++)
+                SHA1(texts[i], texts_byte_size[i], &hashes[5*i]);
+        }));
+
+        Report(Measure("SHA1_Column64", std::string("SHA1_Batch/") + SHA1_Default_Kernel()->name, column.size(), nr_of_rows,
+                       [&] { SHA1_Batch(&texts[0], &texts_byte_size[0], nr_of_rows, &hashes[0]); }));
+
+        Report(Measure("SHA1_Column64", std::string(SHA1_Default_Kernel()->name) + "/1", column.size(), nr_of_rows,
+                       [&] { SHA1_Column64(&column[0], &offsets[0], nr_of_rows, &hashes[0], 1, NULL); }));
+
+        if (nr_of_threads > 1)
+            Report(Measure("SHA1_Column64", std::string(SHA1_Default_Kernel()->name) + "/" + std::to_string(nr_of_threads),
+                           column.size(), nr_of_rows,
+                           [&] { SHA1_Column64(&column[0], &offsets[0], nr_of_rows, &hashes[0], nr_of_threads, NULL); }));
+    }
+
+    /* SHA1_Concat with the message split into a varying number of segments */
+
+    for (s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]) && SIZES[s] <= max_size; s++)
+        for (k = 0; k < sizeof(CONCAT_SEGMENTS)/sizeof(CONCAT_SEGMENTS[0]) && WANTED("SHA1_Concat"); k++)
+        {
+            uint64_t size = SIZES[s];
+            uint64_t nr_of_segments = CONCAT_SEGMENTS[k];
+            std::vector<char*> strings(nr_of_segments);
+            std::vector<uint64_t> sizes(nr_of_segments);
+
+            if (size < 64 && size != 55 && size != 56)
+                continue;
+
+            for (i = 0; i < nr_of_segments; i++)
+            {
+                strings[i] = data + size*i/nr_of_segments;
+                sizes[i] = size*(i + 1)/nr_of_segments - size*i/nr_of_segments;
+            }
+
+            Report(Measure("SHA1_Concat", "portable", size, nr_of_segments,
+                                      [&] { SHA1_Concat(&strings[0], nr_of_segments, &sizes[0], hash32); }));
+        }
+
+    /* File APIs with the file in the page cache (warm) and evicted before every call (cold) */
+
+    for (s = 0; s < sizeof(FILE_SIZES)/sizeof(FILE_SIZES[0]) && FILE_SIZES[s] <= max_size; s++)
+    {
+        uint64_t size = FILE_SIZES[s];
+        FILE *fp;
+
+        if (!WANTED("SHA1_File") && !WANTED("SHA256_File") && !WANTED("SHA512_256_File"))
+            break;
+
+        fp = fopen(filename, "wb");
+        if (fp == NULL || fwrite(data, 1, size, fp) != size)
+        {
+            fprintf(stderr, "Could not write %s\n", filename);
+            return EXIT_FAILURE;
+        }
+        fclose(fp);
+
+        if (WANTED("SHA1_File"))
+        {
+            Report(Measure("SHA1_File/warm", "portable", size, 1, [&] { SHA1_File(filename, hash32); }));
+            Report(Measure("SHA1_File/cold", "portable", size, 1, [&] { SHA1_File(filename, hash32); },
+                                      [&] { Evict_File(filename); }));
+        }
+
+        if (WANTED("SHA256_File"))
+            Report(Measure("SHA256_File/warm", Kernel_Name(SHA256_Get_Kernel()), size, 1,
+                                      [&] { SHA256_File(filename, hash32); }));
+
+        /* The same files hashed by the kernel through AF_ALG, where the kernel provides it */
+
+        if (SHA_File_Set_Backend(SHA_FILE_BACKEND_AF_ALG) == EXIT_SUCCESS)
+        {
+            if (WANTED("SHA1_File"))
+            {
+                Report(Measure("SHA1_File/warm", "af_alg", size, 1, [&] { SHA1_File(filename, hash32); }));
+                Report(Measure("SHA1_File/cold", "af_alg", size, 1, [&] { SHA1_File(filename, hash32); },
+                                          [&] { Evict_File(filename); }));
+            }
+
+            if (WANTED("SHA256_File"))
+                Report(Measure("SHA256_File/warm", "af_alg", size, 1, [&] { SHA256_File(filename, hash32); }));
+
+            SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY);
+        }
+
+        if (WANTED("SHA512_256_File"))
+            Report(Measure("SHA512_256_File/warm", "portable", size, 1,
+                                      [&] { SHA512_256_File(filename, hash64); }));
+    }
+    remove(filename);
+
+    printf("\n  ]\n}\n");
+
+    free(data);
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,8 @@
 #include <stdio.h>
 
 #include "shalib.h"
+#include "shaalg.h"
+#include "shasparse.h"
 #include "sha1.h"
 
 #define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */ 
@@ -121,7 +123,20 @@ void SHA1_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_
 
 void SHA1(char *text, uint64_t text_byte_size, uint32_t *hash)
 {
+    const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
     uint64_t text_byte_size_[1];
+    int i;
+
+    /* Texts that fit in two blocks together with the pad are hashed without the word pointer */
+
+    if (text_byte_size <= SHA1_SHORT_MAX_SIZE)
+    {
+        for (i = 0; i < HASH_SIZE; i++)
+            hash[i] = H_init[i];
+        SHA1_Hash_Short((unsigned char*) text, (unsigned int) text_byte_size, hash);
+        return;
+    }
+
     text_byte_size_[0] = text_byte_size;
     SHA1_Concat(&text, 1, text_byte_size_, hash);
 }
@@ -152,6 +167,16 @@ int SHA1_File(char *filename, uint32_t *hash)
     struct sha_word_pointer p;                  /* the word pointer                     */
 
 
+    /* Let the kernel hash the file if the AF_ALG backend is selected, see shaalg.c */
+
+    if (SHA_File_Get_Backend() == SHA_FILE_BACKEND_AF_ALG && SHA_AF_ALG_File("sha1", filename, hash, HASH_SIZE) == EXIT_SUCCESS)
+        return EXIT_SUCCESS;
+
+    /* Read the data regions alone if the sparse backend is selected, see shasparse.c */
+
+    if (SHA_File_Get_Backend() == SHA_FILE_BACKEND_SPARSE && SHA_Sparse_File("sha1", filename, hash, HASH_SIZE, NULL) == EXIT_SUCCESS)
+        return EXIT_SUCCESS;
+
     /* Open the file and determine its size */ 
 
     fp = fopen(filename, "rb");
@@ -178,6 +203,8 @@ int SHA1_File(char *filename, uint32_t *hash)
 
     SHA1_Compute(&p, hash);
 
+    fclose(fp);
+
     /* Return exit status */
 
     exit_status = EXIT_SUCCESS;
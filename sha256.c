@@ -0,0 +1,311 @@
+/***************************************************************************************************************************************
+ * FILE NAME: sha256.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-04
+ *
+ * CONTENT: Implements the SHA-256 and SHA-224 hash algorithms and their corresponding HMAC functions in accordance with the
+ *          NIST specifications (FIPS PUB 180-4) and (FIPS PUB 198-1).
+ *
+ *          Both algorithms share the SHA-256 iteration function and operate on 64-byte blocks of 32-bit words. They
+ *          differ only in the initial hash vector and in how many words of the final hash are kept.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "shalib.h"
+#include "shaalg.h"
+#include "shasparse.h"
+#include "sha256.h"
+
+#define BLOCK_SIZE 64               /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4                 /* defines the size of a word in BYTES                                      */
+#define STATE_SIZE 8                /* defines the size of the internal state in number of 32-bit INTEGERS      */
+#define SHA256_HASH_SIZE 8          /* defines the size of the SHA-256 hash in number of 32-bit INTEGERS        */
+#define SHA224_HASH_SIZE 7          /* defines the size of the SHA-224 hash in number of 32-bit INTEGERS        */
+
+
+static const uint32_t SHA256_H_init[] = {0x6a09e667,        /* Initial SHA-256 hash vector */
+                                         0xbb67ae85,
+                                         0x3c6ef372,
+                                         0xa54ff53a,
+                                         0x510e527f,
+                                         0x9b05688c,
+                                         0x1f83d9ab,
+                                         0x5be0cd19};
+
+static const uint32_t SHA224_H_init[] = {0xc1059ed8,        /* Initial SHA-224 hash vector */
+                                         0x367cd507,
+                                         0x3070dd17,
+                                         0xf70e5939,
+                                         0xffc00b31,
+                                         0x68581511,
+                                         0x64f98fa7,
+                                         0xbefa4fa4};
+
+
+
+/************************************************************************************************************/
+
+/* The function Compute_Hash runs the SHA-256 iteration over all blocks of the word pointer, starting from the
+   initial hash vector H_init, and stores the first hash_size words of the final hash. Whole blocks that lie
+   inside one of the strings are hashed directly from memory, the remaining blocks go through the word pointer */
+
+static void Compute_Hash(struct sha_word_pointer *p, const uint32_t *H_init, uint32_t *hash, unsigned int hash_size)
+{
+    uint32_t H[STATE_SIZE];
+    uint64_t N;
+    uint64_t nr_of_blocks;
+    unsigned char *data;
+    uint64_t i;
+
+    /* Initiate the hash */
+
+    for (i = 0; i < STATE_SIZE; i++)
+        H[i] = H_init[i];
+
+    /* Iterate the hash */
+
+    N = p->tot_byte_size/BLOCK_SIZE;
+    i = 0;
+    while (i < N)
+    {
+        nr_of_blocks = Get_Bulk_Blocks(p, &data, BLOCK_SIZE);
+
+        if (nr_of_blocks > 0)
+        {
+            SHA256_Hash_Blocks(data, nr_of_blocks, H);
+            i = i + nr_of_blocks;
+        }
+        else
+        {
+            SHA256_Iterate_Hash(p, H);
+            i++;
+        }
+    }
+
+    /* Store final (truncated) hash */
+
+    for (i = 0; i < hash_size; i++)
+        hash[i] = H[i];
+}
+
+/* The function Concat_Hash sets up the word pointer for a virtual concatenation of char arrays and hashes it */
+
+static void Concat_Hash(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, const uint32_t *H_init,
+                        uint32_t *hash, unsigned int hash_size)
+{
+    uint64_t i;
+    uint64_t concat_byte_size;                   /* the size in bytes of the total string concatenation     */
+    unsigned char pad[BLOCK_SIZE + 9];           /* the pad                                                 */
+    struct sha_word_pointer p;                   /* the word pointer                                        */
+
+    /* Initiate the word pointer */
+
+    Set_Zero(&p);
+    p.strings = strings;
+    p.nr_of_strings = nr_of_strings;
+    p.strings_byte_size = strings_byte_size;
+
+    /* Calculate the total byte-size of the string concatenation and set the pad */
+
+    concat_byte_size = 0;
+    for (i = 0; i < nr_of_strings; i++)
+        concat_byte_size = concat_byte_size + strings_byte_size[i];
+    Set_64Byte_Pad(&p, pad, concat_byte_size);
+
+    /* Compute the hash */
+
+    Compute_Hash(&p, H_init, hash, hash_size);
+}
+
+/* The function File_Hash sets up the word pointer for a file and hashes its content, unless the AF_ALG backend is
+   selected and the kernel hashes it with the algorithm of the given name */
+
+static int File_Hash(char *filename, const char *algorithm, const uint32_t *H_init, uint32_t *hash, unsigned int hash_size)
+{
+    FILE* fp;                                   /* pointer to the file to be hashed     */
+    uint64_t file_byte_size;                    /* the size of the file in bytes        */
+    unsigned char pad[BLOCK_SIZE + 9];          /* the pad                              */
+    struct sha_word_pointer p;                  /* the word pointer                     */
+
+    if (SHA_File_Get_Backend() == SHA_FILE_BACKEND_AF_ALG && SHA_AF_ALG_File(algorithm, filename, hash, hash_size) == EXIT_SUCCESS)
+        return EXIT_SUCCESS;
+    if (SHA_File_Get_Backend() == SHA_FILE_BACKEND_SPARSE && SHA_Sparse_File(algorithm, filename, hash, hash_size, NULL) == EXIT_SUCCESS)
+        return EXIT_SUCCESS;
+
+    /* Open the file and determine its size */
+
+    fp = fopen(filename, "rb");
+    if (fp == NULL)
+        return EXIT_FAILURE;
+
+    fseek(fp, 0L, SEEK_END);
+    file_byte_size = ftell(fp);
+    rewind(fp);
+
+    /* Initiate the word pointer and set the pad */
+
+    Set_Zero(&p);
+    p.fp = fp;
+    p.file_byte_size = file_byte_size;
+    Set_64Byte_Pad(&p, pad, file_byte_size);
+
+    /* Compute the hash */
+
+    Compute_Hash(&p, H_init, hash, hash_size);
+
+    fclose(fp);
+    return EXIT_SUCCESS;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SHA-256
+ *
+ **************************************************************************************************************************************/
+
+void SHA256_Compute(struct sha_word_pointer *p, uint32_t *hash)
+{
+    Compute_Hash(p, SHA256_H_init, hash, SHA256_HASH_SIZE);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA256_Concat
+ *
+ * PURPOSE: Takes as an argument a collection of char arrays, performs a virtual concatenation of these arrays in
+ *          the order they appear, implements the SHA-256 algorithm on the concatenated array and stores the resulting hash.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * strings             char**          I       the pointer to the char* array containing the pointers to the char arrays
+ *                                             to be hashed as a concatenation
+ * nr_of_strings       uint64_t        I       the number of char arrays in the concatenation
+ * strings_byte_size   uint64_t*       I       pointer to the uint64_t array containing the size in bytes of each char array
+ * hash                uint32_t*:      O       pointer to the uint32_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA256_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint32_t *hash)
+{
+    Concat_Hash(strings, nr_of_strings, strings_byte_size, SHA256_H_init, hash, SHA256_HASH_SIZE);
+}
+
+/********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA256
+ *
+ * PURPOSE: Takes as an argument a char array and computes its SHA-256 hash
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * text                char*           I       the pointer to the char array containing the text to be hashed
+ * text_byte_size      uint64_t        I       the byte size of the char array to be hashed
+ * hash                uint32_t*:      O       pointer to the uint32_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA256(char *text, uint64_t text_byte_size, uint32_t *hash)
+{
+    uint64_t text_byte_size_[1];
+    text_byte_size_[0] = text_byte_size;
+    SHA256_Concat(&text, 1, text_byte_size_, hash);
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA256_File
+ *
+ * PURPOSE: Takes as an argument a file name and computes the SHA-256 hash of its content
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * filename            char*           I       pointer to char array containing the file name
+ * hash                uint32_t*:      O       pointer to the uint32_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the file cannot be opened, otherwise EXIT_SUCCESS
+ *
+ *******************************************************************************************************************************/
+
+int SHA256_File(char *filename, uint32_t *hash)
+{
+    return File_Hash(filename, "sha256", SHA256_H_init, hash, SHA256_HASH_SIZE);
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: HMAC_SHA256
+ *
+ * PURPOSE: Takes as an argument a string and a key and computes the corresponding HMAC-SHA-256 digest
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * key                 char*           I       the pointer to the char array containing the key
+ * key_size            unsigned int    I       the key size in bytes
+ * text                char*           I       the pointer to the char array containing the text to be digested with the key
+ * text_size           uint64_t        I       the byte size of the char array containing the text
+ * digest              uint32_t*:      O       pointer to the uint32_t array (8 words) where the resulting digest is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *******************************************************************************************************************************/
+
+void HMAC_SHA256(char *key, unsigned int key_size, char *text, uint64_t text_size, uint32_t *digest)
+{
+    HMAC32(key, key_size, text, text_size, digest, SHA256, SHA256_Concat, SHA256_HASH_SIZE);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SHA-224
+ *
+ *  The functions below are the SHA-224 counterparts of the SHA-256 functions above. They take the same arguments
+ *  but store a hash of 7 words.
+ *
+ **************************************************************************************************************************************/
+
+void SHA224_Compute(struct sha_word_pointer *p, uint32_t *hash)
+{
+    Compute_Hash(p, SHA224_H_init, hash, SHA224_HASH_SIZE);
+}
+
+void SHA224_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint32_t *hash)
+{
+    Concat_Hash(strings, nr_of_strings, strings_byte_size, SHA224_H_init, hash, SHA224_HASH_SIZE);
+}
+
+void SHA224(char *text, uint64_t text_byte_size, uint32_t *hash)
+{
+    uint64_t text_byte_size_[1];
+    text_byte_size_[0] = text_byte_size;
+    SHA224_Concat(&text, 1, text_byte_size_, hash);
+}
+
+int SHA224_File(char *filename, uint32_t *hash)
+{
+    return File_Hash(filename, "sha224", SHA224_H_init, hash, SHA224_HASH_SIZE);
+}
+
+void HMAC_SHA224(char *key, unsigned int key_size, char *text, uint64_t text_size, uint32_t *digest)
+{
+    HMAC32(key, key_size, text, text_size, digest, SHA224, SHA224_Concat, SHA224_HASH_SIZE);
+}
@@ -0,0 +1,35 @@
+/***************************************************************************************************************************************
+ * FILENAME: sha256.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Function prototypes for the SHA-256 family C-library contained in sha256.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHA256__
+#define __SHA256__
+
+
+void SHA256_Compute(struct sha_word_pointer *p, uint32_t *hash);
+
+void SHA256_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_len, uint32_t *hash);
+
+void SHA256(char *text, uint64_t text_byte_size, uint32_t *hash);
+
+int SHA256_File(char *filename, uint32_t *hash);
+
+void HMAC_SHA256(char *key, unsigned int key_len, char *text, uint64_t text_len, uint32_t *digest);
+
+
+void SHA224_Compute(struct sha_word_pointer *p, uint32_t *hash);
+
+void SHA224_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_len, uint32_t *hash);
+
+void SHA224(char *text, uint64_t text_byte_size, uint32_t *hash);
+
+int SHA224_File(char *filename, uint32_t *hash);
+
+void HMAC_SHA224(char *key, unsigned int key_len, char *text, uint64_t text_len, uint32_t *digest);
+
+#endif
@@ -0,0 +1,350 @@
+/***************************************************************************************************************************************
+ * FILE NAME: sha512.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-04
+ *
+ * CONTENT: Implements the SHA-512, SHA-384 and SHA-512/256 hash algorithms and their corresponding HMAC functions in accordance
+ *          with the NIST specifications (FIPS PUB 180-4) and (FIPS PUB 198-1).
+ *
+ *          All three algorithms share the SHA-512 iteration function and operate on 128-byte blocks of 64-bit words. They
+ *          differ only in the initial hash vector and in how many words of the final hash are kept.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "shalib.h"
+#include "sha512.h"
+
+#define BLOCK_SIZE 128              /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 8                 /* defines the size of a word in BYTES                                      */
+#define STATE_SIZE 8                /* defines the size of the internal state in number of 64-bit INTEGERS      */
+#define SHA512_HASH_SIZE 8          /* defines the size of the SHA-512 hash in number of 64-bit INTEGERS        */
+#define SHA384_HASH_SIZE 6          /* defines the size of the SHA-384 hash in number of 64-bit INTEGERS        */
+#define SHA512_256_HASH_SIZE 4      /* defines the size of the SHA-512/256 hash in number of 64-bit INTEGERS    */
+
+
+static const uint64_t SHA512_H_init[] = {0x6a09e667f3bcc908,        /* Initial SHA-512 hash vector */
+                                         0xbb67ae8584caa73b,
+                                         0x3c6ef372fe94f82b,
+                                         0xa54ff53a5f1d36f1,
+                                         0x510e527fade682d1,
+                                         0x9b05688c2b3e6c1f,
+                                         0x1f83d9abfb41bd6b,
+                                         0x5be0cd19137e2179};
+
+static const uint64_t SHA384_H_init[] = {0xcbbb9d5dc1059ed8,        /* Initial SHA-384 hash vector */
+                                         0x629a292a367cd507,
+                                         0x9159015a3070dd17,
+                                         0x152fecd8f70e5939,
+                                         0x67332667ffc00b31,
+                                         0x8eb44a8768581511,
+                                         0xdb0c2e0d64f98fa7,
+                                         0x47b5481dbefa4fa4};
+
+static const uint64_t SHA512_256_H_init[] = {0x22312194fc2bf72c,    /* Initial SHA-512/256 hash vector */
+                                             0x9f555fa3c84c64c2,
+                                             0x2393b86b6f53b151,
+                                             0x963877195940eabd,
+                                             0x96283ee2a88effe3,
+                                             0xbe5e1e2553863992,
+                                             0x2b0199fc2c85b8aa,
+                                             0x0eb72ddc81c52ca2};
+
+
+
+/************************************************************************************************************/
+
+/* The function Compute_Hash runs the SHA-512 iteration over all blocks of the word pointer, starting from the
+   initial hash vector H_init, and stores the first hash_size words of the final hash. Whole blocks that lie
+   inside one of the strings are hashed directly from memory, the remaining blocks go through the word pointer */
+
+static void Compute_Hash(struct sha_word_pointer *p, const uint64_t *H_init, uint64_t *hash, unsigned int hash_size)
+{
+    uint64_t H[STATE_SIZE];
+    uint64_t N;
+    uint64_t nr_of_blocks;
+    unsigned char *data;
+    uint64_t i;
+
+    /* Initiate the hash */
+
+    for (i = 0; i < STATE_SIZE; i++)
+        H[i] = H_init[i];
+
+    /* Iterate the hash */
+
+    N = p->tot_byte_size/BLOCK_SIZE;
+    i = 0;
+    while (i < N)
+    {
+        nr_of_blocks = Get_Bulk_Blocks(p, &data, BLOCK_SIZE);
+
+        if (nr_of_blocks > 0)
+        {
+            SHA512_Hash_Blocks(data, nr_of_blocks, H);
+            i = i + nr_of_blocks;
+        }
+        else
+        {
+            SHA512_Iterate_Hash(p, H);
+            i++;
+        }
+    }
+
+    /* Store final (truncated) hash */
+
+    for (i = 0; i < hash_size; i++)
+        hash[i] = H[i];
+}
+
+/* The function Concat_Hash sets up the word pointer for a virtual concatenation of char arrays and hashes it */
+
+static void Concat_Hash(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, const uint64_t *H_init,
+                        uint64_t *hash, unsigned int hash_size)
+{
+    uint64_t i;
+    uint64_t concat_byte_size;                   /* the size in bytes of the total string concatenation     */
+    unsigned char pad[BLOCK_SIZE + 17];          /* the pad                                                 */
+    struct sha_word_pointer p;                   /* the word pointer                                        */
+
+    /* Initiate the word pointer */
+
+    Set_Zero(&p);
+    p.strings = strings;
+    p.nr_of_strings = nr_of_strings;
+    p.strings_byte_size = strings_byte_size;
+
+    /* Calculate the total byte-size of the string concatenation and set the pad */
+
+    concat_byte_size = 0;
+    for (i = 0; i < nr_of_strings; i++)
+        concat_byte_size = concat_byte_size + strings_byte_size[i];
+    Set_128Byte_Pad(&p, pad, concat_byte_size);
+
+    /* Compute the hash */
+
+    Compute_Hash(&p, H_init, hash, hash_size);
+}
+
+/* The function File_Hash sets up the word pointer for a file and hashes its content */
+
+static int File_Hash(char *filename, const uint64_t *H_init, uint64_t *hash, unsigned int hash_size)
+{
+    FILE* fp;                                   /* pointer to the file to be hashed     */
+    uint64_t file_byte_size;                    /* the size of the file in bytes        */
+    unsigned char pad[BLOCK_SIZE + 17];         /* the pad                              */
+    struct sha_word_pointer p;                  /* the word pointer                     */
+
+    /* Open the file and determine its size */
+
+    fp = fopen(filename, "rb");
+    if (fp == NULL)
+        return EXIT_FAILURE;
+
+    fseek(fp, 0L, SEEK_END);
+    file_byte_size = ftell(fp);
+    rewind(fp);
+
+    /* Initiate the word pointer and set the pad */
+
+    Set_Zero(&p);
+    p.fp = fp;
+    p.file_byte_size = file_byte_size;
+    Set_128Byte_Pad(&p, pad, file_byte_size);
+
+    /* Compute the hash */
+
+    Compute_Hash(&p, H_init, hash, hash_size);
+
+    fclose(fp);
+    return EXIT_SUCCESS;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SHA-512
+ *
+ **************************************************************************************************************************************/
+
+void SHA512_Compute(struct sha_word_pointer *p, uint64_t *hash)
+{
+    Compute_Hash(p, SHA512_H_init, hash, SHA512_HASH_SIZE);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA512_Concat
+ *
+ * PURPOSE: Takes as an argument a collection of char arrays, performs a virtual concatenation of these arrays in
+ *          the order they appear, implements the SHA-512 algorithm on the concatenated array and stores the resulting hash.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * strings             char**          I       the pointer to the char* array containing the pointers to the char arrays
+ *                                             to be hashed as a concatenation
+ * nr_of_strings       uint64_t        I       the number of char arrays in the concatenation
+ * strings_byte_size   uint64_t*       I       pointer to the uint64_t array containing the size in bytes of each char array
+ * hash                uint64_t*:      O       pointer to the uint64_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA512_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint64_t *hash)
+{
+    Concat_Hash(strings, nr_of_strings, strings_byte_size, SHA512_H_init, hash, SHA512_HASH_SIZE);
+}
+
+/********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA512
+ *
+ * PURPOSE: Takes as an argument a char array and computes its SHA-512 hash
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * text                char*           I       the pointer to the char array containing the text to be hashed
+ * text_byte_size      uint64_t        I       the byte size of the char array to be hashed
+ * hash                uint64_t*:      O       pointer to the uint64_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA512(char *text, uint64_t text_byte_size, uint64_t *hash)
+{
+    uint64_t text_byte_size_[1];
+    text_byte_size_[0] = text_byte_size;
+    SHA512_Concat(&text, 1, text_byte_size_, hash);
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA512_File
+ *
+ * PURPOSE: Takes as an argument a file name and computes the SHA-512 hash of its content
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * filename            char*           I       pointer to char array containing the file name
+ * hash                uint64_t*:      O       pointer to the uint64_t array (8 words) where the resulting hash is to be stored
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the file cannot be opened, otherwise EXIT_SUCCESS
+ *
+ *******************************************************************************************************************************/
+
+int SHA512_File(char *filename, uint64_t *hash)
+{
+    return File_Hash(filename, SHA512_H_init, hash, SHA512_HASH_SIZE);
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: HMAC_SHA512
+ *
+ * PURPOSE: Takes as an argument a string and a key and computes the corresponding HMAC-SHA-512 digest
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * key                 char*           I       the pointer to the char array containing the key
+ * key_size            unsigned int    I       the key size in bytes
+ * text                char*           I       the pointer to the char array containing the text to be digested with the key
+ * text_size           uint64_t        I       the byte size of the char array containing the text
+ * digest              uint64_t*:      O       pointer to the uint64_t array (8 words) where the resulting digest is to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *******************************************************************************************************************************/
+
+void HMAC_SHA512(char *key, unsigned int key_size, char *text, uint64_t text_size, uint64_t *digest)
+{
+    HMAC64(key, key_size, text, text_size, digest, SHA512, SHA512_Concat, SHA512_HASH_SIZE);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SHA-384
+ *
+ *  The functions below are the SHA-384 counterparts of the SHA-512 functions above. They take the same arguments
+ *  but store a hash of 6 words.
+ *
+ **************************************************************************************************************************************/
+
+void SHA384_Compute(struct sha_word_pointer *p, uint64_t *hash)
+{
+    Compute_Hash(p, SHA384_H_init, hash, SHA384_HASH_SIZE);
+}
+
+void SHA384_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint64_t *hash)
+{
+    Concat_Hash(strings, nr_of_strings, strings_byte_size, SHA384_H_init, hash, SHA384_HASH_SIZE);
+}
+
+void SHA384(char *text, uint64_t text_byte_size, uint64_t *hash)
+{
+    uint64_t text_byte_size_[1];
+    text_byte_size_[0] = text_byte_size;
+    SHA384_Concat(&text, 1, text_byte_size_, hash);
+}
+
+int SHA384_File(char *filename, uint64_t *hash)
+{
+    return File_Hash(filename, SHA384_H_init, hash, SHA384_HASH_SIZE);
+}
+
+void HMAC_SHA384(char *key, unsigned int key_size, char *text, uint64_t text_size, uint64_t *digest)
+{
+    HMAC64(key, key_size, text, text_size, digest, SHA384, SHA384_Concat, SHA384_HASH_SIZE);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SHA-512/256
+ *
+ *  The functions below are the SHA-512/256 counterparts of the SHA-512 functions above. They take the same arguments
+ *  but store a hash of 4 words.
+ *
+ **************************************************************************************************************************************/
+
+void SHA512_256_Compute(struct sha_word_pointer *p, uint64_t *hash)
+{
+    Compute_Hash(p, SHA512_256_H_init, hash, SHA512_256_HASH_SIZE);
+}
+
+void SHA512_256_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint64_t *hash)
+{
+    Concat_Hash(strings, nr_of_strings, strings_byte_size, SHA512_256_H_init, hash, SHA512_256_HASH_SIZE);
+}
+
+void SHA512_256(char *text, uint64_t text_byte_size, uint64_t *hash)
+{
+    uint64_t text_byte_size_[1];
+    text_byte_size_[0] = text_byte_size;
+    SHA512_256_Concat(&text, 1, text_byte_size_, hash);
+}
+
+int SHA512_256_File(char *filename, uint64_t *hash)
+{
+    return File_Hash(filename, SHA512_256_H_init, hash, SHA512_256_HASH_SIZE);
+}
+
+void HMAC_SHA512_256(char *key, unsigned int key_size, char *text, uint64_t text_size, uint64_t *digest)
+{
+    HMAC64(key, key_size, text, text_size, digest, SHA512_256, SHA512_256_Concat, SHA512_256_HASH_SIZE);
+}
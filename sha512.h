@@ -0,0 +1,46 @@
+/***************************************************************************************************************************************
+ * FILENAME: sha512.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Function prototypes for the SHA-512 family C-library contained in sha512.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHA512__
+#define __SHA512__
+
+
+void SHA512_Compute(struct sha_word_pointer *p, uint64_t *hash);
+
+void SHA512_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_len, uint64_t *hash);
+
+void SHA512(char *text, uint64_t text_byte_size, uint64_t *hash);
+
+int SHA512_File(char *filename, uint64_t *hash);
+
+void HMAC_SHA512(char *key, unsigned int key_len, char *text, uint64_t text_len, uint64_t *digest);
+
+
+void SHA384_Compute(struct sha_word_pointer *p, uint64_t *hash);
+
+void SHA384_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_len, uint64_t *hash);
+
+void SHA384(char *text, uint64_t text_byte_size, uint64_t *hash);
+
+int SHA384_File(char *filename, uint64_t *hash);
+
+void HMAC_SHA384(char *key, unsigned int key_len, char *text, uint64_t text_len, uint64_t *digest);
+
+
+void SHA512_256_Compute(struct sha_word_pointer *p, uint64_t *hash);
+
+void SHA512_256_Concat(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_len, uint64_t *hash);
+
+void SHA512_256(char *text, uint64_t text_byte_size, uint64_t *hash);
+
+int SHA512_256_File(char *filename, uint64_t *hash);
+
+void HMAC_SHA512_256(char *key, unsigned int key_len, char *text, uint64_t text_len, uint64_t *digest);
+
+#endif
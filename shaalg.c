@@ -0,0 +1,287 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaalg.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-23
+ *
+ * CONTENT: Implements the AF_ALG file backend of SHA1_File, SHA256_File and SHA224_File. The hash is computed by the
+ *          Linux kernel through a hash socket of the AF_ALG family, and the file pages are moved from the page cache to
+ *          the socket by splice through a pipe, so that the content of the file is never copied to user space. The
+ *          kernel uses its own fastest implementation of the algorithm, or a hardware accelerator where one is present.
+ *
+ *          The backend is chosen by SHA_File_Set_Backend. Whenever the kernel cannot hash a file, because AF_ALG is not
+ *          compiled into the kernel, the algorithm is missing or the file system does not support splice, the file
+ *          functions hash the file in the library instead. On other systems than Linux the backend is never available.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/if_alg.h>
+#endif
+
+#include "shaalg.h"
+
+#define PIPE_BYTE_SIZE (1 << 20)        /* defines the size in BYTES requested for the pipe between file and socket    */
+#define MAX_DIGEST_SIZE 64              /* defines the size in BYTES of the largest digest read from the socket        */
+
+/* The backend used by the file functions, as set by SHA_File_Set_Backend */
+
+static int file_backend = SHA_FILE_BACKEND_LIBRARY;
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: TRANSFORMS
+ *
+ *  A transform socket is bound to an algorithm once and then accepts one operation socket per file. The transform
+ *  sockets of the common algorithms are kept open for the life of the process, and an algorithm found to be missing
+ *  is not looked for again.
+ *
+ **************************************************************************************************************************************/
+
+#ifdef __linux__
+
+#define TRANSFORM_UNKNOWN -1
+#define TRANSFORM_MISSING -2
+
+struct sha_transform
+{
+    const char *algorithm;
+    int fd;
+};
+
+static struct sha_transform transforms[] = {{"sha1", TRANSFORM_UNKNOWN}, {"sha224", TRANSFORM_UNKNOWN},
+                                            {"sha256", TRANSFORM_UNKNOWN}, {"sha384", TRANSFORM_UNKNOWN},
+                                            {"sha512", TRANSFORM_UNKNOWN}};
+
+static int Open_Transform(const char *algorithm)
+{
+    struct sockaddr_alg address;
+    int fd;
+
+    if (strlen(algorithm) >= sizeof(address.salg_name))
+        return -1;
+
+    fd = socket(AF_ALG, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    memset(&address, 0, sizeof(address));
+    address.salg_family = AF_ALG;
+    strcpy((char*) address.salg_type, "hash");
+    strcpy((char*) address.salg_name, algorithm);
+
+    if (bind(fd, (struct sockaddr*) &address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* The function Get_Transform returns the transform socket of an algorithm, or -1 if the kernel does not provide it.
+   If the socket is not cached, *owned is set and the caller must close it. */
+
+static int Get_Transform(const char *algorithm, int *owned)
+{
+    unsigned int i;
+    int fd, expected;
+
+    *owned = 0;
+    for (i = 0; i < sizeof(transforms)/sizeof(transforms[0]); i++)
+    {
+        if (strcmp(transforms[i].algorithm, algorithm) != 0)
+            continue;
+
+        fd = __atomic_load_n(&transforms[i].fd, __ATOMIC_ACQUIRE);
+        if (fd != TRANSFORM_UNKNOWN)
+            return fd >= 0 ? fd : -1;
+
+        /* Two threads may race to open the transform, in which case the loser closes its own */
+
+        fd = Open_Transform(algorithm);
+        expected = TRANSFORM_UNKNOWN;
+        if (__atomic_compare_exchange_n(&transforms[i].fd, &expected, fd >= 0 ? fd : TRANSFORM_MISSING, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return fd;
+
+        if (fd >= 0)
+            close(fd);
+        return expected >= 0 ? expected : -1;
+    }
+
+    fd = Open_Transform(algorithm);
+    *owned = (fd >= 0);
+    return fd;
+}
+
+#endif
+
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_AF_ALG_Available
+ *
+ * PURPOSE: Determines whether the kernel provides a hash algorithm through AF_ALG
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * algorithm           const char*     I       the kernel name of the algorithm, e.g. "sha1" or "sha256"
+ *
+ * RETURN VALUE : int, 1 if the algorithm is available and 0 otherwise
+ *
+ *******************************************************************************************************************************/
+
+int SHA_AF_ALG_Available(const char *algorithm)
+{
+#ifdef __linux__
+    int owned;
+    int fd = Get_Transform(algorithm, &owned);
+
+    if (owned)
+        close(fd);
+    return fd >= 0;
+#else
+    (void) algorithm;
+    return 0;
+#endif
+}
+
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_AF_ALG_File
+ *
+ * PURPOSE: Computes the hash of a file in the kernel. The file is spliced into a pipe and the pipe into an operation
+ *          socket, every chunk with SPLICE_F_MORE so that the kernel keeps the hash open, and an empty message without
+ *          MSG_MORE finally makes the kernel finalise the hash, which is then read from the socket.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * algorithm           const char*     I       the kernel name of the algorithm, e.g. "sha1" or "sha256"
+ * filename            char*           I       pointer to char array containing the file name
+ * hash                uint32_t*       O       pointer to the uint32_t array where the resulting hash is to be stored
+ * nr_of_words         unsigned int    I       the size of the hash in number of 32-bit INTEGERS
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the kernel could not hash the file, otherwise EXIT_SUCCESS
+ *
+ *******************************************************************************************************************************/
+
+int SHA_AF_ALG_File(const char *algorithm, char *filename, uint32_t *hash, unsigned int nr_of_words)
+{
+#ifdef __linux__
+    unsigned char digest[MAX_DIGEST_SIZE];
+    int transform, owned, operation = -1, fd = -1, pipe_fds[2] = {-1, -1};
+    int exit_status = EXIT_FAILURE;
+    ssize_t n, m;
+    unsigned int i;
+
+    if (4*nr_of_words > MAX_DIGEST_SIZE)
+        return EXIT_FAILURE;
+
+    transform = Get_Transform(algorithm, &owned);
+    if (transform < 0)
+        return EXIT_FAILURE;
+
+    operation = accept4(transform, NULL, 0, SOCK_CLOEXEC);
+    fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (operation < 0 || fd < 0 || pipe2(pipe_fds, O_CLOEXEC) != 0)
+        goto end;
+
+    /* A larger pipe moves more pages per pair of splice calls; the default size is kept if the request is refused */
+
+    fcntl(pipe_fds[1], F_SETPIPE_SZ, PIPE_BYTE_SIZE);
+
+    /* Splice the file into the socket */
+
+    for (;;)
+    {
+        n = splice(fd, NULL, pipe_fds[1], NULL, PIPE_BYTE_SIZE, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n < 0)
+            goto end;
+        if (n == 0)
+            break;
+
+        while (n > 0)
+        {
+            m = splice(pipe_fds[0], NULL, operation, NULL, n, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (m <= 0)
+                goto end;
+            n -= m;
+        }
+    }
+
+    /* Finalise and read the hash */
+
+    if (send(operation, NULL, 0, 0) != 0 || read(operation, digest, 4*nr_of_words) != (ssize_t) (4*nr_of_words))
+        goto end;
+
+    for (i = 0; i < nr_of_words; i++)
+        hash[i] = ((uint32_t) digest[4*i] << 24) | ((uint32_t) digest[4*i + 1] << 16) |
+                  ((uint32_t) digest[4*i + 2] << 8) | (uint32_t) digest[4*i + 3];
+
+    exit_status = EXIT_SUCCESS;
+
+    end:
+    if (pipe_fds[0] >= 0)
+    {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+    if (fd >= 0)
+        close(fd);
+    if (operation >= 0)
+        close(operation);
+    if (owned)
+        close(transform);
+    return exit_status;
+#else
+    (void) algorithm;
+    (void) filename;
+    (void) hash;
+    (void) nr_of_words;
+    return EXIT_FAILURE;
+#endif
+}
+
+
+/*******************************************************************************************************************************
+ *
+ *  SECTION: BACKEND SELECTION
+ *
+ *******************************************************************************************************************************/
+
+/* The function SHA_File_Set_Backend selects the backend of the file functions. EXIT_FAILURE is returned, and the backend
+   left unchanged, if the backend is unknown or the kernel does not provide SHA1 through AF_ALG. */
+
+int SHA_File_Set_Backend(int backend)
+{
+    if (backend != SHA_FILE_BACKEND_LIBRARY && backend != SHA_FILE_BACKEND_AF_ALG && backend != SHA_FILE_BACKEND_SPARSE)
+        return EXIT_FAILURE;
+
+    if (backend == SHA_FILE_BACKEND_AF_ALG && !SHA_AF_ALG_Available("sha1"))
+        return EXIT_FAILURE;
+
+    file_backend = backend;
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_File_Get_Backend returns the backend currently used by the file functions */
+
+int SHA_File_Get_Backend(void)
+{
+    return file_backend;
+}
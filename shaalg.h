@@ -0,0 +1,30 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaalg.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the file backends selected for SHA1_File and SHA256_File and the kernel hash functions of the AF_ALG
+ *          backend defined in shaalg.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAALG__
+#define __SHAALG__
+
+/* Backends that can be used to hash files. With SHA_FILE_BACKEND_AF_ALG the file pages are spliced into a hash socket of
+   the Linux kernel, and the library computes the hash itself if the kernel cannot. With SHA_FILE_BACKEND_SPARSE only the
+   data regions of the file are read and its holes are hashed from zero blocks, see shasparse.c */
+
+#define SHA_FILE_BACKEND_LIBRARY 0
+#define SHA_FILE_BACKEND_AF_ALG 1
+#define SHA_FILE_BACKEND_SPARSE 2
+
+int SHA_File_Set_Backend(int backend);
+
+int SHA_File_Get_Backend(void);
+
+int SHA_AF_ALG_Available(const char *algorithm);
+
+int SHA_AF_ALG_File(const char *algorithm, char *filename, uint32_t *hash, unsigned int nr_of_words);
+
+#endif
@@ -0,0 +1,788 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaarchive.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-24
+ *
+ * CONTENT: Implements the class SHA_Archive_Hasher, which computes the hash of every regular file of a tar archive while
+ *          the archive is being read, without unpacking it to disk. The archive may be uncompressed or compressed with
+ *          gzip, or with zstd when compiled with SHA_ZSTD, which is recognised from its first bytes, and it may be read
+ *          from a pipe since it is read only once from start to end. Without SHA_ZSTD, archives compressed with zstd are
+ *          recognised and rejected.
+ *
+ *          Reading and decompression run on a thread of their own, which writes the uncompressed archive into a ring of
+ *          fixed size. The calling thread parses the tar headers in the ring and passes the content of each member from
+ *          the ring directly to an incremental sha::Hasher, so that no member is ever held in memory in full. The
+ *          ring is bounded, so that decompression stalls when hashing falls behind, and Get_Stats reports how often
+ *          each side waited for the other.
+ *
+ *          Archives in the ustar, pax and GNU formats are read, with long names taken from pax "path" records and GNU
+ *          'L' members and large sizes from pax "size" records or base-256 size fields. GNU sparse members are hashed as
+ *          stored, i.e. without their holes.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <zlib.h>
+#ifdef SHA_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "shahasher.h"
+#include "shaarchive.h"
+
+#define TAR_BLOCK_SIZE 512          /* defines the size of a tar header and the unit of padding in BYTES              */
+#define INPUT_SIZE (256 << 10)      /* defines the size in BYTES of the reads of compressed input                     */
+#define MAX_META_SIZE (1 << 20)     /* defines the largest pax header or GNU long name accepted in BYTES              */
+
+typedef std::chrono::steady_clock Clock;
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: RING
+ *
+ *  The Ring is a single-producer single-consumer byte ring. The producer reserves the contiguous free space at its
+ *  position, writes into it and commits what it wrote, and the consumer peeks at the contiguous data at its position
+ *  and consumes what it used, so that data is written once by the decompressor and read in place by the hasher.
+ *  Either side blocks only when the ring is full or empty respectively.
+ *
+ **************************************************************************************************************************************/
+
+class SHA_Archive_Hasher::Ring
+{
+public:
+
+    Ring(size_t size) : buffer(size) { Reset(); }
+
+    void Reset()
+    {
+        head = tail = 0;
+        closed = aborted = false;
+        error.clear();
+        producer_waits = consumer_waits = 0;
+    }
+
+    /* Producer side. Reserve returns 0 once the consumer has aborted */
+
+    size_t Reserve(char **data)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (head - tail == buffer.size() && !aborted)
+        {
+            producer_waits++;
+            not_full.wait(lock, [this] { return head - tail < buffer.size() || aborted; });
+        }
+        if (aborted)
+            return 0;
+
+        size_t position = head % buffer.size();
+        *data = &buffer[position];
+        return std::min(buffer.size() - (head - tail), buffer.size() - position);
+    }
+
+    void Commit(size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        head += n;
+        not_empty.notify_one();
+    }
+
+    void Close(const std::string &message)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        error = message;
+        not_empty.notify_one();
+    }
+
+    /* Consumer side. Peek returns 0 at the end of the stream */
+
+    size_t Peek(const char **data)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (head == tail && !closed)
+        {
+            consumer_waits++;
+            not_empty.wait(lock, [this] { return head != tail || closed; });
+        }
+
+        size_t position = tail % buffer.size();
+        *data = &buffer[position];
+        return std::min(head - tail, buffer.size() - position);
+    }
+
+    void Consume(size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tail += n;
+        not_full.notify_one();
+    }
+
+    void Abort()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = true;
+        not_full.notify_one();
+    }
+
+    std::string Get_Error()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return error;
+    }
+
+    uint64_t head;                            /* the number of bytes committed since Reset                                  */
+    uint64_t tail;                            /* the number of bytes consumed since Reset                                   */
+    uint64_t producer_waits;
+    uint64_t consumer_waits;
+
+private:
+
+    std::vector<char> buffer;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    bool closed;
+    bool aborted;
+    std::string error;
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: DECOMPRESSION
+ *
+ **************************************************************************************************************************************/
+
+/* The function Read_Input reads up to size bytes, retrying reads interrupted by signals. It returns -1 on error */
+
+static ssize_t Read_Input(int fd, char *data, size_t size, uint64_t *bytes_read)
+{
+    ssize_t n;
+
+    do
+        n = read(fd, data, size);
+    while (n < 0 && errno == EINTR);
+
+    if (n > 0)
+        *bytes_read += n;
+    return n;
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Archive_Hasher::Decompress
+ *
+ * PURPOSE: Runs on the producer thread. Recognises the compression from the first bytes of the input and writes the
+ *          uncompressed archive into the ring until the end of the input, an error, or the consumer aborting. The ring
+ *          is closed with an empty message at the end of the input and with a description of the error otherwise.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * fd                  int             I       the file descriptor to read the archive from
+ *
+ *********************************************************************************************************************************/
+
+void SHA_Archive_Hasher::Decompress(int fd)
+{
+    std::vector<char> input(INPUT_SIZE);
+    size_t available = 0;
+    ssize_t n;
+    char *out;
+    size_t space;
+
+    /* Read at least the 4 bytes of the zstd magic number, unless the input is shorter */
+
+    while (available < 4)
+    {
+        n = Read_Input(fd, &input[available], input.size() - available, &stats.bytes_read);
+        if (n < 0)
+        {
+            ring->Close(std::string("read error: ") + strerror(errno));
+            return;
+        }
+        if (n == 0)
+            break;
+        available += n;
+    }
+
+    if (available >= 2 && (unsigned char) input[0] == 0x1f && (unsigned char) input[1] == 0x8b)
+    {
+        /* gzip, including archives of several concatenated gzip members */
+
+        z_stream z;
+        int status = Z_OK;
+        bool end_of_input = false;
+
+        memset(&z, 0, sizeof(z));
+        if (inflateInit2(&z, 15 + 16) != Z_OK)
+        {
+            ring->Close("could not initialise zlib");
+            return;
+        }
+        z.next_in = (Bytef*) &input[0];
+        z.avail_in = available;
+
+        for (;;)
+        {
+            if (z.avail_in == 0 && !end_of_input)
+            {
+                n = Read_Input(fd, &input[0], input.size(), &stats.bytes_read);
+                if (n < 0)
+                {
+                    inflateEnd(&z);
+                    ring->Close(std::string("read error: ") + strerror(errno));
+                    return;
+                }
+                end_of_input = (n == 0);
+                z.next_in = (Bytef*) &input[0];
+                z.avail_in = n;
+            }
+
+            if (z.avail_in == 0 && end_of_input)
+                break;
+
+            if (status == Z_STREAM_END)
+                inflateReset(&z);
+
+            space = ring->Reserve(&out);
+            if (space == 0)
+            {
+                inflateEnd(&z);
+                return;
+            }
+            z.next_out = (Bytef*) out;
+            z.avail_out = std::min<size_t>(space, UINT32_MAX);
+
+            status = inflate(&z, Z_NO_FLUSH);
+            ring->Commit((char*) z.next_out - out);
+
+            if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+            {
+                inflateEnd(&z);
+                ring->Close(std::string("gzip error: ") + (z.msg != NULL ? z.msg : "corrupt data"));
+                return;
+            }
+        }
+
+        inflateEnd(&z);
+        ring->Close(status == Z_STREAM_END ? "" : "gzip error: unexpected end of input");
+        return;
+    }
+
+    if (available >= 4 && (unsigned char) input[0] == 0x28 && (unsigned char) input[1] == 0xb5 &&
+        (unsigned char) input[2] == 0x2f && (unsigned char) input[3] == 0xfd)
+    {
+#ifdef SHA_ZSTD
+        ZSTD_DStream *zstd = ZSTD_createDStream();
+        ZSTD_inBuffer in = {&input[0], available, 0};
+        size_t status = 0;
+        bool end_of_input = false;
+
+        if (zstd == NULL)
+        {
+            ring->Close("zstd error: out of memory");
+            return;
+        }
+        ZSTD_initDStream(zstd);
+        for (;;)
+        {
+            if (in.pos == in.size && !end_of_input)
+            {
+                n = Read_Input(fd, &input[0], input.size(), &stats.bytes_read);
+                if (n < 0)
+                {
+                    ZSTD_freeDStream(zstd);
+                    ring->Close(std::string("read error: ") + strerror(errno));
+                    return;
+                }
+                end_of_input = (n == 0);
+                in.src = &input[0];
+                in.size = n;
+                in.pos = 0;
+            }
+
+            if (in.pos == in.size && end_of_input && status == 0)
+                break;
+
+            space = ring->Reserve(&out);
+            if (space == 0)
+            {
+                ZSTD_freeDStream(zstd);
+                return;
+            }
+            ZSTD_outBuffer output = {out, space, 0};
+
+            status = ZSTD_decompressStream(zstd, &output, &in);
+            ring->Commit(output.pos);
+
+            if (ZSTD_isError(status))
+            {
+                ZSTD_freeDStream(zstd);
+                ring->Close(std::string("zstd error: ") + ZSTD_getErrorName(status));
+                return;
+            }
+            if (in.pos == in.size && end_of_input && output.pos == 0 && status != 0)
+            {
+                ZSTD_freeDStream(zstd);
+                ring->Close("zstd error: unexpected end of input");
+                return;
+            }
+        }
+
+        ZSTD_freeDStream(zstd);
+        ring->Close("");
+#else
+        ring->Close("zstd compressed input is not supported");
+#endif
+        return;
+    }
+
+    /* Uncompressed: copy the bytes already read, and read the rest directly into the ring */
+
+    size_t position = 0;
+    while (position < available)
+    {
+        space = ring->Reserve(&out);
+        if (space == 0)
+            return;
+        space = std::min(space, available - position);
+        memcpy(out, &input[position], space);
+        ring->Commit(space);
+        position += space;
+    }
+
+    for (;;)
+    {
+        space = ring->Reserve(&out);
+        if (space == 0)
+            return;
+        n = Read_Input(fd, out, space, &stats.bytes_read);
+        if (n < 0)
+        {
+            ring->Close(std::string("read error: ") + strerror(errno));
+            return;
+        }
+        if (n == 0)
+            break;
+        ring->Commit(n);
+    }
+
+    ring->Close("");
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: TAR PARSING
+ *
+ **************************************************************************************************************************************/
+
+/* The function Parse_Number reads a numeric header field, in octal terminated by a space or a null character, or in
+   the base-256 encoding of GNU tar if the high bit of the first byte is set */
+
+static uint64_t Parse_Number(const char *field, size_t size)
+{
+    uint64_t value = 0;
+    size_t i = 0;
+
+    if ((unsigned char) field[0] & 0x80)
+    {
+        value = (unsigned char) field[0] & 0x7f;
+        for (i = 1; i < size; i++)
+            value = (value << 8) | (unsigned char) field[i];
+        return value;
+    }
+
+    while (i < size && field[i] == ' ')
+        i++;
+    for (; i < size && field[i] >= '0' && field[i] <= '7'; i++)
+        value = 8*value + (field[i] - '0');
+    return value;
+}
+
+/* The function Checksum_Valid compares the checksum field of a header with the sum of its bytes, the checksum field
+   counted as spaces. Some historic implementations summed signed bytes, which is accepted too */
+
+static bool Checksum_Valid(const char *header)
+{
+    uint64_t expected = Parse_Number(&header[148], 8);
+    uint64_t unsigned_sum = 0;
+    int64_t signed_sum = 0;
+    int i;
+
+    for (i = 0; i < TAR_BLOCK_SIZE; i++)
+    {
+        char c = (i >= 148 && i < 156) ? ' ' : header[i];
+        unsigned_sum += (unsigned char) c;
+        signed_sum += (signed char) c;
+    }
+
+    return expected == unsigned_sum || (int64_t) expected == signed_sum;
+}
+
+/* The function Parse_Pax reads the "path" and "size" records of a pax extended header of the form "LENGTH KEY=VALUE\n" */
+
+static bool Parse_Pax(const std::string &records, std::string *path, bool *has_size, uint64_t *size)
+{
+    size_t position = 0;
+
+    while (position < records.size())
+    {
+        size_t length = 0, i = position;
+
+        while (i < records.size() && records[i] >= '0' && records[i] <= '9')
+            length = 10*length + (records[i++] - '0');
+        if (i >= records.size() || records[i] != ' ' || length == 0 || position + length > records.size() ||
+            records[position + length - 1] != '\n')
+            return false;
+
+        size_t equals = records.find('=', i + 1);
+        if (equals == std::string::npos || equals >= position + length)
+            return false;
+
+        std::string key = records.substr(i + 1, equals - i - 1);
+        std::string value = records.substr(equals + 1, position + length - 1 - (equals + 1));
+
+        if (key == "path")
+            *path = value;
+        else if (key == "size")
+        {
+            *has_size = true;
+            *size = strtoull(value.c_str(), NULL, 10);
+        }
+
+        position += length;
+    }
+
+    return true;
+}
+
+/* The function SHA_Archive_Hasher::Read_Bytes copies the next size bytes of the ring to data, or skips them if data is
+   NULL, and returns the number of bytes copied, which is less than size only at the end of the stream */
+
+size_t SHA_Archive_Hasher::Read_Bytes(char *data, size_t size)
+{
+    size_t copied = 0, n;
+    const char *chunk;
+
+    while (copied < size && (n = ring->Peek(&chunk)) > 0)
+    {
+        n = std::min(n, size - copied);
+        if (data != NULL)
+            memcpy(&data[copied], chunk, n);
+        ring->Consume(n);
+        copied += n;
+    }
+
+    return copied;
+}
+
+/* The function SHA_Archive_Hasher::Hash_Member passes the next size bytes of the ring, in place, to a Hasher of the
+   type H and stores the hash as words. EXIT_FAILURE is returned if the stream ends first. */
+
+template <class H>
+int SHA_Archive_Hasher::Hash_Member(uint64_t size, uint32_t *hash)
+{
+    H h;
+    typename H::digest_type digest;
+    const char *chunk;
+    size_t n;
+    unsigned int i;
+
+    while (size > 0)
+    {
+        n = ring->Peek(&chunk);
+        if (n == 0)
+            return EXIT_FAILURE;
+        n = (size_t) std::min<uint64_t>(n, size);
+        h.update(chunk, n);
+        ring->Consume(n);
+        size -= n;
+    }
+
+    digest = h.final();
+    for (i = 0; i < H::digest_size/4; i++)
+        hash[i] = ((uint32_t) digest[4*i] << 24) | ((uint32_t) digest[4*i + 1] << 16) |
+                  ((uint32_t) digest[4*i + 2] << 8) | (uint32_t) digest[4*i + 3];
+
+    return EXIT_SUCCESS;
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Archive_Hasher::Parse
+ *
+ * PURPOSE: Runs on the calling thread. Parses the archive in the ring header by header, hashes every regular file and
+ *          passes it to the callback, and skips every other member. After the end-of-archive blocks the rest of the
+ *          stream is drained, so that the decompressor checks it to the end.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * callback            Callback        I       the function receiving every member
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the archive is malformed or ends prematurely
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Archive_Hasher::Parse(Callback callback)
+{
+    char header[TAR_BLOCK_SIZE];
+    std::string long_name, pax_path;
+    bool pax_has_size = false;
+    uint64_t pax_size = 0;
+    uint64_t offset;
+    Member member;
+    size_t n;
+
+    member.nr_of_words = (algorithm == SHA1) ? 5 : 8;
+
+    for (;;)
+    {
+        offset = ring->tail;
+        n = Read_Bytes(header, TAR_BLOCK_SIZE);
+        if (n == 0 && offset > 0)
+            break;                                            /* tolerate a missing end-of-archive marker */
+        if (n < TAR_BLOCK_SIZE)
+        {
+            error = "unexpected end of archive in header at offset " + std::to_string(offset);
+            return EXIT_FAILURE;
+        }
+
+        if (std::all_of(header, header + TAR_BLOCK_SIZE, [](char c) { return c == 0; }))
+        {
+            while (Read_Bytes(NULL, SIZE_MAX) > 0)
+                ;
+            break;
+        }
+
+        if (!Checksum_Valid(header))
+        {
+            error = "invalid header checksum at offset " + std::to_string(offset);
+            return EXIT_FAILURE;
+        }
+
+        char type = header[156];
+        uint64_t size = Parse_Number(&header[124], 12);
+        uint64_t padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+        if (type == 'x' || type == 'L')
+        {
+            /* Metadata applying to the next member */
+
+            std::string data;
+
+            if (size > MAX_META_SIZE)
+            {
+                error = "extended header too large at offset " + std::to_string(offset);
+                return EXIT_FAILURE;
+            }
+            data.resize(size);
+            if (Read_Bytes(&data[0], size) < size || Read_Bytes(NULL, padding) < padding)
+            {
+                error = "unexpected end of archive in extended header at offset " + std::to_string(offset);
+                return EXIT_FAILURE;
+            }
+
+            if (type == 'L')
+                long_name = data.substr(0, data.find('\0'));
+            else if (!Parse_Pax(data, &pax_path, &pax_has_size, &pax_size))
+            {
+                error = "malformed pax header at offset " + std::to_string(offset);
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        if (pax_has_size)
+        {
+            size = pax_size;
+            padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+        }
+
+        /* The path is taken from a pax header, a GNU long name, or the ustar prefix and name fields */
+
+        if (!pax_path.empty())
+            member.path = pax_path;
+        else if (!long_name.empty())
+            member.path = long_name;
+        else
+        {
+            member.path.assign(header, strnlen(header, 100));
+            if (memcmp(&header[257], "ustar", 6) == 0 && header[345] != '\0')
+                member.path = std::string(&header[345], strnlen(&header[345], 155)) + "/" + member.path;
+        }
+
+        if (member.path.empty())
+        {
+            error = "member without a name at offset " + std::to_string(offset);
+            return EXIT_FAILURE;
+        }
+
+        bool regular = (type == '0' || type == '7' || type == 'S' || (type == '\0' && member.path.back() != '/'));
+
+        if (regular)
+        {
+            int status = (algorithm == SHA1) ? Hash_Member<sha::Hasher<sha::Sha1>>(size, member.hash)
+                                             : Hash_Member<sha::Hasher<sha::Sha256>>(size, member.hash);
+            if (status != EXIT_SUCCESS || Read_Bytes(NULL, padding) < padding)
+            {
+                error = "unexpected end of archive in member " + member.path;
+                return EXIT_FAILURE;
+            }
+
+            member.file_byte_size = size;
+            stats.members++;
+            stats.bytes_hashed += size;
+            if (callback)
+                callback(member);
+        }
+        else if (type != '1' && type != '2' && type != '3' && type != '4' && type != '5' && type != '6')
+        {
+            /* Other members, e.g. pax global headers, carry data which is skipped */
+
+            if (Read_Bytes(NULL, size + padding) < size + padding)
+            {
+                error = "unexpected end of archive in member " + member.path;
+                return EXIT_FAILURE;
+            }
+        }
+
+        long_name.clear();
+        pax_path.clear();
+        pax_has_size = false;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: PUBLIC INTERFACE
+ *
+ **************************************************************************************************************************************/
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Archive_Hasher::SHA_Archive_Hasher
+ *
+ * PURPOSE: Constructs a hasher and allocates its ring
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * algorithm           Algorithm       I       the algorithm the members are hashed with
+ * ring_byte_size      size_t          I       the size in bytes of the ring between decompression and hashing
+ *
+ *********************************************************************************************************************************/
+
+SHA_Archive_Hasher::SHA_Archive_Hasher(Algorithm algorithm, size_t ring_byte_size)
+    : algorithm(algorithm), ring(new Ring(ring_byte_size > 0 ? ring_byte_size : SHA_ARCHIVE_RING_SIZE))
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+SHA_Archive_Hasher::~SHA_Archive_Hasher()
+{
+    delete ring;
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Archive_Hasher::Hash_Fd
+ *
+ * PURPOSE: Reads an archive from a file descriptor to its end and passes every regular file to the callback, which is
+ *          called on the calling thread in the order of the archive. The file descriptor is not closed.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * fd                  int             I       the file descriptor to read the archive from
+ * callback            Callback        I       the function receiving every member, or an empty function
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the input could not be read or decompressed or is not a valid tar archive, in
+ *                which case Error describes the problem. The members passed before the error are valid.
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Archive_Hasher::Hash_Fd(int fd, Callback callback)
+{
+    Clock::time_point start = Clock::now();
+    std::string decompression_error;
+    int exit_status;
+
+    memset(&stats, 0, sizeof(stats));
+    error.clear();
+    ring->Reset();
+
+    std::thread producer(&SHA_Archive_Hasher::Decompress, this, fd);
+    exit_status = Parse(callback);
+    ring->Abort();
+    producer.join();
+
+    /* An error of the decompressor is the cause of any error found by the parser */
+
+    decompression_error = ring->Get_Error();
+    if (!decompression_error.empty())
+    {
+        error = decompression_error;
+        exit_status = EXIT_FAILURE;
+    }
+
+    stats.bytes_archive = ring->head;
+    stats.producer_waits = ring->producer_waits;
+    stats.consumer_waits = ring->consumer_waits;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    return exit_status;
+}
+
+/* The function SHA_Archive_Hasher::Hash_File does the same as Hash_Fd for the archive of the given file name, or for
+   standard input if the name is "-" */
+
+int SHA_Archive_Hasher::Hash_File(const char *filename, Callback callback)
+{
+    int fd, exit_status;
+
+    if (strcmp(filename, "-") == 0)
+        return Hash_Fd(STDIN_FILENO, callback);
+
+    fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = std::string("could not open ") + filename + ": " + strerror(errno);
+        return EXIT_FAILURE;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    exit_status = Hash_Fd(fd, callback);
+    close(fd);
+
+    return exit_status;
+}
@@ -0,0 +1,85 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaarchive.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the class SHA_Archive_Hasher defined in shaarchive.cpp, which hashes every member of a tar archive,
+ *          optionally compressed with gzip or zstd, while the archive is read from a file or a pipe
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAARCHIVE__
+#define __SHAARCHIVE__
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+#define SHA_ARCHIVE_RING_SIZE (4 << 20)       /* the default size in bytes of the ring between decompression and hashing    */
+
+class SHA_Archive_Hasher
+{
+public:
+
+    /* The algorithms the members may be hashed with */
+
+    enum Algorithm
+    {
+        SHA1,
+        SHA256
+    };
+
+    /* A regular file of the archive */
+
+    struct Member
+    {
+        std::string path;                     /* the path stored in the archive, from a pax or GNU long name if present    */
+        uint64_t file_byte_size;
+        uint32_t hash[8];                     /* the hash of the content of the member                                      */
+        unsigned int nr_of_words;             /* the size of the hash, 5 for SHA1 and 8 for SHA256                          */
+    };
+
+    /* Statistics of the last call of Hash_File or Hash_Fd */
+
+    struct Stats
+    {
+        uint64_t members;                     /* the number of regular files hashed                                         */
+        uint64_t bytes_read;                  /* the number of bytes read from the input, compressed or not                 */
+        uint64_t bytes_archive;               /* the number of bytes of the uncompressed archive                            */
+        uint64_t bytes_hashed;                /* the number of bytes of member content hashed                               */
+        uint64_t producer_waits;              /* the number of times decompression waited for the ring to drain             */
+        uint64_t consumer_waits;              /* the number of times hashing waited for the ring to fill                    */
+        double seconds;
+    };
+
+    typedef std::function<void(const Member &member)> Callback;
+
+    SHA_Archive_Hasher(Algorithm algorithm = SHA1, size_t ring_byte_size = SHA_ARCHIVE_RING_SIZE);
+    ~SHA_Archive_Hasher();
+
+    SHA_Archive_Hasher(const SHA_Archive_Hasher &) = delete;
+    SHA_Archive_Hasher &operator=(const SHA_Archive_Hasher &) = delete;
+
+    int Hash_File(const char *filename, Callback callback);
+    int Hash_Fd(int fd, Callback callback);
+
+    const std::string &Error() const { return error; }
+    Stats Get_Stats() const { return stats; }
+
+private:
+
+    class Ring;
+
+    void Decompress(int fd);
+    int Parse(Callback callback);
+    size_t Read_Bytes(char *data, size_t size);
+    template <class H> int Hash_Member(uint64_t size, uint32_t *hash);
+
+    Algorithm algorithm;
+    Ring *ring;
+    std::string error;
+    Stats stats;
+};
+
+#endif
@@ -0,0 +1,394 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaasync.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-27
+ *
+ * CONTENT: Implements the executors of shaasync.h. A Thread_Pool is a queue of jobs served by a fixed number of threads.
+ *          An Event_Loop runs on the thread calling run, and resumes there every coroutine posted to it and every
+ *          coroutine whose read has completed.
+ *
+ *          With io_uring the reads are submitted in batches to the kernel, and the loop sleeps in io_uring_enter until
+ *          a read completes. Coroutines posted from other threads wake it through an eventfd, which has a read of its
+ *          own pending in the ring whenever the loop may sleep. Without io_uring the reads are made with pread on
+ *          SHA_ASYNC_IO_THREADS threads, which post the reading coroutines back to the loop, and the loop sleeps on a
+ *          condition variable.
+ *
+ *          A read completes either before or after its coroutine awaits it, possibly on different threads when the
+ *          coroutine is compressing the previous chunk on another executor in the meantime. The two sides meet in an
+ *          atomic exchange of the waiter of the read: whichever comes second posts the coroutine to the loop.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "shaasync.h"
+
+/* <linux/io_uring.h> defines BLOCK_SIZE through <linux/fs.h> and must follow shalib.h */
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "shauring.h"
+
+#define WAKEUP_DATA 0       /* defines the user data of the completion of the read of the eventfd       */
+
+namespace sha {
+
+static thread_local Event_Loop *current_loop = nullptr;
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: THREAD POOL
+ *
+ **************************************************************************************************************************************/
+
+Thread_Pool::Thread_Pool(unsigned int nr_of_threads) : stopping(false)
+{
+    if (nr_of_threads == 0)
+        nr_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i = 0; i < nr_of_threads; i++)
+        threads.push_back(std::thread(&Thread_Pool::work, this));
+}
+
+/* The destructor runs every job already posted before stopping the threads */
+
+Thread_Pool::~Thread_Pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void Thread_Pool::post(std::coroutine_handle<> handle)
+{
+    submit([handle] { handle.resume(); });
+}
+
+void Thread_Pool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void Thread_Pool::work()
+{
+    std::function<void()> job;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: READS
+ *
+ **************************************************************************************************************************************/
+
+void Event_Loop::Read_Operation::start()
+{
+    if (started)
+        return;
+    started = true;
+    loop->Submit_Read(this);
+}
+
+void Event_Loop::Read_Operation::await_suspend(std::coroutine_handle<> handle)
+{
+    void *expected = nullptr;
+
+    start();
+    if (!waiter.compare_exchange_strong(expected, handle.address()))
+        loop->post(handle);
+}
+
+void Event_Loop::Read_Operation::complete(ssize_t bytes_read)
+{
+    void *previous;
+
+    result = bytes_read;
+    previous = waiter.exchange(this);
+    if (previous != nullptr)
+        loop->post(std::coroutine_handle<>::from_address(previous));
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: EVENT LOOP
+ *
+ **************************************************************************************************************************************/
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Event_Loop::Event_Loop
+ *
+ * PURPOSE: Creates a loop, on io_uring if it is available and wanted, otherwise with threads for blocking reads
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * queue_depth         unsigned int          I       the number of entries of the submission queue of io_uring
+ * use_io_uring        bool                  I       false to use the blocking reads even where io_uring is available
+ *
+ *********************************************************************************************************************************/
+
+Event_Loop::Event_Loop(unsigned int queue_depth, bool use_io_uring)
+    : ring(nullptr), nr_in_flight(0), io_threads(nullptr), wakeup_fd(-1), wakeup_value(0), wakeup_armed(false),
+      sleeping(false), nr_of_tasks(0)
+{
+#ifdef __linux__
+    if (use_io_uring)
+    {
+        ring = new sha_uring;
+        wakeup_fd = eventfd(0, EFD_CLOEXEC);
+        if (wakeup_fd < 0 || SHA_Uring_Init(ring, queue_depth) != EXIT_SUCCESS)
+        {
+            if (wakeup_fd >= 0)
+                close(wakeup_fd);
+            wakeup_fd = -1;
+            delete ring;
+            ring = nullptr;
+        }
+    }
+#endif
+
+    if (ring == nullptr)
+        io_threads = new Thread_Pool(SHA_ASYNC_IO_THREADS);
+}
+
+Event_Loop::~Event_Loop()
+{
+    if (ring != nullptr)
+    {
+        SHA_Uring_Exit(ring);
+        delete ring;
+        close(wakeup_fd);
+    }
+    delete io_threads;
+}
+
+Event_Loop *Event_Loop::current()
+{
+    return current_loop;
+}
+
+/* The function post queues a coroutine to be resumed on the loop thread, and wakes the loop if it is sleeping. The
+   loop is woken while the mutex is held, since once it is released the coroutine may finish the last task and the
+   loop be destroyed */
+
+void Event_Loop::post(std::coroutine_handle<> handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t one = 1;
+
+    ready.push_back(handle);
+
+    if (ring == nullptr)
+        wake.notify_one();
+    else if (sleeping.load() && write(wakeup_fd, &one, sizeof(one)) < 0)
+        return;
+}
+
+/* The function Submit_Read starts a read on the loop thread. A read finding the rings full waits in waiting_reads
+   until a completion makes room */
+
+void Event_Loop::Submit_Read(Read_Operation *operation)
+{
+#ifdef __linux__
+    if (ring != nullptr)
+    {
+        struct io_uring_sqe *sqe;
+
+        if (nr_in_flight + 1 >= ring->cq_entries || (sqe = SHA_Uring_Get_Sqe(ring)) == NULL)
+        {
+            waiting_reads.push_back(operation);
+            return;
+        }
+
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = operation->fd;
+        sqe->addr = (uint64_t) (uintptr_t) operation->buffer;
+        sqe->len = (uint32_t) operation->size;
+        sqe->off = operation->offset;
+        sqe->user_data = (uint64_t) (uintptr_t) operation;
+        nr_in_flight++;
+        return;
+    }
+#endif
+
+    io_threads->submit([operation]
+    {
+        ssize_t n;
+
+        do
+        {
+            if (operation->offset == SHA_ASYNC_STREAM)
+                n = ::read(operation->fd, operation->buffer, operation->size);
+            else
+                n = pread(operation->fd, operation->buffer, operation->size, (off_t) operation->offset);
+        }
+        while (n < 0 && errno == EINTR);
+
+        operation->complete(n < 0 ? -errno : n);
+    });
+}
+
+/* The function Arm_Wakeup submits a read of the eventfd, which completes when another thread posts to the loop */
+
+void Event_Loop::Arm_Wakeup()
+{
+#ifdef __linux__
+    struct io_uring_sqe *sqe;
+
+    if (wakeup_armed || (sqe = SHA_Uring_Get_Sqe(ring)) == NULL)
+        return;
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd;
+    sqe->addr = (uint64_t) (uintptr_t) &wakeup_value;
+    sqe->len = sizeof(wakeup_value);
+    sqe->user_data = WAKEUP_DATA;
+    wakeup_armed = true;
+    nr_in_flight++;
+#endif
+}
+
+/* The function Reap_Completions completes every read the kernel has finished and resubmits the waiting reads */
+
+void Event_Loop::Reap_Completions()
+{
+#ifdef __linux__
+    struct io_uring_cqe *cqe;
+
+    while ((cqe = SHA_Uring_Peek_Cqe(ring)) != NULL)
+    {
+        uint64_t user_data = cqe->user_data;
+        int res = cqe->res;
+
+        SHA_Uring_Cqe_Seen(ring);
+        nr_in_flight--;
+
+        if (user_data == WAKEUP_DATA)
+            wakeup_armed = false;
+        else
+            ((Read_Operation*) (uintptr_t) user_data)->complete(res);
+    }
+
+    while (!waiting_reads.empty() && nr_in_flight + 1 < ring->cq_entries && ring->nr_to_submit < ring->sq_entries)
+    {
+        Read_Operation *operation = waiting_reads.front();
+        waiting_reads.pop_front();
+        Submit_Read(operation);
+    }
+#endif
+}
+
+Event_Loop::Detached Event_Loop::Run_Detached(Event_Loop *loop, Task<void> task)
+{
+    co_await loop->schedule();
+    co_await task;
+    co_await loop->schedule();
+    loop->nr_of_tasks--;
+}
+
+void Event_Loop::spawn(Task<void> task)
+{
+    nr_of_tasks++;
+    Run_Detached(this, std::move(task));
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Event_Loop::run
+ *
+ * PURPOSE: Runs the loop on the calling thread until every spawned task has finished. Each round resumes the coroutines
+ *          ready to run, which start new reads, submits the reads together, and sleeps only when nothing is ready.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void Event_Loop::run()
+{
+    Event_Loop *previous_loop = current_loop;
+    std::deque<std::coroutine_handle<> > batch;
+
+    current_loop = this;
+
+    while (nr_of_tasks > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(ready);
+        }
+        for (std::coroutine_handle<> handle : batch)
+            handle.resume();
+        batch.clear();
+
+        if (nr_of_tasks == 0)
+            break;
+
+        if (ring == nullptr)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return !ready.empty(); });
+            continue;
+        }
+
+        /* Submit the new reads and collect the completions without waiting, then sleep if nothing is ready */
+
+        if (ring->nr_to_submit > 0)
+            SHA_Uring_Submit(ring, 0);
+        Reap_Completions();
+
+        sleeping.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ready.empty())
+            {
+                sleeping.store(false);
+                continue;
+            }
+        }
+
+        Arm_Wakeup();
+        SHA_Uring_Submit(ring, 1);
+        sleeping.store(false);
+        Reap_Completions();
+    }
+
+    current_loop = previous_loop;
+}
+
+}
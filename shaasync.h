@@ -0,0 +1,503 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaasync.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: C++20 coroutine front end for hashing without blocking the calling thread. Declares the coroutine type
+ *          sha::Task, the executors sha::Thread_Pool and sha::Event_Loop defined in shaasync.cpp, and the operations
+ *
+ *              co_await sha::sha1_file_async(loop, path)           the SHA1 hash of a file
+ *              co_await sha::hash_file_async<sha::Sha256>(...)     the same with any algorithm of shahasher.h
+ *              co_await hasher.update(data, size)                  a stream hasher fed from the caller's own reads
+ *
+ *          The reads of a file suspend the coroutine until the data has arrived, and the compression of each chunk can
+ *          be run on an executor of its own, such as a Thread_Pool, while the next chunk is being read, so that
+ *          thousands of files can be hashed at once by one loop thread and a few compression threads.
+ *
+ *          Event_Loop is a small example loop on io_uring, which falls back to blocking reads on threads of its own
+ *          where io_uring is not available. The file operations are templates accepting any loop with the same
+ *          members post and read, so that they can be driven by the event loop of an existing service.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAASYNC__
+#define __SHAASYNC__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "shahasher.h"
+
+#define SHA_ASYNC_CHUNK_SIZE (128 << 10)      /* the default number of bytes read at a time, two chunks are held per file   */
+#define SHA_ASYNC_QUEUE_DEPTH 256             /* the default number of entries of the submission queue of an Event_Loop     */
+#define SHA_ASYNC_IO_THREADS 4                /* the number of threads reading for an Event_Loop without io_uring           */
+#define SHA_ASYNC_STREAM (~(uint64_t) 0)      /* the offset of a read at the current position of a pipe or socket           */
+
+struct sha_uring;
+
+namespace sha {
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: TASKS
+ *
+ *  A Task<T> is a coroutine returning T. It starts when it is awaited, and when it finishes it resumes the awaiting
+ *  coroutine directly, on the thread it finished on.
+ *
+ **************************************************************************************************************************************/
+
+template <class T> class Task;
+
+namespace detail {
+
+struct Final_Awaiter
+{
+    bool await_ready() noexcept { return false; }
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+};
+
+struct Promise_Base
+{
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    Final_Awaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+}
+
+template <class T>
+class Task
+{
+public:
+
+    struct promise_type : detail::Promise_Base
+    {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_value(T result) { value = std::move(result); }
+    };
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume()
+    {
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <>
+class Task<void>
+{
+public:
+
+    struct promise_type : detail::Promise_Base
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() {}
+    };
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume()
+    {
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
+    }
+
+private:
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: EXECUTORS
+ *
+ *  An executor resumes the coroutines posted to it on threads of its own. co_await executor.schedule() moves the
+ *  awaiting coroutine to the executor.
+ *
+ **************************************************************************************************************************************/
+
+class Executor
+{
+public:
+
+    struct Schedule_Awaiter
+    {
+        Executor *executor;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor->post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    virtual ~Executor() {}
+
+    /* Resumes the coroutine on a thread of the executor. May be called from any thread */
+
+    virtual void post(std::coroutine_handle<> handle) = 0;
+
+    Schedule_Awaiter schedule() { return Schedule_Awaiter{this}; }
+};
+
+/* A Thread_Pool runs coroutines and functions on a fixed number of threads, in the order they were posted */
+
+class Thread_Pool : public Executor
+{
+public:
+
+    explicit Thread_Pool(unsigned int nr_of_threads = 0);
+    ~Thread_Pool();
+
+    void post(std::coroutine_handle<> handle) override;
+    void submit(std::function<void()> job);
+
+    unsigned int nr_of_threads() const { return (unsigned int) threads.size(); }
+
+private:
+
+    void work();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()> > jobs;
+    bool stopping;
+    std::vector<std::thread> threads;
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: EVENT LOOP
+ *
+ **************************************************************************************************************************************/
+
+class Event_Loop : public Executor
+{
+public:
+
+    /* A read of up to size bytes at offset, or at the file position of a pipe or socket if offset is SHA_ASYNC_STREAM.
+       The read starts when start() is called or when it is awaited, and it must be started on the loop thread. The
+       awaiting coroutine is always resumed on the loop thread, with the number of bytes read or -errno */
+
+    class Read_Operation
+    {
+    public:
+
+        Read_Operation(Event_Loop *loop, int fd, void *buffer, size_t size, uint64_t offset)
+            : loop(loop), fd(fd), buffer(buffer), size(size), offset(offset), result(0), started(false), waiter(nullptr) {}
+
+        Read_Operation(const Read_Operation &) = delete;
+        Read_Operation &operator=(const Read_Operation &) = delete;
+
+        void start();
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        ssize_t await_resume() const noexcept { return result; }
+
+    private:
+
+        friend class Event_Loop;
+
+        void complete(ssize_t bytes_read);
+
+        Event_Loop *loop;
+        int fd;
+        void *buffer;
+        size_t size;
+        uint64_t offset;
+        ssize_t result;
+        bool started;
+        std::atomic<void*> waiter;            /* the awaiting coroutine, or the operation itself once complete              */
+    };
+
+    explicit Event_Loop(unsigned int queue_depth = SHA_ASYNC_QUEUE_DEPTH, bool use_io_uring = true);
+    ~Event_Loop();
+
+    void post(std::coroutine_handle<> handle) override;
+
+    Read_Operation read(int fd, void *buffer, size_t size, uint64_t offset)
+    {
+        return Read_Operation(this, fd, buffer, size, offset);
+    }
+
+    /* Starts a task on the loop. The loop keeps running until every task spawned has finished */
+
+    void spawn(Task<void> task);
+
+    void run();
+
+    template <class T> T run_until_complete(Task<T> task);
+
+    bool uses_io_uring() const { return ring != nullptr; }
+
+    static Event_Loop *current();
+
+private:
+
+    struct Detached;
+
+    static Detached Run_Detached(Event_Loop *loop, Task<void> task);
+    void Submit_Read(Read_Operation *operation);
+    void Reap_Completions();
+    void Arm_Wakeup();
+
+    struct sha_uring *ring;
+    unsigned int nr_in_flight;
+    std::deque<Read_Operation*> waiting_reads;
+    Thread_Pool *io_threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<> > ready;
+    int wakeup_fd;
+    uint64_t wakeup_value;
+    bool wakeup_armed;
+    std::atomic<bool> sleeping;
+    uint64_t nr_of_tasks;
+};
+
+/* The coroutine type of the tasks spawned on an Event_Loop, which run to completion without an owner */
+
+struct Event_Loop::Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <class T>
+T Event_Loop::run_until_complete(Task<T> task)
+{
+    std::optional<T> value;
+    std::exception_ptr exception;
+
+    spawn([](Task<T> task, std::optional<T> *value, std::exception_ptr *exception) -> Task<void>
+    {
+        try
+        {
+            *value = co_await task;
+        }
+        catch (...)
+        {
+            *exception = std::current_exception();
+        }
+    }(std::move(task), &value, &exception));
+    run();
+
+    if (exception)
+        std::rethrow_exception(exception);
+    return std::move(*value);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HASHING
+ *
+ **************************************************************************************************************************************/
+
+/* The result of hashing a file. status is EXIT_FAILURE if the file could not be opened or read, with the error in
+   error_number */
+
+template <class Algorithm>
+struct Async_Digest
+{
+    int status;
+    int error_number;
+    uint64_t file_byte_size;
+    typename Hasher<Algorithm>::digest_type digest;
+};
+
+/* An Async_Hasher is a stream hasher for coroutines reading the data themselves. When given a compression executor,
+   update moves the coroutine to it for the compression and back to the home executor before returning, so that the
+   reads of the caller stay on their loop */
+
+template <class Algorithm, class Kernel = Auto>
+class Async_Hasher
+{
+public:
+
+    typedef typename Hasher<Algorithm, Kernel>::digest_type digest_type;
+
+    Async_Hasher(Executor *home = nullptr, Executor *compression = nullptr) : home(home), compression(compression) {}
+
+    Task<void> update(const void *data, size_t size)
+    {
+        if (compression != nullptr && home != nullptr)
+        {
+            co_await compression->schedule();
+            hasher.update(data, size);
+            co_await home->schedule();
+        }
+        else
+            hasher.update(data, size);
+    }
+
+    digest_type final() { return hasher.final(); }
+
+private:
+
+    Hasher<Algorithm, Kernel> hasher;
+    Executor *home;
+    Executor *compression;
+};
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: hash_fd_async
+ *
+ * PURPOSE: Hashes the content of an open file, pipe or socket from the current position until its end. Two chunks are
+ *          used in turn: once a chunk has been read, the read of the next chunk is started before the chunk is
+ *          compressed, on the compression executor if one is given, so that reading and compression overlap.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * loop                Loop&                 I       the loop performing the reads, such as an Event_Loop, which must
+ *                                                   be running on the thread awaiting the task
+ * fd                  int                   I       the file descriptor
+ * seekable            bool                  I       true to read a regular file by offset from its start, false to
+ *                                                   read a stream from its current position
+ * compression         Executor*             I       the executor running the compression, nullptr for the loop thread
+ * chunk_size          size_t                I       the number of bytes read at a time
+ *
+ * RETURN VALUE : Task<Async_Digest<Algorithm>>
+ *
+ *********************************************************************************************************************************/
+
+template <class Algorithm, class Loop>
+Task<Async_Digest<Algorithm> > hash_fd_async(Loop &loop, int fd, bool seekable, Executor *compression = nullptr,
+                                             size_t chunk_size = SHA_ASYNC_CHUNK_SIZE)
+{
+    Async_Digest<Algorithm> result = {EXIT_SUCCESS, 0, 0, {}};
+    Hasher<Algorithm> hasher;
+    std::vector<unsigned char> buffers[2] = {std::vector<unsigned char>(chunk_size), std::vector<unsigned char>(chunk_size)};
+    uint64_t stream = SHA_ASYNC_STREAM;
+    unsigned int current = 0;
+    ssize_t n;
+
+    n = co_await loop.read(fd, buffers[0].data(), chunk_size, seekable ? 0 : stream);
+    while (n > 0)
+    {
+        result.file_byte_size += n;
+
+        auto next = loop.read(fd, buffers[1 - current].data(), chunk_size, seekable ? result.file_byte_size : stream);
+        next.start();
+
+        if (compression != nullptr)
+            co_await compression->schedule();
+        hasher.update(buffers[current].data(), n);
+
+        n = co_await next;
+        current = 1 - current;
+    }
+
+    if (n < 0)
+    {
+        result.status = EXIT_FAILURE;
+        result.error_number = (int) -n;
+    }
+    else
+        result.digest = hasher.final();
+
+    co_return result;
+}
+
+/* The function hash_file_async opens a file and hashes it with hash_fd_async. The open itself is a blocking call on
+   the loop thread, which is short for local files */
+
+template <class Algorithm, class Loop>
+Task<Async_Digest<Algorithm> > hash_file_async(Loop &loop, const char *path, Executor *compression = nullptr,
+                                               size_t chunk_size = SHA_ASYNC_CHUNK_SIZE)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        co_return Async_Digest<Algorithm>{EXIT_FAILURE, errno, 0, {}};
+
+    Async_Digest<Algorithm> result = co_await hash_fd_async<Algorithm>(loop, fd, true, compression, chunk_size);
+    close(fd);
+    co_return result;
+}
+
+template <class Loop>
+Task<Async_Digest<Sha1> > sha1_file_async(Loop &loop, const char *path, Executor *compression = nullptr)
+{
+    return hash_file_async<Sha1>(loop, path, compression);
+}
+
+/* The same on the Event_Loop running on the calling thread */
+
+inline Task<Async_Digest<Sha1> > sha1_file_async(const char *path, Executor *compression = nullptr)
+{
+    return hash_file_async<Sha1>(*Event_Loop::current(), path, compression);
+}
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaawait.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-27
+ *
+ * CONTENT: The example program shaawait for the coroutines of shaasync.h. Hashes every file given with sha1_file_async,
+ *          all of them at once, on one Event_Loop with the compression on a Thread_Pool, and prints one line per file
+ *          in the format of sha1sum in the order the files were given. At most --files files are open at a time. The
+ *          statistics of the run are written as JSON to standard error.
+ *
+ *          Usage: shaawait [--threads N] [--files N] [--no-io-uring] FILE...
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "shaasync.h"
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--threads N] [--files N] [--no-io-uring] FILE...\n", program);
+}
+
+/* The coroutine Hash_Files is one of the workers hashing the files, each taking the next file not yet taken */
+
+static sha::Task<void> Hash_Files(sha::Event_Loop &loop, sha::Executor *pool, const std::vector<const char*> &files,
+                                  size_t *next, std::vector<sha::Async_Digest<sha::Sha1> > *results)
+{
+    while (*next < files.size())
+    {
+        size_t i = (*next)++;
+        (*results)[i] = co_await sha::sha1_file_async(loop, files[i], pool);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<const char*> files;
+    unsigned int nr_of_threads = 0, nr_of_workers = 256;
+    bool use_io_uring = true;
+    uint64_t bytes = 0, failed = 0;
+    struct timespec start, end;
+    size_t next = 0, i;
+    double seconds;
+
+    for (i = 1; i < (size_t) argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < (size_t) argc)
+            nr_of_threads = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--files") == 0 && i + 1 < (size_t) argc)
+            nr_of_workers = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--no-io-uring") == 0)
+            use_io_uring = false;
+        else if (argv[i][0] != '-')
+            files.push_back(argv[i]);
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (files.empty() || nr_of_workers == 0)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sha::Thread_Pool pool(nr_of_threads);
+    sha::Event_Loop loop(SHA_ASYNC_QUEUE_DEPTH, use_io_uring);
+    std::vector<sha::Async_Digest<sha::Sha1> > results(files.size());
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < nr_of_workers && i < files.size(); i++)
+        loop.spawn(Hash_Files(loop, &pool, files, &next, &results));
+    loop.run();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9;
+
+    for (i = 0; i < files.size(); i++)
+    {
+        if (results[i].status != EXIT_SUCCESS)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], files[i], strerror(results[i].error_number));
+            failed++;
+            continue;
+        }
+
+        for (uint8_t byte : results[i].digest)
+            printf("%02x", byte);
+        printf("  %s\n", files[i]);
+        bytes += results[i].file_byte_size;
+    }
+    fflush(stdout);
+
+    fprintf(stderr, "{\"files\": %llu, \"failed\": %llu, \"bytes\": %llu, \"io_uring\": %s, \"threads\": %u, "
+                    "\"seconds\": %.3f, \"mb_per_s\": %.1f, \"files_per_s\": %.1f}\n",
+            (unsigned long long) files.size(), (unsigned long long) failed, (unsigned long long) bytes,
+            loop.uses_io_uring() ? "true" : "false", pool.nr_of_threads(), seconds,
+            seconds > 0 ? bytes/seconds/1e6 : 0.0, seconds > 0 ? files.size()/seconds : 0.0);
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
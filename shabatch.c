@@ -0,0 +1,387 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shabatch.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-12
+ *
+ * CONTENT: Implements multi-lane SHA1 kernels, which compress independent blocks side by side in the lanes of the vector
+ *          registers, and a batch function hashing many independent texts through them.
+ *
+ *          The vector kernels are written once in shabatch_kernel.h using GCC vector extensions and instantiated for
+ *          each vector width. On x86 processors the instruction set of each instance is selected with a target
+ *          attribute and its availability is checked at run time. For processors without vector instructions the
+ *          interleaved scalar kernels of shabatch_scalar.h compress two or three lanes in one instruction stream.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "shalib.h"
+#include "shabatch.h"
+
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4         /* defines the size of a word in BYTES                                      */
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ALTIVEC__) || defined(__mips_msa) || defined(__riscv_vector)
+#define SHA_NATIVE_VECTOR
+#endif
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: KERNELS
+ *
+ **************************************************************************************************************************************/
+
+/* The scalar kernel compresses a single lane with the compression function of shalib.c */
+
+static void SHA1_Lanes_Scalar(uint32_t *H, const uint32_t *W_in)
+{
+    uint32_t W[80];
+
+    memcpy(W, W_in, 16*WORD_SIZE);
+    SHA1_Compress(H, W);
+}
+
+/* The interleaved scalar kernels compress two and three lanes in one stream of scalar instructions, for processors
+   where no vector kernel is available */
+
+#define SCALAR_NAME SHA1_Lanes_Scalar2
+#define SCALAR_N 2
+#include "shabatch_scalar.h"
+
+#define SCALAR_NAME SHA1_Lanes_Scalar3
+#define SCALAR_N 3
+#include "shabatch_scalar.h"
+
+typedef uint32_t sha1_vector4 __attribute__((vector_size(16)));
+typedef uint32_t sha1_vector8 __attribute__((vector_size(32)));
+typedef uint32_t sha1_vector16 __attribute__((vector_size(64)));
+
+#ifdef SHA_X86
+
+#define LANES_NAME SHA1_Lanes_SSE2
+#define LANES_VECTOR sha1_vector4
+#define LANES_N 4
+#define LANES_TARGET __attribute__((target("sse2")))
+#include "shabatch_kernel.h"
+
+#define LANES_NAME SHA1_Lanes_AVX2
+#define LANES_VECTOR sha1_vector8
+#define LANES_N 8
+#define LANES_TARGET __attribute__((target("avx2")))
+#include "shabatch_kernel.h"
+
+#define LANES_NAME SHA1_Lanes_AVX512
+#define LANES_VECTOR sha1_vector16
+#define LANES_N 16
+#define LANES_TARGET __attribute__((target("avx512f")))
+#include "shabatch_kernel.h"
+
+#else
+
+#define LANES_NAME SHA1_Lanes_Vector4
+#define LANES_VECTOR sha1_vector4
+#define LANES_N 4
+#define LANES_TARGET
+#include "shabatch_kernel.h"
+
+#endif
+
+/* All kernels compiled in, in order of increasing preference when chosen by default. The interleaved scalar kernels
+   rank below every vector kernel that runs on vector registers, and the three lanes spill registers where there are
+   only 16 general purpose registers for their 15 words of state. Without native vector registers GCC splits the
+   vector kernel into scalar code, which then ranks below the interleaved scalar kernels */
+
+static const struct sha1_kernel all_kernels[] =
+{
+    {"scalar", 1, SHA1_Lanes_Scalar},
+#if !defined(SHA_X86) && !defined(SHA_NATIVE_VECTOR)
+    {"vector4", 4, SHA1_Lanes_Vector4},
+#endif
+#ifdef SHA_X86
+    {"scalar3", 3, SHA1_Lanes_Scalar3},
+    {"scalar2", 2, SHA1_Lanes_Scalar2},
+#else
+    {"scalar2", 2, SHA1_Lanes_Scalar2},
+    {"scalar3", 3, SHA1_Lanes_Scalar3},
+#endif
+#ifdef SHA_X86
+    {"sse2", 4, SHA1_Lanes_SSE2},
+    {"avx2", 8, SHA1_Lanes_AVX2},
+    {"avx512", 16, SHA1_Lanes_AVX512},
+#elif defined(SHA_NATIVE_VECTOR)
+    {"vector4", 4, SHA1_Lanes_Vector4},
+#endif
+};
+
+#define NR_OF_KERNELS (sizeof(all_kernels)/sizeof(all_kernels[0]))
+
+/* The function Is_Available checks whether the processor supports the instruction set of a kernel */
+
+static int Is_Available(const struct sha1_kernel *kernel)
+{
+#ifdef SHA_X86
+    __builtin_cpu_init();
+    if (strcmp(kernel->name, "sse2") == 0)
+        return __builtin_cpu_supports("sse2");
+    if (strcmp(kernel->name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(kernel->name, "avx512") == 0)
+        return __builtin_cpu_supports("avx512f");
+#endif
+    return 1;
+}
+
+/* The kernels available on the processor, filled once by Find_Available_Kernels whichever thread comes first */
+
+static struct sha1_kernel available_kernels[NR_OF_KERNELS];
+static unsigned int nr_of_available_kernels = 0;
+static pthread_once_t available_once = PTHREAD_ONCE_INIT;
+
+static void Find_Available_Kernels(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < NR_OF_KERNELS; i++)
+        if (Is_Available(&all_kernels[i]))
+            available_kernels[nr_of_available_kernels++] = all_kernels[i];
+}
+
+/* The function SHA1_Kernels returns the kernels available on the processor and stores their number */
+
+const struct sha1_kernel *SHA1_Kernels(unsigned int *nr_of_kernels)
+{
+    pthread_once(&available_once, Find_Available_Kernels);
+
+    *nr_of_kernels = nr_of_available_kernels;
+    return available_kernels;
+}
+
+/* The function SHA1_Find_Kernel returns the available kernel with the given name, or NULL if there is none */
+
+const struct sha1_kernel *SHA1_Find_Kernel(const char *name)
+{
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels, i;
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (i = 0; i < nr_of_kernels; i++)
+        if (strcmp(kernels[i].name, name) == 0)
+            return &kernels[i];
+
+    return NULL;
+}
+
+/* The function SHA1_Default_Kernel returns the kernel used by SHA1_Batch. This is the most preferred available kernel
+   short of AVX-512, whose 16 lanes need large batches to fill and which may lower the clock frequency. On x86-64 it is
+   therefore SSE2 or AVX2. The interleaved scalar kernels are the default only without vector registers, i.e. scalar3
+   on other targets without native vectors and scalar2 on 32-bit x86 processors without SSE2 */
+
+const struct sha1_kernel *SHA1_Default_Kernel(void)
+{
+    const struct sha1_kernel *kernels;
+    const struct sha1_kernel *kernel;
+    unsigned int nr_of_kernels, i;
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    kernel = &kernels[0];
+    for (i = 1; i < nr_of_kernels; i++)
+        if (kernels[i].nr_of_lanes <= 8)
+            kernel = &kernels[i];
+
+    return kernel;
+}
+
+/* The kernels used by SHA1_Batch for each size class of the texts, as set by SHA1_Set_Batch_Kernel. NULL stands
+   for the default kernel. */
+
+static const struct sha1_kernel *batch_kernels[SHA_SIZE_CLASSES];
+
+/* The function SHA1_Set_Batch_Kernel sets the kernel used by SHA1_Batch for texts in the given size class (see
+   SHA_Size_Class), or restores the default kernel if kernel is NULL */
+
+int SHA1_Set_Batch_Kernel(unsigned int size_class, const struct sha1_kernel *kernel)
+{
+    if (size_class >= SHA_SIZE_CLASSES)
+        return EXIT_FAILURE;
+
+    batch_kernels[size_class] = kernel;
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA1_Get_Batch_Kernel returns the kernel used by SHA1_Batch for texts in the given size class */
+
+const struct sha1_kernel *SHA1_Get_Batch_Kernel(unsigned int size_class)
+{
+    if (size_class < SHA_SIZE_CLASSES && batch_kernels[size_class] != NULL)
+        return batch_kernels[size_class];
+
+    return SHA1_Default_Kernel();
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: BATCH HASHING
+ *
+ **************************************************************************************************************************************/
+
+/* A sha1_lane holds the position of one text in its lane. Whole blocks are read directly from the text, while the
+   last bytes together with the pad are copied to final_blocks once the end of the text is reached */
+
+struct sha1_lane
+{
+    unsigned char *text;                      /* the text being hashed, NULL if the lane is idle                            */
+    uint64_t text_byte_size;                  /* the size in bytes of the text                                              */
+    uint64_t position;                        /* the position of the next block in the text                                 */
+    uint64_t job;                             /* the index of the text in the batch                                         */
+    unsigned char final_blocks[2*BLOCK_SIZE]; /* the last bytes of the text followed by the pad                             */
+    unsigned int nr_of_final_blocks;          /* the number of final blocks, 0 until they have been set                     */
+    unsigned int final_position;              /* the number of final blocks already loaded                                  */
+};
+
+/* The function Load_Lane loads the next block of a lane into the lane-interleaved W and returns TRUE if it was the
+   last block of the text */
+
+static int Load_Lane(struct sha1_lane *lane, uint32_t *W, unsigned int l, unsigned int nr_of_lanes)
+{
+    unsigned char *block;
+    unsigned int i;
+
+    if (lane->position + BLOCK_SIZE <= lane->text_byte_size)
+    {
+        block = &lane->text[lane->position];
+        lane->position = lane->position + BLOCK_SIZE;
+    }
+    else
+    {
+        if (lane->nr_of_final_blocks == 0)
+            lane->nr_of_final_blocks = Set_64Byte_Final_Blocks(lane->final_blocks, &lane->text[lane->position],
+                                                               lane->text_byte_size - lane->position, lane->text_byte_size);
+        block = &lane->final_blocks[BLOCK_SIZE*lane->final_position];
+        lane->final_position++;
+    }
+
+    for (i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
+        W[i*nr_of_lanes + l] = Conv_Word_To_32Int(&block[i*WORD_SIZE]);
+
+    return lane->nr_of_final_blocks > 0 && lane->final_position == lane->nr_of_final_blocks;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Batch_Kernel
+ *
+ * PURPOSE: Computes the SHA1 hashes of a number of independent char arrays with the given multi-lane kernel. Each lane
+ *          hashes one array at a time, and a lane is given the next array as soon as it has finished, so that the
+ *          lanes are kept filled even when the arrays differ in length.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * kernel              struct sha1_kernel*   I       the kernel to use, see SHA1_Kernels
+ * texts               char**                I       the pointer to the array of pointers to the char arrays to be hashed
+ * texts_byte_size     uint64_t*             I       pointer to the array containing the size in bytes of each char array
+ * nr_of_texts         uint64_t              I       the number of char arrays
+ * hashes              uint32_t*:            O       pointer to the uint32_t array where the 5-word hash of char array i
+ *                                                   is to be stored at index 5*i
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Batch_Kernel(const struct sha1_kernel *kernel, char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes)
+{
+    const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    struct sha1_lane lanes[SHA1_MAX_LANES];
+    uint32_t H[HASH_SIZE*SHA1_MAX_LANES];
+    uint32_t W[(BLOCK_SIZE/WORD_SIZE)*SHA1_MAX_LANES];
+    int is_last[SHA1_MAX_LANES];
+    unsigned int nr_of_lanes, nr_of_active, l, i;
+    uint64_t next;
+
+    nr_of_lanes = kernel->nr_of_lanes;
+    memset(W, 0, sizeof(W));
+    for (l = 0; l < nr_of_lanes; l++)
+        lanes[l].text = NULL;
+
+    next = 0;
+    for (;;)
+    {
+        /* Give every idle lane the next text */
+
+        nr_of_active = 0;
+        for (l = 0; l < nr_of_lanes; l++)
+        {
+            if (lanes[l].text == NULL && next < nr_of_texts)
+            {
+                lanes[l].text = (unsigned char*) texts[next];
+                lanes[l].text_byte_size = texts_byte_size[next];
+                lanes[l].position = 0;
+                lanes[l].job = next;
+                lanes[l].nr_of_final_blocks = 0;
+                lanes[l].final_position = 0;
+                for (i = 0; i < HASH_SIZE; i++)
+                    H[i*nr_of_lanes + l] = H_init[i];
+                next++;
+            }
+
+            if (lanes[l].text != NULL)
+                nr_of_active++;
+        }
+
+        if (nr_of_active == 0)
+            break;
+
+        /* Load one block per active lane and compress all lanes at once. Idle lanes compress stale data,
+           which is cheaper than splitting the call */
+
+        for (l = 0; l < nr_of_lanes; l++)
+            is_last[l] = lanes[l].text != NULL && Load_Lane(&lanes[l], W, l, nr_of_lanes);
+
+        kernel->compress(H, W);
+
+        /* Store the hash of every text that has been completed */
+
+        for (l = 0; l < nr_of_lanes; l++)
+            if (is_last[l])
+            {
+                for (i = 0; i < HASH_SIZE; i++)
+                    hashes[HASH_SIZE*lanes[l].job + i] = H[i*nr_of_lanes + l];
+                lanes[l].text = NULL;
+            }
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Batch
+ *
+ * PURPOSE: Computes the SHA1 hashes of a number of independent char arrays with the kernel set for the size class
+ *          of their mean size, by default the default kernel. See SHA1_Batch_Kernel.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Batch(char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes)
+{
+    uint64_t tot_byte_size = 0, i;
+
+    for (i = 0; i < nr_of_texts; i++)
+        tot_byte_size += texts_byte_size[i];
+
+    SHA1_Batch_Kernel(SHA1_Get_Batch_Kernel(SHA_Size_Class(nr_of_texts > 0 ? tot_byte_size/nr_of_texts : 0)), texts, texts_byte_size, nr_of_texts, hashes);
+}
@@ -0,0 +1,39 @@
+/***************************************************************************************************************************************
+ * FILENAME: shabatch.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the multi-lane SHA1 kernels and the batch hashing functions defined in shabatch.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHABATCH__
+#define __SHABATCH__
+
+#define SHA1_MAX_LANES 16                     /* the largest number of lanes of any kernel                                  */
+
+/* A sha1_kernel compresses one block in each of its lanes at a time. The hash H (5 words per lane) and the block
+   W (16 words per lane) are stored lane-interleaved, i.e. word t of lane l is found at index t*nr_of_lanes + l */
+
+struct sha1_kernel
+{
+    const char *name;                         /* the name of the kernel, e.g. "avx2"                                        */
+    unsigned int nr_of_lanes;                 /* the number of independent blocks compressed per call                       */
+    void (*compress)(uint32_t *H, const uint32_t *W);
+};
+
+const struct sha1_kernel *SHA1_Kernels(unsigned int *nr_of_kernels);
+
+const struct sha1_kernel *SHA1_Find_Kernel(const char *name);
+
+const struct sha1_kernel *SHA1_Default_Kernel(void);
+
+int SHA1_Set_Batch_Kernel(unsigned int size_class, const struct sha1_kernel *kernel);
+
+const struct sha1_kernel *SHA1_Get_Batch_Kernel(unsigned int size_class);
+
+void SHA1_Batch_Kernel(const struct sha1_kernel *kernel, char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes);
+
+void SHA1_Batch(char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes);
+
+#endif
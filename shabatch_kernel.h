@@ -0,0 +1,76 @@
+/***************************************************************************************************************************************
+ * FILENAME: shabatch_kernel.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Template of a multi-lane SHA1 compression function, included by shabatch.c once per vector width.
+ *          Before inclusion the following must be defined:
+ *
+ *          LANES_NAME      the name of the function to define
+ *          LANES_VECTOR    a GCC vector type of 32-bit unsigned integers, one element per lane
+ *          LANES_N         the number of lanes, i.e. the number of elements in LANES_VECTOR
+ *          LANES_TARGET    the function attributes selecting the instruction set, possibly empty
+ *
+ *          The hash H and the block W are stored lane-interleaved: word t of lane l is found at index t*LANES_N + l.
+ *
+ **************************************************************************************************************************************/
+
+#define Lanes_Rot_Left(t, x) (((x) << (t)) | ((x) >> (32 - (t))))
+
+#define Lanes_Round(F, K)                                                                               \
+{                                                                                                       \
+    if (t >= 16)                                                                                        \
+        W[t & 15] = Lanes_Rot_Left(1, W[(t - 3) & 15] ^ W[(t - 8) & 15] ^ W[(t - 14) & 15] ^ W[t & 15]);  \
+    T = Lanes_Rot_Left(5, a) + (F) + e + (uint32_t) (K) + W[t & 15];                                    \
+    e = d;                                                                                              \
+    d = c;                                                                                              \
+    c = Lanes_Rot_Left(30, b);                                                                          \
+    b = a;                                                                                              \
+    a = T;                                                                                              \
+}
+
+#define Lanes_Add_State(i, x)                                                                           \
+{                                                                                                       \
+    memcpy(&T, &H[(i)*LANES_N], sizeof(LANES_VECTOR));                                                  \
+    T += x;                                                                                             \
+    memcpy(&H[(i)*LANES_N], &T, sizeof(LANES_VECTOR));                                                  \
+}
+
+LANES_TARGET
+static void LANES_NAME(uint32_t *H, const uint32_t *W_in)
+{
+    LANES_VECTOR W[16], a, b, c, d, e, T;
+    int t;
+
+    for (t = 0; t < 16; t++)
+        memcpy(&W[t], &W_in[t*LANES_N], sizeof(LANES_VECTOR));
+
+    memcpy(&a, &H[0*LANES_N], sizeof(LANES_VECTOR));
+    memcpy(&b, &H[1*LANES_N], sizeof(LANES_VECTOR));
+    memcpy(&c, &H[2*LANES_N], sizeof(LANES_VECTOR));
+    memcpy(&d, &H[3*LANES_N], sizeof(LANES_VECTOR));
+    memcpy(&e, &H[4*LANES_N], sizeof(LANES_VECTOR));
+
+    for (t = 0; t < 20; t++)
+        Lanes_Round(d ^ (b & (c ^ d)), 0x5a827999);
+    for (; t < 40; t++)
+        Lanes_Round(b ^ c ^ d, 0x6ed9eba1);
+    for (; t < 60; t++)
+        Lanes_Round((b & c) | (d & (b | c)), 0x8f1bbcdc);
+    for (; t < 80; t++)
+        Lanes_Round(b ^ c ^ d, 0xca62c1d6);
+
+    Lanes_Add_State(0, a);
+    Lanes_Add_State(1, b);
+    Lanes_Add_State(2, c);
+    Lanes_Add_State(3, d);
+    Lanes_Add_State(4, e);
+}
+
+#undef Lanes_Round
+#undef Lanes_Add_State
+#undef Lanes_Rot_Left
+#undef LANES_NAME
+#undef LANES_VECTOR
+#undef LANES_N
+#undef LANES_TARGET
@@ -0,0 +1,100 @@
+/***************************************************************************************************************************************
+ * FILENAME: shabatch_scalar.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Template of an interleaved scalar SHA1 compression function, included by shabatch.c once per number of
+ *          lanes. Each round is computed for every lane before the next round is started, so that the independent
+ *          chains of additions of the lanes fill the integer units of processors without usable vector instructions,
+ *          where a single chain is limited by the latency of its additions. Before inclusion the following must be
+ *          defined:
+ *
+ *          SCALAR_NAME     the name of the function to define
+ *          SCALAR_N        the number of lanes, small enough for the state of all lanes to stay in registers
+ *
+ *          The hash H and the block W are stored lane-interleaved as for the vector kernels of shabatch_kernel.h.
+ *
+ **************************************************************************************************************************************/
+
+#define Scalar_Rot_Left(t, x) (((x) << (t)) | ((x) >> (32 - (t))))
+
+#define Scalar_Ch(b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
+#define Scalar_Parity(b, c, d) ((b) ^ (c) ^ (d))
+#define Scalar_Maj(b, c, d) (((b) & (c)) | ((d) & ((b) | (c))))
+
+/* One round of every lane. The roles of the five words rotate from round to round instead of the words being moved */
+
+#define Scalar_Round(a, b, c, d, e, F, K)                                                               \
+{                                                                                                       \
+    _Pragma("GCC unroll 4")                                                                             \
+    for (l = 0; l < SCALAR_N; l++)                                                                      \
+    {                                                                                                   \
+        e[l] += Scalar_Rot_Left(5, a[l]) + F(b[l], c[l], d[l]) + (uint32_t) (K) + W[t][l];              \
+        b[l] = Scalar_Rot_Left(30, b[l]);                                                               \
+    }                                                                                                   \
+    t++;                                                                                                \
+}
+
+#define Scalar_Five_Rounds(F, K)                                                                        \
+{                                                                                                       \
+    Scalar_Round(a, b, c, d, e, F, K);                                                                  \
+    Scalar_Round(e, a, b, c, d, F, K);                                                                  \
+    Scalar_Round(d, e, a, b, c, F, K);                                                                  \
+    Scalar_Round(c, d, e, a, b, F, K);                                                                  \
+    Scalar_Round(b, c, d, e, a, F, K);                                                                  \
+}
+
+/* The lanes are kept out of the vector registers, which the vectorizer of GCC otherwise packs them into */
+
+__attribute__((optimize("no-tree-vectorize", "no-tree-slp-vectorize")))
+static void SCALAR_NAME(uint32_t *H, const uint32_t *W_in)
+{
+    uint32_t W[80][SCALAR_N], a[SCALAR_N], b[SCALAR_N], c[SCALAR_N], d[SCALAR_N], e[SCALAR_N];
+    int t, l;
+
+    /* The message schedule of all lanes is computed ahead of the rounds, whose chains it does not depend on */
+
+    for (t = 0; t < 16; t++)
+        for (l = 0; l < SCALAR_N; l++)
+            W[t][l] = W_in[t*SCALAR_N + l];
+    for (; t < 80; t++)
+        for (l = 0; l < SCALAR_N; l++)
+            W[t][l] = Scalar_Rot_Left(1, W[t - 3][l] ^ W[t - 8][l] ^ W[t - 14][l] ^ W[t - 16][l]);
+
+    for (l = 0; l < SCALAR_N; l++)
+    {
+        a[l] = H[0*SCALAR_N + l];
+        b[l] = H[1*SCALAR_N + l];
+        c[l] = H[2*SCALAR_N + l];
+        d[l] = H[3*SCALAR_N + l];
+        e[l] = H[4*SCALAR_N + l];
+    }
+
+    t = 0;
+    while (t < 20)
+        Scalar_Five_Rounds(Scalar_Ch, 0x5a827999);
+    while (t < 40)
+        Scalar_Five_Rounds(Scalar_Parity, 0x6ed9eba1);
+    while (t < 60)
+        Scalar_Five_Rounds(Scalar_Maj, 0x8f1bbcdc);
+    while (t < 80)
+        Scalar_Five_Rounds(Scalar_Parity, 0xca62c1d6);
+
+    for (l = 0; l < SCALAR_N; l++)
+    {
+        H[0*SCALAR_N + l] += a[l];
+        H[1*SCALAR_N + l] += b[l];
+        H[2*SCALAR_N + l] += c[l];
+        H[3*SCALAR_N + l] += d[l];
+        H[4*SCALAR_N + l] += e[l];
+    }
+}
+
+#undef Scalar_Five_Rounds
+#undef Scalar_Round
+#undef Scalar_Maj
+#undef Scalar_Parity
+#undef Scalar_Ch
+#undef Scalar_Rot_Left
+#undef SCALAR_NAME
+#undef SCALAR_N
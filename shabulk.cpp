@@ -0,0 +1,501 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shabulk.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-04
+ *
+ * CONTENT: Implements SHA1_Bulk_Files, which hashes trees of many small files. SHA1_File spends several system calls
+ *          per file on fopen, fseek, ftell and rewind before it reads, which dominates the time when the files are a
+ *          few hundred bytes. Here the files are taken in batches of SHA_BULK_BATCH_SIZE and for each file a chain of
+ *          three linked entries is queued on io_uring:
+ *
+ *              openat into a direct descriptor -> read of up to SHA_BULK_SMALL_FILE_SIZE bytes -> close
+ *
+ *          The read refers to the file by the slot the open placed it in, so the whole chain is submitted at once and a
+ *          batch of files costs a few calls of io_uring_enter. The links are hard, so that the close runs even if the
+ *          read is short or fails. Two batches are in flight: while the kernel works on one, the contents of the other
+ *          are hashed together by SHA1_Batch on the multi-lane kernels.
+ *
+ *          A read that does not fill the buffer has reached the end of the file. The chain does not tell whether the
+ *          file is a regular file, and IORING_OP_STATX is always handed to a worker thread of the kernel, which every
+ *          batch would then wait for. Instead only the files that read nothing are checked with stat, since a FIFO
+ *          without a writer or a device such as /dev/null reads as empty, a directory fails to read, and a device that
+ *          fills the buffer is checked like the large files.
+ *
+ *          Where io_uring or its direct descriptors are not available, a few threads each take the next batch of
+ *          files and open, fstat and pread them in turn before hashing the batch the same way. Files larger than
+ *          SHA_BULK_SMALL_FILE_SIZE are hashed by SHA1_File on either backend.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "sha1.h"
+#include "shabatch.h"
+#include "shabulk.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#endif
+
+#include "shauring.h"
+
+#define HASH_SIZE 5             /* defines the size of a SHA1 hash in number of 32-bit INTEGERS      */
+#define CHAIN_LENGTH 3          /* defines the number of linked entries queued on io_uring per file  */
+
+/* The contents of a batch of files and the hashing of them, shared by both backends */
+
+struct Bulk_Batch
+{
+    std::vector<unsigned char> buffers;       /* SHA_BULK_BATCH_SIZE buffers of SHA_BULK_SMALL_FILE_SIZE bytes              */
+    std::vector<char*> texts;
+    std::vector<uint64_t> texts_byte_size;
+    std::vector<uint64_t> files;              /* the index among the files of each text                                     */
+    std::vector<uint32_t> hashes;
+
+    Bulk_Batch() : buffers((size_t) SHA_BULK_BATCH_SIZE*SHA_BULK_SMALL_FILE_SIZE), hashes(HASH_SIZE*SHA_BULK_BATCH_SIZE) {}
+
+    unsigned char *Buffer(unsigned int slot) { return &buffers[(size_t) slot*SHA_BULK_SMALL_FILE_SIZE]; }
+};
+
+/* The counters of sha_bulk_stats, kept atomic since the threads add to them */
+
+struct Bulk_Counters
+{
+    std::atomic<uint64_t> nr_of_failed;
+    std::atomic<uint64_t> nr_of_large_files;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> nr_of_batches;
+    std::atomic<uint64_t> nr_of_enters;
+
+    Bulk_Counters() : nr_of_failed(0), nr_of_large_files(0), bytes(0), nr_of_batches(0), nr_of_enters(0) {}
+};
+
+/* The outcome of opening and reading one file, as far as the backend got */
+
+struct Bulk_Read
+{
+    uint64_t file;
+    int open_result;                          /* 0 or -errno                                                                */
+    int is_regular;                           /* 1 for a regular file, 0 for another file and -1 if not yet checked         */
+    int64_t read_result;                      /* the bytes read into the buffer, or -errno                                  */
+    int whole;                                /* true if the buffer holds the whole file                                    */
+};
+
+/* The function Is_Regular_File returns true if filename names a regular file */
+
+static bool Is_Regular_File(const char *filename, struct stat *file_status)
+{
+    return stat(filename, file_status) == 0 && S_ISREG(file_status->st_mode);
+}
+
+/* The function Finish_Batch hashes the files of a batch read whole with SHA1_Batch and the larger ones with SHA1_File,
+   and records the outcome of each. Files not yet checked are checked with stat if they read nothing or filled the
+   buffer */
+
+static void Finish_Batch(Bulk_Batch *batch, const Bulk_Read *reads, unsigned int nr_of_reads, char **filenames,
+                         uint32_t *hashes, int *statuses, Bulk_Counters *counters)
+{
+    unsigned int i, j;
+
+    batch->texts.clear();
+    batch->texts_byte_size.clear();
+    batch->files.clear();
+
+    for (i = 0; i < nr_of_reads; i++)
+    {
+        const Bulk_Read &r = reads[i];
+        int status = EXIT_SUCCESS;
+
+        struct stat file_status;
+
+        if (r.open_result < 0 || r.is_regular == 0 || r.read_result < 0 ||
+            (r.is_regular < 0 && r.read_result == 0 && !Is_Regular_File(filenames[r.file], &file_status)))
+            status = EXIT_FAILURE;
+        else if (r.whole)
+        {
+            batch->texts.push_back((char*) batch->Buffer(i));
+            batch->texts_byte_size.push_back((uint64_t) r.read_result);
+            batch->files.push_back(r.file);
+            counters->bytes += (uint64_t) r.read_result;
+        }
+        else if (!Is_Regular_File(filenames[r.file], &file_status))
+            status = EXIT_FAILURE;
+        else
+        {
+            status = SHA1_File(filenames[r.file], &hashes[HASH_SIZE*r.file]);
+            counters->nr_of_large_files++;
+            if (status == EXIT_SUCCESS)
+                counters->bytes += file_status.st_size;
+        }
+
+        if (status != EXIT_SUCCESS)
+            counters->nr_of_failed++;
+        if (statuses != NULL)
+            statuses[r.file] = status;
+    }
+
+    if (batch->texts.empty())
+        return;
+
+    SHA1_Batch(batch->texts.data(), batch->texts_byte_size.data(), batch->texts.size(), batch->hashes.data());
+    counters->nr_of_batches++;
+
+    for (i = 0; i < batch->files.size(); i++)
+        for (j = 0; j < HASH_SIZE; j++)
+            hashes[HASH_SIZE*batch->files[i] + j] = batch->hashes[HASH_SIZE*i + j];
+}
+
+
+/*******************************************************************************************************************************
+ *
+ *  SECTION: THE IO_URING BACKEND
+ *
+ *******************************************************************************************************************************/
+
+#ifdef __linux__
+
+/* A batch in flight on the ring. Slot i of batch k is the direct descriptor k*SHA_BULK_BATCH_SIZE + i */
+
+struct Uring_Batch
+{
+    Bulk_Batch batch;
+    Bulk_Read reads[SHA_BULK_BATCH_SIZE];
+    unsigned int nr_of_completions[SHA_BULK_BATCH_SIZE];
+    unsigned int nr_of_files;
+    unsigned int nr_complete;
+};
+
+/* The function Queue_Batch queues the chains of the files first, first + 1, ... of batch k and submits them */
+
+static int Queue_Batch(struct sha_uring *ring, Uring_Batch *u, unsigned int k, char **filenames, uint64_t first,
+                       unsigned int nr_of_files, Bulk_Counters *counters)
+{
+    struct io_uring_sqe *sqe;
+    unsigned int i, slot;
+    uint64_t data;
+    int result;
+
+    u->nr_of_files = nr_of_files;
+    u->nr_complete = 0;
+
+    for (i = 0; i < nr_of_files; i++)
+    {
+        slot = k*SHA_BULK_BATCH_SIZE + i;
+        data = (uint64_t) slot*CHAIN_LENGTH;
+        u->reads[i].file = first + i;
+        u->reads[i].is_regular = -1;
+        u->nr_of_completions[i] = 0;
+
+        /* The ring holds two batches of chains, so the entries never run out */
+
+        sqe = SHA_Uring_Get_Sqe(ring);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->flags = IOSQE_IO_HARDLINK;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) filenames[first + i];
+        sqe->open_flags = O_RDONLY | O_NONBLOCK;
+        sqe->file_index = slot + 1;
+        sqe->user_data = data;
+
+        sqe = SHA_Uring_Get_Sqe(ring);
+        sqe->opcode = IORING_OP_READ;
+        sqe->flags = IOSQE_IO_HARDLINK | IOSQE_FIXED_FILE;
+        sqe->fd = (int) slot;
+        sqe->addr = (uint64_t) (uintptr_t) u->batch.Buffer(i);
+        sqe->len = SHA_BULK_SMALL_FILE_SIZE;
+        sqe->user_data = data + 1;
+
+        sqe = SHA_Uring_Get_Sqe(ring);
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->file_index = slot + 1;
+        sqe->user_data = data + 2;
+    }
+
+    while (ring->nr_to_submit > 0)
+    {
+        result = SHA_Uring_Submit(ring, 0);
+        counters->nr_of_enters++;
+        if (result < 0 && result != -EAGAIN && result != -EBUSY)
+            return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* The function Reap takes the completions available and files them with the chains they belong to */
+
+static void Reap(struct sha_uring *ring, Uring_Batch *batches)
+{
+    struct io_uring_cqe *cqe;
+    unsigned int slot, operation, i;
+    Uring_Batch *u;
+
+    while ((cqe = SHA_Uring_Peek_Cqe(ring)) != NULL)
+    {
+        slot = (unsigned int) (cqe->user_data/CHAIN_LENGTH);
+        operation = (unsigned int) (cqe->user_data % CHAIN_LENGTH);
+        u = &batches[slot/SHA_BULK_BATCH_SIZE];
+        i = slot % SHA_BULK_BATCH_SIZE;
+
+        if (operation == 0)
+            u->reads[i].open_result = cqe->res < 0 ? cqe->res : 0;
+        else if (operation == 1)
+        {
+            u->reads[i].read_result = cqe->res;
+            u->reads[i].whole = cqe->res < SHA_BULK_SMALL_FILE_SIZE;
+        }
+
+        if (++u->nr_of_completions[i] == CHAIN_LENGTH)
+            u->nr_complete++;
+        SHA_Uring_Cqe_Seen(ring);
+    }
+}
+
+/* The function Opens_Supported returns false if the kernel refused to open into direct descriptors, as before Linux
+   5.15, which it reports as EINVAL for every file */
+
+static bool Opens_Supported(const Uring_Batch *u)
+{
+    for (unsigned int i = 0; i < u->nr_of_files; i++)
+        if (u->reads[i].open_result == -EINVAL)
+            return false;
+    return true;
+}
+
+/* The function Uring_Files hashes the files from first on through io_uring. It returns EXIT_FAILURE, and sets *first to
+   the first file not hashed, if io_uring cannot be used or fails on the way */
+
+static int Uring_Files(char **filenames, uint64_t nr_of_files, uint32_t *hashes, int *statuses, uint64_t *first,
+                       Bulk_Counters *counters)
+{
+    std::vector<Uring_Batch> batches(2);
+    struct sha_uring ring;
+    unsigned int k = 0, count, next_count;
+    uint64_t next;
+    bool queued;
+    int result;
+
+    if (SHA_Uring_Init(&ring, 2*CHAIN_LENGTH*SHA_BULK_BATCH_SIZE) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    if (SHA_Uring_Register_Files(&ring, 2*SHA_BULK_BATCH_SIZE) != EXIT_SUCCESS)
+    {
+        SHA_Uring_Exit(&ring);
+        return EXIT_FAILURE;
+    }
+
+    count = (unsigned int) (nr_of_files - *first < SHA_BULK_BATCH_SIZE ? nr_of_files - *first : SHA_BULK_BATCH_SIZE);
+    queued = count == 0 || Queue_Batch(&ring, &batches[k], k, filenames, *first, count, counters) == EXIT_SUCCESS;
+
+    while (queued && *first < nr_of_files)
+    {
+        /* Queue the next batch before waiting for this one */
+
+        next = *first + count;
+        next_count = (unsigned int) (nr_of_files - next < SHA_BULK_BATCH_SIZE ? nr_of_files - next : SHA_BULK_BATCH_SIZE);
+        if (next_count > 0 && Queue_Batch(&ring, &batches[k ^ 1], k ^ 1, filenames, next, next_count, counters) != EXIT_SUCCESS)
+            break;
+
+        Reap(&ring, batches.data());
+        while (batches[k].nr_complete < batches[k].nr_of_files)
+        {
+            result = SHA_Uring_Submit(&ring, 1);
+            counters->nr_of_enters++;
+            if (result < 0 && result != -EAGAIN && result != -EBUSY)
+                break;
+            Reap(&ring, batches.data());
+        }
+        if (batches[k].nr_complete < batches[k].nr_of_files || !Opens_Supported(&batches[k]))
+            break;
+
+        Finish_Batch(&batches[k].batch, batches[k].reads, count, filenames, hashes, statuses, counters);
+        *first = next;
+        count = next_count;
+        k ^= 1;
+    }
+
+    /* Let the chains left in flight complete before the buffers they read into are freed */
+
+    while (batches[0].nr_complete < batches[0].nr_of_files || batches[1].nr_complete < batches[1].nr_of_files)
+    {
+        result = SHA_Uring_Submit(&ring, 1);
+        if (result < 0 && result != -EAGAIN && result != -EBUSY)
+            break;
+        Reap(&ring, batches.data());
+    }
+
+    SHA_Uring_Exit(&ring);
+    return *first < nr_of_files ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#else
+
+static int Uring_Files(char **filenames, uint64_t nr_of_files, uint32_t *hashes, int *statuses, uint64_t *first,
+                       Bulk_Counters *counters)
+{
+    return EXIT_FAILURE;
+}
+
+#endif
+
+
+/*******************************************************************************************************************************
+ *
+ *  SECTION: THE THREADS
+ *
+ *******************************************************************************************************************************/
+
+/* The function Read_File opens a file and reads it with pread if it is smaller than SHA_BULK_SMALL_FILE_SIZE bytes */
+
+static void Read_File(const char *filename, unsigned char *buffer, Bulk_Read *r)
+{
+    struct stat status;
+    ssize_t n;
+    int fd;
+
+    r->is_regular = 0;
+    r->read_result = 0;
+    r->whole = 0;
+
+    fd = open(filename, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    r->open_result = fd < 0 ? -errno : 0;
+    if (fd < 0)
+        return;
+
+    if (fstat(fd, &status) == 0)
+        r->is_regular = S_ISREG(status.st_mode);
+
+    /* Read until the end of the file, which is whole if it comes before the end of the buffer */
+
+    while (r->is_regular && status.st_size < SHA_BULK_SMALL_FILE_SIZE && r->read_result < SHA_BULK_SMALL_FILE_SIZE)
+    {
+        n = pread(fd, buffer + r->read_result, SHA_BULK_SMALL_FILE_SIZE - r->read_result, r->read_result);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            r->read_result = -errno;
+        if (n == 0)
+            r->whole = 1;
+        if (n <= 0)
+            break;
+        r->read_result += n;
+    }
+
+    close(fd);
+}
+
+/* The function Thread_Files is run by every thread, taking the next batch of files until none are left */
+
+static void Thread_Files(char **filenames, uint64_t nr_of_files, uint32_t *hashes, int *statuses,
+                         std::atomic<uint64_t> *next, Bulk_Counters *counters)
+{
+    Bulk_Batch batch;
+    std::vector<Bulk_Read> reads(SHA_BULK_BATCH_SIZE);
+    uint64_t first;
+    unsigned int i, count;
+
+    while ((first = next->fetch_add(SHA_BULK_BATCH_SIZE)) < nr_of_files)
+    {
+        count = (unsigned int) (nr_of_files - first < SHA_BULK_BATCH_SIZE ? nr_of_files - first : SHA_BULK_BATCH_SIZE);
+        for (i = 0; i < count; i++)
+        {
+            reads[i].file = first + i;
+            Read_File(filenames[first + i], batch.Buffer(i), &reads[i]);
+        }
+        Finish_Batch(&batch, reads.data(), count, filenames, hashes, statuses, counters);
+    }
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Bulk_Files
+ *
+ * PURPOSE: Computes the SHA1 hashes of many files, meant for files of at most a few kilobytes
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                      I/O     DESCRIPTION
+ * --------            ----                      ---     -----------
+ * filenames           char**                    I       the names of the files
+ * nr_of_files         uint64_t                  I       the number of files
+ * hashes              uint32_t*                 O       the hashes, 5 words per file in the order of the files
+ * statuses            int*                      O       EXIT_SUCCESS or EXIT_FAILURE per file, or NULL
+ * backend             int                       I       SHA_BULK_AUTO, SHA_BULK_IO_URING or SHA_BULK_THREADS
+ * nr_of_threads       unsigned int              I       the number of threads of SHA_BULK_THREADS, 0 for one per
+ *                                                       processor
+ * stats               struct sha_bulk_stats*    O       a description of the call, or NULL
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS if every file was hashed. EXIT_FAILURE if any file failed, or io_uring was asked for
+ *                and is not available, in which case no file is hashed
+ *
+ *********************************************************************************************************************************/
+
+int SHA1_Bulk_Files(char **filenames, uint64_t nr_of_files, uint32_t *hashes, int *statuses, int backend,
+                    unsigned int nr_of_threads, struct sha_bulk_stats *stats)
+{
+    Bulk_Counters counters;
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> threads;
+    struct timespec start, end;
+    uint64_t first = 0;
+    int used = SHA_BULK_IO_URING;
+
+    if (stats != NULL)
+        memset(stats, 0, sizeof(*stats));
+    if (backend != SHA_BULK_AUTO && backend != SHA_BULK_IO_URING && backend != SHA_BULK_THREADS)
+        return EXIT_FAILURE;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* Take io_uring as far as it goes, and the threads for whatever is left */
+
+    if (backend == SHA_BULK_THREADS
+        || Uring_Files(filenames, nr_of_files, hashes, statuses, &first, &counters) != EXIT_SUCCESS)
+    {
+        if (backend == SHA_BULK_IO_URING && first == 0)
+            return EXIT_FAILURE;
+
+        used = first == 0 ? SHA_BULK_THREADS : SHA_BULK_IO_URING;
+        next = first;
+        if (nr_of_threads == 0)
+            nr_of_threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        if (nr_of_threads > (nr_of_files - first + SHA_BULK_BATCH_SIZE - 1)/SHA_BULK_BATCH_SIZE)
+            nr_of_threads = (unsigned int) ((nr_of_files - first + SHA_BULK_BATCH_SIZE - 1)/SHA_BULK_BATCH_SIZE);
+
+        for (unsigned int t = 1; t < nr_of_threads; t++)
+            threads.push_back(std::thread(Thread_Files, filenames, nr_of_files, hashes, statuses, &next, &counters));
+        Thread_Files(filenames, nr_of_files, hashes, statuses, &next, &counters);
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (stats != NULL)
+    {
+        stats->backend = used;
+        stats->nr_of_files = nr_of_files;
+        stats->nr_of_failed = counters.nr_of_failed;
+        stats->nr_of_large_files = counters.nr_of_large_files;
+        stats->bytes = counters.bytes;
+        stats->nr_of_batches = counters.nr_of_batches;
+        stats->nr_of_enters = counters.nr_of_enters;
+        stats->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9;
+        stats->files_per_s = stats->seconds > 0 ? nr_of_files/stats->seconds : 0.0;
+    }
+
+    return counters.nr_of_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
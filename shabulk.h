@@ -0,0 +1,42 @@
+/***************************************************************************************************************************************
+ * FILENAME: shabulk.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the bulk hashing of small files defined in shabulk.cpp, which opens, reads and closes batches of
+ *          files through io_uring, or on a few threads with pread, and hashes their contents with the multi-lane kernels
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHABULK__
+#define __SHABULK__
+
+/* Backends of SHA1_Bulk_Files. SHA_BULK_AUTO uses io_uring where the kernel supports opening into direct descriptors
+   (Linux 5.15) and the threads otherwise */
+
+#define SHA_BULK_AUTO 0
+#define SHA_BULK_IO_URING 1
+#define SHA_BULK_THREADS 2
+
+#define SHA_BULK_BATCH_SIZE 256               /* the number of files in a batch, two batches being in flight at a time      */
+#define SHA_BULK_SMALL_FILE_SIZE 16384        /* the size of the batch buffers, files of this size or more go to SHA1_File  */
+
+/* The sha_bulk_stats describes a call of SHA1_Bulk_Files */
+
+struct sha_bulk_stats
+{
+    int backend;                              /* SHA_BULK_IO_URING or SHA_BULK_THREADS, the backend actually used           */
+    uint64_t nr_of_files;
+    uint64_t nr_of_failed;                    /* the files which could not be opened or read, or are not regular files      */
+    uint64_t nr_of_large_files;               /* the files of SHA_BULK_SMALL_FILE_SIZE bytes or more, hashed by SHA1_File   */
+    uint64_t bytes;                           /* the bytes hashed                                                           */
+    uint64_t nr_of_batches;                   /* the number of calls of SHA1_Batch                                          */
+    uint64_t nr_of_enters;                    /* the number of calls of io_uring_enter, 0 with the threads                  */
+    double seconds;
+    double files_per_s;
+};
+
+int SHA1_Bulk_Files(char **filenames, uint64_t nr_of_files, uint32_t *hashes, int *statuses, int backend,
+                    unsigned int nr_of_threads, struct sha_bulk_stats *stats);
+
+#endif
@@ -0,0 +1,370 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shachain.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-30
+ *
+ * CONTENT: Implements SHA1 hash chains y = H^n(x), the hash of the hash of ... of a 20-byte value x, as used by S/KEY
+ *          one-time passwords, Lamport commitments and checks of sequential work.
+ *
+ *          Every step hashes exactly 20 bytes, so that every step compresses the same single block: the 5 words of
+ *          the previous hash followed by the pad and the size of 160 bits. The hash is therefore kept as words from
+ *          one step to the next, without converting it to bytes and back, and only the first 5 words of the block
+ *          change. For a single chain the block is a constant template in a compression function of its own, whose
+ *          state stays in registers and in which the constant words of the template fold into the message schedule.
+ *          Many chains are computed side by side in the lanes of the multi-lane kernels of shabatch.c, whose block
+ *          holds the template in all lanes once and receives only the 5 words of each lane per step.
+ *
+ *          The values of a chain may be stored every interval steps, e.g. to verify a long chain later in pieces in
+ *          parallel or to hand out the one-time passwords of S/KEY in reverse order without recomputing the chain.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shalib.h"
+#include "shabatch.h"
+#include "shachain.h"
+
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4         /* defines the size of a word in BYTES                                      */
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+#define PAD_WORD 0x80000000 /* defines the word following the 20 bytes of the hash in the block         */
+#define BIT_SIZE 160        /* defines the size of the hashed value in BITS, the last word of the block */
+
+static const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SINGLE CHAIN
+ *
+ **************************************************************************************************************************************/
+
+#define Rot_Left(t, x) (((x) << t) | ((x) >> (32 - t)))
+#define Ch(x, y, z) ((x & y) ^ (~x & z))
+#define Parity(x, y, z) (x ^ y ^ z)
+#define Maj(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
+
+#define F1(a, b, c, d, e, x)                                    \
+{                                                               \
+    e += Rot_Left(5, a) + Ch(b, c, d) + 0x5a827999 + x;         \
+    b =  Rot_Left(30, b);                                       \
+}
+
+#define F2(a, b, c, d, e, x)                                    \
+{                                                               \
+    e += Rot_Left(5, a) + Parity(b, c, d) + 0x6ed9eba1 + x;     \
+    b = Rot_Left(30, b);                                        \
+}
+
+#define F3(a, b, c, d, e, x)                                    \
+{                                                               \
+    e += Rot_Left(5, a) + Maj(b, c, d) + 0x8f1bbcdc + x;        \
+    b = Rot_Left(30, b);                                        \
+}
+
+#define F4(a, b, c, d, e, x)                                    \
+{                                                               \
+    e += Rot_Left(5, a) + Parity(b, c, d) + 0xca62c1d6 + x;     \
+    b = Rot_Left(30, b);                                        \
+}
+
+#define U(i)  (W[i] = Rot_Left(1, W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16]), W[i])
+
+/* The function Chain_Step replaces the hash x by the hash of its 20 bytes. The block is written out in full with the
+   words of the template as constants, so that the compiler drops the additions of the zero words and folds the
+   constant words into the message schedule */
+
+static inline void Chain_Step(uint32_t *x)
+{
+    uint32_t W[80];
+    uint32_t a, b, c, d, e;
+
+    W[0] = x[0];
+    W[1] = x[1];
+    W[2] = x[2];
+    W[3] = x[3];
+    W[4] = x[4];
+    W[5] = PAD_WORD;
+    W[6] = 0;
+    W[7] = 0;
+    W[8] = 0;
+    W[9] = 0;
+    W[10] = 0;
+    W[11] = 0;
+    W[12] = 0;
+    W[13] = 0;
+    W[14] = 0;
+    W[15] = BIT_SIZE;
+
+    a = H_init[0];
+    b = H_init[1];
+    c = H_init[2];
+    d = H_init[3];
+    e = H_init[4];
+
+    F1(a, b, c, d, e, W[0]);
+    F1(e, a, b, c, d, W[1]);
+    F1(d, e, a, b, c, W[2]);
+    F1(c, d, e, a, b, W[3]);
+    F1(b, c, d, e, a, W[4]);
+    F1(a, b, c, d, e, W[5]);
+    F1(e, a, b, c, d, W[6]);
+    F1(d, e, a, b, c, W[7]);
+    F1(c, d, e, a, b, W[8]);
+    F1(b, c, d, e, a, W[9]);
+    F1(a, b, c, d, e, W[10]);
+    F1(e, a, b, c, d, W[11]);
+    F1(d, e, a, b, c, W[12]);
+    F1(c, d, e, a, b, W[13]);
+    F1(b, c, d, e, a, W[14]);
+    F1(a, b, c, d, e, W[15]);
+    F1(e, a, b, c, d, U(16));
+    F1(d, e, a, b, c, U(17));
+    F1(c, d, e, a, b, U(18));
+    F1(b, c, d, e, a, U(19));
+
+    F2(a, b, c, d, e, U(20));
+    F2(e, a, b, c, d, U(21));
+    F2(d, e, a, b, c, U(22));
+    F2(c, d, e, a, b, U(23));
+    F2(b, c, d, e, a, U(24));
+    F2(a, b, c, d, e, U(25));
+    F2(e, a, b, c, d, U(26));
+    F2(d, e, a, b, c, U(27));
+    F2(c, d, e, a, b, U(28));
+    F2(b, c, d, e, a, U(29));
+    F2(a, b, c, d, e, U(30));
+    F2(e, a, b, c, d, U(31));
+    F2(d, e, a, b, c, U(32));
+    F2(c, d, e, a, b, U(33));
+    F2(b, c, d, e, a, U(34));
+    F2(a, b, c, d, e, U(35));
+    F2(e, a, b, c, d, U(36));
+    F2(d, e, a, b, c, U(37));
+    F2(c, d, e, a, b, U(38));
+    F2(b, c, d, e, a, U(39));
+
+    F3(a, b, c, d, e, U(40));
+    F3(e, a, b, c, d, U(41));
+    F3(d, e, a, b, c, U(42));
+    F3(c, d, e, a, b, U(43));
+    F3(b, c, d, e, a, U(44));
+    F3(a, b, c, d, e, U(45));
+    F3(e, a, b, c, d, U(46));
+    F3(d, e, a, b, c, U(47));
+    F3(c, d, e, a, b, U(48));
+    F3(b, c, d, e, a, U(49));
+    F3(a, b, c, d, e, U(50));
+    F3(e, a, b, c, d, U(51));
+    F3(d, e, a, b, c, U(52));
+    F3(c, d, e, a, b, U(53));
+    F3(b, c, d, e, a, U(54));
+    F3(a, b, c, d, e, U(55));
+    F3(e, a, b, c, d, U(56));
+    F3(d, e, a, b, c, U(57));
+    F3(c, d, e, a, b, U(58));
+    F3(b, c, d, e, a, U(59));
+
+    F4(a, b, c, d, e, U(60));
+    F4(e, a, b, c, d, U(61));
+    F4(d, e, a, b, c, U(62));
+    F4(c, d, e, a, b, U(63));
+    F4(b, c, d, e, a, U(64));
+    F4(a, b, c, d, e, U(65));
+    F4(e, a, b, c, d, U(66));
+    F4(d, e, a, b, c, U(67));
+    F4(c, d, e, a, b, U(68));
+    F4(b, c, d, e, a, U(69));
+    F4(a, b, c, d, e, U(70));
+    F4(e, a, b, c, d, U(71));
+    F4(d, e, a, b, c, U(72));
+    F4(c, d, e, a, b, U(73));
+    F4(b, c, d, e, a, U(74));
+    F4(a, b, c, d, e, U(75));
+    F4(e, a, b, c, d, U(76));
+    F4(d, e, a, b, c, U(77));
+    F4(c, d, e, a, b, U(78));
+    F4(b, c, d, e, a, U(79));
+
+    x[0] = H_init[0] + a;
+    x[1] = H_init[1] + b;
+    x[2] = H_init[2] + c;
+    x[3] = H_init[3] + d;
+    x[4] = H_init[4] + e;
+}
+
+#undef U
+#undef F4
+#undef F3
+#undef F2
+#undef F1
+#undef Maj
+#undef Parity
+#undef Ch
+#undef Rot_Left
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Chain
+ *
+ * PURPOSE: Computes the hash chain y = H^n(x) of a 20-byte value x, with H the SHA1 hash of 20 bytes, and optionally
+ *          stores the value of the chain after every interval steps
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * x                   uint32_t*       I       pointer to the 5 words of the value, the 20 bytes read most significant byte
+ *                                             first, i.e. in the form a hash is returned by SHA1
+ * nr_of_steps         uint64_t        I       the number n of times the hash is applied, 0 to copy x to y
+ * interval            uint64_t        I       the number of steps between checkpoints, 0 for no checkpoints
+ * checkpoints         uint32_t*       O       pointer to the array of 5*(nr_of_steps/interval) words where the value
+ *                                             after step k*interval is to be stored at index 5*(k-1), or NULL
+ * y                   uint32_t*       O       pointer to the 5 words where the end of the chain is to be stored, which
+ *                                             may be x
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Chain(const uint32_t *x, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y)
+{
+    uint32_t h[HASH_SIZE];
+    uint64_t step, countdown;
+
+    if (checkpoints == NULL)
+        interval = 0;
+
+    memcpy(h, x, sizeof(h));
+
+    countdown = interval;
+    for (step = 0; step < nr_of_steps; step++)
+    {
+        Chain_Step(h);
+
+        if (--countdown == 0)
+        {
+            memcpy(checkpoints, h, sizeof(h));
+            checkpoints = checkpoints + HASH_SIZE;
+            countdown = interval;
+        }
+    }
+
+    memcpy(y, h, sizeof(h));
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: LANES
+ *
+ **************************************************************************************************************************************/
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Chain_Batch_Kernel
+ *
+ * PURPOSE: Computes the hash chains of a number of independent values, all of the same length, side by side in the lanes
+ *          of the given multi-lane kernel. See SHA1_Chain.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * kernel              struct sha1_kernel*   I       the kernel to use, see SHA1_Kernels
+ * x                   uint32_t*             I       pointer to the array of 5*nr_of_chains words where value i is stored at
+ *                                                   index 5*i
+ * nr_of_chains        uint64_t              I       the number of chains
+ * nr_of_steps         uint64_t              I       the number n of times the hash is applied in each chain
+ * interval            uint64_t              I       the number of steps between checkpoints, 0 for no checkpoints
+ * checkpoints         uint32_t*             O       pointer to the array where checkpoint k of chain i is to be stored at
+ *                                                   index 5*(i*(nr_of_steps/interval) + k - 1), or NULL
+ * y                   uint32_t*             O       pointer to the array where the end of chain i is to be stored at
+ *                                                   index 5*i, which may be x
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Chain_Batch_Kernel(const struct sha1_kernel *kernel, const uint32_t *x, uint64_t nr_of_chains, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y)
+{
+    uint32_t H[HASH_SIZE*SHA1_MAX_LANES];
+    uint32_t W[(BLOCK_SIZE/WORD_SIZE)*SHA1_MAX_LANES];
+    unsigned int nr_of_lanes, n, l, i;
+    uint64_t first, step, countdown, nr_of_checkpoints, checkpoint;
+
+    nr_of_lanes = kernel->nr_of_lanes;
+    if (checkpoints == NULL)
+        interval = 0;
+    nr_of_checkpoints = interval == 0 ? 0 : nr_of_steps/interval;
+
+    /* The template: the words after the hash are the same in every lane and every step */
+
+    memset(W, 0, sizeof(W));
+    for (l = 0; l < nr_of_lanes; l++)
+    {
+        W[HASH_SIZE*nr_of_lanes + l] = PAD_WORD;
+        W[(BLOCK_SIZE/WORD_SIZE - 1)*nr_of_lanes + l] = BIT_SIZE;
+    }
+
+    for (first = 0; first < nr_of_chains; first = first + n)
+    {
+        n = nr_of_chains - first < nr_of_lanes ? (unsigned int) (nr_of_chains - first) : nr_of_lanes;
+
+        memset(H, 0, sizeof(H));
+        for (l = 0; l < n; l++)
+            for (i = 0; i < HASH_SIZE; i++)
+                H[i*nr_of_lanes + l] = x[HASH_SIZE*(first + l) + i];
+
+        /* Each step the hash of every lane becomes the start of its block, and the hash starts anew */
+
+        countdown = interval;
+        checkpoint = 0;
+        for (step = 0; step < nr_of_steps; step++)
+        {
+            for (i = 0; i < HASH_SIZE*nr_of_lanes; i++)
+                W[i] = H[i];
+            for (i = 0; i < HASH_SIZE; i++)
+                for (l = 0; l < nr_of_lanes; l++)
+                    H[i*nr_of_lanes + l] = H_init[i];
+
+            kernel->compress(H, W);
+
+            if (--countdown == 0)
+            {
+                for (l = 0; l < n; l++)
+                    for (i = 0; i < HASH_SIZE; i++)
+                        checkpoints[HASH_SIZE*((first + l)*nr_of_checkpoints + checkpoint) + i] = H[i*nr_of_lanes + l];
+                checkpoint++;
+                countdown = interval;
+            }
+        }
+
+        for (l = 0; l < n; l++)
+            for (i = 0; i < HASH_SIZE; i++)
+                y[HASH_SIZE*(first + l) + i] = H[i*nr_of_lanes + l];
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Chain_Batch
+ *
+ * PURPOSE: Computes the hash chains of a number of independent values with the kernel set for one-block messages,
+ *          by default the default kernel. See SHA1_Chain_Batch_Kernel.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Chain_Batch(const uint32_t *x, uint64_t nr_of_chains, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y)
+{
+    SHA1_Chain_Batch_Kernel(SHA1_Get_Batch_Kernel(SHA_Size_Class(20)), x, nr_of_chains, nr_of_steps, interval, checkpoints, y);
+}
@@ -0,0 +1,19 @@
+/***************************************************************************************************************************************
+ * FILENAME: shachain.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the SHA1 hash chain functions defined in shachain.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHACHAIN__
+#define __SHACHAIN__
+
+void SHA1_Chain(const uint32_t *x, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y);
+
+void SHA1_Chain_Batch_Kernel(const struct sha1_kernel *kernel, const uint32_t *x, uint64_t nr_of_chains, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y);
+
+void SHA1_Chain_Batch(const uint32_t *x, uint64_t nr_of_chains, uint64_t nr_of_steps, uint64_t interval, uint32_t *checkpoints, uint32_t *y);
+
+#endif
@@ -0,0 +1,134 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shacheck.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-22
+ *
+ * CONTENT: The manifest checker shacheck. Verifies the files listed in manifests written by sha1sum or sha256sum through a
+ *          SHA_Verifier, and prints the outcome of every file as sha1sum -c does while the files are being verified. The
+ *          warnings of sha1sum and a summary of the throughput and the slowest files are written to standard error.
+ *
+ *          Usage: shacheck [--jobs N] [--order physical|inode|manifest] [--slowest N] [--quiet] MANIFEST...
+ *
+ *          The exit status is EXIT_SUCCESS if the manifests list at least one file and every file was verified, and
+ *          EXIT_FAILURE otherwise. Malformed lines are reported but, as for sha1sum, do not fail the check.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shaverify.h"
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--jobs N] [--order physical|inode|manifest] [--slowest N] [--quiet] MANIFEST...\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+    SHA_Verifier verifier;
+    SHA_Verifier::Summary summary;
+    SHA_Verifier::Order order = SHA_Verifier::PHYSICAL_ORDER;
+    unsigned int nr_of_threads = 16;
+    unsigned int nr_of_slowest = 10;
+    bool quiet = false;
+    int nr_of_manifests = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            nr_of_threads = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--slowest") == 0 && i + 1 < argc)
+            nr_of_slowest = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "physical") == 0)
+                order = SHA_Verifier::PHYSICAL_ORDER;
+            else if (strcmp(argv[i], "inode") == 0)
+                order = SHA_Verifier::INODE_ORDER;
+            else if (strcmp(argv[i], "manifest") == 0)
+                order = SHA_Verifier::MANIFEST_ORDER;
+            else
+            {
+                Usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argv[i][0] == '-' && argv[i][1] == '-')
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            if (verifier.Load_Manifest(argv[i]) != EXIT_SUCCESS)
+            {
+                fprintf(stderr, "%s: %s: No such file or directory\n", argv[0], argv[i]);
+                return EXIT_FAILURE;
+            }
+            nr_of_manifests++;
+        }
+    }
+
+    if (nr_of_manifests == 0)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    verifier.Verify(order, nr_of_threads, nr_of_slowest, [quiet](const SHA_Verifier::Entry &entry)
+    {
+        if (entry.status == SHA_Verifier::OK && !quiet)
+            printf("%s: OK\n", entry.filename.c_str());
+        else if (entry.status == SHA_Verifier::MISMATCH)
+            printf("%s: FAILED\n", entry.filename.c_str());
+        else if (entry.status == SHA_Verifier::UNREADABLE)
+            printf("%s: FAILED open or read\n", entry.filename.c_str());
+    }, &summary);
+
+    fflush(stdout);
+
+    if (summary.malformed_lines > 0)
+        fprintf(stderr, "%s: WARNING: %llu line%s improperly formatted\n", argv[0],
+                (unsigned long long) summary.malformed_lines, summary.malformed_lines == 1 ? " is" : "s are");
+    if (summary.unreadable > 0)
+        fprintf(stderr, "%s: WARNING: %llu listed file%s could not be read\n", argv[0],
+                (unsigned long long) summary.unreadable, summary.unreadable == 1 ? "" : "s");
+    if (summary.mismatches > 0)
+        fprintf(stderr, "%s: WARNING: %llu computed checksum%s did NOT match\n", argv[0],
+                (unsigned long long) summary.mismatches, summary.mismatches == 1 ? "" : "s");
+
+    fprintf(stderr, "{\"files\": %llu, \"ok\": %llu, \"mismatches\": %llu, \"unreadable\": %llu, \"malformed_lines\": %llu, "
+                    "\"physically_ordered\": %llu, \"bytes\": %llu, \"seconds\": %.3f, \"mb_per_s\": %.1f, \"files_per_s\": %.1f, "
+                    "\"slowest\": [",
+            (unsigned long long) summary.files, (unsigned long long) summary.ok, (unsigned long long) summary.mismatches,
+            (unsigned long long) summary.unreadable, (unsigned long long) summary.malformed_lines,
+            (unsigned long long) summary.physically_ordered, (unsigned long long) summary.bytes, summary.seconds,
+            summary.mb_per_s, summary.files_per_s);
+    for (size_t j = 0; j < summary.slowest.size(); j++)
+    {
+        fprintf(stderr, "%s{\"file\": \"", j == 0 ? "" : ", ");
+        for (const char *c = summary.slowest[j]->filename.c_str(); *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                fprintf(stderr, "\\%c", *c);
+            else if ((unsigned char) *c < 0x20)
+                fprintf(stderr, "\\u%04x", (unsigned char) *c);
+            else
+                fputc(*c, stderr);
+        }
+        fprintf(stderr, "\", \"bytes\": %llu, \"ms\": %.3f}", (unsigned long long) summary.slowest[j]->file_byte_size,
+                1e3*summary.slowest[j]->seconds);
+    }
+    fprintf(stderr, "]}\n");
+
+    return (summary.files > 0 && summary.ok == summary.files) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,314 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaclient.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-15
+ *
+ * CONTENT: Implements the client library of the hashing daemon shad, see shaproto.h for the protocol.
+ *
+ *          A payload can either be hashed in a single call with SHA_Client_SHA1, which copies it into the ring, or be
+ *          written by the caller directly into a slot obtained with SHA_Client_Acquire and SHA_Client_Payload. In the
+ *          latter case several requests can be kept in flight with SHA_Client_Submit and collected with SHA_Client_Wait,
+ *          which lets the daemon place them in the same multi-lane batch.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "sha1.h"
+#include "shaproto.h"
+#include "shaclient.h"
+
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+
+/* The function Send_Hello sends the sha_hello message with the memfd attached and reads the answer of the daemon */
+
+static int Send_Hello(struct sha_client *client, int memfd)
+{
+    struct sha_hello hello;
+    struct sha_reply reply;
+    struct msghdr message;
+    struct iovec iov;
+    struct cmsghdr *control;
+    char control_buffer[CMSG_SPACE(sizeof(int))];
+
+    hello.magic = SHA_PROTO_MAGIC;
+    hello.version = SHA_PROTO_VERSION;
+    hello.nr_of_slots = client->nr_of_slots;
+    hello.slot_byte_size = client->slot_byte_size;
+
+    memset(&message, 0, sizeof(message));
+    memset(control_buffer, 0, sizeof(control_buffer));
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control_buffer;
+    message.msg_controllen = sizeof(control_buffer);
+
+    control = CMSG_FIRSTHDR(&message);
+    control->cmsg_level = SOL_SOCKET;
+    control->cmsg_type = SCM_RIGHTS;
+    control->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(control), &memfd, sizeof(int));
+
+    if (sendmsg(client->socket, &message, MSG_NOSIGNAL) != sizeof(hello))
+        return EXIT_FAILURE;
+
+    if (recv(client->socket, &reply, sizeof(reply), 0) != sizeof(reply) || reply.status != SHA_PROTO_OK)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Client_Open
+ *
+ * PURPOSE: Creates the shared ring and connects to the daemon
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * client              struct sha_client*    O       the client to be opened
+ * socket_path         char*                 I       the path of the socket of the daemon, e.g. SHA_SERVER_DEFAULT_PATH
+ * nr_of_slots         uint32_t              I       the largest number of requests in flight
+ * slot_byte_size      uint32_t              I       the largest payload of a request in bytes, at most
+ *                                                   SHA_PROTO_MAX_SLOT_BYTE_SIZE
+ *
+ * RETURN VALUE: EXIT_SUCCESS or EXIT_FAILURE if the ring could not be created or the daemon could not be reached
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Client_Open(struct sha_client *client, const char *socket_path, uint32_t nr_of_slots, uint32_t slot_byte_size)
+{
+    struct sockaddr_un address;
+    int memfd;
+    uint32_t i;
+
+    memset(client, 0, sizeof(*client));
+    client->socket = -1;
+    client->nr_of_slots = nr_of_slots;
+    client->slot_byte_size = slot_byte_size;
+    client->ring_byte_size = nr_of_slots*SHA_SLOT_STRIDE(slot_byte_size);
+
+    if (nr_of_slots == 0 || slot_byte_size > SHA_PROTO_MAX_SLOT_BYTE_SIZE || strlen(socket_path) >= sizeof(address.sun_path))
+        return EXIT_FAILURE;
+
+    /* The ring is sealed against shrinking, so that the daemon can rely on its mapping */
+
+    memfd = memfd_create("sha_client_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0)
+        return EXIT_FAILURE;
+
+    if (ftruncate(memfd, client->ring_byte_size) != 0 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        close(memfd);
+        return EXIT_FAILURE;
+    }
+
+    client->ring = (unsigned char*) mmap(NULL, client->ring_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (client->ring == MAP_FAILED)
+    {
+        client->ring = NULL;
+        close(memfd);
+        return EXIT_FAILURE;
+    }
+
+    if (nr_of_slots <= SIZE_MAX/sizeof(uint32_t))
+        client->free_slots = (uint32_t*) malloc(nr_of_slots*sizeof(uint32_t));
+    if (client->free_slots == NULL)
+    {
+        munmap(client->ring, client->ring_byte_size);
+        client->ring = NULL;
+        close(memfd);
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < nr_of_slots; i++)
+        client->free_slots[i] = nr_of_slots - 1 - i;
+    client->nr_of_free_slots = nr_of_slots;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    client->socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (client->socket < 0 || connect(client->socket, (struct sockaddr*) &address, sizeof(address)) != 0 ||
+        Send_Hello(client, memfd) != EXIT_SUCCESS)
+    {
+        close(memfd);
+        SHA_Client_Close(client);
+        return EXIT_FAILURE;
+    }
+
+    /* The daemon holds its own reference to the memfd */
+
+    close(memfd);
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_Client_Close disconnects from the daemon and releases the ring */
+
+void SHA_Client_Close(struct sha_client *client)
+{
+    if (client->socket >= 0)
+        close(client->socket);
+    if (client->ring != NULL)
+        munmap(client->ring, client->ring_byte_size);
+    free(client->free_slots);
+
+    client->socket = -1;
+    client->ring = NULL;
+    client->free_slots = NULL;
+    client->nr_of_free_slots = 0;
+}
+
+/* The function SHA_Client_Acquire takes a free slot. It returns EXIT_FAILURE if all slots are in flight */
+
+int SHA_Client_Acquire(struct sha_client *client, uint32_t *slot)
+{
+    if (client->nr_of_free_slots == 0)
+        return EXIT_FAILURE;
+
+    client->nr_of_free_slots--;
+    *slot = client->free_slots[client->nr_of_free_slots];
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_Client_Payload returns the address where the payload of a slot is to be written */
+
+char *SHA_Client_Payload(struct sha_client *client, uint32_t slot)
+{
+    return (char*) &client->ring[slot*SHA_SLOT_STRIDE(client->slot_byte_size) + sizeof(struct sha_slot_header)];
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Client_Submit
+ *
+ * PURPOSE: Asks the daemon to hash the payload written into an acquired slot. The hash is collected with SHA_Client_Wait.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * client              struct sha_client*    I/O     the client
+ * slot                uint32_t              I       the slot obtained with SHA_Client_Acquire
+ * byte_size           uint64_t              I       the size of the payload in bytes, at most slot_byte_size
+ *
+ * RETURN VALUE: EXIT_SUCCESS or EXIT_FAILURE if the request could not be sent
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Client_Submit(struct sha_client *client, uint32_t slot, uint64_t byte_size)
+{
+    struct sha_request request;
+
+    if (slot >= client->nr_of_slots || byte_size > client->slot_byte_size)
+        return EXIT_FAILURE;
+
+    request.slot = slot;
+    request.reserved = 0;
+    request.byte_size = byte_size;
+
+    if (send(client->socket, &request, sizeof(request), MSG_NOSIGNAL) != sizeof(request))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Client_Wait
+ *
+ * PURPOSE: Waits for the next completed request, stores its hash and returns its slot to the free slots
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * client              struct sha_client*    I/O     the client
+ * slot                uint32_t*             O       the slot of the completed request
+ * hash                uint32_t*             O       pointer to the 5-word array where the hash is to be stored
+ *
+ * RETURN VALUE: EXIT_SUCCESS or EXIT_FAILURE if the connection was lost or the daemon rejected the request
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Client_Wait(struct sha_client *client, uint32_t *slot, uint32_t *hash)
+{
+    struct sha_reply reply;
+    struct sha_slot_header *header;
+    ssize_t received;
+
+    do
+        received = recv(client->socket, &reply, sizeof(reply), 0);
+    while (received < 0 && errno == EINTR);
+
+    if (received != sizeof(reply) || reply.slot >= client->nr_of_slots)
+        return EXIT_FAILURE;
+
+    *slot = reply.slot;
+    header = (struct sha_slot_header*) &client->ring[reply.slot*SHA_SLOT_STRIDE(client->slot_byte_size)];
+    memcpy(hash, header->hash, HASH_SIZE*sizeof(uint32_t));
+    client->free_slots[client->nr_of_free_slots++] = reply.slot;
+
+    return reply.status == SHA_PROTO_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Client_SHA1
+ *
+ * PURPOSE: Computes the SHA1 hash of a char array through the daemon. Char arrays larger than a slot are hashed locally.
+ *          No other request of the client may be in flight.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * client              struct sha_client*    I/O     the client
+ * text                char*                 I       pointer to the char array to be hashed
+ * text_byte_size      uint64_t              I       the size of the char array in bytes
+ * hash                uint32_t*             O       pointer to the 5-word array where the hash is to be stored
+ *
+ * RETURN VALUE: EXIT_SUCCESS or EXIT_FAILURE if the daemon could not be reached
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Client_SHA1(struct sha_client *client, char *text, uint64_t text_byte_size, uint32_t *hash)
+{
+    uint32_t slot;
+
+    if (text_byte_size > client->slot_byte_size)
+    {
+        SHA1(text, text_byte_size, hash);
+        return EXIT_SUCCESS;
+    }
+
+    if (SHA_Client_Acquire(client, &slot) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    memcpy(SHA_Client_Payload(client, slot), text, text_byte_size);
+
+    if (SHA_Client_Submit(client, slot, text_byte_size) != EXIT_SUCCESS)
+    {
+        client->free_slots[client->nr_of_free_slots++] = slot;
+        return EXIT_FAILURE;
+    }
+
+    return SHA_Client_Wait(client, &slot, hash);
+}
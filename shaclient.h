@@ -0,0 +1,41 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaclient.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the sha_client and the client functions of the hashing daemon defined in shaclient.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHACLIENT__
+#define __SHACLIENT__
+
+/* A sha_client holds the connection to the daemon and the shared ring. A sha_client must only be used by one thread
+   at a time */
+
+struct sha_client
+{
+    int socket;                               /* the connected Unix socket                                                  */
+    unsigned char *ring;                      /* the mapped ring shared with the daemon                                     */
+    uint64_t ring_byte_size;                  /* the size of the ring in bytes                                              */
+    uint32_t nr_of_slots;                     /* the number of slots in the ring                                            */
+    uint32_t slot_byte_size;                  /* the largest payload of a slot in bytes                                     */
+    uint32_t *free_slots;                     /* stack of the slots not in use                                              */
+    uint32_t nr_of_free_slots;                /* the number of slots on the stack                                           */
+};
+
+int SHA_Client_Open(struct sha_client *client, const char *socket_path, uint32_t nr_of_slots, uint32_t slot_byte_size);
+
+void SHA_Client_Close(struct sha_client *client);
+
+int SHA_Client_Acquire(struct sha_client *client, uint32_t *slot);
+
+char *SHA_Client_Payload(struct sha_client *client, uint32_t slot);
+
+int SHA_Client_Submit(struct sha_client *client, uint32_t slot, uint64_t byte_size);
+
+int SHA_Client_Wait(struct sha_client *client, uint32_t *slot, uint32_t *hash);
+
+int SHA_Client_SHA1(struct sha_client *client, char *text, uint64_t text_byte_size, uint32_t *hash);
+
+#endif
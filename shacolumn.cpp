@@ -0,0 +1,267 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shacolumn.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-26
+ *
+ * CONTENT: Implements the hashing of columns of strings, one SHA1 hash per row. A column is given as in Apache Arrow by
+ *          one buffer holding the strings one after another and an array of nr_of_rows + 1 offsets, 32-bit for the
+ *          binary and utf8 types and 64-bit for the large_binary and large_utf8 types, where row i is found between
+ *          offsets i and i + 1. The hashes are written to an output column of 5 words per row.
+ *
+ *          The rows are hashed through the multi-lane kernels of shabatch.c. A kernel compresses one block in each of
+ *          its lanes at a time, so its lanes are used in full only while they hold strings of the same number of
+ *          blocks. The rows are therefore taken in chunks of SHA1_COLUMN_CHUNK_ROWS and sorted by their number of
+ *          blocks within each chunk before hashing. Rows longer than LONG_BLOCKS blocks are rare in most columns and
+ *          would leave the other lanes of a chunk idle while they finish, so they are collected over the whole range
+ *          of a thread and hashed together at its end, sorted by length.
+ *
+ *          Large columns are split into one contiguous range of rows per thread, balanced by the number of blocks
+ *          rather than of rows, since the lengths of the strings of a column are often skewed.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "shabatch.h"
+#include "shacolumn.h"
+
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define LONG_BLOCKS 64      /* defines the number of blocks above which a row is hashed at the end      */
+#define THREAD_BLOCKS 65536 /* defines the smallest number of blocks worth starting a thread for        */
+
+
+/* The function Nr_Of_Blocks returns the number of blocks SHA1 compresses for a string, including the pad */
+
+static inline uint64_t Nr_Of_Blocks(uint64_t size)
+{
+    return (size + 8)/BLOCK_SIZE + 1;
+}
+
+/* The function Cost estimates the work of the rows before row i from the number of bytes and rows before it. It is
+   nondecreasing in i, so that the ranges of the threads can be found by bisection */
+
+template <class Offset>
+static inline uint64_t Cost(const Offset *offsets, uint64_t i)
+{
+    return (uint64_t) (offsets[i] - offsets[0]) + BLOCK_SIZE*i;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Hash_Rows
+ *
+ * PURPOSE: Hashes the rows first to last - 1 of a column on the calling thread, chunk by chunk with the rows of every
+ *          chunk sorted by their number of blocks, and the long rows of the whole range at the end
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * data                char*                 I       pointer to the buffer of the strings of the column
+ * offsets             Offset*               I       pointer to the offsets of the column
+ * first               uint64_t              I       the first row to be hashed
+ * last                uint64_t              I       the row following the last row to be hashed
+ * hashes              uint32_t*             O       pointer to the output column, where the hash of row i is stored at
+ *                                                   index 5*i
+ * kernel              struct sha1_kernel*   I       the kernel to use
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+template <class Offset>
+static void Hash_Rows(const char *data, const Offset *offsets, uint64_t first, uint64_t last, uint32_t *hashes,
+                      const struct sha1_kernel *kernel)
+{
+    unsigned int counts[LONG_BLOCKS + 2];
+    std::vector<uint64_t> order(SHA1_COLUMN_CHUNK_ROWS);
+    std::vector<char*> texts(SHA1_COLUMN_CHUNK_ROWS);
+    std::vector<uint64_t> texts_byte_size(SHA1_COLUMN_CHUNK_ROWS);
+    std::vector<uint32_t> chunk_hashes(HASH_SIZE*SHA1_COLUMN_CHUNK_ROWS);
+    std::vector<std::pair<uint64_t, uint64_t> > long_rows;
+    uint64_t start, end, row, nr_of_blocks, n, i;
+    unsigned int c;
+
+    for (start = first; start < last; start = end)
+    {
+        end = std::min<uint64_t>(start + SHA1_COLUMN_CHUNK_ROWS, last);
+
+        /* Sort the rows of the chunk by their number of blocks with a counting sort, setting the long rows aside */
+
+        memset(counts, 0, sizeof(counts));
+        for (row = start; row < end; row++)
+        {
+            nr_of_blocks = Nr_Of_Blocks(offsets[row + 1] - offsets[row]);
+            if (nr_of_blocks > LONG_BLOCKS)
+                long_rows.push_back(std::make_pair(nr_of_blocks, row));
+            else
+                counts[nr_of_blocks + 1]++;
+        }
+        for (c = 1; c <= LONG_BLOCKS + 1; c++)
+            counts[c] += counts[c - 1];
+
+        for (row = start; row < end; row++)
+        {
+            nr_of_blocks = Nr_Of_Blocks(offsets[row + 1] - offsets[row]);
+            if (nr_of_blocks <= LONG_BLOCKS)
+                order[counts[nr_of_blocks]++] = row;
+        }
+        n = counts[LONG_BLOCKS];
+
+        /* Hash the sorted rows and scatter their hashes to the output column */
+
+        for (i = 0; i < n; i++)
+        {
+            texts[i] = (char*) &data[offsets[order[i]]];
+            texts_byte_size[i] = offsets[order[i] + 1] - offsets[order[i]];
+        }
+        SHA1_Batch_Kernel(kernel, texts.data(), texts_byte_size.data(), n, chunk_hashes.data());
+        for (i = 0; i < n; i++)
+            memcpy(&hashes[HASH_SIZE*order[i]], &chunk_hashes[HASH_SIZE*i], HASH_SIZE*sizeof(uint32_t));
+    }
+
+    /* Hash the long rows, sorted by their number of blocks so that the lanes finish together */
+
+    std::sort(long_rows.begin(), long_rows.end());
+    for (start = 0; start < long_rows.size(); start = end)
+    {
+        end = std::min<uint64_t>(start + SHA1_COLUMN_CHUNK_ROWS, long_rows.size());
+
+        for (i = start; i < end; i++)
+        {
+            row = long_rows[i].second;
+            texts[i - start] = (char*) &data[offsets[row]];
+            texts_byte_size[i - start] = offsets[row + 1] - offsets[row];
+        }
+        SHA1_Batch_Kernel(kernel, texts.data(), texts_byte_size.data(), end - start, chunk_hashes.data());
+        for (i = start; i < end; i++)
+            memcpy(&hashes[HASH_SIZE*long_rows[i].second], &chunk_hashes[HASH_SIZE*(i - start)], HASH_SIZE*sizeof(uint32_t));
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Hash_Column
+ *
+ * PURPOSE: Checks the offsets of a column and hashes its rows, split into ranges of about the same number of blocks
+ *          over the threads
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if an offset is negative or smaller than the previous one, in which case no hash
+ *                is written
+ *
+ *********************************************************************************************************************************/
+
+template <class Offset>
+static int Hash_Column(const char *data, const Offset *offsets, uint64_t nr_of_rows, uint32_t *hashes,
+                       unsigned int nr_of_threads, const struct sha1_kernel *kernel)
+{
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> bounds;
+    uint64_t total, target, lo, hi, mid, i;
+    unsigned int t;
+
+    if (offsets[0] < 0)
+        return EXIT_FAILURE;
+    for (i = 0; i < nr_of_rows; i++)
+        if (offsets[i + 1] < offsets[i])
+            return EXIT_FAILURE;
+
+    if (kernel == NULL)
+        kernel = SHA1_Default_Kernel();
+    if (nr_of_threads == 0)
+        nr_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    /* Give every thread at least THREAD_BLOCKS blocks of work */
+
+    total = Cost(offsets, nr_of_rows);
+    nr_of_threads = (unsigned int) std::max<uint64_t>(1, std::min<uint64_t>(nr_of_threads, total/(BLOCK_SIZE*THREAD_BLOCKS)));
+
+    if (nr_of_threads == 1)
+    {
+        Hash_Rows(data, offsets, 0, nr_of_rows, hashes, kernel);
+        return EXIT_SUCCESS;
+    }
+
+    /* Find the first row of every thread as the first row whose preceding cost reaches its share */
+
+    bounds.push_back(0);
+    for (t = 1; t < nr_of_threads; t++)
+    {
+        target = total/nr_of_threads*t;
+        lo = bounds.back();
+        hi = nr_of_rows;
+        while (lo < hi)
+        {
+            mid = lo + (hi - lo)/2;
+            if (Cost(offsets, mid) < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds.push_back(lo);
+    }
+    bounds.push_back(nr_of_rows);
+
+    for (t = 1; t < nr_of_threads; t++)
+        threads.push_back(std::thread(Hash_Rows<Offset>, data, offsets, bounds[t], bounds[t + 1], hashes, kernel));
+    Hash_Rows(data, offsets, bounds[0], bounds[1], hashes, kernel);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Column32
+ *
+ * PURPOSE: Computes the SHA1 hash of every row of a column of strings with 32-bit offsets
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * data                char*                 I       pointer to the buffer of the strings of the column
+ * offsets             int32_t*              I       pointer to the nr_of_rows + 1 offsets of the column, where row i is
+ *                                                   found from data + offsets[i] to data + offsets[i + 1]
+ * nr_of_rows          uint64_t              I       the number of rows
+ * hashes              uint32_t*             O       pointer to the output column, where the 5-word hash of row i is
+ *                                                   stored at index 5*i
+ * nr_of_threads       unsigned int          I       the largest number of threads to use, 0 for one per processor
+ * kernel              struct sha1_kernel*   I       the kernel to use, NULL for the default kernel of SHA1_Batch
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the offsets are not a nondecreasing sequence starting at 0 or above
+ *
+ *********************************************************************************************************************************/
+
+int SHA1_Column32(const char *data, const int32_t *offsets, uint64_t nr_of_rows, uint32_t *hashes,
+                  unsigned int nr_of_threads, const struct sha1_kernel *kernel)
+{
+    return Hash_Column(data, offsets, nr_of_rows, hashes, nr_of_threads, kernel);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Column64
+ *
+ * PURPOSE: Computes the SHA1 hash of every row of a column of strings with 64-bit offsets. See SHA1_Column32.
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the offsets are not a nondecreasing sequence starting at 0 or above
+ *
+ *********************************************************************************************************************************/
+
+int SHA1_Column64(const char *data, const int64_t *offsets, uint64_t nr_of_rows, uint32_t *hashes,
+                  unsigned int nr_of_threads, const struct sha1_kernel *kernel)
+{
+    return Hash_Column(data, offsets, nr_of_rows, hashes, nr_of_threads, kernel);
+}
@@ -0,0 +1,22 @@
+/***************************************************************************************************************************************
+ * FILENAME: shacolumn.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the functions hashing every row of a column of strings stored in the columnar format of Apache Arrow,
+ *          defined in shacolumn.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHACOLUMN__
+#define __SHACOLUMN__
+
+#define SHA1_COLUMN_CHUNK_ROWS 4096           /* the number of rows sorted by length and hashed together                    */
+
+int SHA1_Column32(const char *data, const int32_t *offsets, uint64_t nr_of_rows, uint32_t *hashes,
+                  unsigned int nr_of_threads, const struct sha1_kernel *kernel);
+
+int SHA1_Column64(const char *data, const int64_t *offsets, uint64_t nr_of_rows, uint32_t *hashes,
+                  unsigned int nr_of_threads, const struct sha1_kernel *kernel);
+
+#endif
@@ -0,0 +1,359 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaconst.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Header-only constexpr implementation of SHA1 and SHA256/SHA224, for digests and HMAC key midstates that are
+ *          known at compile time. The compression functions follow SHA1_Compress and SHA256_Compress of shalib.c and
+ *          the padding follows Set_64Byte_Pad, so the results are identical to those of SHA1() and SHA256(): the hash
+ *          is returned as an array of 32-bit words in the same order.
+ *
+ *              constexpr auto digest = sha::ct::sha1("protocol-guid");
+ *              constexpr auto midstate = sha::ct::hmac_sha1_midstate("constant key");
+ *              sha::HMAC<sha::Hasher<sha::Sha1>> hmac(midstate.inner.data(), midstate.outer.data());
+ *
+ *          The functions of sha::ct are constexpr and may also be called at run time, while those of sha::ce are
+ *          consteval (C++20) and are guaranteed never to cost anything at run time.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHACONST__
+#define __SHACONST__
+
+#include <stdint.h>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace sha {
+namespace ct {
+
+constexpr size_t block_size = 64;   /* the size of a block in bytes                                             */
+
+typedef std::array<uint8_t, block_size> block_type;
+
+constexpr uint32_t Rot_Left(unsigned int t, uint32_t x) { return (x << t) | (x >> (32 - t)); }
+
+constexpr uint32_t Rot_Right(unsigned int t, uint32_t x) { return (x >> t) | (x << (32 - t)); }
+
+constexpr uint32_t Load_Word(const block_type &block, size_t i)
+{
+    return (uint32_t) block[4*i] << 24 | (uint32_t) block[4*i + 1] << 16 | (uint32_t) block[4*i + 2] << 8 | block[4*i + 3];
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: COMPRESSION FUNCTIONS
+ *
+ **************************************************************************************************************************************/
+
+struct Sha1_Compression
+{
+    static constexpr size_t state_words = 5;
+    typedef std::array<uint32_t, 5> state_type;
+
+    static constexpr state_type init = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+    static constexpr void compress(state_type &H, const block_type &block)
+    {
+        uint32_t W[80] = {};
+        uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = 0, k = 0, T = 0;
+
+        for (size_t t = 0; t < 16; t++)
+            W[t] = Load_Word(block, t);
+        for (size_t t = 16; t < 80; t++)
+            W[t] = Rot_Left(1, W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
+
+        for (size_t t = 0; t < 80; t++)
+        {
+            if (t < 20)
+            {
+                f = (b & c) ^ (~b & d);
+                k = 0x5a827999;
+            }
+            else if (t < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if (t < 60)
+            {
+                f = (b & c) ^ (b & d) ^ (c & d);
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+
+            T = Rot_Left(5, a) + f + e + k + W[t];
+            e = d;
+            d = c;
+            c = Rot_Left(30, b);
+            b = a;
+            a = T;
+        }
+
+        H[0] += a;
+        H[1] += b;
+        H[2] += c;
+        H[3] += d;
+        H[4] += e;
+    }
+};
+
+struct Sha256_Compression
+{
+    static constexpr size_t state_words = 8;
+    typedef std::array<uint32_t, 8> state_type;
+
+    static constexpr state_type init = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    static constexpr uint32_t K[64] =
+    {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+    };
+
+    static constexpr void compress(state_type &H, const block_type &block)
+    {
+        uint32_t W[64] = {};
+        uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7], T1 = 0, T2 = 0;
+
+        for (size_t i = 0; i < 16; i++)
+            W[i] = Load_Word(block, i);
+        for (size_t i = 16; i < 64; i++)
+            W[i] = (Rot_Right(17, W[i-2]) ^ Rot_Right(19, W[i-2]) ^ (W[i-2] >> 10)) + W[i-7] +
+                   (Rot_Right(7, W[i-15]) ^ Rot_Right(18, W[i-15]) ^ (W[i-15] >> 3)) + W[i-16];
+
+        for (size_t i = 0; i < 64; i++)
+        {
+            T1 = h + (Rot_Right(6, e) ^ Rot_Right(11, e) ^ Rot_Right(25, e)) + ((e & f) ^ (~e & g)) + K[i] + W[i];
+            T2 = (Rot_Right(2, a) ^ Rot_Right(13, a) ^ Rot_Right(22, a)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + T1;
+            d = c;
+            c = b;
+            b = a;
+            a = T1 + T2;
+        }
+
+        H[0] += a;
+        H[1] += b;
+        H[2] += c;
+        H[3] += d;
+        H[4] += e;
+        H[5] += f;
+        H[6] += g;
+        H[7] += h;
+    }
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HASHING AND PADDING
+ *
+ **************************************************************************************************************************************/
+
+/* The function Hash_Resume iterates the hash H over text followed by the pad. H is either the initial hash or the
+   midstate after prefix_byte_size bytes, which must be a whole number of blocks and are counted in the pad */
+
+template <class C>
+constexpr typename C::state_type Hash_Resume(typename C::state_type H, uint64_t prefix_byte_size, std::string_view text)
+{
+    block_type block = {};
+    uint64_t text_byte_size = prefix_byte_size + text.size();
+    size_t position = 0, i = 0;
+
+    for (; position + block_size <= text.size(); position += block_size)
+    {
+        for (i = 0; i < block_size; i++)
+            block[i] = (uint8_t) text[position + i];
+        C::compress(H, block);
+    }
+
+    /* The last bytes of the text followed by the pad: 0x80, zeros and the size in bits in the last 8 bytes */
+
+    block = {};
+    for (i = 0; position + i < text.size(); i++)
+        block[i] = (uint8_t) text[position + i];
+    block[i] = 0x80;
+
+    if (i >= block_size - 8)
+    {
+        C::compress(H, block);
+        block = {};
+    }
+
+    for (i = 0; i < 8; i++)
+        block[block_size - 1 - i] = (uint8_t) ((text_byte_size*8) >> 8*i);
+    C::compress(H, block);
+
+    return H;
+}
+
+constexpr std::array<uint32_t, 5> sha1(std::string_view text)
+{
+    return Hash_Resume<Sha1_Compression>(Sha1_Compression::init, 0, text);
+}
+
+constexpr std::array<uint32_t, 8> sha256(std::string_view text)
+{
+    return Hash_Resume<Sha256_Compression>(Sha256_Compression::init, 0, text);
+}
+
+constexpr std::array<uint32_t, 7> sha224(std::string_view text)
+{
+    std::array<uint32_t, 8> H = Hash_Resume<Sha256_Compression>({0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+                                                                 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4}, 0, text);
+    std::array<uint32_t, 7> hash = {};
+
+    for (size_t i = 0; i < 7; i++)
+        hash[i] = H[i];
+    return hash;
+}
+
+/* The function to_bytes converts a hash to the bytes of the digest, in the order of the standard */
+
+template <size_t N>
+constexpr std::array<uint8_t, 4*N> to_bytes(const std::array<uint32_t, N> &hash)
+{
+    std::array<uint8_t, 4*N> digest = {};
+
+    for (size_t i = 0; i < 4*N; i++)
+        digest[i] = (uint8_t) (hash[i/4] >> 8*(3 - i % 4));
+    return digest;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HMAC
+ *
+ **************************************************************************************************************************************/
+
+/* The midstates of an HMAC key are the hashes of the key block XOR ipad (inner) and XOR opad (outer) */
+
+template <size_t N>
+struct hmac_midstate
+{
+    std::array<uint32_t, N> inner;
+    std::array<uint32_t, N> outer;
+};
+
+/* The function Key_Block returns the key padded with zeros to a block, hashing it first if it is longer than a block */
+
+template <class C, size_t N>
+constexpr block_type Key_Block(std::string_view key, const std::array<uint32_t, N> &hashed_key)
+{
+    block_type block = {};
+
+    if (key.size() > block_size)
+    {
+        for (size_t i = 0; i < 4*N; i++)
+            block[i] = (uint8_t) (hashed_key[i/4] >> 8*(3 - i % 4));
+    }
+    else
+    {
+        for (size_t i = 0; i < key.size(); i++)
+            block[i] = (uint8_t) key[i];
+    }
+    return block;
+}
+
+template <class C>
+constexpr hmac_midstate<C::state_words> Midstate(block_type key_block, typename C::state_type init)
+{
+    hmac_midstate<C::state_words> midstate = {init, init};
+    block_type pad = {};
+
+    for (size_t i = 0; i < block_size; i++)
+        pad[i] = key_block[i] ^ 0x36;
+    C::compress(midstate.inner, pad);
+
+    for (size_t i = 0; i < block_size; i++)
+        pad[i] = key_block[i] ^ 0x5c;
+    C::compress(midstate.outer, pad);
+
+    return midstate;
+}
+
+constexpr hmac_midstate<5> hmac_sha1_midstate(std::string_view key)
+{
+    return Midstate<Sha1_Compression>(Key_Block<Sha1_Compression>(key, key.size() > block_size ? sha1(key) : std::array<uint32_t, 5>{}),
+                                      Sha1_Compression::init);
+}
+
+constexpr hmac_midstate<8> hmac_sha256_midstate(std::string_view key)
+{
+    return Midstate<Sha256_Compression>(Key_Block<Sha256_Compression>(key, key.size() > block_size ? sha256(key) : std::array<uint32_t, 8>{}),
+                                        Sha256_Compression::init);
+}
+
+/* The function Finish_HMAC completes an HMAC from the midstates of the key: the inner hash resumes over the text,
+   and the outer hash over the digest of the inner hash */
+
+template <class C>
+constexpr typename C::state_type Finish_HMAC(const hmac_midstate<C::state_words> &midstate, std::string_view text)
+{
+    typename C::state_type inner = Hash_Resume<C>(midstate.inner, block_size, text);
+    char inner_digest[4*C::state_words] = {};
+
+    for (size_t i = 0; i < 4*C::state_words; i++)
+        inner_digest[i] = (char) (inner[i/4] >> 8*(3 - i % 4));
+
+    return Hash_Resume<C>(midstate.outer, block_size, std::string_view(inner_digest, 4*C::state_words));
+}
+
+constexpr std::array<uint32_t, 5> hmac_sha1(std::string_view key, std::string_view text)
+{
+    return Finish_HMAC<Sha1_Compression>(hmac_sha1_midstate(key), text);
+}
+
+constexpr std::array<uint32_t, 8> hmac_sha256(std::string_view key, std::string_view text)
+{
+    return Finish_HMAC<Sha256_Compression>(hmac_sha256_midstate(key), text);
+}
+
+}
+
+/* The consteval versions, which the compiler must evaluate at compile time */
+
+#if defined(__cpp_consteval)
+
+namespace ce {
+
+consteval std::array<uint32_t, 5> sha1(std::string_view text) { return ct::sha1(text); }
+
+consteval std::array<uint32_t, 8> sha256(std::string_view text) { return ct::sha256(text); }
+
+consteval std::array<uint32_t, 7> sha224(std::string_view text) { return ct::sha224(text); }
+
+consteval ct::hmac_midstate<5> hmac_sha1_midstate(std::string_view key) { return ct::hmac_sha1_midstate(key); }
+
+consteval ct::hmac_midstate<8> hmac_sha256_midstate(std::string_view key) { return ct::hmac_sha256_midstate(key); }
+
+consteval std::array<uint32_t, 5> hmac_sha1(std::string_view key, std::string_view text) { return ct::hmac_sha1(key, text); }
+
+consteval std::array<uint32_t, 8> hmac_sha256(std::string_view key, std::string_view text) { return ct::hmac_sha256(key, text); }
+
+}
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shad.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-15
+ *
+ * CONTENT: The hashing daemon shad. Serves SHA1 requests of local clients through a SHA1_Server until it receives SIGINT or
+ *          SIGTERM, and then writes the statistics of its queue to standard error.
+ *
+ *          Usage: shad [--socket PATH] [--deadline-us MICROSECONDS] [--kernel NAME]
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "shaproto.h"
+#include "shaserver.h"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void Request_Stop(int signal_number)
+{
+    (void) signal_number;
+    stop_requested = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socket_path = SHA_SERVER_DEFAULT_PATH;
+    const struct sha1_kernel *kernel = NULL;
+    unsigned int deadline_us = 100;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (strcmp(argv[i], "--deadline-us") == 0 && i + 1 < argc)
+            deadline_us = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc)
+        {
+            kernel = SHA1_Find_Kernel(argv[++i]);
+            if (kernel == NULL)
+            {
+                fprintf(stderr, "Kernel %s is not available\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--socket PATH] [--deadline-us MICROSECONDS] [--kernel NAME]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    signal(SIGINT, Request_Stop);
+    signal(SIGTERM, Request_Stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    SHA1_Server server(socket_path, deadline_us, kernel);
+    if (server.Start() != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Could not listen on %s\n", socket_path);
+        return EXIT_FAILURE;
+    }
+
+    while (!stop_requested)
+        pause();
+
+    server.Stop();
+
+    SHA1_Queue::Stats stats = server.Get_Stats();
+    fprintf(stderr, "{\"jobs\": %llu, \"batches\": %llu, \"full_batches\": %llu, \"deadline_flushes\": %llu, "
+                    "\"mean_lane_fill\": %.3f, \"max_queue_depth\": %llu, \"mean_queue_depth\": %.1f, "
+                    "\"mean_latency_us\": %.1f, \"max_latency_us\": %.1f, \"p99_latency_us\": %.1f}\n",
+            (unsigned long long) stats.jobs, (unsigned long long) stats.batches, (unsigned long long) stats.full_batches,
+            (unsigned long long) stats.deadline_flushes, stats.mean_lane_fill, (unsigned long long) stats.max_queue_depth,
+            stats.mean_queue_depth, stats.mean_latency_us, stats.max_latency_us, stats.p99_latency_us);
+
+    return EXIT_SUCCESS;
+}
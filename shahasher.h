@@ -0,0 +1,457 @@
+/***************************************************************************************************************************************
+ * FILENAME: shahasher.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Header-only C++17/C++20 front end of the library. The algorithm and the kernel are template parameters,
+ *
+ *              sha::Hasher<sha::Sha1>                      SHA1 with the kernel chosen by the library
+ *              sha::Hasher<sha::Sha256, sha::Portable>     SHA256 always with the portable kernel
+ *              sha::HMAC<sha::Hasher<sha::Sha256>>         HMAC-SHA256
+ *
+ *          so that every algorithm/kernel pair compiles into its own monomorphic path in which whole blocks are passed
+ *          directly to the block functions of shalib.c. Unlike HMAC32 and HMAC64, which call the hash through function
+ *          pointers, HMAC<H> contains no indirect calls, and it keeps the inner and outer hash of the key so that the key
+ *          is hashed only once however many messages are authenticated with it.
+ *
+ *          Data is passed as std::span<const std::byte> when compiled as C++20, or as a pointer and a size, and the
+ *          digest is returned as a std::array of bytes in the order of the standard (big-endian words).
+ *
+ *          For messages of a length known at compile time, sha::sha1_fixed<N> builds the padded blocks directly.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAHASHER__
+#define __SHAHASHER__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include "shalib.h"
+
+namespace sha {
+
+/* Kernels. Auto lets the library choose at run time, the others are fixed at compile time. ShaNi must only be used
+   after SHA256_Get_Kernel() has returned SHA_KERNEL_SHANI */
+
+struct Auto {};
+struct Portable {};
+struct ShaNi {};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: ALGORITHMS
+ *
+ *  An algorithm defines its word type, block and digest sizes, initial hash and a static function blocks<Kernel>
+ *  hashing whole blocks. Algorithms sharing a compression function differ only in the initial hash and digest size.
+ *
+ **************************************************************************************************************************************/
+
+struct Sha1
+{
+    typedef uint32_t word_type;
+    static constexpr size_t block_size = 64;
+    static constexpr size_t length_size = 8;
+    static constexpr size_t state_words = 5;
+    static constexpr size_t digest_size = 20;
+    static constexpr word_type init[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+    template <class Kernel> static void blocks(const unsigned char *data, uint64_t nr_of_blocks, word_type *H)
+    {
+        static_assert(std::is_same<Kernel, Auto>::value || std::is_same<Kernel, Portable>::value,
+                      "SHA1 has no SHA-NI kernel");
+        SHA1_Hash_Blocks((unsigned char*) data, nr_of_blocks, H);
+    }
+};
+
+struct Sha256_Compression
+{
+    typedef uint32_t word_type;
+    static constexpr size_t block_size = 64;
+    static constexpr size_t length_size = 8;
+    static constexpr size_t state_words = 8;
+
+    template <class Kernel> static void blocks(const unsigned char *data, uint64_t nr_of_blocks, word_type *H)
+    {
+        if constexpr (std::is_same<Kernel, Portable>::value)
+            SHA256_Hash_Blocks_Portable((unsigned char*) data, nr_of_blocks, H);
+        else if constexpr (std::is_same<Kernel, ShaNi>::value)
+            SHA256_Hash_Blocks_SHANI((unsigned char*) data, nr_of_blocks, H);
+        else
+            SHA256_Hash_Blocks((unsigned char*) data, nr_of_blocks, H);
+    }
+};
+
+struct Sha256 : Sha256_Compression
+{
+    static constexpr size_t digest_size = 32;
+    static constexpr word_type init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+};
+
+struct Sha224 : Sha256_Compression
+{
+    static constexpr size_t digest_size = 28;
+    static constexpr word_type init[8] = {0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+                                          0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4};
+};
+
+struct Sha512_Compression
+{
+    typedef uint64_t word_type;
+    static constexpr size_t block_size = 128;
+    static constexpr size_t length_size = 16;
+    static constexpr size_t state_words = 8;
+
+    template <class Kernel> static void blocks(const unsigned char *data, uint64_t nr_of_blocks, word_type *H)
+    {
+        static_assert(std::is_same<Kernel, Auto>::value || std::is_same<Kernel, Portable>::value,
+                      "SHA512 has no SHA-NI kernel");
+        SHA512_Hash_Blocks((unsigned char*) data, nr_of_blocks, H);
+    }
+};
+
+struct Sha512 : Sha512_Compression
+{
+    static constexpr size_t digest_size = 64;
+    static constexpr word_type init[8] = {0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+                                          0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+};
+
+struct Sha384 : Sha512_Compression
+{
+    static constexpr size_t digest_size = 48;
+    static constexpr word_type init[8] = {0xcbbb9d5dc1059ed8, 0x629a292a367cd507, 0x9159015a3070dd17, 0x152fecd8f70e5939,
+                                          0x67332667ffc00b31, 0x8eb44a8768581511, 0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4};
+};
+
+struct Sha512_256 : Sha512_Compression
+{
+    static constexpr size_t digest_size = 32;
+    static constexpr word_type init[8] = {0x22312194fc2bf72c, 0x9f555fa3c84c64c2, 0x2393b86b6f53b151, 0x963877195940eabd,
+                                          0x96283ee2a88effe3, 0xbe5e1e2553863992, 0x2b0199fc2c85b8aa, 0x0eb72ddc81c52ca2};
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HASHER
+ *
+ **************************************************************************************************************************************/
+
+template <class Algorithm, class Kernel = Auto>
+class Hasher
+{
+public:
+
+    typedef Algorithm algorithm_type;
+    typedef Kernel kernel_type;
+    typedef typename Algorithm::word_type word_type;
+    typedef std::array<uint8_t, Algorithm::digest_size> digest_type;
+
+    static constexpr size_t block_size = Algorithm::block_size;
+    static constexpr size_t digest_size = Algorithm::digest_size;
+
+    Hasher() { reset(); }
+
+    /* Resumes from a midstate: the hash H after byte_count bytes, which must be a whole number of blocks. Midstates of
+       constant prefixes can be computed at compile time with shaconst.h */
+
+    Hasher(const word_type *state, uint64_t byte_count)
+    {
+        for (size_t i = 0; i < Algorithm::state_words; i++)
+            H[i] = state[i];
+        buffered = 0;
+        total = byte_count;
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < Algorithm::state_words; i++)
+            H[i] = Algorithm::init[i];
+        buffered = 0;
+        total = 0;
+    }
+
+    /* Appends size bytes at data to the message. Whole blocks are hashed directly from data, only the bytes of an
+       incomplete block are copied to the buffer */
+
+    Hasher &update(const void *data, size_t size)
+    {
+        const unsigned char *bytes = (const unsigned char*) data;
+        size_t n;
+
+        total += size;
+
+        if (buffered > 0)
+        {
+            n = size < block_size - buffered ? size : block_size - buffered;
+            memcpy(&buffer[buffered], bytes, n);
+            buffered += n;
+            bytes += n;
+            size -= n;
+            if (buffered < block_size)
+                return *this;
+            Algorithm::template blocks<Kernel>(buffer, 1, H);
+            buffered = 0;
+        }
+
+        if (size >= block_size)
+        {
+            Algorithm::template blocks<Kernel>(bytes, size/block_size, H);
+            bytes += size - size % block_size;
+            size = size % block_size;
+        }
+
+        memcpy(buffer, bytes, size);
+        buffered = size;
+        return *this;
+    }
+
+    Hasher &update(std::string_view text) { return update(text.data(), text.size()); }
+
+#if __cplusplus >= 202002L
+    Hasher &update(std::span<const std::byte> data) { return update(data.data(), data.size()); }
+#endif
+
+    /* Appends the pad, stores the digest and resets the hasher for a new message */
+
+    void final(uint8_t *digest)
+    {
+        uint64_t bit_size = total*8;
+        size_t i;
+
+        buffer[buffered++] = 0x80;
+        if (buffered > block_size - Algorithm::length_size)
+        {
+            memset(&buffer[buffered], 0, block_size - buffered);
+            Algorithm::template blocks<Kernel>(buffer, 1, H);
+            buffered = 0;
+        }
+        memset(&buffer[buffered], 0, block_size - 8 - buffered);
+        for (i = 0; i < 8; i++)
+            buffer[block_size - 1 - i] = (unsigned char) (bit_size >> 8*i);
+        Algorithm::template blocks<Kernel>(buffer, 1, H);
+
+        for (i = 0; i < digest_size; i++)
+            digest[i] = (uint8_t) (H[i/sizeof(word_type)] >> 8*(sizeof(word_type) - 1 - i % sizeof(word_type)));
+
+        reset();
+    }
+
+    digest_type final()
+    {
+        digest_type digest;
+        final(digest.data());
+        return digest;
+    }
+
+    /* Computes the digest of a single message */
+
+    static digest_type hash(const void *data, size_t size)
+    {
+        Hasher hasher;
+        return hasher.update(data, size).final();
+    }
+
+    static digest_type hash(std::string_view text) { return hash(text.data(), text.size()); }
+
+#if __cplusplus >= 202002L
+    static digest_type hash(std::span<const std::byte> data) { return hash(data.data(), data.size()); }
+#endif
+
+private:
+
+    word_type H[Algorithm::state_words];
+    unsigned char buffer[Algorithm::block_size];
+    size_t buffered;
+    uint64_t total;
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: FIXED-LENGTH MESSAGES
+ *
+ *  sha1_fixed<N>(text) computes the SHA1 hash of a message whose length N of at most SHA1_SHORT_MAX_SIZE bytes is known
+ *  at compile time, e.g. the 60 bytes of key and GUID of a WebSocket handshake or a 20-byte digest. Each word of the
+ *  padded block is resolved at compile time to a load from the text, the word holding the delimiter, zero or the
+ *  length, so that one or two calls of SHA1_Compress remain. The hash is returned as words, as by SHA1.
+ *
+ **************************************************************************************************************************************/
+
+template <size_t N, size_t I>
+inline uint32_t Fixed_Word(const unsigned char *text)
+{
+    constexpr size_t nr_of_blocks = N + 9 > 64 ? 2 : 1;
+    constexpr size_t position = 4*I;
+
+    if constexpr (I == 16*nr_of_blocks - 1)
+        return (uint32_t) (8*N);
+    else if constexpr (position + 4 <= N)
+        return (uint32_t) text[position] << 24 | (uint32_t) text[position + 1] << 16 |
+               (uint32_t) text[position + 2] << 8 | text[position + 3];
+    else if constexpr (position > N)
+        return 0;
+    else
+    {
+        uint32_t word = 0;
+        for (size_t j = 0; j < 4; j++)
+            word = (word << 8) | (position + j < N ? text[position + j] : position + j == N ? 0x80 : 0);
+        return word;
+    }
+}
+
+template <size_t N, size_t B, size_t... I>
+inline void Fixed_Block(const unsigned char *text, uint32_t *W, std::index_sequence<I...>)
+{
+    ((W[I] = Fixed_Word<N, 16*B + I>(text)), ...);
+}
+
+template <size_t N>
+inline std::array<uint32_t, 5> sha1_fixed(const void *text)
+{
+    static_assert(N <= SHA1_SHORT_MAX_SIZE, "sha1_fixed is limited to messages of two blocks less the pad");
+
+    const unsigned char *p = static_cast<const unsigned char*>(text);
+    std::array<uint32_t, 5> H = {Sha1::init[0], Sha1::init[1], Sha1::init[2], Sha1::init[3], Sha1::init[4]};
+    uint32_t W[80];
+
+    Fixed_Block<N, 0>(p, W, std::make_index_sequence<16>());
+    SHA1_Compress(H.data(), W);
+
+    if constexpr (N + 9 > 64)
+    {
+        Fixed_Block<N, 1>(p, W, std::make_index_sequence<16>());
+        SHA1_Compress(H.data(), W);
+    }
+
+    return H;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HMAC
+ *
+ **************************************************************************************************************************************/
+
+/* HMAC<H> computes the HMAC of FIPS PUB 198-1 with the hasher H. The key is processed once by the constructor, which
+   stores the inner and outer hashers after the key block; every message then starts from copies of them */
+
+template <class H>
+class HMAC
+{
+public:
+
+    typedef typename H::digest_type digest_type;
+
+    static constexpr size_t block_size = H::block_size;
+    static constexpr size_t digest_size = H::digest_size;
+
+    HMAC(const void *key, size_t key_size)
+    {
+        unsigned char pad[block_size];
+        digest_type hashed_key;
+        size_t i;
+
+        memset(pad, 0, block_size);
+        if (key_size > block_size)
+        {
+            hashed_key = H::hash(key, key_size);
+            memcpy(pad, hashed_key.data(), digest_size);
+        }
+        else
+            memcpy(pad, key, key_size);
+
+        for (i = 0; i < block_size; i++)
+            pad[i] ^= 0x36;
+        inner_key.update(pad, block_size);
+
+        for (i = 0; i < block_size; i++)
+            pad[i] ^= 0x36 ^ 0x5c;
+        outer_key.update(pad, block_size);
+
+        inner = inner_key;
+    }
+
+    explicit HMAC(std::string_view key) : HMAC(key.data(), key.size()) {}
+
+    /* Starts from the inner and outer midstates of a key, i.e. the hashes of the key block XOR ipad and XOR opad, for
+       example computed at compile time with sha::ct::hmac_sha1_midstate of shaconst.h */
+
+    HMAC(const typename H::word_type *inner_state, const typename H::word_type *outer_state)
+        : inner_key(inner_state, block_size), outer_key(outer_state, block_size), inner(inner_key) {}
+
+#if __cplusplus >= 202002L
+    explicit HMAC(std::span<const std::byte> key) : HMAC(key.data(), key.size()) {}
+#endif
+
+    HMAC &update(const void *data, size_t size)
+    {
+        inner.update(data, size);
+        return *this;
+    }
+
+    HMAC &update(std::string_view text) { return update(text.data(), text.size()); }
+
+#if __cplusplus >= 202002L
+    HMAC &update(std::span<const std::byte> data) { return update(data.data(), data.size()); }
+#endif
+
+    /* Stores the HMAC of the message and restarts from the key for a new message */
+
+    void final(uint8_t *digest)
+    {
+        H outer = outer_key;
+        uint8_t inner_digest[digest_size];
+
+        inner.final(inner_digest);
+        outer.update(inner_digest, digest_size);
+        outer.final(digest);
+
+        inner = inner_key;
+    }
+
+    digest_type final()
+    {
+        digest_type digest;
+        final(digest.data());
+        return digest;
+    }
+
+    /* Computes the HMAC of a single message */
+
+    static digest_type mac(const void *key, size_t key_size, const void *data, size_t size)
+    {
+        HMAC hmac(key, key_size);
+        return hmac.update(data, size).final();
+    }
+
+    static digest_type mac(std::string_view key, std::string_view text)
+    {
+        return mac(key.data(), key.size(), text.data(), text.size());
+    }
+
+private:
+
+    H inner_key;
+    H outer_key;
+    H inner;
+};
+
+}
+
+#endif
@@ -0,0 +1,509 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shahex.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-19
+ *
+ * CONTENT: Implements the conversion of hashes, held as the 32-bit words computed by the hash functions, to and from
+ *          hexadecimal text. The most significant byte of each word is written first, so the byte order conversion
+ *          done by Conv_32Int_To_Word is part of the encoding and no intermediate byte array is needed.
+ *
+ *          Besides the scalar kernel there are SSSE3 and AVX2 kernels, which convert 4 and 8 words at a time: the
+ *          bytes are reordered and the nibbles looked up with the byte shuffle instruction. On x86 processors the
+ *          instruction set of each kernel is selected with a target attribute and its availability is checked at
+ *          run time, as in shabatch.c.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "shahex.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA_X86
+#include <immintrin.h>
+#endif
+
+#define WORD_HEX_SIZE 8     /* defines the number of hexadecimal digits of a 32-bit word                */
+
+static const char lowercase_digits[] = "0123456789abcdef";
+static const char uppercase_digits[] = "0123456789ABCDEF";
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SCALAR KERNEL
+ *
+ **************************************************************************************************************************************/
+
+static void Hex_Encode_Scalar(const uint32_t *words, uint64_t nr_of_words, char *hex, const char *digits)
+{
+    uint64_t i;
+    unsigned int j;
+
+    for (i = 0; i < nr_of_words; i++)
+        for (j = 0; j < WORD_HEX_SIZE; j++)
+            hex[WORD_HEX_SIZE*i + j] = digits[(words[i] >> (28 - 4*j)) & 0x0f];
+}
+
+/* The function Hex_Value returns the value of a hexadecimal digit of either case, or -1 for any other character */
+
+static int Hex_Value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static int Hex_Decode_Scalar(const char *hex, uint64_t nr_of_words, uint32_t *words)
+{
+    uint64_t i;
+    unsigned int j;
+    uint32_t word;
+    int value, invalid;
+
+    invalid = 0;
+    for (i = 0; i < nr_of_words; i++)
+    {
+        word = 0;
+        for (j = 0; j < WORD_HEX_SIZE; j++)
+        {
+            value = Hex_Value(hex[WORD_HEX_SIZE*i + j]);
+            invalid |= value;
+            word = (word << 4) | (uint32_t) (value & 0x0f);
+        }
+        words[i] = word;
+    }
+
+    return invalid < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: VECTOR KERNELS
+ *
+ *  The vector kernels convert whole groups of 4 or 8 words. A remainder of at least one group is handled by
+ *  converting the last group again, overlapping the previous one, so that e.g. the 5 words of a SHA1 hash take two
+ *  SSSE3 steps. Shorter input is left to the scalar kernel.
+ *
+ **************************************************************************************************************************************/
+
+#ifdef SHA_X86
+
+/* The byte shuffle mask reversing the bytes of each 32-bit word */
+
+#define BSWAP32_MASK 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL
+
+/* Converts the bytes of x into pairs of hexadecimal digits, high nibble first. The byte order of each word is
+   reversed first, so that the most significant byte of the word comes first */
+
+__attribute__((target("ssse3")))
+static inline void Hex_Encode_Group_SSSE3(const uint32_t *words, char *hex, __m128i digits)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i x, high, low;
+
+    x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) words), _mm_set_epi64x(BSWAP32_MASK));
+    high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+    low = _mm_shuffle_epi8(digits, _mm_and_si128(x, mask));
+
+    _mm_storeu_si128((__m128i*) hex, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128((__m128i*) (hex + 16), _mm_unpackhi_epi8(high, low));
+}
+
+__attribute__((target("ssse3")))
+static void Hex_Encode_SSSE3(const uint32_t *words, uint64_t nr_of_words, char *hex, const char *digits)
+{
+    const __m128i table = _mm_loadu_si128((const __m128i*) digits);
+    uint64_t i;
+
+    if (nr_of_words < 4)
+    {
+        Hex_Encode_Scalar(words, nr_of_words, hex, digits);
+        return;
+    }
+
+    for (i = 0; i + 4 <= nr_of_words; i += 4)
+        Hex_Encode_Group_SSSE3(&words[i], &hex[WORD_HEX_SIZE*i], table);
+    if (i < nr_of_words)
+        Hex_Encode_Group_SSSE3(&words[nr_of_words - 4], &hex[WORD_HEX_SIZE*(nr_of_words - 4)], table);
+}
+
+/* Converts 16 hexadecimal digits of either case to their values and sets *valid to all ones if every character
+   is a digit */
+
+__attribute__((target("ssse3")))
+static inline __m128i Hex_Values_SSSE3(__m128i c, __m128i *valid)
+{
+    __m128i digit, letter, is_digit, is_letter;
+
+    digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_letter));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+/* Converts 32 hexadecimal digits to 4 words and returns FALSE if any character is not a digit */
+
+__attribute__((target("ssse3")))
+static inline int Hex_Decode_Group_SSSE3(const char *hex, uint32_t *words)
+{
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i valid, low, high;
+
+    valid = _mm_set1_epi8(-1);
+    low = Hex_Values_SSSE3(_mm_loadu_si128((const __m128i*) hex), &valid);
+    high = Hex_Values_SSSE3(_mm_loadu_si128((const __m128i*) (hex + 16)), &valid);
+
+    /* Each pair of values v0, v1 is combined into the byte 16*v0 + v1 */
+
+    low = _mm_packus_epi16(_mm_maddubs_epi16(low, weights), _mm_maddubs_epi16(high, weights));
+    _mm_storeu_si128((__m128i*) words, _mm_shuffle_epi8(low, _mm_set_epi64x(BSWAP32_MASK)));
+
+    return _mm_movemask_epi8(valid) == 0xffff;
+}
+
+__attribute__((target("ssse3")))
+static int Hex_Decode_SSSE3(const char *hex, uint64_t nr_of_words, uint32_t *words)
+{
+    uint64_t i;
+    int valid;
+
+    if (nr_of_words < 4)
+        return Hex_Decode_Scalar(hex, nr_of_words, words);
+
+    valid = 1;
+    for (i = 0; i + 4 <= nr_of_words; i += 4)
+        valid &= Hex_Decode_Group_SSSE3(&hex[WORD_HEX_SIZE*i], &words[i]);
+    if (i < nr_of_words)
+        valid &= Hex_Decode_Group_SSSE3(&hex[WORD_HEX_SIZE*(nr_of_words - 4)], &words[nr_of_words - 4]);
+
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* The AVX2 kernel works as the SSSE3 kernel on two 128-bit halves at once. The byte shuffle and unpack
+   instructions stay within each half, so the halves are put back in order before they are stored. Fewer than 8
+   words are converted with the 128-bit groups, inlined here so that they share the AVX encoding and no switch
+   between SSE and AVX instructions takes place */
+
+__attribute__((target("avx2")))
+static inline void Hex_Encode_Group_AVX2(const uint32_t *words, char *hex, __m256i digits)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i x, high, low, first, second;
+
+    x = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) words), _mm256_set_epi64x(BSWAP32_MASK, BSWAP32_MASK));
+    high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask));
+    low = _mm256_shuffle_epi8(digits, _mm256_and_si256(x, mask));
+
+    first = _mm256_unpacklo_epi8(high, low);
+    second = _mm256_unpackhi_epi8(high, low);
+    _mm256_storeu_si256((__m256i*) hex, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256((__m256i*) (hex + 32), _mm256_permute2x128_si256(first, second, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void Hex_Encode_AVX2(const uint32_t *words, uint64_t nr_of_words, char *hex, const char *digits)
+{
+    const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) digits));
+    uint64_t i;
+
+    if (nr_of_words < 4)
+    {
+        Hex_Encode_Scalar(words, nr_of_words, hex, digits);
+        return;
+    }
+
+    if (nr_of_words < 8)
+    {
+        Hex_Encode_Group_SSSE3(words, hex, _mm256_castsi256_si128(table));
+        Hex_Encode_Group_SSSE3(&words[nr_of_words - 4], &hex[WORD_HEX_SIZE*(nr_of_words - 4)], _mm256_castsi256_si128(table));
+        return;
+    }
+
+    for (i = 0; i + 8 <= nr_of_words; i += 8)
+        Hex_Encode_Group_AVX2(&words[i], &hex[WORD_HEX_SIZE*i], table);
+    if (i < nr_of_words)
+        Hex_Encode_Group_AVX2(&words[nr_of_words - 8], &hex[WORD_HEX_SIZE*(nr_of_words - 8)], table);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i Hex_Values_AVX2(__m256i c, __m256i *valid)
+{
+    __m256i digit, letter, is_digit, is_letter;
+
+    digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+    *valid = _mm256_and_si256(*valid, _mm256_or_si256(is_digit, is_letter));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static inline int Hex_Decode_Group_AVX2(const char *hex, uint32_t *words)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i valid, low, high;
+
+    valid = _mm256_set1_epi8(-1);
+    low = Hex_Values_AVX2(_mm256_loadu_si256((const __m256i*) hex), &valid);
+    high = Hex_Values_AVX2(_mm256_loadu_si256((const __m256i*) (hex + 32)), &valid);
+
+    low = _mm256_packus_epi16(_mm256_maddubs_epi16(low, weights), _mm256_maddubs_epi16(high, weights));
+    low = _mm256_permute4x64_epi64(low, 0xd8);
+    _mm256_storeu_si256((__m256i*) words, _mm256_shuffle_epi8(low, _mm256_set_epi64x(BSWAP32_MASK, BSWAP32_MASK)));
+
+    return _mm256_movemask_epi8(valid) == -1;
+}
+
+__attribute__((target("avx2")))
+static int Hex_Decode_AVX2(const char *hex, uint64_t nr_of_words, uint32_t *words)
+{
+    uint64_t i;
+    int valid;
+
+    if (nr_of_words < 4)
+        return Hex_Decode_Scalar(hex, nr_of_words, words);
+
+    if (nr_of_words < 8)
+    {
+        valid = Hex_Decode_Group_SSSE3(hex, words);
+        valid &= Hex_Decode_Group_SSSE3(&hex[WORD_HEX_SIZE*(nr_of_words - 4)], &words[nr_of_words - 4]);
+        return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    valid = 1;
+    for (i = 0; i + 8 <= nr_of_words; i += 8)
+        valid &= Hex_Decode_Group_AVX2(&hex[WORD_HEX_SIZE*i], &words[i]);
+    if (i < nr_of_words)
+        valid &= Hex_Decode_Group_AVX2(&hex[WORD_HEX_SIZE*(nr_of_words - 8)], &words[nr_of_words - 8]);
+
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: KERNEL SELECTION
+ *
+ **************************************************************************************************************************************/
+
+struct sha_hex_kernel
+{
+    const char *name;
+    void (*encode)(const uint32_t *words, uint64_t nr_of_words, char *hex, const char *digits);
+    int (*decode)(const char *hex, uint64_t nr_of_words, uint32_t *words);
+};
+
+/* All kernels compiled in, in order of increasing preference */
+
+static const struct sha_hex_kernel all_kernels[] =
+{
+    {"scalar", Hex_Encode_Scalar, Hex_Decode_Scalar},
+#ifdef SHA_X86
+    {"ssse3", Hex_Encode_SSSE3, Hex_Decode_SSSE3},
+    {"avx2", Hex_Encode_AVX2, Hex_Decode_AVX2},
+#endif
+};
+
+#define NR_OF_KERNELS (sizeof(all_kernels)/sizeof(all_kernels[0]))
+
+/* The kernel forced by SHA_Hex_Set_Kernel, or NULL, and the fastest available one, chosen once by Choose_Kernel */
+
+static const struct sha_hex_kernel *hex_kernel = NULL;
+static const struct sha_hex_kernel *best_kernel = NULL;
+static pthread_once_t best_once = PTHREAD_ONCE_INIT;
+
+static int Is_Available(const struct sha_hex_kernel *kernel)
+{
+#ifdef SHA_X86
+    __builtin_cpu_init();
+    if (strcmp(kernel->name, "ssse3") == 0)
+        return __builtin_cpu_supports("ssse3");
+    if (strcmp(kernel->name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+#endif
+    return 1;
+}
+
+static void Choose_Kernel(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < NR_OF_KERNELS; i++)
+        if (Is_Available(&all_kernels[i]))
+            best_kernel = &all_kernels[i];
+}
+
+static const struct sha_hex_kernel *Get_Kernel(void)
+{
+    const struct sha_hex_kernel *kernel = __atomic_load_n(&hex_kernel, __ATOMIC_ACQUIRE);
+
+    if (kernel != NULL)
+        return kernel;
+
+    pthread_once(&best_once, Choose_Kernel);
+    return best_kernel;
+}
+
+/* The function SHA_Hex_Set_Kernel forces the conversions to use the kernel with the given name ("scalar", "ssse3"
+   or "avx2"), or lets them choose the fastest available one again if name is NULL. EXIT_FAILURE is returned if the
+   kernel is unknown or not available.                                                                             */
+
+int SHA_Hex_Set_Kernel(const char *name)
+{
+    unsigned int i;
+
+    if (name == NULL)
+    {
+        __atomic_store_n(&hex_kernel, (const struct sha_hex_kernel*) NULL, __ATOMIC_RELEASE);
+        return EXIT_SUCCESS;
+    }
+
+    for (i = 0; i < NR_OF_KERNELS; i++)
+        if (strcmp(all_kernels[i].name, name) == 0 && Is_Available(&all_kernels[i]))
+        {
+            __atomic_store_n(&hex_kernel, &all_kernels[i], __ATOMIC_RELEASE);
+            return EXIT_SUCCESS;
+        }
+
+    return EXIT_FAILURE;
+}
+
+/* The function SHA_Hex_Get_Kernel returns the name of the kernel currently used by the conversions */
+
+const char *SHA_Hex_Get_Kernel(void)
+{
+    return Get_Kernel()->name;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: CONVERSIONS
+ *
+ **************************************************************************************************************************************/
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Hex_Encode
+ *
+ * PURPOSE: Writes a hash as hexadecimal text, the most significant byte of each word first, followed by a
+ *          terminating null character.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * hash                uint32_t*             I       pointer to the words of the hash, e.g. as computed by SHA1
+ * nr_of_words         unsigned int          I       the number of words of the hash, e.g. 5 for SHA1
+ * hex                 char*                 O       pointer to the char array of at least 8*nr_of_words + 1 bytes where
+ *                                                   the text is to be stored
+ * letter_case         int                   I       SHA_HEX_LOWERCASE or SHA_HEX_UPPERCASE
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA_Hex_Encode(const uint32_t *hash, unsigned int nr_of_words, char *hex, int letter_case)
+{
+    const char *digits = letter_case == SHA_HEX_UPPERCASE ? uppercase_digits : lowercase_digits;
+
+    Get_Kernel()->encode(hash, nr_of_words, hex, digits);
+    hex[WORD_HEX_SIZE*nr_of_words] = '\0';
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Hex_Encode_Batch
+ *
+ * PURPOSE: Writes a number of hashes stored one after the other as hexadecimal text into a single char array, each hash
+ *          followed by the separator unless it is the null character, and the whole text by a terminating null
+ *          character. Without separator the hashes are converted as one sequence of words.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * hashes              uint32_t*             I       pointer to the words of the hashes, hash i starting at index
+ *                                                   nr_of_words*i, e.g. as computed by SHA1_Batch
+ * nr_of_hashes        uint64_t              I       the number of hashes
+ * nr_of_words         unsigned int          I       the number of words of each hash
+ * hex                 char*                 O       pointer to the char array of at least
+ *                                                   nr_of_hashes*(8*nr_of_words + 1) + 1 bytes where the text is to be stored
+ * separator           char                  I       the character written after each hash, e.g. '\n', or '\0' for none
+ * letter_case         int                   I       SHA_HEX_LOWERCASE or SHA_HEX_UPPERCASE
+ *
+ * RETURN VALUE : uint64_t, the number of characters written, not counting the terminating null character
+ *
+ *********************************************************************************************************************************/
+
+uint64_t SHA_Hex_Encode_Batch(const uint32_t *hashes, uint64_t nr_of_hashes, unsigned int nr_of_words, char *hex, char separator, int letter_case)
+{
+    const char *digits = letter_case == SHA_HEX_UPPERCASE ? uppercase_digits : lowercase_digits;
+    const struct sha_hex_kernel *kernel = Get_Kernel();
+    uint64_t position, i;
+
+    if (separator == '\0')
+    {
+        kernel->encode(hashes, nr_of_hashes*nr_of_words, hex, digits);
+        position = WORD_HEX_SIZE*nr_of_hashes*nr_of_words;
+    }
+    else
+    {
+        position = 0;
+        for (i = 0; i < nr_of_hashes; i++)
+        {
+            kernel->encode(&hashes[nr_of_words*i], nr_of_words, &hex[position], digits);
+            position = position + WORD_HEX_SIZE*nr_of_words;
+            hex[position++] = separator;
+        }
+    }
+
+    hex[position] = '\0';
+    return position;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Hex_Decode
+ *
+ * PURPOSE: Reads a hash from hexadecimal text of either case, written the most significant byte of each word first.
+ *          Every character is checked to be a hexadecimal digit.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * hex                 char*                 I       pointer to the text, of which the first 8*nr_of_words characters
+ *                                                   are read. The text must be at least that long
+ * nr_of_words         unsigned int          I       the number of words of the hash, e.g. 5 for SHA1
+ * hash                uint32_t*             O       pointer to the uint32_t array where the hash is to be stored. Its
+ *                                                   content is undefined if the text is not valid
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if any character is not a hexadecimal digit
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Hex_Decode(const char *hex, unsigned int nr_of_words, uint32_t *hash)
+{
+    return Get_Kernel()->decode(hex, nr_of_words, hash);
+}
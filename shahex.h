@@ -0,0 +1,26 @@
+/***************************************************************************************************************************************
+ * FILENAME: shahex.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the functions converting hashes to and from hexadecimal text defined in shahex.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAHEX__
+#define __SHAHEX__
+
+#define SHA_HEX_LOWERCASE 0
+#define SHA_HEX_UPPERCASE 1
+
+void SHA_Hex_Encode(const uint32_t *hash, unsigned int nr_of_words, char *hex, int letter_case);
+
+uint64_t SHA_Hex_Encode_Batch(const uint32_t *hashes, uint64_t nr_of_hashes, unsigned int nr_of_words, char *hex, char separator, int letter_case);
+
+int SHA_Hex_Decode(const char *hex, unsigned int nr_of_words, uint32_t *hash);
+
+int SHA_Hex_Set_Kernel(const char *name);
+
+const char *SHA_Hex_Get_Kernel(void);
+
+#endif
@@ -0,0 +1,376 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shahmac.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-29
+ *
+ * CONTENT: Implements the verification of many HMAC-SHA1 tags at once, each message with a key of its own, on the
+ *          multi-lane kernels of shabatch.c.
+ *
+ *          HMAC-SHA1 of a short message takes four compressions: the block of the key xored with the outer pad, the
+ *          block of the key xored with the inner pad, the message from the inner hash and the inner digest from the
+ *          outer hash. Each lane takes one message through all four stages in turn and is given the next message as
+ *          soon as it has finished, so that the lanes are kept filled with messages of different keys and lengths.
+ *          Keys longer than the block size are first hashed side by side by SHA1_Batch_Kernel, as prescribed by HMAC.
+ *
+ *          The tags are compared without branching on their content and the result is a bitmap, so that the time
+ *          taken depends only on the sizes of the keys and messages and not on which tags match or on how many of
+ *          their bytes do.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shalib.h"
+#include "sha1.h"
+#include "shabatch.h"
+#include "shahmac.h"
+
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4         /* defines the size of a word in BYTES                                      */
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+#define INNER_PAD 0x36      /* defines the byte xored with the key before the message                   */
+#define OUTER_PAD 0x5c      /* defines the byte xored with the key before the inner digest              */
+
+/* The stages of a message in its lane, in the order they are compressed */
+
+enum hmac_stage
+{
+    HMAC_OUTER_KEY,                           /* the block of the key xor OUTER_PAD, whose hash is kept in outer            */
+    HMAC_INNER_KEY,                           /* the block of the key xor INNER_PAD                                         */
+    HMAC_TEXT,                                /* the blocks of the message, from the hash of the inner key                  */
+    HMAC_OUTER                                /* the block of the inner digest, from the hash of the outer key              */
+};
+
+/* A hmac_lane holds the position of one message in its lane */
+
+struct hmac_lane
+{
+    const struct sha_hmac_check *check;       /* the message being verified, NULL if the lane is idle                       */
+    uint64_t job;                             /* the index of the message in the batch                                      */
+    enum hmac_stage stage;                    /* the stage of the block loaded into the lane                                */
+    unsigned char key_block[BLOCK_SIZE];      /* the key, or the hash of a long key, padded with zeros                      */
+    uint32_t outer[HASH_SIZE];                /* the hash of the outer key                                                  */
+    uint64_t position;                        /* the position of the next block in the message                              */
+    unsigned char final_blocks[2*BLOCK_SIZE]; /* the last bytes of the message followed by the pad                          */
+    unsigned int nr_of_final_blocks;          /* the number of final blocks, 0 until they have been set                     */
+    unsigned int final_position;              /* the number of final blocks already loaded                                  */
+};
+
+static const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: LANES
+ *
+ **************************************************************************************************************************************/
+
+/* The function Start_Lane gives a lane the message job. The key block is taken from the hashes of the long keys,
+   which are stored in the order of the long keys in the batch */
+
+static void Start_Lane(struct hmac_lane *lane, const struct sha_hmac_check *check, uint64_t job, const uint32_t *key_hash)
+{
+    unsigned int i;
+
+    lane->check = check;
+    lane->job = job;
+    lane->stage = HMAC_OUTER_KEY;
+    lane->position = 0;
+    lane->nr_of_final_blocks = 0;
+    lane->final_position = 0;
+
+    memset(lane->key_block, 0, BLOCK_SIZE);
+    if (check->key_byte_size > BLOCK_SIZE)
+        for (i = 0; i < HASH_SIZE; i++)
+            Conv_32Int_To_Word(key_hash[i], (char*) &lane->key_block[WORD_SIZE*i]);
+    else
+        memcpy(lane->key_block, check->key, check->key_byte_size);
+}
+
+/* The function Load_Key loads the key block of a lane xored with pad and starts the hash of the lane anew */
+
+static void Load_Key(struct hmac_lane *lane, unsigned char pad, uint32_t *H, uint32_t *W, unsigned int l, unsigned int nr_of_lanes)
+{
+    unsigned char block[BLOCK_SIZE];
+    unsigned int i;
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+        block[i] = lane->key_block[i] ^ pad;
+    for (i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
+        W[i*nr_of_lanes + l] = Conv_Word_To_32Int(&block[WORD_SIZE*i]);
+    for (i = 0; i < HASH_SIZE; i++)
+        H[i*nr_of_lanes + l] = H_init[i];
+
+    memset(block, 0, BLOCK_SIZE);
+}
+
+/* The function Load_Text loads the next block of the message of a lane and returns TRUE if it was the last block.
+   The message follows the block of the inner key, which is counted in its size in bits */
+
+static int Load_Text(struct hmac_lane *lane, uint32_t *W, unsigned int l, unsigned int nr_of_lanes)
+{
+    const struct sha_hmac_check *check = lane->check;
+    unsigned char *block;
+    unsigned int i;
+
+    if (lane->position + BLOCK_SIZE <= check->text_byte_size)
+    {
+        block = (unsigned char*) &check->text[lane->position];
+        lane->position = lane->position + BLOCK_SIZE;
+    }
+    else
+    {
+        if (lane->nr_of_final_blocks == 0)
+            lane->nr_of_final_blocks = Set_64Byte_Final_Blocks(lane->final_blocks, (unsigned char*) &check->text[lane->position],
+                                                               check->text_byte_size - lane->position, BLOCK_SIZE + check->text_byte_size);
+        block = &lane->final_blocks[BLOCK_SIZE*lane->final_position];
+        lane->final_position++;
+    }
+
+    for (i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
+        W[i*nr_of_lanes + l] = Conv_Word_To_32Int(&block[i*WORD_SIZE]);
+
+    return lane->nr_of_final_blocks > 0 && lane->final_position == lane->nr_of_final_blocks;
+}
+
+/* The function Load_Outer loads the inner digest of a lane followed by the pad, and continues from the hash of the
+   outer key */
+
+static void Load_Outer(struct hmac_lane *lane, uint32_t *H, uint32_t *W, unsigned int l, unsigned int nr_of_lanes)
+{
+    unsigned int i;
+
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        W[i*nr_of_lanes + l] = H[i*nr_of_lanes + l];
+        H[i*nr_of_lanes + l] = lane->outer[i];
+    }
+    W[HASH_SIZE*nr_of_lanes + l] = 0x80000000;
+    for (i = HASH_SIZE + 1; i < BLOCK_SIZE/WORD_SIZE - 1; i++)
+        W[i*nr_of_lanes + l] = 0;
+    W[(BLOCK_SIZE/WORD_SIZE - 1)*nr_of_lanes + l] = 8*(BLOCK_SIZE + SHA_HMAC_TAG_SIZE);
+}
+
+/* The function Match_Tag returns 1 if the digest in lane l equals the expected tag and 0 otherwise. Every byte is
+   compared and the differences are gathered without branches */
+
+static uint64_t Match_Tag(const uint32_t *H, unsigned int l, unsigned int nr_of_lanes, const unsigned char *tag)
+{
+    uint32_t difference;
+    unsigned int i;
+
+    difference = 0;
+    for (i = 0; i < SHA_HMAC_TAG_SIZE; i++)
+        difference |= ((H[(i/WORD_SIZE)*nr_of_lanes + l] >> (24 - 8*(i % WORD_SIZE))) & 0xff) ^ tag[i];
+
+    return (uint64_t) ((difference - 1) >> 31);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: VERIFICATION
+ *
+ **************************************************************************************************************************************/
+
+/* The function Hash_Long_Keys hashes every key longer than the block size side by side and returns the hashes in the
+   order of the keys in the batch, or NULL if there are none. Sets *status to EXIT_FAILURE if memory runs out */
+
+static uint32_t *Hash_Long_Keys(const struct sha1_kernel *kernel, const struct sha_hmac_check *checks, uint64_t nr_of_checks, int *status)
+{
+    char **keys;
+    uint64_t *keys_byte_size;
+    uint32_t *key_hashes;
+    uint64_t nr_of_long_keys, i;
+
+    *status = EXIT_SUCCESS;
+    nr_of_long_keys = 0;
+    for (i = 0; i < nr_of_checks; i++)
+        if (checks[i].key_byte_size > BLOCK_SIZE)
+            nr_of_long_keys++;
+
+    if (nr_of_long_keys == 0)
+        return NULL;
+
+    keys = (char**) malloc(nr_of_long_keys*sizeof(char*));
+    keys_byte_size = (uint64_t*) malloc(nr_of_long_keys*sizeof(uint64_t));
+    key_hashes = (uint32_t*) malloc(nr_of_long_keys*HASH_SIZE*sizeof(uint32_t));
+    if (keys == NULL || keys_byte_size == NULL || key_hashes == NULL)
+    {
+        free(keys);
+        free(keys_byte_size);
+        free(key_hashes);
+        *status = EXIT_FAILURE;
+        return NULL;
+    }
+
+    nr_of_long_keys = 0;
+    for (i = 0; i < nr_of_checks; i++)
+        if (checks[i].key_byte_size > BLOCK_SIZE)
+        {
+            keys[nr_of_long_keys] = (char*) checks[i].key;
+            keys_byte_size[nr_of_long_keys] = checks[i].key_byte_size;
+            nr_of_long_keys++;
+        }
+
+    SHA1_Batch_Kernel(kernel, keys, keys_byte_size, nr_of_long_keys, key_hashes);
+
+    free(keys);
+    free(keys_byte_size);
+    return key_hashes;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HMAC_Verify_Batch_Kernel
+ *
+ * PURPOSE: Verifies the HMAC-SHA1 tags of a number of messages, each with its own key, with the given multi-lane kernel.
+ *          Bit i % 64 of matches[i/64] is set if the tag of message i matches and cleared otherwise. The time taken
+ *          does not depend on the tags.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                    I/O     DESCRIPTION
+ * --------            ----                    ---     -----------
+ * kernel              struct sha1_kernel*     I       the kernel to use, see SHA1_Kernels
+ * checks              struct sha_hmac_check*  I       pointer to the array of the keys, messages and expected tags
+ * nr_of_checks        uint64_t                I       the number of messages
+ * matches             uint64_t*               O       pointer to the bitmap of (nr_of_checks + 63)/64 words where the
+ *                                                     results are to be stored
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if memory for the hashes of the long keys could not be allocated
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HMAC_Verify_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_hmac_check *checks, uint64_t nr_of_checks, uint64_t *matches)
+{
+    struct hmac_lane lanes[SHA1_MAX_LANES];
+    uint32_t H[HASH_SIZE*SHA1_MAX_LANES];
+    uint32_t W[(BLOCK_SIZE/WORD_SIZE)*SHA1_MAX_LANES];
+    int is_last[SHA1_MAX_LANES];
+    uint32_t *key_hashes;
+    unsigned int nr_of_lanes, nr_of_active, l, i;
+    uint64_t next, next_long_key;
+    int status;
+
+    key_hashes = Hash_Long_Keys(kernel, checks, nr_of_checks, &status);
+    if (status != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    memset(matches, 0, ((nr_of_checks + 63)/64)*sizeof(uint64_t));
+
+    nr_of_lanes = kernel->nr_of_lanes;
+    memset(H, 0, sizeof(H));
+    memset(W, 0, sizeof(W));
+    for (l = 0; l < nr_of_lanes; l++)
+        lanes[l].check = NULL;
+
+    next = 0;
+    next_long_key = 0;
+    for (;;)
+    {
+        /* Give every idle lane the next message and load the next block of every active lane */
+
+        nr_of_active = 0;
+        for (l = 0; l < nr_of_lanes; l++)
+        {
+            is_last[l] = 0;
+
+            if (lanes[l].check == NULL && next < nr_of_checks)
+            {
+                Start_Lane(&lanes[l], &checks[next], next, &key_hashes[HASH_SIZE*next_long_key]);
+                if (checks[next].key_byte_size > BLOCK_SIZE)
+                    next_long_key++;
+                next++;
+            }
+
+            if (lanes[l].check == NULL)
+                continue;
+            nr_of_active++;
+
+            switch (lanes[l].stage)
+            {
+                case HMAC_OUTER_KEY:
+                    Load_Key(&lanes[l], OUTER_PAD, H, W, l, nr_of_lanes);
+                    break;
+                case HMAC_INNER_KEY:
+                    Load_Key(&lanes[l], INNER_PAD, H, W, l, nr_of_lanes);
+                    break;
+                case HMAC_TEXT:
+                    is_last[l] = Load_Text(&lanes[l], W, l, nr_of_lanes);
+                    break;
+                case HMAC_OUTER:
+                    Load_Outer(&lanes[l], H, W, l, nr_of_lanes);
+                    break;
+            }
+        }
+
+        if (nr_of_active == 0)
+            break;
+
+        kernel->compress(H, W);
+
+        /* Move every lane on to its next stage, and compare the tag of every message that has been completed */
+
+        for (l = 0; l < nr_of_lanes; l++)
+        {
+            if (lanes[l].check == NULL)
+                continue;
+
+            switch (lanes[l].stage)
+            {
+                case HMAC_OUTER_KEY:
+                    for (i = 0; i < HASH_SIZE; i++)
+                        lanes[l].outer[i] = H[i*nr_of_lanes + l];
+                    lanes[l].stage = HMAC_INNER_KEY;
+                    break;
+                case HMAC_INNER_KEY:
+                    lanes[l].stage = HMAC_TEXT;
+                    break;
+                case HMAC_TEXT:
+                    if (is_last[l])
+                        lanes[l].stage = HMAC_OUTER;
+                    break;
+                case HMAC_OUTER:
+                    matches[lanes[l].job/64] |= Match_Tag(H, l, nr_of_lanes, lanes[l].check->tag) << (lanes[l].job % 64);
+                    memset(lanes[l].key_block, 0, BLOCK_SIZE);
+                    lanes[l].check = NULL;
+                    break;
+            }
+        }
+    }
+
+    memset(H, 0, sizeof(H));
+    memset(W, 0, sizeof(W));
+    for (l = 0; l < nr_of_lanes; l++)
+        memset(lanes[l].outer, 0, sizeof(lanes[l].outer));
+
+    if (key_hashes != NULL)
+    {
+        memset(key_hashes, 0, next_long_key*HASH_SIZE*sizeof(uint32_t));
+        free(key_hashes);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HMAC_Verify_Batch
+ *
+ * PURPOSE: Verifies the HMAC-SHA1 tags of a number of messages with the default kernel. See SHA_HMAC_Verify_Batch_Kernel.
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if memory for the hashes of the long keys could not be allocated
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HMAC_Verify_Batch(const struct sha_hmac_check *checks, uint64_t nr_of_checks, uint64_t *matches)
+{
+    return SHA_HMAC_Verify_Batch_Kernel(SHA1_Default_Kernel(), checks, nr_of_checks, matches);
+}
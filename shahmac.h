@@ -0,0 +1,30 @@
+/***************************************************************************************************************************************
+ * FILENAME: shahmac.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the batch HMAC-SHA1 verification functions defined in shahmac.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAHMAC__
+#define __SHAHMAC__
+
+#define SHA_HMAC_TAG_SIZE 20                  /* the size in bytes of an HMAC-SHA1 tag                                      */
+
+/* A sha_hmac_check is one message to be verified by SHA_HMAC_Verify_Batch, each with a key of its own */
+
+struct sha_hmac_check
+{
+    const char *key;                          /* the key of the sender                                                      */
+    uint64_t key_byte_size;                   /* the size in bytes of the key                                               */
+    const char *text;                         /* the message                                                                */
+    uint64_t text_byte_size;                  /* the size in bytes of the message                                           */
+    const unsigned char *tag;                 /* the expected tag of SHA_HMAC_TAG_SIZE bytes, most significant byte first   */
+};
+
+int SHA_HMAC_Verify_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_hmac_check *checks, uint64_t nr_of_checks, uint64_t *matches);
+
+int SHA_HMAC_Verify_Batch(const struct sha_hmac_check *checks, uint64_t nr_of_checks, uint64_t *matches);
+
+#endif
@@ -12,14 +12,80 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "shalib.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #define TRUE 1
 #define FALSE 0 
 #define DELIMITER 128
 
 
+/***************************************************************************************************************************************
+ *
+ *  SECTION: INSTRUMENTATION
+ *
+ *  When compiled with SHA_STATS defined, the word pointer methods and the iteration functions count, per thread, how
+ *  the blocks are loaded and compressed and how much time is spent in compression and file reads. Without SHA_STATS
+ *  the Stats_* macros expand to nothing and the hot paths are unchanged.
+ *
+ **************************************************************************************************************************************/
+
+#ifdef SHA_STATS
+
+static __thread struct sha_stats stats;         /* the counters of the calling thread */
+
+static uint64_t Stats_Nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+#define Stats_Add(field, n) (stats.field += (n))
+#define Stats_Start(t) uint64_t t = Stats_Nanoseconds()
+#define Stats_Stop(field, t) (stats.field += Stats_Nanoseconds() - (t))
+
+#else
+
+#define Stats_Add(field, n)
+#define Stats_Start(t)
+#define Stats_Stop(field, t)
+
+#endif
+
+/* The function SHA_Stats_Snapshot copies the counters of the calling thread to the struct pointed to by s.
+   EXIT_FAILURE is returned, and s is zeroed, if the library was compiled without SHA_STATS.               */
+
+int SHA_Stats_Snapshot(struct sha_stats *s)
+{
+#ifdef SHA_STATS
+    *s = stats;
+    return EXIT_SUCCESS;
+#else
+    memset(s, 0, sizeof(*s));
+    return EXIT_FAILURE;
+#endif
+}
+
+/* The function SHA_Stats_Reset sets the counters of the calling thread to zero */
+
+void SHA_Stats_Reset(void)
+{
+#ifdef SHA_STATS
+    memset(&stats, 0, sizeof(stats));
+#endif
+}
+
+
 /***************************************************************************************************************************************/
 
 /* The function Set_Zero sets all parameters in the word pointer to zero or NULL depending on their type */ 
@@ -82,6 +148,34 @@ void Set_Pad(struct sha_word_pointer *p, unsigned char *pad, uint64_t text_byte_
     p->pad_byte_size = pad_byte_size;
     p->is_in_pad = FALSE;
     p->tot_byte_size = text_byte_size + pad_byte_size;
+
+    Stats_Add(bytes_hashed, text_byte_size);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+
+/* The function Get_Bulk_Blocks returns the number of whole blocks that can be read directly from the current string
+   of the word pointer, stores a pointer to the first of them in data and advances the word pointer past them.
+   Zero is returned if the pointer is set to a file, is in the pad or is closer than one block to the end of the
+   current string, in which case the blocks must be loaded through the word pointer as usual.                   */
+
+uint64_t Get_Bulk_Blocks(struct sha_word_pointer *p, unsigned char **data, unsigned int BLOCK_SIZE)
+{
+    uint64_t nr_of_blocks;                              /* the number of whole blocks left in the current string   */
+
+    if (p->fp != NULL || p->is_in_pad == TRUE || p->array_index >= p->nr_of_strings)
+        return 0;
+
+    nr_of_blocks = (p->strings_byte_size[p->array_index] - p->array_position)/BLOCK_SIZE;
+
+    if (nr_of_blocks > 0)
+    {
+        *data = (unsigned char*) &p->strings[p->array_index][p->array_position];
+        p->array_position = p->array_position + nr_of_blocks*BLOCK_SIZE;
+        Stats_Add(fast_path_blocks, nr_of_blocks);
+    }
+
+    return nr_of_blocks;
 }
 
 /***************************************************************************************************************************************
@@ -125,6 +219,30 @@ void Set_64Byte_Pad(struct sha_word_pointer *p, unsigned char *pad, uint64_t tex
     Set_Pad(p, pad, text_byte_size, BLOCK_SIZE);
 }
 
+/* The function Set_64Byte_Final_Blocks writes the last tail_byte_size (< 64) bytes of a text of text_byte_size bytes,
+   followed by the pad, into blocks and returns the number of 64-byte blocks written, which is 1 or 2.
+   This lets callers that hash whole blocks directly from memory finish the text without a word pointer.
+   Note that blocks must have room for two blocks                                                               */
+
+unsigned int Set_64Byte_Final_Blocks(unsigned char *blocks, unsigned char *tail, unsigned int tail_byte_size, uint64_t text_byte_size)
+{
+    unsigned int i;
+    unsigned int nr_of_blocks;                          /* the number of blocks holding the tail and the pad       */
+    uint64_t text_bit_size;                             /* the size in BITS of the text                            */
+
+    nr_of_blocks = (tail_byte_size + 9 > BLOCK_SIZE) ? 2 : 1;
+
+    memcpy(blocks, tail, tail_byte_size);
+    blocks[tail_byte_size] = DELIMITER;
+    memset(&blocks[tail_byte_size + 1], 0, nr_of_blocks*BLOCK_SIZE - tail_byte_size - 9);
+
+    text_bit_size = 8*text_byte_size;
+    for (i = 0; i < 8; i++)
+        blocks[nr_of_blocks*BLOCK_SIZE - i - 1] = (text_bit_size >> i*8) & 255;
+
+    return nr_of_blocks;
+}
+
 
 /*------------------------------------------------------------------------------------------------------------------*/
 
@@ -140,6 +258,7 @@ void Load_String_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
             W[i] = Conv_Word_To_32Int((unsigned char*) &p->strings[p->array_index][p->array_position + WORD_SIZE*i]);
 
         p->array_position = p->array_position + BLOCK_SIZE;
+        Stats_Add(fast_path_blocks, 1);
     }
 
     else
@@ -182,6 +301,9 @@ void Load_String_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
             }
         }while (i < BLOCK_SIZE);
 
+        Stats_Add(slow_path_blocks, 1);
+        Stats_Add(pad_blocks, p->is_in_pad == TRUE);
+
         /* Convert the buffer to 32-bit integers and store the result */
         for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
             W[i] = Conv_Word_To_32Int(&p->buffer[i*WORD_SIZE]);
@@ -191,22 +313,31 @@ void Load_String_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
 void Load_File_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
 {
     int i;              /* internal counter variable */
+    size_t n = 0;       /* the number of bytes read at once */
+
+    Stats_Start(t);
 
-    /* Fast track if the position is not close to the pad */
+    /* Fast track if the position is not close to the pad: read the whole block at once */
     if(p->file_position + BLOCK_SIZE < p->file_byte_size)
+        n = fread(p->buffer, 1, BLOCK_SIZE, p->fp);
+
+    if(n == BLOCK_SIZE)
         {
+            Stats_Stop(io_ns, t);
+            Stats_Add(file_read_calls, 1);
+            Stats_Add(fast_path_blocks, 1);
+
             for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
-                W[i] = (unsigned char) fgetc(p->fp) << 24 |
-                       (unsigned char) fgetc(p->fp) << 16 |
-                       (unsigned char) fgetc(p->fp) << 8 |
-                       (unsigned char) fgetc(p->fp);
+                W[i] = Conv_Word_To_32Int(&p->buffer[i*WORD_SIZE]);
 
             p->file_position = p->file_position + BLOCK_SIZE;
         }
 
     else
     {
-        i = 0;
+        /* The bytes of a short read of the fast track are kept, and the rest of the block is loaded after them */
+        p->file_position = p->file_position + n;
+        i = (int) n;
 
         do
         {
@@ -228,6 +359,7 @@ void Load_File_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
             {
                 p->buffer[i] = (unsigned char) fgetc(p->fp);
                 p->file_position++;
+                Stats_Add(file_read_calls, 1);
                 i++;
             }
             /* Else report error */
@@ -238,6 +370,10 @@ void Load_File_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W)
             }
         }while (i < BLOCK_SIZE);
 
+        Stats_Add(slow_path_blocks, 1);
+        Stats_Add(pad_blocks, p->is_in_pad == TRUE);
+        Stats_Stop(io_ns, t);
+
         /* Convert the buffer to 32-bit integers and store the result */
         for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
             W[i] = Conv_Word_To_32Int(&p->buffer[i*WORD_SIZE]);
@@ -326,6 +462,7 @@ void Load_String_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
             W[i] = Conv_Word_To_64Int((unsigned char*) &p->strings[p->array_index][p->array_position + WORD_SIZE*i]);
 
         p->array_position = p->array_position + BLOCK_SIZE;
+        Stats_Add(fast_path_blocks, 1);
     }
 
     else
@@ -368,6 +505,9 @@ void Load_String_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
             }
         }while (i < BLOCK_SIZE);
 
+        Stats_Add(slow_path_blocks, 1);
+        Stats_Add(pad_blocks, p->is_in_pad == TRUE);
+
         /* Convert the buffer to 64-bit integers and store the result */
         for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
             W[i] = Conv_Word_To_64Int(&p->buffer[i*WORD_SIZE]);
@@ -377,26 +517,31 @@ void Load_String_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
 void Load_File_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
 {
     int i;              /* internal counter variable */
+    size_t n = 0;       /* the number of bytes read at once */
+
+    Stats_Start(t);
 
-    /* Fast track if the position is not close to the pad */
+    /* Fast track if the position is not close to the pad: read the whole block at once */
     if(p->file_position + BLOCK_SIZE < p->file_byte_size)
+        n = fread(p->buffer, 1, BLOCK_SIZE, p->fp);
+
+    if(n == BLOCK_SIZE)
         {
+            Stats_Stop(io_ns, t);
+            Stats_Add(file_read_calls, 1);
+            Stats_Add(fast_path_blocks, 1);
+
             for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
-                W[i] = (uint64_t) fgetc(p->fp) << 56 |
-                       (uint64_t) fgetc(p->fp) << 48 |
-                       (uint64_t) fgetc(p->fp) << 40 |
-                       (uint64_t) fgetc(p->fp) << 32 |
-                       (uint64_t) fgetc(p->fp) << 24 |
-                       (uint64_t) fgetc(p->fp) << 16 |
-                       (uint64_t) fgetc(p->fp) << 8 |
-                       (uint64_t) fgetc(p->fp);
+                W[i] = Conv_Word_To_64Int(&p->buffer[i*WORD_SIZE]);
 
             p->file_position = p->file_position + BLOCK_SIZE;
         }
 
     else
     {
-        i = 0;
+        /* The bytes of a short read of the fast track are kept, and the rest of the block is loaded after them */
+        p->file_position = p->file_position + n;
+        i = (int) n;
 
         do
         {
@@ -418,6 +563,7 @@ void Load_File_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
             {
                 p->buffer[i] = (unsigned char) fgetc(p->fp);
                 p->file_position++;
+                Stats_Add(file_read_calls, 1);
                 i++;
             }
             /* Else report error */
@@ -428,6 +574,10 @@ void Load_File_64Int_Buffer(struct sha_word_pointer *p, uint64_t *W)
             }
         }while (i < BLOCK_SIZE);
 
+        Stats_Add(slow_path_blocks, 1);
+        Stats_Add(pad_blocks, p->is_in_pad == TRUE);
+        Stats_Stop(io_ns, t);
+
         /* Convert the buffer to 64-bit integers and store the result */
         for(i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
             W[i] = Conv_Word_To_64Int(&p->buffer[i*WORD_SIZE]);
@@ -621,12 +771,13 @@ void HMAC64(char *key, unsigned int key_size, char *text, uint64_t text_size, ui
  *
  **************************************************************************************************************************************/
 
-/* The function SHA1_Iterate_Hash implements the SHA1 hash iteration function. 
+/* The function SHA1_Compress implements the SHA1 compression function, given a block whose first 16 words have been
+   loaded into W. W must have room for the 80 words of the message schedule.
    See the NIST documentation (FIPS PUB 180-4) for details. 
    This part of the code has been optimized for speed */
 
 
-void SHA1_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
+void SHA1_Compress(uint32_t *H, uint32_t *W)
 {
     #define Rot_Left(t, x) (((x) << t) | ((x) >> (32 - t)))
     #define Ch(x, y, z) ((x & y) ^ (~x & z))
@@ -659,9 +810,9 @@ void SHA1_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
 
     #define U(i)  (W[i] = Rot_Left(1, W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16]), W[i])
 
-    uint32_t W[80], a, b, c, d, e;
+    uint32_t a, b, c, d, e;
 
-    Load_32Int_Buffer(p, W);
+    Stats_Start(t);
 
     a = H[0];
     b = H[1];
@@ -758,51 +909,131 @@ void SHA1_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
     H[2] += c;
     H[3] += d;
     H[4] += e;
+
+    Stats_Stop(compress_ns, t);
+    Stats_Add(blocks_compressed, 1);
 }
 
-/****************************************************************************************************************/
+/* The function SHA1_Iterate_Hash implements the SHA1 hash iteration function: it loads the next block of the
+   word pointer and compresses it into the hash H */
 
-/* The function SHA256_Iterate_Hash implements the SHA256 hash iteration function. 
-   See the NIST documentation (FIPS PUB 180-4) for details.                         */
+void SHA1_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
+{
+    uint32_t W[80];
+
+    Load_32Int_Buffer(p, W);
+    SHA1_Compress(H, W);
+}
 
+/* The function SHA1_Hash_Blocks iterates the SHA1 hash over nr_of_blocks consecutive 64-byte blocks
+   starting at data, without going through the word pointer. */
 
-void SHA256_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
+void SHA1_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H)
 {
-    #define Rot_Left(t, x) (((x) << t) | ((x) >> (32 - t)))
-    #define Rot_Right(t, x) (((x) << (32 - t)|((x) >> t)))
-    #define Ch(x, y, z) ((x & y) ^ (~x & z))
-    #define Parity(x, y, z) (x ^ y ^ z)
-    #define Maj(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
-    #define Sigma_Maj_0(x) (Rot_Right(2, x) ^ Rot_Right(13, x) ^ Rot_Right(22, x))
-    #define Sigma_Maj_1(x) (Rot_Right(6, x) ^ Rot_Right(11, x) ^ Rot_Right(25, x))
-    #define Sigma_Min_0(x) (Rot_Right(7, x) ^ Rot_Right(18, x) ^ (x >> 3))
-    #define Sigma_Min_1(x) (Rot_Right(17, x) ^ Rot_Right(19, x) ^ (x >> 10))
+    uint64_t n;
+    unsigned int i;
+    uint32_t W[80];
 
-    const unsigned int K[] =
+    for (n = 0; n < nr_of_blocks; n++)
     {
-        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
-        0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
-        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
-        0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
-        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
-        0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
-        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
-        0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
-        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
-        0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
-        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
-        0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
-        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
-        0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
-        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
-        0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
-    };
+        for (i = 0; i < 16; i++)
+            W[i] = Conv_Word_To_32Int(&data[64*n + 4*i]);
 
-    unsigned int i;
-    unsigned int a,b,c,d,e,f,g,h,T1,T2;
-    unsigned int W[64];
+        SHA1_Compress(H, W);
+    }
+}
 
-    Load_32Int_Buffer(p, W);
+/* The function Load_Short_Word returns word i of the padded text of a short message of text_byte_size bytes. Words
+   lying wholly within the text are read directly, the word containing the end of the text is assembled with the
+   delimiter, and the words after it are zero, except the length which is set by the caller.                     */
+
+static inline uint32_t Load_Short_Word(const unsigned char *text, unsigned int text_byte_size, unsigned int i)
+{
+    unsigned int position, j;
+    uint32_t word;
+
+    position = 4*i;
+    if (position + 4 <= text_byte_size)
+        return (uint32_t) text[position] << 24 | (uint32_t) text[position + 1] << 16 |
+               (uint32_t) text[position + 2] << 8 | text[position + 3];
+
+    if (position > text_byte_size)
+        return 0;
+
+    word = 0;
+    for (j = 0; j < 4; j++)
+        word = (word << 8) | (position + j < text_byte_size ? text[position + j] :
+                              position + j == text_byte_size ? DELIMITER : 0);
+    return word;
+}
+
+/* The function SHA1_Hash_Short iterates the SHA1 hash over a whole message of at most SHA1_SHORT_MAX_SIZE (119)
+   bytes followed by its pad, i.e. over one block if the text is at most 55 bytes and over two blocks otherwise. The
+   padded blocks are built word by word directly from the text, without a word pointer or a pad buffer.           */
+
+void SHA1_Hash_Short(unsigned char *text, unsigned int text_byte_size, uint32_t *H)
+{
+    uint32_t W[80];
+    unsigned int nr_of_blocks, n, i;
+
+    nr_of_blocks = (text_byte_size + 9 > 64) ? 2 : 1;
+    Stats_Add(bytes_hashed, text_byte_size);
+
+    for (n = 0; n < nr_of_blocks; n++)
+    {
+        for (i = 0; i < 16; i++)
+            W[i] = Load_Short_Word(text, text_byte_size, 16*n + i);
+        if (n == nr_of_blocks - 1)
+            W[15] = 8*text_byte_size;
+
+        SHA1_Compress(H, W);
+    }
+}
+
+/****************************************************************************************************************/
+
+/* The function SHA256_Iterate_Hash implements the SHA256 hash iteration function. 
+   See the NIST documentation (FIPS PUB 180-4) for details.
+   The round constants are kept in static storage so that they are not rebuilt for every block, and the
+   compression itself is shared with SHA256_Hash_Blocks which hashes whole blocks directly from memory.   */
+
+#define Rot_Left(t, x) (((x) << t) | ((x) >> (32 - t)))
+#define Rot_Right(t, x) (((x) << (32 - t)|((x) >> t)))
+#define Ch(x, y, z) ((x & y) ^ (~x & z))
+#define Parity(x, y, z) (x ^ y ^ z)
+#define Maj(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
+#define Sigma_Maj_0(x) (Rot_Right(2, x) ^ Rot_Right(13, x) ^ Rot_Right(22, x))
+#define Sigma_Maj_1(x) (Rot_Right(6, x) ^ Rot_Right(11, x) ^ Rot_Right(25, x))
+#define Sigma_Min_0(x) (Rot_Right(7, x) ^ Rot_Right(18, x) ^ (x >> 3))
+#define Sigma_Min_1(x) (Rot_Right(17, x) ^ Rot_Right(19, x) ^ (x >> 10))
+
+static const uint32_t SHA256_K[] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/* The function SHA256_Compress applies the SHA256 compression function to the hash H, given a block whose
+   first 16 words have been loaded into W. W must have room for the 64 words of the message schedule.  */
+
+static void SHA256_Compress(uint32_t *H, uint32_t *W)
+{
+    unsigned int i;
+    uint32_t a,b,c,d,e,f,g,h,T1,T2;
 
     for (i = 16; i < 64; i++)
         W[i] = Sigma_Min_1(W[i-2]) + W[i-7] + Sigma_Min_0(W[i-15]) + W[i-16];
@@ -818,7 +1049,7 @@ void SHA256_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
 
     for (i = 0; i < 64; i++)
     {
-        T1 = h + Sigma_Maj_1(e) + Ch(e, f, g) + K[i] + W[i];
+        T1 = h + Sigma_Maj_1(e) + Ch(e, f, g) + SHA256_K[i] + W[i];
         T2 = Sigma_Maj_0(a) + Maj(a, b, c);
         h = g;
         g = f;
@@ -840,24 +1071,270 @@ void SHA256_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
     H[7] = h + H[7];
 }
 
-/*************************************************************************************************************************/
+void SHA256_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H)
+{
+    uint32_t W[64];
 
-/* The function SHA512_Iterate_Hash implements the SHA512 hash iteration function. 
-   See the NIST documentation (FIPS PUB 180-4) for details. */
+    Load_32Int_Buffer(p, W);
+
+    Stats_Start(t);
+    SHA256_Compress(H, W);
+    Stats_Stop(compress_ns, t);
+    Stats_Add(blocks_compressed, 1);
+}
 
+/* The function SHA256_Hash_Blocks_Portable iterates the SHA256 hash over nr_of_blocks consecutive 64-byte blocks
+   starting at data, without going through the word pointer. */
 
-void SHA512_Iterate_Hash(struct sha_word_pointer *p, uint64_t *H)
+void SHA256_Hash_Blocks_Portable(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H)
 {
+    uint64_t n;
+    unsigned int i;
+    uint32_t W[64];
 
-#define Sigma_512_0(x)  (((x << (64 - 28))|(x >> 28)) ^ ((x << (64 - 34))|(x >> 34)) ^ ((x << (64 - 39))|(x >> 39)))
-#define Sigma_512_1(x)  (((x << (64 - 14))|(x >> 14)) ^ ((x << (64 - 18))|(x >> 18)) ^ ((x << (64 - 41))|(x >> 41)))
-#define Sigma_512_2(x)  (((x << (64 - 1))|(x >> 1)) ^ ((x << (64 - 8))|(x >> 8)) ^ (x >> 7))
-#define Sigma_512_3(x)  (((x << (64 - 19))|(x >> 19)) ^ ((x << (64 - 61))|(x >> 61)) ^ (x >> 6))
-#define Ch(x, y, z) ((x & y) ^ (~x & z))
-#define Parity(x, y, z) (x ^ y ^ z)
-#define Maj(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
+    for (n = 0; n < nr_of_blocks; n++)
+    {
+        for (i = 0; i < 16; i++)
+            W[i] = Conv_Word_To_32Int(&data[64*n + 4*i]);
 
-const uint64_t K[80] = {
+        SHA256_Compress(H, W);
+    }
+}
+
+#ifdef SHA_X86
+
+/* The function SHA256_Hash_Blocks_SHANI does the same as SHA256_Hash_Blocks_Portable using the x86 SHA extensions,
+   which the caller must have checked through SHA256_Set_Kernel or SHA256_Get_Kernel. The hash is kept in the ABEF/CDGH register layout expected by the sha256rnds2 instruction while iterating.     */
+
+#define SHANI_Rounds(i, M)                                                          \
+{                                                                                   \
+    MSG = _mm_add_epi32(M, _mm_loadu_si128((const __m128i*) &SHA256_K[4*(i)]));     \
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);                            \
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);                                             \
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);                            \
+}
+
+#define SHANI_Schedule(M4, M3, M2, M1)                                              \
+    M4 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(M4, M3), _mm_alignr_epi8(M1, M2, 4)), M1);
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void SHA256_Hash_Blocks_SHANI(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H)
+{
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i STATE0, STATE1, ABEF_SAVE, CDGH_SAVE, MSG, TMP, M0, M1, M2, M3;
+    uint64_t n;
+    unsigned int i;
+
+    /* Convert the hash from ABCD/EFGH to the ABEF/CDGH layout */
+
+    TMP = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &H[0]), 0xB1);
+    STATE1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &H[4]), 0x1B);
+    STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);
+
+    for (n = 0; n < nr_of_blocks; n++)
+    {
+        ABEF_SAVE = STATE0;
+        CDGH_SAVE = STATE1;
+
+        M0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &data[64*n]), MASK);
+        M1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &data[64*n + 16]), MASK);
+        M2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &data[64*n + 32]), MASK);
+        M3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &data[64*n + 48]), MASK);
+
+        SHANI_Rounds(0, M0);
+        SHANI_Rounds(1, M1);
+        SHANI_Rounds(2, M2);
+        SHANI_Rounds(3, M3);
+
+        for (i = 4; i < 16; i += 4)
+        {
+            SHANI_Schedule(M0, M1, M2, M3);
+            SHANI_Rounds(i, M0);
+            SHANI_Schedule(M1, M2, M3, M0);
+            SHANI_Rounds(i + 1, M1);
+            SHANI_Schedule(M2, M3, M0, M1);
+            SHANI_Rounds(i + 2, M2);
+            SHANI_Schedule(M3, M0, M1, M2);
+            SHANI_Rounds(i + 3, M3);
+        }
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    }
+
+    /* Convert the hash back to the ABCD/EFGH layout */
+
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);
+    _mm_storeu_si128((__m128i*) &H[0], _mm_blend_epi16(TMP, STATE1, 0xF0));
+    _mm_storeu_si128((__m128i*) &H[4], _mm_alignr_epi8(STATE1, TMP, 8));
+}
+
+#undef SHANI_Rounds
+#undef SHANI_Schedule
+
+#else
+
+/* Without the SHA extensions the SHA-NI entry point falls back on the portable kernel */
+
+void SHA256_Hash_Blocks_SHANI(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H)
+{
+    SHA256_Hash_Blocks_Portable(data, nr_of_blocks, H);
+}
+
+#endif
+
+/* The function Has_SHA_Extensions checks once through CPUID whether the processor supports the SHA extensions
+   together with the SSSE3 and SSE4.1 instructions used alongside them. The probe is run by Probe_SHA_Extensions under
+   pthread_once, so that threads making their first call at the same time see it completed */
+
+static int has_sha = FALSE;
+static pthread_once_t has_sha_once = PTHREAD_ONCE_INIT;
+
+static void Probe_SHA_Extensions(void)
+{
+#ifdef SHA_X86
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) && (ecx & bit_SSE4_1) &&
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA))
+        has_sha = TRUE;
+#endif
+}
+
+static int Has_SHA_Extensions(void)
+{
+    pthread_once(&has_sha_once, Probe_SHA_Extensions);
+    return has_sha;
+}
+
+/* The kernel used by SHA256_Hash_Blocks, as set by SHA256_Set_Kernel */
+
+static int sha256_kernel = SHA_KERNEL_AUTO;
+
+/* The function SHA256_Set_Kernel forces SHA256_Hash_Blocks to use the given kernel, or lets it choose the fastest
+   available one again if kernel is SHA_KERNEL_AUTO. EXIT_FAILURE is returned if the kernel is not available.  */
+
+int SHA256_Set_Kernel(int kernel)
+{
+    if (kernel != SHA_KERNEL_AUTO && kernel != SHA_KERNEL_PORTABLE && kernel != SHA_KERNEL_SHANI)
+        return EXIT_FAILURE;
+
+    if (kernel == SHA_KERNEL_SHANI && !Has_SHA_Extensions())
+        return EXIT_FAILURE;
+
+    sha256_kernel = kernel;
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA256_Get_Kernel returns the kernel currently used by SHA256_Hash_Blocks */
+
+int SHA256_Get_Kernel(void)
+{
+    if (sha256_kernel != SHA_KERNEL_AUTO)
+        return sha256_kernel;
+
+    return Has_SHA_Extensions() ? SHA_KERNEL_SHANI : SHA_KERNEL_PORTABLE;
+}
+
+/* The function SHA256_Kernel_Available returns TRUE if the given kernel can be used on this processor */
+
+int SHA256_Kernel_Available(int kernel)
+{
+    return kernel == SHA_KERNEL_PORTABLE || (kernel == SHA_KERNEL_SHANI && Has_SHA_Extensions());
+}
+
+/* The largest message size in bytes of each size class. The last class has no limit. */
+
+static const uint64_t size_class_limits[SHA_SIZE_CLASSES] = {64, 1024, 16384, UINT64_MAX};
+
+/* The function SHA_Size_Class returns the size class of a message of byte_size bytes */
+
+unsigned int SHA_Size_Class(uint64_t byte_size)
+{
+    unsigned int size_class = 0;
+
+    while (byte_size > size_class_limits[size_class])
+        size_class++;
+
+    return size_class;
+}
+
+/* The function SHA_Size_Class_Limit returns the largest message size in bytes of the given size class */
+
+uint64_t SHA_Size_Class_Limit(unsigned int size_class)
+{
+    return size_class < SHA_SIZE_CLASSES ? size_class_limits[size_class] : UINT64_MAX;
+}
+
+/* The kernels used by SHA256_Hash_Blocks for each size class while sha256_kernel is SHA_KERNEL_AUTO, as set by
+   SHA256_Set_Size_Kernel */
+
+static int sha256_size_kernels[SHA_SIZE_CLASSES] = {SHA_KERNEL_AUTO, SHA_KERNEL_AUTO, SHA_KERNEL_AUTO, SHA_KERNEL_AUTO};
+
+/* The function SHA256_Set_Size_Kernel sets the kernel used for runs of blocks in the given size class, or lets
+   SHA256_Hash_Blocks choose as for the other classes if the kernel is SHA_KERNEL_AUTO. A kernel forced through
+   SHA256_Set_Kernel takes precedence. */
+
+int SHA256_Set_Size_Kernel(unsigned int size_class, int kernel)
+{
+    if (size_class >= SHA_SIZE_CLASSES)
+        return EXIT_FAILURE;
+
+    if (kernel != SHA_KERNEL_AUTO && kernel != SHA_KERNEL_PORTABLE && kernel != SHA_KERNEL_SHANI)
+        return EXIT_FAILURE;
+
+    if (kernel == SHA_KERNEL_SHANI && !Has_SHA_Extensions())
+        return EXIT_FAILURE;
+
+    sha256_size_kernels[size_class] = kernel;
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA256_Get_Size_Kernel returns the kernel currently used by SHA256_Hash_Blocks for runs of blocks
+   in the given size class */
+
+int SHA256_Get_Size_Kernel(unsigned int size_class)
+{
+    if (sha256_kernel == SHA_KERNEL_AUTO && size_class < SHA_SIZE_CLASSES && sha256_size_kernels[size_class] != SHA_KERNEL_AUTO)
+        return sha256_size_kernels[size_class];
+
+    return SHA256_Get_Kernel();
+}
+
+/* The function SHA256_Hash_Blocks iterates the SHA256 hash over nr_of_blocks consecutive 64-byte blocks
+   starting at data, using the SHA extensions of the processor when they are available, unless another kernel
+   has been set for the size class of the run of blocks. */
+
+void SHA256_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H)
+{
+    Stats_Start(t);
+
+#ifdef SHA_X86
+    if (SHA256_Get_Size_Kernel(SHA_Size_Class(nr_of_blocks*64)) == SHA_KERNEL_SHANI)
+        SHA256_Hash_Blocks_SHANI(data, nr_of_blocks, H);
+    else
+#endif
+        SHA256_Hash_Blocks_Portable(data, nr_of_blocks, H);
+
+    Stats_Stop(compress_ns, t);
+    Stats_Add(blocks_compressed, nr_of_blocks);
+}
+
+#undef Rot_Left
+#undef Rot_Right
+#undef Ch
+#undef Parity
+#undef Maj
+#undef Sigma_Maj_0
+#undef Sigma_Maj_1
+#undef Sigma_Min_0
+#undef Sigma_Min_1
+
+/*************************************************************************************************************************/
+
+static const uint64_t SHA512_K[80] = {
 
     0x428A2F98D728AE22,  0x7137449123EF65CD,
     0xB5C0FBCFEC4D3B2F,  0xE9B5DBA58189DBBC,
@@ -900,10 +1377,26 @@ const uint64_t K[80] = {
     0x4CC5D4BECB3E42B6,  0x597F299CFC657E2A,
     0x5FCB6FAB3AD6FAEC,  0x6C44198C4A475817 };
 
+/* The function SHA512_Compress implements the SHA512 compression function, given a block whose first 16 words
+   have been loaded into W. W must have room for the 80 words of the message schedule.
+   See the NIST documentation (FIPS PUB 180-4) for details. */
+
+
+void SHA512_Compress(uint64_t *H, uint64_t *W)
+{
+
+#define Sigma_512_0(x)  (((x << (64 - 28))|(x >> 28)) ^ ((x << (64 - 34))|(x >> 34)) ^ ((x << (64 - 39))|(x >> 39)))
+#define Sigma_512_1(x)  (((x << (64 - 14))|(x >> 14)) ^ ((x << (64 - 18))|(x >> 18)) ^ ((x << (64 - 41))|(x >> 41)))
+#define Sigma_512_2(x)  (((x << (64 - 1))|(x >> 1)) ^ ((x << (64 - 8))|(x >> 8)) ^ (x >> 7))
+#define Sigma_512_3(x)  (((x << (64 - 19))|(x >> 19)) ^ ((x << (64 - 61))|(x >> 61)) ^ (x >> 6))
+#define Ch(x, y, z) ((x & y) ^ (~x & z))
+#define Parity(x, y, z) (x ^ y ^ z)
+#define Maj(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
+
     int i;
-    uint64_t a, b, c, d, e, f, g, h, T1, T2, W[80];
+    uint64_t a, b, c, d, e, f, g, h, T1, T2;
 
-    Load_64Int_Buffer(p, W);
+    Stats_Start(t);
 
     for (i = 16; i < 80; i++)
         W[i] = Sigma_512_3(W[i-2]) + W[i-7] + Sigma_512_2(W[i-15]) + W[i-16];
@@ -919,7 +1412,7 @@ const uint64_t K[80] = {
 
     for (i = 0; i < 80; i++)
     {
-        T1 = h + Sigma_512_1(e) + Ch(e, f, g) + K[i] + W[i];
+        T1 = h + Sigma_512_1(e) + Ch(e, f, g) + SHA512_K[i] + W[i];
         T2 = Sigma_512_0(a) + Maj(a, b, c);
         h = g;
         g = f;
@@ -939,4 +1432,36 @@ const uint64_t K[80] = {
     H[5] = f + H[5];
     H[6] = g + H[6];
     H[7] = h + H[7];
+
+    Stats_Stop(compress_ns, t);
+    Stats_Add(blocks_compressed, 1);
+}
+
+/* The function SHA512_Iterate_Hash implements the SHA512 hash iteration function: it loads the next block of the
+   word pointer and compresses it into the hash H */
+
+void SHA512_Iterate_Hash(struct sha_word_pointer *p, uint64_t *H)
+{
+    uint64_t W[80];
+
+    Load_64Int_Buffer(p, W);
+    SHA512_Compress(H, W);
+}
+
+/* The function SHA512_Hash_Blocks iterates the SHA512 hash over nr_of_blocks consecutive 128-byte blocks
+   starting at data, without going through the word pointer. */
+
+void SHA512_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint64_t *H)
+{
+    uint64_t n;
+    unsigned int i;
+    uint64_t W[80];
+
+    for (n = 0; n < nr_of_blocks; n++)
+    {
+        for (i = 0; i < 16; i++)
+            W[i] = Conv_Word_To_64Int(&data[128*n + 8*i]);
+
+        SHA512_Compress(H, W);
+    }
 }
@@ -10,6 +10,18 @@
 #ifndef __SHALIB__
 #define __SHALIB__
 
+/* Kernels that can be used to iterate the hash over whole blocks. With SHA_KERNEL_AUTO the fastest kernel
+   available on the processor is chosen at run time */
+
+#define SHA_KERNEL_AUTO 0
+#define SHA_KERNEL_PORTABLE 1
+#define SHA_KERNEL_SHANI 2
+
+/* Classes of message sizes for which different kernels can be chosen, e.g. by the autotuner of shatune.c: messages
+   of at most 64 bytes, 1 KiB, 16 KiB and larger messages */
+
+#define SHA_SIZE_CLASSES 4
+
 /* The sha_word_pointer defines a pointer type that acts as a virtual concatenation between the char arrays to be hashed 
    and the pad, or alternatively the file to be hashed and the pad */ 
 
@@ -36,10 +48,31 @@ struct sha_word_pointer
     int is_in_pad;                            /* specifies whether the pointer is in the pad or not                         */
 };
 
+/* The sha_stats holds the per-thread counters kept when the library is compiled with SHA_STATS defined */
+
+struct sha_stats
+{
+    uint64_t bytes_hashed;                    /* message bytes hashed, excluding the pad                                    */
+    uint64_t blocks_compressed;               /* blocks passed through a compression function                               */
+    uint64_t fast_path_blocks;                /* blocks loaded word-wise directly from a string or with one file read       */
+    uint64_t slow_path_blocks;                /* blocks assembled byte by byte because they straddle a string edge or pad   */
+    uint64_t pad_blocks;                      /* blocks containing (part of) the pad                                        */
+    uint64_t file_read_calls;                 /* calls to fread and fgetc                                                   */
+    uint64_t compress_ns;                     /* nanoseconds spent in the compression functions                             */
+    uint64_t io_ns;                           /* nanoseconds spent reading files                                            */
+};
+
+int SHA_Stats_Snapshot(struct sha_stats *s);
+
+void SHA_Stats_Reset(void);
+
+
 void Set_Zero(struct sha_word_pointer *p);
 
 void Set_Pad(struct sha_word_pointer *p, unsigned char *pad, uint64_t text_byte_size, unsigned int BLOCK_SIZE);
 
+uint64_t Get_Bulk_Blocks(struct sha_word_pointer *p, unsigned char **data, unsigned int BLOCK_SIZE);
+
 
 void Conv_32Int_To_Word(uint32_t i, char *a);
 
@@ -47,6 +80,8 @@ uint32_t Conv_Word_To_32Int(unsigned char *a);
 
 void Set_64Byte_Pad(struct sha_word_pointer *p, unsigned char *pad, uint64_t text_byte_size);
 
+unsigned int Set_64Byte_Final_Blocks(unsigned char *blocks, unsigned char *tail, unsigned int tail_byte_size, uint64_t text_byte_size);
+
 void Load_String_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W);
 
 void Load_File_32Int_Buffer(struct sha_word_pointer *p, uint32_t* W);
@@ -67,12 +102,44 @@ void Load_File_64Int_Buffer(struct sha_word_pointer *p, uint64_t* W);
 void Load_64Int_Buffer(struct sha_word_pointer *p, uint64_t* W);
 
 
+void SHA1_Compress(uint32_t *H, uint32_t *W);
+
 void SHA1_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H);
 
+void SHA1_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+
+#define SHA1_SHORT_MAX_SIZE 119              /* the largest text hashed by SHA1_Hash_Short, i.e. two blocks less the pad   */
+
+void SHA1_Hash_Short(unsigned char *text, unsigned int text_byte_size, uint32_t *H);
+
 void SHA256_Iterate_Hash(struct sha_word_pointer *p, uint32_t *H);
 
+void SHA256_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+
+void SHA256_Hash_Blocks_Portable(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+
+void SHA256_Hash_Blocks_SHANI(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+
+int SHA256_Set_Kernel(int kernel);
+
+int SHA256_Get_Kernel(void);
+
+int SHA256_Kernel_Available(int kernel);
+
+unsigned int SHA_Size_Class(uint64_t byte_size);
+
+uint64_t SHA_Size_Class_Limit(unsigned int size_class);
+
+int SHA256_Set_Size_Kernel(unsigned int size_class, int kernel);
+
+int SHA256_Get_Size_Kernel(unsigned int size_class);
+
+void SHA512_Compress(uint64_t *H, uint64_t *W);
+
 void SHA512_Iterate_Hash(struct sha_word_pointer *p, uint64_t *H);
 
+void SHA512_Hash_Blocks(unsigned char *data, uint64_t nr_of_blocks, uint64_t *H);
+
 void HMAC32(char *key, unsigned int key_size, char *text, uint64_t text_size, uint32_t *digest, void (*SHA)(char *text, uint64_t text_byte_size, uint32_t *hash), void (*SHA_Concat)(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint32_t *hash), unsigned int HASH_SIZE);
 
 void HMAC64(char *key, unsigned int key_size, char *text, uint64_t text_size, uint64_t *digest, void (*SHA)(char *text, uint64_t text_byte_size, uint64_t *hash), void (*SHA_Concat)(char **strings, uint64_t nr_of_strings, uint64_t *strings_byte_size, uint64_t *hash), unsigned int HASH_SIZE);
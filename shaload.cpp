@@ -0,0 +1,178 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaload.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-15
+ *
+ * CONTENT: Load generator of the hashing daemon shad. Each client runs in a thread of its own with its own connection and
+ *          ring, exactly as separate processes would, and keeps a number of requests in flight. Every reply is checked
+ *          against a locally computed hash. The throughput and the round trip latency are written as JSON to standard
+ *          output.
+ *
+ *          Usage: shaload [--socket PATH] [--clients N] [--depth N] [--size BYTES] [--seconds S]
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "sha1.h"
+#include "shaproto.h"
+#include "shaclient.h"
+
+#define HASH_SIZE 5
+
+static uint64_t Read_Nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+/* The results of one client */
+
+struct Client_Result
+{
+    int failed;
+    uint64_t requests;
+    std::vector<double> latencies_us;
+};
+
+/* The function Run_Client sends requests until the end time and records the round trip of each */
+
+static void Run_Client(const char *socket_path, uint32_t depth, uint32_t size, uint64_t end_ns, Client_Result *result)
+{
+    struct sha_client client;
+    std::vector<uint64_t> sent_ns(depth);
+    uint32_t reference[HASH_SIZE];
+    uint32_t hash[HASH_SIZE];
+    uint32_t slot, i;
+    uint64_t in_flight = 0;
+    std::vector<char> text(size);
+
+    result->failed = 0;
+    result->requests = 0;
+
+    for (i = 0; i < size; i++)
+        text[i] = (char) (i*2654435761u >> 24);
+    SHA1(size > 0 ? &text[0] : NULL, size, reference);
+
+    if (SHA_Client_Open(&client, socket_path, depth, size) != EXIT_SUCCESS)
+    {
+        result->failed = 1;
+        return;
+    }
+
+    for (;;)
+    {
+        /* Refill every free slot while the time lasts, then collect one reply */
+
+        while (Read_Nanoseconds() < end_ns && SHA_Client_Acquire(&client, &slot) == EXIT_SUCCESS)
+        {
+            if (size > 0)
+                memcpy(SHA_Client_Payload(&client, slot), &text[0], size);
+            sent_ns[slot] = Read_Nanoseconds();
+            if (SHA_Client_Submit(&client, slot, size) != EXIT_SUCCESS)
+            {
+                result->failed = 1;
+                SHA_Client_Close(&client);
+                return;
+            }
+            in_flight++;
+        }
+
+        if (in_flight == 0)
+            break;
+
+        if (SHA_Client_Wait(&client, &slot, hash) != EXIT_SUCCESS || memcmp(hash, reference, sizeof(hash)) != 0)
+        {
+            result->failed = 1;
+            break;
+        }
+        result->latencies_us.push_back((Read_Nanoseconds() - sent_ns[slot])/1000.0);
+        result->requests++;
+        in_flight--;
+    }
+
+    SHA_Client_Close(&client);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socket_path = SHA_SERVER_DEFAULT_PATH;
+    uint32_t nr_of_clients = 4, depth = 16, size = 64;
+    double seconds = 2;
+    std::vector<std::thread> threads;
+    std::vector<Client_Result> results;
+    std::vector<double> latencies_us;
+    uint64_t start_ns, end_ns, requests = 0;
+    double elapsed_s, sum_us = 0;
+    int failed = 0;
+    uint32_t i;
+
+    for (i = 1; i < (uint32_t) argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < (uint32_t) argc)
+            socket_path = argv[++i];
+        else if (strcmp(argv[i], "--clients") == 0 && i + 1 < (uint32_t) argc)
+            nr_of_clients = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < (uint32_t) argc)
+            depth = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < (uint32_t) argc)
+            size = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < (uint32_t) argc)
+            seconds = strtod(argv[++i], NULL);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--socket PATH] [--clients N] [--depth N] [--size BYTES] [--seconds S]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (nr_of_clients == 0 || depth == 0)
+    {
+        fprintf(stderr, "The number of clients and the depth must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    results.resize(nr_of_clients);
+    start_ns = Read_Nanoseconds();
+    end_ns = start_ns + (uint64_t) (seconds*1e9);
+
+    for (i = 0; i < nr_of_clients; i++)
+        threads.push_back(std::thread(Run_Client, socket_path, depth, size, end_ns, &results[i]));
+    for (i = 0; i < nr_of_clients; i++)
+        threads[i].join();
+
+    elapsed_s = (Read_Nanoseconds() - start_ns)/1e9;
+
+    for (i = 0; i < nr_of_clients; i++)
+    {
+        failed |= results[i].failed;
+        requests += results[i].requests;
+        latencies_us.insert(latencies_us.end(), results[i].latencies_us.begin(), results[i].latencies_us.end());
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    for (i = 0; i < latencies_us.size(); i++)
+        sum_us += latencies_us[i];
+
+    if (failed)
+        fprintf(stderr, "A client failed: the daemon could not be reached or returned a wrong hash\n");
+
+    printf("{\"clients\": %u, \"depth\": %u, \"size\": %u, \"seconds\": %.3f, \"requests\": %llu, "
+           "\"requests_per_s\": %.0f, \"mb_per_s\": %.1f, \"mean_latency_us\": %.1f, \"p99_latency_us\": %.1f}\n",
+           nr_of_clients, depth, size, elapsed_s, (unsigned long long) requests, requests/elapsed_s,
+           requests*(double) size/elapsed_s/1e6, latencies_us.empty() ? 0 : sum_us/latencies_us.size(),
+           latencies_us.empty() ? 0 : latencies_us[(size_t) (0.99*(latencies_us.size() - 1))]);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shanodes.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-02
+ *
+ * CONTENT: The example program shanodes for the NUMA-aware worker pool of shanuma.h. Hashes every file given on a
+ *          SHA_NUMA_Pool and prints one line per file in the format of sha1sum or sha256sum. Without files it instead
+ *          hashes --texts texts of --size bytes placed in the arenas of the nodes in turn, --rounds times. The
+ *          statistics of every node are written as JSON to standard error.
+ *
+ *          The topology of the machine is used unless --simulate gives a number of made-up nodes among which the
+ *          processors are divided, so that the scheduling per node can be tried on a machine of a single node.
+ *
+ *          Usage: shanodes [--simulate NODES] [--workers N] [--sha256] [--texts N] [--size BYTES] [--rounds N] [FILE...]
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "shanuma.h"
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--simulate NODES] [--workers N] [--sha256] [--texts N] [--size BYTES] [--rounds N] [FILE...]\n",
+            program);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> files;
+    unsigned int nr_of_nodes = 0, nr_of_workers = 0, nr_of_rounds = 10;
+    uint64_t nr_of_texts = 65536, size = 1024, failed = 0;
+    bool sha256 = false;
+    struct timespec start, end;
+    double seconds;
+    size_t i;
+
+    for (i = 1; i < (size_t) argc; i++)
+    {
+        if (strcmp(argv[i], "--simulate") == 0 && i + 1 < (size_t) argc)
+            nr_of_nodes = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < (size_t) argc)
+            nr_of_workers = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--texts") == 0 && i + 1 < (size_t) argc)
+            nr_of_texts = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < (size_t) argc)
+            size = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < (size_t) argc)
+            nr_of_rounds = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--sha256") == 0)
+            sha256 = true;
+        else if (argv[i][0] != '-')
+            files.push_back(argv[i]);
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (size == 0 || size > SHA_NUMA_BUFFER_SIZE || nr_of_texts == 0)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    SHA_NUMA_Topology topology = nr_of_nodes > 0 ? SHA_NUMA_Topology::Simulate(nr_of_nodes) : SHA_NUMA_Topology::Detect();
+    uint64_t texts_per_buffer = SHA_NUMA_BUFFER_SIZE/size;
+    uint64_t buffers_per_node = (nr_of_texts + texts_per_buffer*topology.nodes.size() - 1)/(texts_per_buffer*topology.nodes.size());
+    SHA_NUMA_Pool pool(topology, nr_of_workers, SHA_NUMA_BUFFER_SIZE, files.empty() ? (unsigned int) buffers_per_node : 0);
+    std::vector<SHA_NUMA_Pool::File_Digest> digests;
+    std::vector<char*> texts, buffers;
+    std::vector<uint64_t> texts_byte_size;
+    std::vector<uint32_t> hashes;
+
+    /* Place the texts in the arenas, a buffer of each node in turn */
+
+    if (files.empty())
+    {
+        for (uint64_t b = 0; b < buffers_per_node*pool.Nr_Of_Nodes(); b++)
+        {
+            char *buffer = (char*) pool.Allocate((unsigned int) (b % pool.Nr_Of_Nodes()));
+
+            if (buffer == NULL)
+            {
+                fprintf(stderr, "%s: the arenas could not be mapped\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+            for (uint64_t j = 0; j < SHA_NUMA_BUFFER_SIZE; j++)
+                buffer[j] = (char) (j*2654435761u >> 24);
+            buffers.push_back(buffer);
+        }
+        for (uint64_t t = 0; t < nr_of_texts; t++)
+        {
+            texts.push_back(buffers[t/texts_per_buffer] + size*(t % texts_per_buffer));
+            texts_byte_size.push_back(size);
+        }
+        hashes.resize(5*nr_of_texts);
+    }
+
+    pool.Reset_Stats();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (files.empty())
+        for (unsigned int r = 0; r < nr_of_rounds; r++)
+            pool.Hash_Batch(texts.data(), texts_byte_size.data(), nr_of_texts, hashes.data());
+    else
+        pool.Hash_Files(files, sha256, &digests);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9;
+
+    for (i = 0; i < digests.size(); i++)
+    {
+        if (digests[i].status != EXIT_SUCCESS)
+        {
+            fprintf(stderr, "%s: %s: cannot be read\n", argv[0], files[i].c_str());
+            failed++;
+            continue;
+        }
+
+        for (unsigned int w = 0; w < (sha256 ? 8u : 5u); w++)
+            printf("%08x", digests[i].hash[w]);
+        printf("  %s\n", files[i].c_str());
+    }
+    fflush(stdout);
+
+    fprintf(stderr, "{\"simulated\": %s, \"seconds\": %.3f, \"nodes\": [", topology.simulated ? "true" : "false", seconds);
+    for (unsigned int k = 0; k < pool.Nr_Of_Nodes(); k++)
+    {
+        SHA_NUMA_Pool::Node_Stats stats = pool.Stats(k);
+
+        fprintf(stderr, "%s\n    {\"node\": %u, \"id\": %d, \"workers\": %u, \"jobs\": %llu, \"bytes\": %llu, \"busy_seconds\": %.3f, "
+                        "\"mb_per_s\": %.1f, \"huge_pages\": %s, \"bound\": %s}",
+                k > 0 ? "," : "", k, stats.id, stats.nr_of_workers, (unsigned long long) stats.jobs,
+                (unsigned long long) stats.bytes, stats.busy_seconds, stats.mb_per_s, stats.huge_pages ? "true" : "false",
+                stats.bound ? "true" : "false");
+    }
+    fprintf(stderr, "]}\n");
+
+    for (char *buffer : buffers)
+        pool.Release(buffer);
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,717 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shanuma.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-02
+ *
+ * CONTENT: Implements the NUMA-aware worker pool of shanuma.h. On machines of several sockets, a thread hashing memory
+ *          attached to another socket reads every byte over the interconnect between them. The pool therefore keeps
+ *          the workers of each node pinned to the processors of that node and a queue of jobs per node, and work on a
+ *          buffer is queued to the node owning the buffer. Files are read by the workers of every node into buffers of
+ *          an arena of their own node, so that the data is both written and hashed in local memory.
+ *
+ *          An arena is a single mapping of explicit huge pages when the system has them reserved, and otherwise of
+ *          ordinary pages for which transparent huge pages are requested, which saves the misses of the TLB when
+ *          streaming through large buffers. The mapping is bound to its node with mbind before it is first touched.
+ *          The system calls mbind and get_mempolicy are made directly, so that libnuma is not needed.
+ *
+ *          The topology is read from /sys/devices/system/node. SHA_NUMA_Topology::Simulate divides the processors
+ *          among made-up nodes instead, whose arenas are not bound, so that the scheduling and the statistics per node
+ *          can be exercised and measured on a machine of a single node.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+
+#include "shalib.h"
+#include "shabatch.h"
+#include "shahasher.h"
+#include "shanuma.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#endif
+
+#define HASH_SIZE 5         /* defines the size of the SHA1 hash in number of 32-bit INTEGERS           */
+#define BATCH_TEXTS 4096    /* defines the largest number of texts of a job of Hash_Batch               */
+#define NODE_DIRECTORY "/sys/devices/system/node"
+
+
+static uint64_t Nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: TOPOLOGY
+ *
+ **************************************************************************************************************************************/
+
+/* The function Allowed_CPUs returns the processors the calling process may run on */
+
+static std::vector<int> Allowed_CPUs()
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+    }
+
+    if (cpus.empty())
+        cpus.push_back(0);
+
+    return cpus;
+}
+
+/* The function Parse_CPU_List returns the processors of a list in the format of sysfs, e.g. "0-3,8-11" */
+
+static std::vector<int> Parse_CPU_List(const char *text)
+{
+    std::vector<int> cpus;
+    char *end;
+    long first, last;
+
+    while (*text >= '0' && *text <= '9')
+    {
+        first = last = strtol(text, &end, 10);
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+        for (long cpu = first; cpu <= last; cpu++)
+            cpus.push_back((int) cpu);
+        text = *end == ',' ? end + 1 : end;
+    }
+
+    return cpus;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Topology::Detect
+ *
+ * PURPOSE: Reads the nodes of the machine and their processors from sysfs, keeping the processors the process may run on.
+ *          Nodes without such processors, e.g. of memory alone, are left out. Without sysfs, or on a kernel without NUMA,
+ *          the result is a single simulated node of every processor.
+ *
+ * RETURN VALUE : SHA_NUMA_Topology
+ *
+ *********************************************************************************************************************************/
+
+SHA_NUMA_Topology SHA_NUMA_Topology::Detect()
+{
+    SHA_NUMA_Topology topology;
+    std::vector<int> allowed = Allowed_CPUs();
+    struct dirent *entry;
+    char path[256], list[4096];
+    DIR *directory;
+    FILE *fp;
+    int id;
+
+    topology.simulated = false;
+
+    if ((directory = opendir(NODE_DIRECTORY)) != NULL)
+    {
+        while ((entry = readdir(directory)) != NULL)
+        {
+            if (sscanf(entry->d_name, "node%d", &id) != 1)
+                continue;
+
+            snprintf(path, sizeof(path), NODE_DIRECTORY "/node%d/cpulist", id);
+            if ((fp = fopen(path, "r")) == NULL)
+                continue;
+            if (fgets(list, sizeof(list), fp) != NULL)
+            {
+                SHA_NUMA_Node node;
+
+                node.id = id;
+                for (int cpu : Parse_CPU_List(list))
+                    if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                        node.cpus.push_back(cpu);
+                if (!node.cpus.empty())
+                    topology.nodes.push_back(node);
+            }
+            fclose(fp);
+        }
+        closedir(directory);
+    }
+
+    if (topology.nodes.empty())
+        return Simulate(1);
+
+    std::sort(topology.nodes.begin(), topology.nodes.end(),
+              [](const SHA_NUMA_Node &a, const SHA_NUMA_Node &b) { return a.id < b.id; });
+
+    return topology;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Topology::Simulate
+ *
+ * PURPOSE: Makes up a topology of nr_of_nodes nodes, each of a contiguous share of the processors the process may run on.
+ *          With fewer processors than nodes the processors are shared by the nodes in turn.
+ *
+ * RETURN VALUE : SHA_NUMA_Topology
+ *
+ *********************************************************************************************************************************/
+
+SHA_NUMA_Topology SHA_NUMA_Topology::Simulate(unsigned int nr_of_nodes)
+{
+    SHA_NUMA_Topology topology;
+    std::vector<int> allowed = Allowed_CPUs();
+    size_t n = allowed.size();
+
+    topology.simulated = true;
+    nr_of_nodes = std::max(1u, nr_of_nodes);
+
+    for (unsigned int k = 0; k < nr_of_nodes; k++)
+    {
+        SHA_NUMA_Node node;
+
+        node.id = -1;
+        if (n >= nr_of_nodes)
+            node.cpus.assign(allowed.begin() + k*n/nr_of_nodes, allowed.begin() + (k + 1)*n/nr_of_nodes);
+        else
+            node.cpus.push_back(allowed[k % n]);
+        topology.nodes.push_back(node);
+    }
+
+    return topology;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: ARENAS
+ *
+ **************************************************************************************************************************************/
+
+/* The function Bind_To_Node binds the pages of a mapping not yet touched to a node */
+
+static bool Bind_To_Node(void *base, size_t size, int node_id)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    std::vector<unsigned long> mask(node_id/(8*sizeof(unsigned long)) + 1, 0);
+
+    mask[node_id/(8*sizeof(unsigned long))] |= 1ul << (node_id % (8*sizeof(unsigned long)));
+    return syscall(SYS_mbind, base, size, MPOL_BIND, mask.data(), 8*sizeof(unsigned long)*mask.size() + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Arena::SHA_NUMA_Arena
+ *
+ * PURPOSE: Maps the memory of nr_of_buffers buffers, rounded up to whole huge pages, binds it to the node if node_id is
+ *          not negative and touches every page so that the memory is allocated up front. If the memory cannot be mapped,
+ *          Allocate always returns nullptr.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * node_id             int             I       the number of the node in the kernel, or -1 to leave the memory unbound
+ * buffer_size         size_t          I       the size in bytes of every buffer
+ * nr_of_buffers       unsigned int    I       the number of buffers
+ *
+ *********************************************************************************************************************************/
+
+SHA_NUMA_Arena::SHA_NUMA_Arena(int node_id, size_t buffer_size, unsigned int nr_of_buffers)
+    : huge_pages(false), bound(false), base(nullptr), mapped_size(0), buffer_size(buffer_size)
+{
+    void *p = MAP_FAILED;
+
+    mapped_size = (buffer_size*nr_of_buffers + SHA_NUMA_HUGE_PAGE_SIZE - 1)/SHA_NUMA_HUGE_PAGE_SIZE*SHA_NUMA_HUGE_PAGE_SIZE;
+    if (mapped_size == 0)
+        return;
+
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages = p != MAP_FAILED;
+#endif
+    if (p == MAP_FAILED)
+    {
+        p = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return;
+#ifdef MADV_HUGEPAGE
+        madvise(p, mapped_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    base = (unsigned char*) p;
+    if (node_id >= 0)
+        bound = Bind_To_Node(base, mapped_size, node_id);
+    memset(base, 0, mapped_size);
+
+    for (unsigned int i = nr_of_buffers; i > 0; i--)
+        free_buffers.push_back(base + (i - 1)*buffer_size);
+}
+
+SHA_NUMA_Arena::~SHA_NUMA_Arena()
+{
+    if (base != nullptr)
+        munmap(base, mapped_size);
+}
+
+/* The function Allocate returns a free buffer of the arena, or nullptr if every buffer is in use */
+
+unsigned char *SHA_NUMA_Arena::Allocate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned char *buffer;
+
+    if (free_buffers.empty())
+        return nullptr;
+
+    buffer = free_buffers.back();
+    free_buffers.pop_back();
+    return buffer;
+}
+
+void SHA_NUMA_Arena::Release(void *buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    free_buffers.push_back((unsigned char*) buffer);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: POOL
+ *
+ **************************************************************************************************************************************/
+
+/* A Countdown lets the caller of Hash_Batch or Hash_Files wait for its own jobs alone */
+
+struct Countdown
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    uint64_t remaining;
+
+    explicit Countdown(uint64_t count) : remaining(count) {}
+
+    void Count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--remaining == 0)
+            done.notify_all();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return remaining == 0; });
+    }
+};
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Pool::SHA_NUMA_Pool
+ *
+ * PURPOSE: Creates the arena and starts the workers of every node of the topology
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                        I/O     DESCRIPTION
+ * --------            ----                        ---     -----------
+ * topology            const SHA_NUMA_Topology&    I       the nodes, e.g. from Detect or Simulate
+ * workers_per_node    unsigned int                I       the number of workers of every node, 0 for one per processor
+ * buffer_size         size_t                      I       the size of the buffers of the arenas, in which files are read
+ * spare_buffers       unsigned int                I       the number of buffers of every arena beyond the one of every
+ *                                                         worker, which are handed out by Allocate
+ *
+ *********************************************************************************************************************************/
+
+SHA_NUMA_Pool::SHA_NUMA_Pool(const SHA_NUMA_Topology &topology, unsigned int workers_per_node, size_t buffer_size,
+                             unsigned int spare_buffers)
+    : stopping(false), nr_pending(0), stats_start_ns(Nanoseconds())
+{
+    for (const SHA_NUMA_Node &topology_node : topology.nodes)
+    {
+        std::unique_ptr<Node> node(new Node);
+        unsigned int nr_of_workers = workers_per_node > 0 ? workers_per_node : std::max<unsigned int>(1, topology_node.cpus.size());
+
+        node->topology = topology_node;
+        node->arena.reset(new SHA_NUMA_Arena(topology_node.id, buffer_size, nr_of_workers + spare_buffers));
+        node->nr_of_jobs = 0;
+        node->bytes = 0;
+        node->busy_ns = 0;
+        node->workers.resize(nr_of_workers);
+        nodes.push_back(std::move(node));
+    }
+
+    for (unsigned int k = 0; k < nodes.size(); k++)
+        for (std::thread &worker : nodes[k]->workers)
+            worker = std::thread(&SHA_NUMA_Pool::Work, this, k, nodes[k]->arena->Allocate());
+}
+
+/* The destructor runs every job already posted before stopping the workers */
+
+SHA_NUMA_Pool::~SHA_NUMA_Pool()
+{
+    stopping = true;
+
+    /* A worker tests stopping under the mutex of its node, so taking the mutex once makes sure that no worker is
+       between the test and the wait when the node is woken */
+
+    for (std::unique_ptr<Node> &node : nodes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+        }
+        node->wake.notify_all();
+    }
+
+    for (std::unique_ptr<Node> &node : nodes)
+        for (std::thread &worker : node->workers)
+            worker.join();
+}
+
+/* The function Work is run by every worker of a node. The worker pins itself to the processors of the node. The jobs
+   read their files into the buffer of the worker, which is taken from the arena of the node, or from the heap if the
+   arena could not be mapped. */
+
+void SHA_NUMA_Pool::Work(unsigned int k, unsigned char *buffer)
+{
+    Node &node = *nodes[k];
+    std::vector<unsigned char> fallback;
+    uint64_t start;
+    cpu_set_t set;
+    Job job;
+
+    CPU_ZERO(&set);
+    for (int cpu : node.topology.cpus)
+        CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    if (buffer == nullptr)
+    {
+        fallback.resize(node.arena->Buffer_Size());
+        buffer = fallback.data();
+    }
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(node.mutex);
+            node.wake.wait(lock, [this, &node] { return stopping || !node.jobs.empty(); });
+            if (node.jobs.empty())
+                break;
+            job = std::move(node.jobs.front());
+            node.jobs.pop_front();
+        }
+
+        start = Nanoseconds();
+        job(buffer);
+        node.busy_ns += Nanoseconds() - start;
+        node.nr_of_jobs++;
+
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (--nr_pending == 0)
+            idle.notify_all();
+    }
+
+    if (fallback.empty())
+        node.arena->Release(buffer);
+}
+
+void SHA_NUMA_Pool::Post(unsigned int k, Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        nr_pending++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(nodes[k]->mutex);
+        nodes[k]->jobs.push_back(std::move(job));
+    }
+    nodes[k]->wake.notify_one();
+}
+
+/* The function Submit runs a job on a worker of the given node */
+
+void SHA_NUMA_Pool::Submit(unsigned int node, std::function<void()> job)
+{
+    Post(node % nodes.size(), [job](unsigned char *) { job(); });
+}
+
+/* The function Wait returns when every job submitted to the pool has finished */
+
+void SHA_NUMA_Pool::Wait()
+{
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    idle.wait(lock, [this] { return nr_pending == 0; });
+}
+
+/* The function Allocate returns a free buffer of the arena of a node, or nullptr if every buffer is in use. Texts placed
+   in the buffer are hashed by the workers of that node. */
+
+void *SHA_NUMA_Pool::Allocate(unsigned int node)
+{
+    return node < nodes.size() ? nodes[node]->arena->Allocate() : nullptr;
+}
+
+void SHA_NUMA_Pool::Release(void *buffer)
+{
+    int k = Node_Of(buffer);
+
+    if (k >= 0 && nodes[k]->arena->Owns(buffer))
+        nodes[k]->arena->Release(buffer);
+}
+
+/* The function Node_Of returns the index of the node owning the memory at p: the node of the arena it lies in, or else
+   the node the kernel placed its page on. It returns -1 if the node is not known, e.g. for memory outside the arenas of
+   a simulated topology. */
+
+int SHA_NUMA_Pool::Node_Of(const void *p) const
+{
+    for (unsigned int k = 0; k < nodes.size(); k++)
+        if (nodes[k]->arena->Owns(p))
+            return (int) k;
+
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int id = -1;
+
+    if (nodes.size() > 1 && nodes[0]->topology.id >= 0 &&
+        syscall(SYS_get_mempolicy, &id, NULL, 0, p, MPOL_F_NODE | MPOL_F_ADDR) == 0)
+    {
+        for (unsigned int k = 0; k < nodes.size(); k++)
+            if (nodes[k]->topology.id == id)
+                return (int) k;
+    }
+#endif
+
+    return -1;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Pool::Hash_Batch
+ *
+ * PURPOSE: Computes the SHA1 hashes of a number of independent char arrays, as SHA1_Batch, on the workers of the node
+ *          owning each text. The texts of a node are divided into jobs of at most BATCH_TEXTS texts, at least one per
+ *          worker. Texts whose node is not known are shared among the nodes in turn.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * texts               char**          I       array of pointers to the texts
+ * texts_byte_size     uint64_t*       I       array of the sizes of the texts in bytes
+ * nr_of_texts         uint64_t        I       the number of texts
+ * hashes              uint32_t*       O       the hashes, 5 words per text
+ *
+ *********************************************************************************************************************************/
+
+void SHA_NUMA_Pool::Hash_Batch(char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes)
+{
+    std::vector<std::vector<uint64_t> > owned(nodes.size());
+    std::vector<std::pair<unsigned int, std::pair<uint64_t, uint64_t> > > jobs;
+    uintptr_t page = 0, last_page = ~(uintptr_t) 0;
+    uint64_t next_unknown = 0, i, first, chunk;
+    int k = -1;
+
+    /* Find the owner of every text, asking once per page */
+
+    for (i = 0; i < nr_of_texts; i++)
+    {
+        page = (uintptr_t) texts[i] >> 12;
+        if (page != last_page)
+        {
+            k = Node_Of(texts[i]);
+            last_page = page;
+        }
+        owned[k >= 0 ? k : next_unknown++ % nodes.size()].push_back(i);
+    }
+
+    for (unsigned int n = 0; n < nodes.size(); n++)
+    {
+        chunk = (owned[n].size() + nodes[n]->workers.size() - 1)/nodes[n]->workers.size();
+        chunk = std::max<uint64_t>(1, std::min<uint64_t>(BATCH_TEXTS, chunk));
+        for (first = 0; first < owned[n].size(); first += chunk)
+            jobs.push_back(std::make_pair(n, std::make_pair(first, std::min<uint64_t>(owned[n].size(), first + chunk))));
+    }
+
+    if (jobs.empty())
+        return;
+
+    Countdown countdown(jobs.size());
+
+    for (auto &job : jobs)
+    {
+        unsigned int n = job.first;
+        uint64_t begin = job.second.first, end = job.second.second;
+
+        Post(n, [this, &owned, &countdown, texts, texts_byte_size, hashes, n, begin, end](unsigned char *)
+        {
+            std::vector<char*> job_texts;
+            std::vector<uint64_t> job_sizes;
+            std::vector<uint32_t> job_hashes(HASH_SIZE*(end - begin));
+            uint64_t bytes = 0;
+
+            for (uint64_t j = begin; j < end; j++)
+            {
+                job_texts.push_back(texts[owned[n][j]]);
+                job_sizes.push_back(texts_byte_size[owned[n][j]]);
+                bytes += texts_byte_size[owned[n][j]];
+            }
+
+            SHA1_Batch(job_texts.data(), job_sizes.data(), end - begin, job_hashes.data());
+            for (uint64_t j = begin; j < end; j++)
+                memcpy(&hashes[HASH_SIZE*owned[n][j]], &job_hashes[HASH_SIZE*(j - begin)], HASH_SIZE*sizeof(uint32_t));
+
+            nodes[n]->bytes += bytes;
+            countdown.Count();
+        });
+    }
+
+    countdown.Wait();
+}
+
+/* The function Hash_File hashes a file with the algorithm A, reading it into buffer, and returns the number of bytes
+   hashed, or -1 if the file could not be opened or read */
+
+template <class A>
+static int64_t Hash_File(const char *filename, unsigned char *buffer, size_t buffer_size, uint32_t *hash)
+{
+    sha::Hasher<A> hasher;
+    int64_t file_byte_size = 0;
+    ssize_t n;
+    int fd;
+
+    if ((fd = open(filename, O_RDONLY | O_CLOEXEC)) < 0)
+        return -1;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    while ((n = read(fd, buffer, buffer_size)) > 0)
+    {
+        hasher.update(buffer, n);
+        file_byte_size += n;
+    }
+    close(fd);
+
+    if (n < 0)
+        return -1;
+
+    typename sha::Hasher<A>::digest_type digest = hasher.final();
+    for (size_t i = 0; i < digest.size(); i++)
+        hash[i/4] = (hash[i/4] << 8) | digest[i];
+
+    return file_byte_size;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_NUMA_Pool::Hash_Files
+ *
+ * PURPOSE: Hashes a number of files with SHA1 or SHA256. Every worker of every node takes the next file not yet taken
+ *          and reads it into its buffer in the arena of its node.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                        I/O     DESCRIPTION
+ * --------            ----                        ---     -----------
+ * filenames           std::vector<std::string>&   I       the files
+ * sha256              bool                        I       true for SHA256 and false for SHA1
+ * digests             std::vector<File_Digest>*   O       the hash, size and node of every file, in the order given
+ *
+ *********************************************************************************************************************************/
+
+void SHA_NUMA_Pool::Hash_Files(const std::vector<std::string> &filenames, bool sha256, std::vector<File_Digest> *digests)
+{
+    std::atomic<uint64_t> next(0);
+    uint64_t nr_of_workers = 0;
+
+    digests->assign(filenames.size(), File_Digest());
+    for (std::unique_ptr<Node> &node : nodes)
+        nr_of_workers += node->workers.size();
+
+    Countdown countdown(nr_of_workers);
+
+    for (unsigned int n = 0; n < nodes.size(); n++)
+        for (size_t w = 0; w < nodes[n]->workers.size(); w++)
+            Post(n, [this, &filenames, sha256, digests, &next, &countdown, n](unsigned char *buffer)
+            {
+                size_t buffer_size = nodes[n]->arena->Buffer_Size();
+
+                for (uint64_t i = next++; i < filenames.size(); i = next++)
+                {
+                    File_Digest &digest = (*digests)[i];
+                    int64_t file_byte_size;
+
+                    memset(&digest, 0, sizeof(digest));
+                    if (sha256)
+                        file_byte_size = Hash_File<sha::Sha256>(filenames[i].c_str(), buffer, buffer_size, digest.hash);
+                    else
+                        file_byte_size = Hash_File<sha::Sha1>(filenames[i].c_str(), buffer, buffer_size, digest.hash);
+
+                    digest.status = file_byte_size >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+                    digest.node = n;
+                    digest.file_byte_size = file_byte_size >= 0 ? file_byte_size : 0;
+                    nodes[n]->bytes += digest.file_byte_size;
+                }
+                countdown.Count();
+            });
+
+    countdown.Wait();
+}
+
+/* The function Stats returns the work done on a node since the pool was created or Reset_Stats was called */
+
+SHA_NUMA_Pool::Node_Stats SHA_NUMA_Pool::Stats(unsigned int k) const
+{
+    Node_Stats stats;
+    uint64_t elapsed_ns = Nanoseconds() - stats_start_ns;
+
+    stats.id = nodes[k]->topology.id;
+    stats.nr_of_workers = (unsigned int) nodes[k]->workers.size();
+    stats.jobs = nodes[k]->nr_of_jobs;
+    stats.bytes = nodes[k]->bytes;
+    stats.busy_seconds = nodes[k]->busy_ns/1e9;
+    stats.mb_per_s = elapsed_ns > 0 ? stats.bytes*1000.0/elapsed_ns : 0;
+    stats.huge_pages = nodes[k]->arena->huge_pages;
+    stats.bound = nodes[k]->arena->bound;
+
+    return stats;
+}
+
+/* The function Reset_Stats clears the statistics of every node. It should not be called while jobs are running. */
+
+void SHA_NUMA_Pool::Reset_Stats()
+{
+    for (std::unique_ptr<Node> &node : nodes)
+    {
+        node->nr_of_jobs = 0;
+        node->bytes = 0;
+        node->busy_ns = 0;
+    }
+    stats_start_ns = Nanoseconds();
+}
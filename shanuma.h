@@ -0,0 +1,153 @@
+/***************************************************************************************************************************************
+ * FILENAME: shanuma.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the NUMA topology, the node-local arenas and the worker pool SHA_NUMA_Pool defined in shanuma.cpp,
+ *          which hashes files and batches of texts on workers pinned to the node owning the memory they read
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHANUMA__
+#define __SHANUMA__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SHA_NUMA_BUFFER_SIZE (1 << 20)        /* the default size in bytes of the buffers of an arena                       */
+#define SHA_NUMA_HUGE_PAGE_SIZE (2 << 20)     /* the size of the huge pages the arenas are rounded up to                    */
+
+/* A node of a SHA_NUMA_Topology. A simulated node has no memory of its own in the kernel and its id is -1 */
+
+struct SHA_NUMA_Node
+{
+    int id;                                   /* the number of the node in the kernel, or -1 for a simulated node           */
+    std::vector<int> cpus;                    /* the processors of the node the calling process may run on                  */
+};
+
+struct SHA_NUMA_Topology
+{
+    std::vector<SHA_NUMA_Node> nodes;
+    bool simulated;                           /* true if the nodes were made up by Simulate                                 */
+
+    static SHA_NUMA_Topology Detect();
+    static SHA_NUMA_Topology Simulate(unsigned int nr_of_nodes);
+};
+
+/* A SHA_NUMA_Arena hands out buffers of a fixed size from one mapping, backed by huge pages where possible and bound to
+   its node when the node is real */
+
+class SHA_NUMA_Arena
+{
+public:
+
+    SHA_NUMA_Arena(int node_id, size_t buffer_size, unsigned int nr_of_buffers);
+    ~SHA_NUMA_Arena();
+
+    SHA_NUMA_Arena(const SHA_NUMA_Arena &) = delete;
+    SHA_NUMA_Arena &operator=(const SHA_NUMA_Arena &) = delete;
+
+    unsigned char *Allocate();
+    void Release(void *buffer);
+
+    bool Owns(const void *p) const { return base != nullptr && (const unsigned char*) p >= base && (const unsigned char*) p < base + mapped_size; }
+    size_t Buffer_Size() const { return buffer_size; }
+
+    bool huge_pages;                          /* true if the mapping is of explicit huge pages, false if transparent ones   */
+    bool bound;                               /* true if the memory is bound to the node                                    */
+
+private:
+
+    unsigned char *base;
+    size_t mapped_size;
+    size_t buffer_size;
+    std::mutex mutex;
+    std::vector<unsigned char*> free_buffers;
+};
+
+class SHA_NUMA_Pool
+{
+public:
+
+    /* The work done on a node since the pool was created or Reset_Stats was called */
+
+    struct Node_Stats
+    {
+        int id;                               /* the number of the node in the kernel, -1 if simulated                      */
+        unsigned int nr_of_workers;
+        uint64_t jobs;                        /* the number of jobs run                                                     */
+        uint64_t bytes;                       /* the number of bytes hashed                                                 */
+        double busy_seconds;                  /* the time the workers of the node spent running jobs, summed                */
+        double mb_per_s;                      /* bytes per second of wall time since the statistics were reset, in MB       */
+        bool huge_pages;                      /* true if the arena of the node is of explicit huge pages                    */
+        bool bound;                           /* true if the arena of the node is bound to the node                         */
+    };
+
+    /* The result of hashing a file. status is EXIT_FAILURE if the file could not be opened or read */
+
+    struct File_Digest
+    {
+        int status;
+        unsigned int node;                    /* the index of the node which hashed the file                                */
+        uint64_t file_byte_size;
+        uint32_t hash[8];                     /* 5 words for SHA1 and 8 for SHA256                                          */
+    };
+
+    SHA_NUMA_Pool(const SHA_NUMA_Topology &topology, unsigned int workers_per_node = 0,
+                  size_t buffer_size = SHA_NUMA_BUFFER_SIZE, unsigned int spare_buffers = 4);
+    ~SHA_NUMA_Pool();
+
+    unsigned int Nr_Of_Nodes() const { return (unsigned int) nodes.size(); }
+
+    void *Allocate(unsigned int node);
+    void Release(void *buffer);
+    int Node_Of(const void *p) const;
+
+    void Submit(unsigned int node, std::function<void()> job);
+    void Wait();
+
+    void Hash_Batch(char **texts, uint64_t *texts_byte_size, uint64_t nr_of_texts, uint32_t *hashes);
+    void Hash_Files(const std::vector<std::string> &filenames, bool sha256, std::vector<File_Digest> *digests);
+
+    Node_Stats Stats(unsigned int node) const;
+    void Reset_Stats();
+
+private:
+
+    typedef std::function<void(unsigned char *buffer)> Job;
+
+    struct Node
+    {
+        SHA_NUMA_Node topology;
+        std::unique_ptr<SHA_NUMA_Arena> arena;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Job> jobs;
+        std::vector<std::thread> workers;
+        std::atomic<uint64_t> nr_of_jobs;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> busy_ns;
+    };
+
+    void Post(unsigned int node, Job job);
+    void Work(unsigned int node, unsigned char *buffer);
+
+    std::vector<std::unique_ptr<Node> > nodes;
+    std::atomic<bool> stopping;
+    std::mutex pending_mutex;
+    std::condition_variable idle;
+    uint64_t nr_pending;
+    uint64_t stats_start_ns;
+};
+
+#endif
@@ -0,0 +1,467 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaotp.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-20
+ *
+ * CONTENT: Implements the HMAC-based one-time passwords HOTP (RFC 4226) and their time-based variant TOTP (RFC 6238)
+ *          with HMAC-SHA1, computed on the multi-lane kernels of shabatch.c.
+ *
+ *          The message of HOTP is the 8-byte counter, so that once the inner and outer pads of the key have been hashed
+ *          each code takes exactly two compressions: one of the counter block from the inner hash and one of the
+ *          inner digest block from the outer hash. The pads are therefore hashed once per key, by SHA_OTP_Set_Key, and
+ *          the codes of many counters, of one or of many keys, are computed side by side in the lanes of the kernel.
+ *          A window of counters around the expected one, as used to verify codes in the presence of clock drift, thus
+ *          costs two multi-lane compressions per group of lanes instead of a full HMAC per counter.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shalib.h"
+#include "sha1.h"
+#include "shabatch.h"
+#include "shaotp.h"
+
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4         /* defines the size of a word in BYTES                                      */
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+#define COUNTER_SIZE 8      /* defines the size of the HOTP counter in BYTES                            */
+
+#define VERIFY_CHUNK (16*SHA1_MAX_LANES)    /* the number of candidate codes computed at a time by SHA_HOTP_Verify_Batch */
+
+static const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+static const uint32_t powers_of_ten[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: KEYS
+ *
+ **************************************************************************************************************************************/
+
+/* The function Hash_Pad hashes one block of the key padded with zeros and xored with the byte pad */
+
+static void Hash_Pad(const unsigned char *key_block, unsigned char pad, uint32_t *H)
+{
+    unsigned char block[BLOCK_SIZE];
+    uint32_t W[80];
+    unsigned int i;
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+        block[i] = key_block[i] ^ pad;
+    for (i = 0; i < BLOCK_SIZE/WORD_SIZE; i++)
+        W[i] = Conv_Word_To_32Int(&block[WORD_SIZE*i]);
+
+    memcpy(H, H_init, sizeof(H_init));
+    SHA1_Compress(H, W);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_OTP_Set_Key
+ *
+ * PURPOSE: Hashes the inner and outer pads of an HMAC-SHA1 key. A key longer than the block size of 64 bytes is
+ *          hashed first, as prescribed by HMAC.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * key                 char*                 I       the pointer to the char array containing the key, i.e. the shared secret
+ * key_byte_size       uint64_t              I       the size in bytes of the key
+ * otp_key             struct sha_otp_key*   O       the pointer to the structure where the pad hashes are to be stored
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA_OTP_Set_Key(const char *key, uint64_t key_byte_size, struct sha_otp_key *otp_key)
+{
+    unsigned char key_block[BLOCK_SIZE];
+    uint32_t key_hash[HASH_SIZE];
+    unsigned int i;
+
+    memset(key_block, 0, BLOCK_SIZE);
+    if (key_byte_size > BLOCK_SIZE)
+    {
+        SHA1((char*) key, key_byte_size, key_hash);
+        for (i = 0; i < HASH_SIZE; i++)
+            Conv_32Int_To_Word(key_hash[i], (char*) &key_block[WORD_SIZE*i]);
+    }
+    else
+        memcpy(key_block, key, key_byte_size);
+
+    Hash_Pad(key_block, 0x36, otp_key->inner);
+    Hash_Pad(key_block, 0x5c, otp_key->outer);
+
+    memset(key_block, 0, BLOCK_SIZE);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: CODES
+ *
+ **************************************************************************************************************************************/
+
+/* The function Truncate applies the dynamic truncation of RFC 4226 to the digest in lane l: the low 4 bits of the
+   last byte give the position of 4 bytes, which are read as a 31-bit number and reduced to the number of digits */
+
+static uint32_t Truncate(const uint32_t *H, unsigned int l, unsigned int nr_of_lanes, unsigned int nr_of_digits)
+{
+    unsigned int offset, b, i;
+    uint32_t binary;
+
+    offset = H[4*nr_of_lanes + l] & 0x0f;
+    binary = 0;
+    for (i = 0; i < 4; i++)
+    {
+        b = offset + i;
+        binary = (binary << 8) | ((H[(b/WORD_SIZE)*nr_of_lanes + l] >> (24 - 8*(b % WORD_SIZE))) & 0xff);
+    }
+
+    return (binary & 0x7fffffff) % powers_of_ten[nr_of_digits];
+}
+
+/* The function HOTP_Lanes computes the codes of up to one group of lanes. The block of the counter and the block of
+   the inner digest are padded in place: both messages follow a full block of pad, so their sizes in bits are fixed */
+
+static void HOTP_Lanes(const struct sha1_kernel *kernel, const struct sha_otp_key *const *keys, const uint64_t *counters, unsigned int nr_of_codes, unsigned int nr_of_digits, uint32_t *codes)
+{
+    uint32_t H[HASH_SIZE*SHA1_MAX_LANES];
+    uint32_t W[(BLOCK_SIZE/WORD_SIZE)*SHA1_MAX_LANES];
+    unsigned int nr_of_lanes, l, i;
+
+    nr_of_lanes = kernel->nr_of_lanes;
+    memset(H, 0, sizeof(H));
+    memset(W, 0, sizeof(W));
+
+    /* Inner hash: the counter, most significant byte first, followed by the pad */
+
+    for (l = 0; l < nr_of_codes; l++)
+    {
+        for (i = 0; i < HASH_SIZE; i++)
+            H[i*nr_of_lanes + l] = keys[l]->inner[i];
+        W[l] = (uint32_t) (counters[l] >> 32);
+        W[nr_of_lanes + l] = (uint32_t) counters[l];
+    }
+    for (l = 0; l < nr_of_lanes; l++)
+    {
+        W[2*nr_of_lanes + l] = 0x80000000;
+        W[15*nr_of_lanes + l] = 8*(BLOCK_SIZE + COUNTER_SIZE);
+    }
+
+    kernel->compress(H, W);
+
+    /* Outer hash: the inner digest followed by the pad */
+
+    for (l = 0; l < nr_of_lanes; l++)
+    {
+        for (i = 0; i < HASH_SIZE; i++)
+            W[i*nr_of_lanes + l] = H[i*nr_of_lanes + l];
+        W[HASH_SIZE*nr_of_lanes + l] = 0x80000000;
+        W[15*nr_of_lanes + l] = 8*(BLOCK_SIZE + WORD_SIZE*HASH_SIZE);
+    }
+    for (l = 0; l < nr_of_codes; l++)
+        for (i = 0; i < HASH_SIZE; i++)
+            H[i*nr_of_lanes + l] = keys[l]->outer[i];
+
+    kernel->compress(H, W);
+
+    for (l = 0; l < nr_of_codes; l++)
+        codes[l] = Truncate(H, l, nr_of_lanes, nr_of_digits);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HOTP_Batch_Kernel
+ *
+ * PURPOSE: Computes a number of HOTP codes with the given multi-lane kernel. The keys may all be the same, for example
+ *          to compute a window of counters of one user, or all different.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * kernel              struct sha1_kernel*   I       the kernel to use, see SHA1_Kernels
+ * keys                struct sha_otp_key**  I       pointer to the array of pointers to the key of each code, see SHA_OTP_Set_Key
+ * counters            uint64_t*             I       pointer to the array containing the counter of each code
+ * nr_of_codes         uint64_t              I       the number of codes
+ * nr_of_digits        unsigned int          I       the number of decimal digits of the codes, 1 to SHA_OTP_MAX_DIGITS
+ * codes               uint32_t*             O       pointer to the uint32_t array where the codes are to be stored
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if nr_of_digits is out of range
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HOTP_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_otp_key *const *keys, const uint64_t *counters, uint64_t nr_of_codes, unsigned int nr_of_digits, uint32_t *codes)
+{
+    uint64_t i, n;
+
+    if (nr_of_digits < 1 || nr_of_digits > SHA_OTP_MAX_DIGITS)
+        return EXIT_FAILURE;
+
+    for (i = 0; i < nr_of_codes; i = i + n)
+    {
+        n = nr_of_codes - i < kernel->nr_of_lanes ? nr_of_codes - i : kernel->nr_of_lanes;
+        HOTP_Lanes(kernel, &keys[i], &counters[i], (unsigned int) n, nr_of_digits, &codes[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HOTP_Batch
+ *
+ * PURPOSE: Computes a number of HOTP codes with the default kernel. See SHA_HOTP_Batch_Kernel.
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if nr_of_digits is out of range
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HOTP_Batch(const struct sha_otp_key *const *keys, const uint64_t *counters, uint64_t nr_of_codes, unsigned int nr_of_digits, uint32_t *codes)
+{
+    return SHA_HOTP_Batch_Kernel(SHA1_Default_Kernel(), keys, counters, nr_of_codes, nr_of_digits, codes);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HOTP
+ *
+ * PURPOSE: Computes the HOTP code of a key and a counter
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * key                 char*                 I       the pointer to the char array containing the key
+ * key_byte_size       uint64_t              I       the size in bytes of the key
+ * counter             uint64_t              I       the counter
+ * nr_of_digits        unsigned int          I       the number of decimal digits of the code, 1 to SHA_OTP_MAX_DIGITS
+ *
+ * RETURN VALUE : uint32_t, the code, or SHA_OTP_INVALID_CODE if nr_of_digits is out of range
+ *
+ *********************************************************************************************************************************/
+
+uint32_t SHA_HOTP(const char *key, uint64_t key_byte_size, uint64_t counter, unsigned int nr_of_digits)
+{
+    struct sha_otp_key otp_key;
+    const struct sha_otp_key *keys[1];
+    uint32_t code;
+
+    if (nr_of_digits < 1 || nr_of_digits > SHA_OTP_MAX_DIGITS)
+        return SHA_OTP_INVALID_CODE;
+
+    SHA_OTP_Set_Key(key, key_byte_size, &otp_key);
+    keys[0] = &otp_key;
+    HOTP_Lanes(SHA1_Find_Kernel("scalar"), keys, &counter, 1, nr_of_digits, &code);
+
+    return code;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: VERIFICATION
+ *
+ **************************************************************************************************************************************/
+
+/* Candidates gathered by SHA_HOTP_Verify_Batch, whose codes are computed a chunk at a time */
+
+struct otp_candidates
+{
+    const struct sha_otp_key *keys[VERIFY_CHUNK];
+    uint64_t counters[VERIFY_CHUNK];
+    uint32_t codes[VERIFY_CHUNK];
+    struct sha_otp_check *checks[VERIFY_CHUNK];
+    int64_t offsets[VERIFY_CHUNK];
+    unsigned int nr_of_candidates;
+};
+
+/* The function Verify_Candidates computes the codes of the candidates gathered so far and marks each check whose
+   code matches. All candidates are compared, so that the time taken does not depend on where a match is found */
+
+static void Verify_Candidates(const struct sha1_kernel *kernel, struct otp_candidates *c, unsigned int nr_of_digits)
+{
+    unsigned int i;
+    int is_match;
+
+    SHA_HOTP_Batch_Kernel(kernel, c->keys, c->counters, c->nr_of_candidates, nr_of_digits, c->codes);
+
+    for (i = 0; i < c->nr_of_candidates; i++)
+    {
+        is_match = c->codes[i] == c->checks[i]->code && c->checks[i]->result != EXIT_SUCCESS;
+        if (is_match)
+        {
+            c->checks[i]->result = EXIT_SUCCESS;
+            c->checks[i]->offset = c->offsets[i];
+        }
+    }
+
+    c->nr_of_candidates = 0;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HOTP_Verify_Batch
+ *
+ * PURPOSE: Verifies a number of HOTP codes, each against the counters from window below to window above its expected
+ *          counter. The codes of all counters of all checks are computed in the lanes of the default kernel, and every
+ *          check is given the result EXIT_SUCCESS if its code matches one of them. Counters are tried in order of
+ *          increasing distance from the expected counter, the earlier one first, and the offset of the first match is
+ *          reported. Counters below zero are skipped.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                    I/O     DESCRIPTION
+ * --------            ----                    ---     -----------
+ * checks              struct sha_otp_check*   I/O     pointer to the array of checks, whose result and offset are set
+ * nr_of_checks        uint64_t                I       the number of checks
+ * window              unsigned int            I       the number of counters tried on each side of the expected counter
+ * nr_of_digits        unsigned int            I       the number of decimal digits of the codes, 1 to SHA_OTP_MAX_DIGITS
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if nr_of_digits is out of range
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HOTP_Verify_Batch(struct sha_otp_check *checks, uint64_t nr_of_checks, unsigned int window, unsigned int nr_of_digits)
+{
+    const struct sha1_kernel *kernel;
+    struct otp_candidates *c;
+    uint64_t i, k;
+    int64_t offset;
+
+    if (nr_of_digits < 1 || nr_of_digits > SHA_OTP_MAX_DIGITS)
+        return EXIT_FAILURE;
+
+    c = (struct otp_candidates*) malloc(sizeof(struct otp_candidates));
+    if (c == NULL)
+        return EXIT_FAILURE;
+
+    kernel = SHA1_Default_Kernel();
+    c->nr_of_candidates = 0;
+
+    for (i = 0; i < nr_of_checks; i++)
+    {
+        checks[i].result = EXIT_FAILURE;
+        checks[i].offset = 0;
+
+        for (k = 0; k <= 2*(uint64_t) window; k++)
+        {
+            /* The offsets 0, -1, +1, -2, +2, ... */
+
+            offset = k % 2 == 1 ? -(int64_t) ((k + 1)/2) : (int64_t) (k/2);
+            if (offset < 0 && (uint64_t) -offset > checks[i].counter)
+                continue;
+
+            c->keys[c->nr_of_candidates] = checks[i].key;
+            c->counters[c->nr_of_candidates] = checks[i].counter + offset;
+            c->checks[c->nr_of_candidates] = &checks[i];
+            c->offsets[c->nr_of_candidates] = offset;
+            c->nr_of_candidates++;
+
+            if (c->nr_of_candidates == VERIFY_CHUNK)
+                Verify_Candidates(kernel, c, nr_of_digits);
+        }
+    }
+
+    if (c->nr_of_candidates > 0)
+        Verify_Candidates(kernel, c, nr_of_digits);
+
+    free(c);
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_HOTP_Verify
+ *
+ * PURPOSE: Verifies one HOTP code against the counters from window below to window above the expected counter,
+ *          computing the codes of all of them in the lanes of the default kernel. See SHA_HOTP_Verify_Batch.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * key                 struct sha_otp_key*   I       the key of the user, see SHA_OTP_Set_Key
+ * counter             uint64_t              I       the expected counter
+ * window              unsigned int          I       the number of counters tried on each side of the expected counter
+ * nr_of_digits        unsigned int          I       the number of decimal digits of the code, 1 to SHA_OTP_MAX_DIGITS
+ * code                uint32_t              I       the code given by the user
+ * offset              int64_t*              O       pointer to where the offset of the matching counter is to be stored,
+ *                                                   or NULL
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS if the code matches, otherwise EXIT_FAILURE
+ *
+ *********************************************************************************************************************************/
+
+int SHA_HOTP_Verify(const struct sha_otp_key *key, uint64_t counter, unsigned int window, unsigned int nr_of_digits, uint32_t code, int64_t *offset)
+{
+    struct sha_otp_check check;
+
+    check.key = key;
+    check.counter = counter;
+    check.code = code;
+
+    if (SHA_HOTP_Verify_Batch(&check, 1, window, nr_of_digits) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    if (offset != NULL)
+        *offset = check.offset;
+    return check.result;
+}
+
+/* The function SHA_TOTP_Counter stores the TOTP counter of a time, i.e. the number of whole time steps elapsed since
+   start_time, in counter. Times are counted in seconds, normally since the Unix epoch with start_time 0 and a time
+   step of 30 seconds. It returns EXIT_FAILURE if time_step is zero */
+
+int SHA_TOTP_Counter(uint64_t time, uint64_t start_time, uint64_t time_step, uint64_t *counter)
+{
+    if (time_step == 0)
+        return EXIT_FAILURE;
+
+    *counter = time > start_time ? (time - start_time)/time_step : 0;
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_TOTP_Verify
+ *
+ * PURPOSE: Verifies one TOTP code given at the Unix time time, allowing a drift of window time steps in either direction.
+ *          See SHA_HOTP_Verify.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * key                 struct sha_otp_key*   I       the key of the user, see SHA_OTP_Set_Key
+ * time                uint64_t              I       the time in seconds since the Unix epoch
+ * time_step           uint64_t              I       the time step in seconds, normally 30
+ * window              unsigned int          I       the number of time steps tried on each side of the current one
+ * nr_of_digits        unsigned int          I       the number of decimal digits of the code, 1 to SHA_OTP_MAX_DIGITS
+ * code                uint32_t              I       the code given by the user
+ * offset              int64_t*              O       pointer to where the offset in time steps of the match is to be stored,
+ *                                                   or NULL
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS if the code matches, otherwise EXIT_FAILURE, also if time_step is zero
+ *
+ *********************************************************************************************************************************/
+
+int SHA_TOTP_Verify(const struct sha_otp_key *key, uint64_t time, uint64_t time_step, unsigned int window, unsigned int nr_of_digits, uint32_t code, int64_t *offset)
+{
+    uint64_t counter;
+
+    if (SHA_TOTP_Counter(time, 0, time_step, &counter) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    return SHA_HOTP_Verify(key, counter, window, nr_of_digits, code, offset);
+}
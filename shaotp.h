@@ -0,0 +1,52 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaotp.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the HOTP and TOTP one-time password functions defined in shaotp.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAOTP__
+#define __SHAOTP__
+
+#define SHA_OTP_MAX_DIGITS 9                  /* the largest number of digits of a code                                     */
+#define SHA_OTP_INVALID_CODE 0xffffffff       /* returned by SHA_HOTP for a number of digits out of range                   */
+
+/* A sha_otp_key holds the HMAC-SHA1 hash of the inner and the outer pad of a key, which is all that is needed of the
+   key to compute its codes */
+
+struct sha_otp_key
+{
+    uint32_t inner[5];                        /* the hash after the block of the key xor 0x36                               */
+    uint32_t outer[5];                        /* the hash after the block of the key xor 0x5c                               */
+};
+
+/* A sha_otp_check is one code to be verified by SHA_HOTP_Verify_Batch */
+
+struct sha_otp_check
+{
+    const struct sha_otp_key *key;            /* the key of the user                                                        */
+    uint64_t counter;                         /* the expected counter, e.g. as stored by SHA_TOTP_Counter                   */
+    uint32_t code;                            /* the code given by the user                                                 */
+    int result;                               /* set to EXIT_SUCCESS if the code matches a counter in the window            */
+    int64_t offset;                           /* set to the offset from the expected counter of the matching counter        */
+};
+
+void SHA_OTP_Set_Key(const char *key, uint64_t key_byte_size, struct sha_otp_key *otp_key);
+
+int SHA_HOTP_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_otp_key *const *keys, const uint64_t *counters, uint64_t nr_of_codes, unsigned int nr_of_digits, uint32_t *codes);
+
+int SHA_HOTP_Batch(const struct sha_otp_key *const *keys, const uint64_t *counters, uint64_t nr_of_codes, unsigned int nr_of_digits, uint32_t *codes);
+
+uint32_t SHA_HOTP(const char *key, uint64_t key_byte_size, uint64_t counter, unsigned int nr_of_digits);
+
+int SHA_HOTP_Verify_Batch(struct sha_otp_check *checks, uint64_t nr_of_checks, unsigned int window, unsigned int nr_of_digits);
+
+int SHA_HOTP_Verify(const struct sha_otp_key *key, uint64_t counter, unsigned int window, unsigned int nr_of_digits, uint32_t code, int64_t *offset);
+
+int SHA_TOTP_Counter(uint64_t time, uint64_t start_time, uint64_t time_step, uint64_t *counter);
+
+int SHA_TOTP_Verify(const struct sha_otp_key *key, uint64_t time, uint64_t time_step, unsigned int window, unsigned int nr_of_digits, uint32_t code, int64_t *offset);
+
+#endif
@@ -0,0 +1,63 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaproto.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Defines the protocol between the hashing daemon shad (shaserver.cpp) and its clients (shaclient.c).
+ *
+ *          A client creates a memfd holding a ring of nr_of_slots slots, seals it against shrinking and passes it to the
+ *          daemon in a sha_hello message over a SOCK_SEQPACKET Unix socket. Each slot consists of a sha_slot_header
+ *          followed by slot_byte_size bytes of payload. To hash a payload the client writes it into a free slot and sends
+ *          a sha_request naming the slot. The daemon hashes the payload directly from the shared memory, writes the hash
+ *          into the slot header and answers with a sha_reply naming the slot.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAPROTO__
+#define __SHAPROTO__
+
+#define SHA_PROTO_MAGIC 0x53484131            /* "SHA1"                                                                     */
+#define SHA_PROTO_VERSION 1
+#define SHA_SERVER_DEFAULT_PATH "/tmp/shad.socket"
+
+#define SHA_PROTO_MAX_SLOT_BYTE_SIZE (1 << 30)    /* the largest slot_byte_size accepted by the daemon                      */
+
+#define SHA_PROTO_OK 0
+#define SHA_PROTO_BAD_REQUEST 1
+
+/* The first message of a client, carrying the memfd of the ring as SCM_RIGHTS ancillary data */
+
+struct sha_hello
+{
+    uint32_t magic;                           /* SHA_PROTO_MAGIC                                                            */
+    uint32_t version;                         /* SHA_PROTO_VERSION                                                          */
+    uint32_t nr_of_slots;                     /* the number of slots in the ring                                            */
+    uint32_t slot_byte_size;                  /* the largest payload of a slot in bytes                                     */
+};
+
+struct sha_slot_header
+{
+    uint32_t hash[5];                         /* the hash of the payload, written by the daemon                             */
+    uint32_t reserved[3];
+};
+
+struct sha_request
+{
+    uint32_t slot;                            /* the slot holding the payload                                               */
+    uint32_t reserved;
+    uint64_t byte_size;                       /* the size of the payload in bytes, at most slot_byte_size                   */
+};
+
+/* The answer to a sha_hello, with slot set to 0, and to every sha_request */
+
+struct sha_reply
+{
+    uint32_t slot;                            /* the slot of the request                                                    */
+    uint32_t status;                          /* SHA_PROTO_OK or SHA_PROTO_BAD_REQUEST                                      */
+};
+
+/* The distance in bytes between two slots of the ring, which keeps every slot header on its own cache line */
+
+#define SHA_SLOT_STRIDE(slot_byte_size) ((sizeof(struct sha_slot_header) + (uint64_t) (slot_byte_size) + 63) & ~(uint64_t) 63)
+
+#endif
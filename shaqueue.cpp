@@ -0,0 +1,267 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaqueue.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-13
+ *
+ * CONTENT: Implements the class SHA1_Queue, a thread-safe submission queue for servers hashing one small message per
+ *          request from many threads. Threads post jobs consisting of a char array and a completion, which is either a
+ *          callback or a future. A dispatcher thread gathers the jobs into groups filling all lanes of a multi-lane
+ *          kernel, and dispatches a partially filled group only once the oldest job has waited for the deadline.
+ *
+ *          The char array of a job must remain valid until its completion has been delivered. Callbacks are called on
+ *          the dispatcher thread and should therefore return quickly.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "shaqueue.h"
+
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+#define MAX_GROUPS 8        /* defines the largest number of full lane groups dispatched in one batch   */
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Queue::SHA1_Queue
+ *
+ * PURPOSE: Starts the dispatcher thread of a queue
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * deadline_us         unsigned int          I       the longest time in microseconds a job waits for its lane group to fill
+ * kernel              struct sha1_kernel*   I       the kernel to use, NULL for the default kernel of SHA1_Batch
+ *
+ *********************************************************************************************************************************/
+
+SHA1_Queue::SHA1_Queue(unsigned int deadline_us, const struct sha1_kernel *kernel)
+    : kernel(kernel != NULL ? kernel : SHA1_Default_Kernel()), deadline(deadline_us), stopping(false),
+      latency_histogram(SHA1_QUEUE_LATENCY_BUCKETS + 1)
+{
+    Reset_Stats();
+    dispatcher = std::thread(&SHA1_Queue::Dispatch, this);
+}
+
+/* The destructor completes every job already submitted before stopping the dispatcher thread */
+
+SHA1_Queue::~SHA1_Queue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    dispatcher.join();
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Queue::Submit
+ *
+ * PURPOSE: Posts a job to the queue. The callback is called with the SHA1 hash of the char array once it has been computed.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * text                char*                 I       pointer to the char array to be hashed, valid until completion
+ * text_byte_size      uint64_t              I       the size of the char array in bytes
+ * callback            Callback              I       the function called on the dispatcher thread with the hash
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Queue::Submit(const char *text, uint64_t text_byte_size, Callback callback)
+{
+    Job job;
+    size_t depth;
+
+    job.text = text;
+    job.text_byte_size = text_byte_size;
+    job.callback = callback;
+    job.submitted = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+        depth = jobs.size();
+
+        nr_of_submissions++;
+        sum_of_depths += depth;
+        if (depth > max_depth)
+            max_depth = depth;
+    }
+
+    /* The dispatcher needs to know when the first job arrives, to start the deadline, and when a group is full */
+
+    if (depth == 1 || depth % kernel->nr_of_lanes == 0)
+        wake.notify_one();
+}
+
+/* Posts a job to the queue and returns a future receiving the SHA1 hash of the char array */
+
+std::future<SHA1_Queue::Digest> SHA1_Queue::Submit(const char *text, uint64_t text_byte_size)
+{
+    std::shared_ptr<std::promise<Digest> > promise = std::make_shared<std::promise<Digest> >();
+    std::future<Digest> future = promise->get_future();
+
+    Submit(text, text_byte_size, [promise](const Digest &hash) { promise->set_value(hash); });
+
+    return future;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Queue::Dispatch
+ *
+ * PURPOSE: The loop of the dispatcher thread. Waits until either a full lane group has been gathered or the oldest job
+ *          has reached the deadline, hashes the gathered jobs with SHA1_Batch_Kernel and delivers the completions.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Queue::Dispatch()
+{
+    const size_t nr_of_lanes = kernel->nr_of_lanes;
+    std::vector<Job> batch;
+    std::vector<char*> texts;
+    std::vector<uint64_t> texts_byte_size;
+    std::vector<uint32_t> hashes;
+    Clock::time_point now;
+    size_t nr_to_take, i;
+    double latency_us;
+    bool is_full;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            for (;;)
+            {
+                if (jobs.size() >= nr_of_lanes || (stopping && !jobs.empty()))
+                    break;
+                if (stopping)
+                    return;
+                if (jobs.empty())
+                    wake.wait(lock);
+                else if (wake.wait_until(lock, jobs.front().submitted + deadline) == std::cv_status::timeout)
+                    break;
+            }
+
+            /* Take whole lane groups if there are any, otherwise flush everything waiting */
+
+            is_full = jobs.size() >= nr_of_lanes;
+            if (is_full)
+                nr_to_take = std::min(jobs.size(), MAX_GROUPS*nr_of_lanes)/nr_of_lanes*nr_of_lanes;
+            else
+                nr_to_take = jobs.size();
+
+            now = Clock::now();
+            batch.assign(jobs.begin(), jobs.begin() + nr_to_take);
+            jobs.erase(jobs.begin(), jobs.begin() + nr_to_take);
+
+            nr_of_jobs += nr_to_take;
+            nr_of_batches++;
+            nr_of_lane_groups += (nr_to_take + nr_of_lanes - 1)/nr_of_lanes;
+            if (is_full)
+                nr_of_full_batches++;
+            else
+                nr_of_deadline_flushes++;
+
+            for (i = 0; i < nr_to_take; i++)
+            {
+                latency_us = std::chrono::duration<double, std::micro>(now - batch[i].submitted).count();
+                sum_of_latencies_us += latency_us;
+                if (latency_us > max_latency_us)
+                    max_latency_us = latency_us;
+                latency_histogram[std::min<uint64_t>((uint64_t) latency_us, SHA1_QUEUE_LATENCY_BUCKETS)]++;
+            }
+        }
+
+        texts.resize(nr_to_take);
+        texts_byte_size.resize(nr_to_take);
+        hashes.resize(HASH_SIZE*nr_to_take);
+        for (i = 0; i < nr_to_take; i++)
+        {
+            texts[i] = (char*) batch[i].text;
+            texts_byte_size[i] = batch[i].text_byte_size;
+        }
+
+        SHA1_Batch_Kernel(kernel, &texts[0], &texts_byte_size[0], nr_to_take, &hashes[0]);
+
+        for (i = 0; i < nr_to_take; i++)
+        {
+            Digest hash;
+            memcpy(&hash[0], &hashes[HASH_SIZE*i], sizeof(hash));
+            batch[i].callback(hash);
+        }
+    }
+}
+
+/* The function Get_Stats returns the statistics accumulated since construction or the last call of Reset_Stats */
+
+SHA1_Queue::Stats SHA1_Queue::Get_Stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    uint64_t nr_of_dispatched, count, i;
+
+    nr_of_dispatched = 0;
+    for (i = 0; i <= SHA1_QUEUE_LATENCY_BUCKETS; i++)
+        nr_of_dispatched += latency_histogram[i];
+
+    stats.jobs = nr_of_jobs;
+    stats.batches = nr_of_batches;
+    stats.full_batches = nr_of_full_batches;
+    stats.deadline_flushes = nr_of_deadline_flushes;
+    stats.mean_lane_fill = nr_of_lane_groups > 0 ? (double) nr_of_dispatched/(nr_of_lane_groups*kernel->nr_of_lanes) : 0;
+    stats.max_queue_depth = max_depth;
+    stats.mean_queue_depth = nr_of_submissions > 0 ? (double) sum_of_depths/nr_of_submissions : 0;
+    stats.mean_latency_us = nr_of_dispatched > 0 ? sum_of_latencies_us/nr_of_dispatched : 0;
+    stats.max_latency_us = max_latency_us;
+
+    stats.p99_latency_us = 0;
+    count = 0;
+    for (i = 0; i <= SHA1_QUEUE_LATENCY_BUCKETS && nr_of_dispatched > 0; i++)
+    {
+        count += latency_histogram[i];
+        if (count*100 >= nr_of_dispatched*99)
+        {
+            stats.p99_latency_us = (double) (i + 1);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+/* The function Reset_Stats sets all statistics to zero */
+
+void SHA1_Queue::Reset_Stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    nr_of_jobs = 0;
+    nr_of_batches = 0;
+    nr_of_full_batches = 0;
+    nr_of_deadline_flushes = 0;
+    nr_of_lane_groups = 0;
+    nr_of_submissions = 0;
+    sum_of_depths = 0;
+    max_depth = 0;
+    sum_of_latencies_us = 0;
+    max_latency_us = 0;
+    std::fill(latency_histogram.begin(), latency_histogram.end(), 0);
+}
@@ -0,0 +1,103 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaqueue.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the class SHA1_Queue defined in shaqueue.cpp, a thread-safe submission queue which gathers SHA1 jobs
+ *          posted by many threads into batches for the multi-lane kernels of shabatch.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAQUEUE__
+#define __SHAQUEUE__
+
+#include <stdint.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "shabatch.h"
+
+#define SHA1_QUEUE_LATENCY_BUCKETS 65536      /* the number of 1 microsecond buckets of the latency histogram               */
+
+class SHA1_Queue
+{
+public:
+
+    typedef std::array<uint32_t, 5> Digest;
+    typedef std::function<void(const Digest &hash)> Callback;
+
+    /* Statistics accumulated since construction or the last call of Reset_Stats */
+
+    struct Stats
+    {
+        uint64_t jobs;                        /* the number of jobs dispatched                                              */
+        uint64_t batches;                     /* the number of batches dispatched to the kernel                             */
+        uint64_t full_batches;                /* the number of batches dispatched because all lanes could be filled         */
+        uint64_t deadline_flushes;            /* the number of batches dispatched because the deadline expired              */
+        double mean_lane_fill;                /* the mean fraction of the lanes of the kernel occupied by a job             */
+        uint64_t max_queue_depth;             /* the largest number of jobs waiting in the queue                            */
+        double mean_queue_depth;              /* the mean number of jobs waiting in the queue, sampled at every submission  */
+        double mean_latency_us;               /* the mean time in microseconds a job waited before being dispatched         */
+        double max_latency_us;                /* the largest time in microseconds a job waited before being dispatched      */
+        double p99_latency_us;                /* the 99th percentile of the waiting time in microseconds                    */
+    };
+
+    SHA1_Queue(unsigned int deadline_us = 100, const struct sha1_kernel *kernel = NULL);
+    ~SHA1_Queue();
+
+    void Submit(const char *text, uint64_t text_byte_size, Callback callback);
+    std::future<Digest> Submit(const char *text, uint64_t text_byte_size);
+
+    Stats Get_Stats();
+    void Reset_Stats();
+
+    unsigned int Nr_Of_Lanes() const { return kernel->nr_of_lanes; }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Job
+    {
+        const char *text;
+        uint64_t text_byte_size;
+        Callback callback;
+        Clock::time_point submitted;
+    };
+
+    void Dispatch();
+
+    const struct sha1_kernel *kernel;
+    std::chrono::microseconds deadline;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    bool stopping;
+
+    /* Counters protected by mutex */
+
+    uint64_t nr_of_jobs;
+    uint64_t nr_of_batches;
+    uint64_t nr_of_full_batches;
+    uint64_t nr_of_deadline_flushes;
+    uint64_t nr_of_lane_groups;
+    uint64_t nr_of_submissions;
+    uint64_t sum_of_depths;
+    uint64_t max_depth;
+    double sum_of_latencies_us;
+    double max_latency_us;
+    std::vector<uint64_t> latency_histogram;
+
+    std::thread dispatcher;
+};
+
+#endif
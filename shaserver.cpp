@@ -0,0 +1,402 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaserver.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-15
+ *
+ * CONTENT: Implements the class SHA1_Server, which accepts clients on a Unix socket and hashes their requests, see
+ *          shaproto.h for the protocol. Every client is served by a thread of its own, which maps the ring of the client
+ *          and posts its requests to a SHA1_Queue shared by all clients. The payloads are thereby hashed directly from
+ *          the shared memory, and requests of different clients are gathered into the same multi-lane batches.
+ *
+ *          The replies of a client are queued by the completion callbacks and sent by a writer thread of the client,
+ *          so that a client which stops reading its socket only stalls itself and never the dispatcher of the queue.
+ *          A client has at most nr_of_slots requests unanswered; beyond that its socket is not read until replies
+ *          have been sent.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <condition_variable>
+#include <deque>
+
+#include "shaproto.h"
+#include "shaserver.h"
+
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+#define POLL_MS 100         /* defines how often in milliseconds the accepting thread checks for Stop   */
+
+
+/* A Connection holds the state of one client */
+
+struct SHA1_Server::Connection
+{
+    int socket;
+    unsigned char *ring;
+    uint64_t ring_byte_size;
+    uint32_t nr_of_slots;
+    uint32_t slot_byte_size;
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::condition_variable wake_writer;
+    std::deque<struct sha_reply> replies;     /* the replies waiting to be sent by the writer                           */
+    uint64_t nr_unanswered;                   /* the number of requests received whose reply has not been sent          */
+    bool closing;                             /* set when the writer is to exit once the replies are sent               */
+
+    std::atomic<bool> done;
+    std::thread thread;
+    std::thread writer;
+};
+
+/* The function Send_Reply sends a sha_reply to a client. Errors are ignored, since a lost client is detected when reading */
+
+static void Send_Reply(int socket, uint32_t slot, uint32_t status)
+{
+    struct sha_reply reply;
+
+    reply.slot = slot;
+    reply.status = status;
+    send(socket, &reply, sizeof(reply), MSG_NOSIGNAL);
+}
+
+/* The function Post_Reply queues a reply for the writer of a connection, which must hold a request counted as
+   unanswered */
+
+void SHA1_Server::Post_Reply(Connection *c, uint32_t slot, uint32_t status)
+{
+    struct sha_reply reply;
+
+    reply.slot = slot;
+    reply.status = status;
+
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->replies.push_back(reply);
+    c->wake_writer.notify_one();
+}
+
+/* The function Write_Replies is the loop of the writer thread of a connection. A send that fails, because the client
+   has gone, discards the reply so that the requests are still accounted for */
+
+void SHA1_Server::Write_Replies(Connection *c)
+{
+    std::unique_lock<std::mutex> lock(c->mutex);
+    struct sha_reply reply;
+
+    for (;;)
+    {
+        while (c->replies.empty() && !c->closing)
+            c->wake_writer.wait(lock);
+        if (c->replies.empty())
+            return;
+
+        reply = c->replies.front();
+        c->replies.pop_front();
+
+        lock.unlock();
+        Send_Reply(c->socket, reply.slot, reply.status);
+        lock.lock();
+
+        c->nr_unanswered--;
+        c->idle.notify_all();
+    }
+}
+
+/* The function Receive_Hello reads the sha_hello of a client and maps its ring. It returns EXIT_FAILURE if the message
+   is malformed, if the size of the ring does not fit in 64 bits, or if the memfd is not sealed against shrinking, any of
+   which would let the client fault the daemon */
+
+static int Receive_Hello(int socket, unsigned char **ring, uint64_t *ring_byte_size, uint32_t *nr_of_slots, uint32_t *slot_byte_size)
+{
+    struct sha_hello hello;
+    struct msghdr message;
+    struct iovec iov;
+    struct cmsghdr *control;
+    struct stat status;
+    char control_buffer[CMSG_SPACE(sizeof(int))];
+    int memfd = -1;
+    int seals;
+    void *address;
+
+    memset(&message, 0, sizeof(message));
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control_buffer;
+    message.msg_controllen = sizeof(control_buffer);
+
+    if (recvmsg(socket, &message, MSG_CMSG_CLOEXEC) != sizeof(hello))
+        return EXIT_FAILURE;
+
+    control = CMSG_FIRSTHDR(&message);
+    if (control == NULL || control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_RIGHTS ||
+        control->cmsg_len != CMSG_LEN(sizeof(int)))
+        return EXIT_FAILURE;
+    memcpy(&memfd, CMSG_DATA(control), sizeof(int));
+
+    /* The sizes come from the client, so the size of the ring is only computed once it is known not to wrap */
+
+    if (hello.slot_byte_size > SHA_PROTO_MAX_SLOT_BYTE_SIZE ||
+        hello.nr_of_slots > UINT64_MAX/SHA_SLOT_STRIDE(hello.slot_byte_size))
+    {
+        close(memfd);
+        return EXIT_FAILURE;
+    }
+
+    *nr_of_slots = hello.nr_of_slots;
+    *slot_byte_size = hello.slot_byte_size;
+    *ring_byte_size = hello.nr_of_slots*SHA_SLOT_STRIDE(hello.slot_byte_size);
+
+    seals = fcntl(memfd, F_GET_SEALS);
+    if (hello.magic != SHA_PROTO_MAGIC || hello.version != SHA_PROTO_VERSION || hello.nr_of_slots == 0 ||
+        seals < 0 || (seals & F_SEAL_SHRINK) == 0 || fstat(memfd, &status) != 0 ||
+        (uint64_t) status.st_size < *ring_byte_size)
+    {
+        close(memfd);
+        return EXIT_FAILURE;
+    }
+
+    address = mmap(NULL, *ring_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+    if (address == MAP_FAILED)
+        return EXIT_FAILURE;
+
+    *ring = (unsigned char*) address;
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Server::SHA1_Server
+ *
+ * PURPOSE: Constructs a server. No socket is created until Start is called.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                  I/O     DESCRIPTION
+ * --------            ----                  ---     -----------
+ * socket_path         char*                 I       the path of the Unix socket to listen on
+ * deadline_us         unsigned int          I       the deadline of the SHA1_Queue shared by all clients
+ * kernel              struct sha1_kernel*   I       the kernel to use, NULL for the default kernel of SHA1_Batch
+ *
+ *********************************************************************************************************************************/
+
+SHA1_Server::SHA1_Server(const char *socket_path, unsigned int deadline_us, const struct sha1_kernel *kernel)
+    : socket_path(socket_path), queue(deadline_us, kernel), listen_socket(-1), stopping(false)
+{
+}
+
+SHA1_Server::~SHA1_Server()
+{
+    Stop();
+}
+
+/* The function Start creates the socket and starts accepting clients. It returns EXIT_FAILURE if the socket cannot be
+   created or if another daemon is already listening on it */
+
+int SHA1_Server::Start()
+{
+    struct sockaddr_un address;
+    int probe;
+
+    if (socket_path.size() >= sizeof(address.sun_path))
+        return EXIT_FAILURE;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path.c_str());
+
+    /* A socket file left behind by a daemon that has exited is removed, a socket still answering is not */
+
+    probe = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (struct sockaddr*) &address, sizeof(address)) == 0)
+    {
+        close(probe);
+        return EXIT_FAILURE;
+    }
+    if (probe >= 0)
+        close(probe);
+    unlink(socket_path.c_str());
+
+    listen_socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_socket < 0 || bind(listen_socket, (struct sockaddr*) &address, sizeof(address)) != 0 ||
+        listen(listen_socket, SOMAXCONN) != 0)
+    {
+        if (listen_socket >= 0)
+            close(listen_socket);
+        listen_socket = -1;
+        return EXIT_FAILURE;
+    }
+
+    stopping = false;
+    acceptor = std::thread(&SHA1_Server::Accept_Loop, this);
+    return EXIT_SUCCESS;
+}
+
+/* The function Stop disconnects all clients, completing the requests in flight, and removes the socket */
+
+void SHA1_Server::Stop()
+{
+    std::list<Connection*>::iterator it;
+
+    if (listen_socket < 0)
+        return;
+
+    stopping = true;
+    acceptor.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (it = connections.begin(); it != connections.end(); ++it)
+            shutdown((*it)->socket, SHUT_RDWR);
+    }
+    Reap_Connections(true);
+
+    close(listen_socket);
+    unlink(socket_path.c_str());
+    listen_socket = -1;
+}
+
+/* The function Reap_Connections joins the threads of the clients that have disconnected, or of all clients if all is set */
+
+void SHA1_Server::Reap_Connections(bool all)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::list<Connection*>::iterator it;
+
+    for (it = connections.begin(); it != connections.end();)
+    {
+        if (all || (*it)->done)
+        {
+            (*it)->thread.join();
+            delete *it;
+            it = connections.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void SHA1_Server::Accept_Loop()
+{
+    struct pollfd poll_socket;
+    Connection *connection;
+    int socket;
+
+    poll_socket.fd = listen_socket;
+    poll_socket.events = POLLIN;
+
+    while (!stopping)
+    {
+        Reap_Connections(false);
+
+        if (poll(&poll_socket, 1, POLL_MS) <= 0)
+            continue;
+
+        socket = accept4(listen_socket, NULL, NULL, SOCK_CLOEXEC);
+        if (socket < 0)
+            continue;
+
+        connection = new Connection;
+        connection->socket = socket;
+        connection->ring = NULL;
+        connection->nr_unanswered = 0;
+        connection->closing = false;
+        connection->done = false;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.push_back(connection);
+        connection->thread = std::thread(&SHA1_Server::Serve, this, connection);
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA1_Server::Serve
+ *
+ * PURPOSE: The loop of the thread serving one client. Maps the ring of the client and posts every valid request to the
+ *          shared queue, whose callback writes the hash into the slot header and queues the reply for the writer of the
+ *          client. When the client disconnects, the requests in flight are completed and their replies sent before the
+ *          ring is unmapped.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA1_Server::Serve(Connection *c)
+{
+    struct sha_request request;
+    ssize_t received;
+    uint64_t stride;
+
+    if (Receive_Hello(c->socket, &c->ring, &c->ring_byte_size, &c->nr_of_slots, &c->slot_byte_size) != EXIT_SUCCESS)
+    {
+        Send_Reply(c->socket, 0, SHA_PROTO_BAD_REQUEST);
+        close(c->socket);
+        c->done = true;
+        return;
+    }
+    Send_Reply(c->socket, 0, SHA_PROTO_OK);
+    stride = SHA_SLOT_STRIDE(c->slot_byte_size);
+    c->writer = std::thread(&SHA1_Server::Write_Replies, c);
+
+    for (;;)
+    {
+        received = recv(c->socket, &request, sizeof(request), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received != sizeof(request))
+            break;
+
+        /* A client may not have more requests unanswered than it has slots */
+
+        {
+            std::unique_lock<std::mutex> lock(c->mutex);
+            while (c->nr_unanswered >= c->nr_of_slots)
+                c->idle.wait(lock);
+            c->nr_unanswered++;
+        }
+
+        if (request.slot >= c->nr_of_slots || request.byte_size > c->slot_byte_size)
+        {
+            Post_Reply(c, request.slot, SHA_PROTO_BAD_REQUEST);
+            continue;
+        }
+
+        uint32_t slot = request.slot;
+        unsigned char *header = &c->ring[slot*stride];
+
+        queue.Submit((char*) header + sizeof(struct sha_slot_header), request.byte_size, [c, slot, header](const SHA1_Queue::Digest &hash)
+        {
+            memcpy(header, &hash[0], HASH_SIZE*sizeof(uint32_t));
+            Post_Reply(c, slot, SHA_PROTO_OK);
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(c->mutex);
+        while (c->nr_unanswered > 0)
+            c->idle.wait(lock);
+        c->closing = true;
+        c->wake_writer.notify_one();
+    }
+    c->writer.join();
+
+    munmap(c->ring, c->ring_byte_size);
+    close(c->socket);
+    c->done = true;
+}
@@ -0,0 +1,55 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaserver.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the class SHA1_Server defined in shaserver.cpp, the core of the hashing daemon shad
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHASERVER__
+#define __SHASERVER__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "shaqueue.h"
+
+class SHA1_Server
+{
+public:
+
+    SHA1_Server(const char *socket_path, unsigned int deadline_us = 100, const struct sha1_kernel *kernel = NULL);
+    ~SHA1_Server();
+
+    int Start();
+    void Stop();
+
+    SHA1_Queue::Stats Get_Stats() { return queue.Get_Stats(); }
+
+private:
+
+    struct Connection;
+
+    void Accept_Loop();
+    void Serve(Connection *connection);
+    static void Post_Reply(Connection *connection, uint32_t slot, uint32_t status);
+    static void Write_Replies(Connection *connection);
+    void Reap_Connections(bool all);
+
+    std::string socket_path;
+    SHA1_Queue queue;
+    int listen_socket;
+    std::atomic<bool> stopping;
+    std::thread acceptor;
+
+    std::mutex mutex;
+    std::list<Connection*> connections;       /* the connections being served, protected by mutex                       */
+};
+
+#endif
@@ -0,0 +1,566 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaset.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-25
+ *
+ * CONTENT: Implements sets of known SHA1 hashes stored in a file which is mapped into memory, so that a set of a hundred
+ *          million hashes is opened after one pass over its index, under a hundredth of the file, and its pages are
+ *          shared by every process using it. The file
+ *          holds, each section aligned to a page,
+ *
+ *              the header          struct sha_set_header below
+ *              the index           2^index_bits + 1 positions, the first hash of every bucket of hashes sharing their
+ *                                  leading index_bits bits, chosen so that a bucket holds 32 to 64 hashes on average
+ *              the hashes          the distinct hashes in increasing order, as 20 big-endian bytes each
+ *              the Bloom filter    blocks of 64 bytes, where a hash sets nr_of_bloom_probes bits of a single block
+ *
+ *          The numbers of the header and the index are stored in the byte order of the host which built the file.
+ *
+ *          A lookup first tests the Bloom filter, which costs a single cache line and rejects most unknown hashes. Since
+ *          SHA1 hashes are uniformly distributed, the position of a hash within its bucket is then estimated from its
+ *          leading 64 bits by interpolation, and the hash is found within a step or two from the estimate. The bits of
+ *          the hash itself serve as the hash functions of the Bloom filter. The batch lookup goes through groups of
+ *          hashes one stage at a time and prefetches the cache lines needed by the next stage, so that the memory
+ *          accesses of a group overlap instead of following each other.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shaset.h"
+
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+#define HASH_BYTES 20       /* defines the size of the hash in BYTES                                    */
+#define PAGE_SIZE 4096      /* defines the alignment of the sections of the file in BYTES               */
+#define BUCKET_SIZE 32      /* defines the smallest average number of hashes in a bucket of the index   */
+#define MAX_PROBES 7        /* defines the largest number of bits tested per hash in the Bloom filter   */
+#define GROUP_SIZE 16       /* defines the number of hashes looked up together by the batch lookup      */
+
+#define SHA_SET_MAGIC "SHA1SET"
+#define SHA_SET_VERSION 1
+
+struct sha_set_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t index_bits;
+    uint64_t nr_of_hashes;
+    uint64_t nr_of_bloom_blocks;
+    uint32_t nr_of_bloom_probes;
+    uint32_t reserved;
+    uint64_t index_offset;
+    uint64_t hashes_offset;
+    uint64_t bloom_offset;
+};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: HASH ARITHMETIC
+ *
+ **************************************************************************************************************************************/
+
+static inline uint64_t Align(uint64_t offset)
+{
+    return (offset + PAGE_SIZE - 1) & ~(uint64_t) (PAGE_SIZE - 1);
+}
+
+static inline uint64_t Prefix(const uint32_t *hash)
+{
+    return ((uint64_t) hash[0] << 32) | hash[1];
+}
+
+static inline uint64_t Bucket(uint64_t prefix, unsigned int index_bits)
+{
+    return index_bits > 0 ? prefix >> (64 - index_bits) : 0;
+}
+
+static inline void To_Bytes(const uint32_t *hash, unsigned char *bytes)
+{
+    int i;
+
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        bytes[4*i] = (unsigned char) (hash[i] >> 24);
+        bytes[4*i + 1] = (unsigned char) (hash[i] >> 16);
+        bytes[4*i + 2] = (unsigned char) (hash[i] >> 8);
+        bytes[4*i + 3] = (unsigned char) hash[i];
+    }
+}
+
+/* The block of the Bloom filter is chosen by the last two words of the hash, and the bits within it by 9-bit fields of
+   the second and third words */
+
+static inline uint64_t Bloom_Block(uint64_t nr_of_bloom_blocks, const uint32_t *hash)
+{
+    uint64_t v = ((uint64_t) hash[3] << 32) | hash[4];
+    return (uint64_t) (((unsigned __int128) v*nr_of_bloom_blocks) >> 64);
+}
+
+static inline int Bloom_Test(const uint64_t *block, unsigned int nr_of_probes, const uint32_t *hash)
+{
+    uint64_t v = ((uint64_t) hash[1] << 32) | hash[2];
+    unsigned int i, bit;
+
+    for (i = 0; i < nr_of_probes; i++)
+    {
+        bit = (v >> 9*i) & 511;
+        if ((block[bit >> 6] & ((uint64_t) 1 << (bit & 63))) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+/* The function Guess estimates the position of a hash in its bucket from the bits of the prefix below the index bits */
+
+static inline uint64_t Guess(uint64_t prefix, unsigned int index_bits, uint64_t lo, uint64_t hi)
+{
+    uint64_t fraction = index_bits > 0 ? prefix << index_bits : prefix;
+    return lo + (uint64_t) (((unsigned __int128) fraction*(hi - lo)) >> 64);
+}
+
+/* The function Scan walks from the estimated position towards the hash until it is found or passed */
+
+static int Scan(const unsigned char *hashes, const unsigned char *bytes, uint64_t lo, uint64_t hi, uint64_t guess)
+{
+    uint64_t i;
+    int c;
+
+    c = memcmp(bytes, &hashes[HASH_BYTES*guess], HASH_BYTES);
+    if (c == 0)
+        return 1;
+
+    if (c > 0)
+    {
+        for (i = guess + 1; i < hi; i++)
+        {
+            c = memcmp(bytes, &hashes[HASH_BYTES*i], HASH_BYTES);
+            if (c <= 0)
+                return c == 0;
+        }
+        return 0;
+    }
+
+    for (i = guess; i-- > lo; )
+    {
+        c = memcmp(bytes, &hashes[HASH_BYTES*i], HASH_BYTES);
+        if (c >= 0)
+            return c == 0;
+    }
+    return 0;
+}
+
+static inline void From_Bytes(const unsigned char *bytes, uint32_t *hash)
+{
+    int i;
+
+    for (i = 0; i < HASH_SIZE; i++)
+        hash[i] = ((uint32_t) bytes[4*i] << 24) | ((uint32_t) bytes[4*i + 1] << 16) | ((uint32_t) bytes[4*i + 2] << 8) | bytes[4*i + 3];
+}
+
+static int Compare_Hashes(const void *a, const void *b)
+{
+    return memcmp(a, b, HASH_BYTES);
+}
+
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Set_Build
+ *
+ * PURPOSE: Writes a set file of the given hashes. Duplicates are stored once. The hashes are scattered by bucket directly
+ *          into the mapped file and every bucket is then sorted on its own, so that apart from the index and the Bloom
+ *          filter no memory is needed beyond the hashes given.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT              TYPE            I/O     DESCRIPTION
+ * --------              ----            ---     -----------
+ * filename              const char*     I       the name of the file to be written
+ * hashes                const uint32_t* I       the hashes, 5 words each as computed by SHA1
+ * nr_of_hashes          uint64_t        I       the number of hashes
+ * bloom_bits_per_hash   unsigned int    I       the size of the Bloom filter in bits per hash, 0 for no filter
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the file could not be written
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Set_Build(const char *filename, const uint32_t *hashes, uint64_t nr_of_hashes, unsigned int bloom_bits_per_hash)
+{
+    struct sha_set_header header;
+    uint64_t *index, *cursor, *bloom = NULL;
+    uint64_t nr_of_buckets, map_byte_size, i, j, k, bucket, nr_of_unique;
+    unsigned char *map, *sorted;
+    unsigned int index_bits = 0, nr_of_probes;
+    int fd, exit_status = EXIT_FAILURE;
+
+    /* Lay out the index and the hashes. The Bloom filter follows the hashes, since its size depends on the number of
+       distinct hashes, which is known only once they are sorted */
+
+    while (index_bits < 40 && (nr_of_hashes >> (index_bits + 1)) >= BUCKET_SIZE)
+        index_bits++;
+    nr_of_buckets = (uint64_t) 1 << index_bits;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SHA_SET_MAGIC, sizeof(header.magic));
+    header.version = SHA_SET_VERSION;
+    header.index_bits = index_bits;
+    header.index_offset = Align(sizeof(header));
+    header.hashes_offset = Align(header.index_offset + 8*(nr_of_buckets + 1));
+    map_byte_size = header.hashes_offset + HASH_BYTES*nr_of_hashes;
+
+    /* Count the hashes of every bucket */
+
+    index = (uint64_t*) calloc(nr_of_buckets + 1, sizeof(uint64_t));
+    cursor = (uint64_t*) malloc(nr_of_buckets*sizeof(uint64_t));
+    if (index == NULL || cursor == NULL)
+        goto free_index;
+
+    for (i = 0; i < nr_of_hashes; i++)
+        index[Bucket(Prefix(&hashes[HASH_SIZE*i]), index_bits) + 1]++;
+    for (bucket = 0; bucket < nr_of_buckets; bucket++)
+    {
+        index[bucket + 1] += index[bucket];
+        cursor[bucket] = index[bucket];
+    }
+
+    /* Map the file and scatter the hashes into their buckets */
+
+    fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        goto free_index;
+    if (ftruncate(fd, map_byte_size) != 0)
+        goto close_file;
+    map = (unsigned char*) mmap(NULL, map_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        goto close_file;
+
+    sorted = &map[header.hashes_offset];
+    for (i = 0; i < nr_of_hashes; i++)
+    {
+        bucket = Bucket(Prefix(&hashes[HASH_SIZE*i]), index_bits);
+        To_Bytes(&hashes[HASH_SIZE*i], &sorted[HASH_BYTES*cursor[bucket]++]);
+    }
+
+    /* Sort every bucket and remove the duplicates, moving the hashes down and updating the index as we go */
+
+    nr_of_unique = 0;
+    for (bucket = 0; bucket < nr_of_buckets; bucket++)
+    {
+        j = index[bucket];
+        k = index[bucket + 1];
+        qsort(&sorted[HASH_BYTES*j], k - j, HASH_BYTES, Compare_Hashes);
+
+        index[bucket] = nr_of_unique;
+        for (i = j; i < k; i++)
+        {
+            if (nr_of_unique > index[bucket] &&
+                memcmp(&sorted[HASH_BYTES*i], &sorted[HASH_BYTES*(nr_of_unique - 1)], HASH_BYTES) == 0)
+                continue;
+            if (nr_of_unique != i)
+                memmove(&sorted[HASH_BYTES*nr_of_unique], &sorted[HASH_BYTES*i], HASH_BYTES);
+            nr_of_unique++;
+        }
+    }
+    index[nr_of_buckets] = nr_of_unique;
+
+    /* Fill the Bloom filter from the distinct hashes */
+
+    header.nr_of_hashes = nr_of_unique;
+    header.nr_of_bloom_blocks = (nr_of_unique*bloom_bits_per_hash + 511)/512;
+    nr_of_probes = (unsigned int) (0.693*bloom_bits_per_hash + 0.5);
+    header.nr_of_bloom_probes = nr_of_probes < 1 ? 1 : (nr_of_probes > MAX_PROBES ? MAX_PROBES : nr_of_probes);
+    header.bloom_offset = Align(header.hashes_offset + HASH_BYTES*nr_of_unique);
+
+    bloom = (uint64_t*) calloc(8*header.nr_of_bloom_blocks + 1, sizeof(uint64_t));
+    if (bloom == NULL)
+    {
+        munmap(map, map_byte_size);
+        goto close_file;
+    }
+
+    for (i = 0; i < nr_of_unique && header.nr_of_bloom_blocks > 0; i++)
+    {
+        uint32_t hash[HASH_SIZE];
+        uint64_t *block, v;
+        unsigned int p, bit;
+
+        From_Bytes(&sorted[HASH_BYTES*i], hash);
+        block = &bloom[8*Bloom_Block(header.nr_of_bloom_blocks, hash)];
+        v = ((uint64_t) hash[1] << 32) | hash[2];
+        for (p = 0; p < header.nr_of_bloom_probes; p++)
+        {
+            bit = (v >> 9*p) & 511;
+            block[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+        }
+    }
+
+    memcpy(map, &header, sizeof(header));
+    memcpy(&map[header.index_offset], index, 8*(nr_of_buckets + 1));
+
+    if (munmap(map, map_byte_size) == 0 &&
+        ftruncate(fd, header.bloom_offset + 64*header.nr_of_bloom_blocks) == 0 &&
+        pwrite(fd, bloom, 64*header.nr_of_bloom_blocks, header.bloom_offset) == (ssize_t) (64*header.nr_of_bloom_blocks))
+        exit_status = EXIT_SUCCESS;
+
+    close_file:
+    if (close(fd) != 0)
+        exit_status = EXIT_FAILURE;
+    if (exit_status != EXIT_SUCCESS)
+        unlink(filename);
+
+    free_index:
+    free(index);
+    free(cursor);
+    free(bloom);
+    return exit_status;
+}
+
+
+/* The function Check_Index returns 1 if the index starts at zero, never decreases and ends at nr_of_hashes, so that
+   every bucket lies within the hashes, and 0 otherwise */
+
+static int Check_Index(const uint64_t *index, unsigned int index_bits, uint64_t nr_of_hashes)
+{
+    uint64_t nr_of_buckets, bucket;
+
+    nr_of_buckets = (uint64_t) 1 << index_bits;
+    if (index[0] != 0 || index[nr_of_buckets] != nr_of_hashes)
+        return 0;
+
+    for (bucket = 0; bucket < nr_of_buckets; bucket++)
+        if (index[bucket] > index[bucket + 1])
+            return 0;
+
+    return 1;
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Set_Open
+ *
+ * PURPOSE: Maps a set file written by SHA_Set_Build into memory and checks its header and its index, which must start at
+ *          zero, never decrease and end at the number of hashes, so that no lookup reaches outside the hashes. Beyond
+ *          the index, only the pages touched by lookups are read from disk.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * set                 sha_set*        O       pointer to the set to be opened
+ * filename            const char*     I       the name of the set file
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the file cannot be mapped or is not a valid set file
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Set_Open(struct sha_set *set, const char *filename)
+{
+    struct sha_set_header header;
+    struct stat st;
+    unsigned char *map;
+    uint64_t size;
+    int fd;
+
+    memset(set, 0, sizeof(*set));
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return EXIT_FAILURE;
+    if (fstat(fd, &st) != 0 || (uint64_t) st.st_size < sizeof(header))
+    {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    size = st.st_size;
+
+    map = (unsigned char*) mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return EXIT_FAILURE;
+
+    /* The offsets and counts are bounded by the size of the file before they are added, so that no sum overflows */
+
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, SHA_SET_MAGIC, sizeof(header.magic)) != 0 || header.version != SHA_SET_VERSION ||
+        header.index_bits > 40 || header.nr_of_bloom_probes < 1 || header.nr_of_bloom_probes > MAX_PROBES ||
+        header.index_offset < sizeof(header) || header.index_offset % 8 != 0 || header.index_offset > size ||
+        header.hashes_offset > size || header.bloom_offset > size || header.nr_of_hashes > size/HASH_BYTES || header.nr_of_bloom_blocks > size/64 ||
+        header.index_offset + 8*(((uint64_t) 1 << header.index_bits) + 1) > header.hashes_offset ||
+        header.hashes_offset + HASH_BYTES*header.nr_of_hashes > header.bloom_offset ||
+        header.bloom_offset + 64*header.nr_of_bloom_blocks != size ||
+        !Check_Index((const uint64_t*) &map[header.index_offset], header.index_bits, header.nr_of_hashes))
+    {
+        munmap(map, size);
+        return EXIT_FAILURE;
+    }
+
+    /* Lookups touch the file at random, so read-ahead would only fetch pages never used */
+
+    madvise(map, size, MADV_RANDOM);
+
+    set->map = map;
+    set->map_byte_size = size;
+    set->nr_of_hashes = header.nr_of_hashes;
+    set->index_bits = header.index_bits;
+    set->index = (const uint64_t*) &map[header.index_offset];
+    set->nr_of_bloom_blocks = header.nr_of_bloom_blocks;
+    set->nr_of_bloom_probes = header.nr_of_bloom_probes;
+    set->bloom = (const uint64_t*) &map[header.bloom_offset];
+    set->hashes = &map[header.hashes_offset];
+
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_Set_Close unmaps a set opened by SHA_Set_Open */
+
+void SHA_Set_Close(struct sha_set *set)
+{
+    if (set->map != NULL)
+        munmap(set->map, set->map_byte_size);
+    memset(set, 0, sizeof(*set));
+}
+
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Set_Contains
+ *
+ * PURPOSE: Determines whether a hash is in a set
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * set                 sha_set*        I       pointer to the set
+ * hash                const uint32_t* I       the hash, 5 words as computed by SHA1
+ *
+ * RETURN VALUE : int, 1 if the hash is in the set and 0 otherwise
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Set_Contains(const struct sha_set *set, const uint32_t *hash)
+{
+    unsigned char bytes[HASH_BYTES];
+    uint64_t prefix, bucket, lo, hi;
+
+    if (set->nr_of_bloom_blocks > 0 &&
+        !Bloom_Test(&set->bloom[8*Bloom_Block(set->nr_of_bloom_blocks, hash)], set->nr_of_bloom_probes, hash))
+        return 0;
+
+    prefix = Prefix(hash);
+    bucket = Bucket(prefix, set->index_bits);
+    lo = set->index[bucket];
+    hi = set->index[bucket + 1];
+    if (lo == hi)
+        return 0;
+
+    To_Bytes(hash, bytes);
+    return Scan(set->hashes, bytes, lo, hi, Guess(prefix, set->index_bits, lo, hi));
+}
+
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Set_Contains_Batch
+ *
+ * PURPOSE: Determines for many hashes whether they are in a set. The hashes are taken in groups, and every group goes
+ *          through the Bloom filter, the index and the hashes one stage at a time, each stage prefetching the cache lines
+ *          read by the next stage for all hashes of the group still in question.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * set                 sha_set*        I       pointer to the set
+ * hashes              const uint32_t* I       the hashes, 5 words each as computed by SHA1
+ * nr_of_hashes        uint64_t        I       the number of hashes
+ * results             unsigned char*  O       pointer to the array where 1 or 0 is stored for every hash
+ *
+ * RETURN VALUE : uint64_t, the number of hashes found in the set
+ *
+ *******************************************************************************************************************************/
+
+uint64_t SHA_Set_Contains_Batch(const struct sha_set *set, const uint32_t *hashes, uint64_t nr_of_hashes, unsigned char *results)
+{
+    const uint64_t *blocks[GROUP_SIZE];
+    uint64_t prefix[GROUP_SIZE], bucket[GROUP_SIZE], guess[GROUP_SIZE];
+    unsigned char candidate[GROUP_SIZE];
+    unsigned char bytes[HASH_BYTES];
+    uint64_t nr_found = 0, start, lo, hi;
+    unsigned int n, g;
+
+    for (start = 0; start < nr_of_hashes; start += n)
+    {
+        const uint32_t *group = &hashes[HASH_SIZE*start];
+        n = (unsigned int) (nr_of_hashes - start < GROUP_SIZE ? nr_of_hashes - start : GROUP_SIZE);
+
+        /* Stage 1: prefetch the blocks of the Bloom filter */
+
+        for (g = 0; g < n; g++)
+        {
+            candidate[g] = 1;
+            if (set->nr_of_bloom_blocks > 0)
+            {
+                blocks[g] = &set->bloom[8*Bloom_Block(set->nr_of_bloom_blocks, &group[HASH_SIZE*g])];
+                __builtin_prefetch(blocks[g]);
+            }
+        }
+
+        /* Stage 2: test the Bloom filter and prefetch the index entries of the hashes passing it */
+
+        for (g = 0; g < n; g++)
+        {
+            if (set->nr_of_bloom_blocks > 0)
+                candidate[g] = Bloom_Test(blocks[g], set->nr_of_bloom_probes, &group[HASH_SIZE*g]);
+            if (candidate[g])
+            {
+                prefix[g] = Prefix(&group[HASH_SIZE*g]);
+                bucket[g] = Bucket(prefix[g], set->index_bits);
+                __builtin_prefetch(&set->index[bucket[g]]);
+            }
+        }
+
+        /* Stage 3: estimate the positions and prefetch the hashes there */
+
+        for (g = 0; g < n; g++)
+        {
+            if (!candidate[g])
+                continue;
+            lo = set->index[bucket[g]];
+            hi = set->index[bucket[g] + 1];
+            if (lo == hi)
+            {
+                candidate[g] = 0;
+                continue;
+            }
+            guess[g] = Guess(prefix[g], set->index_bits, lo, hi);
+            __builtin_prefetch(&set->hashes[HASH_BYTES*guess[g]]);
+            __builtin_prefetch(&set->hashes[HASH_BYTES*guess[g] + HASH_BYTES - 1]);
+        }
+
+        /* Stage 4: compare */
+
+        for (g = 0; g < n; g++)
+        {
+            if (candidate[g])
+            {
+                To_Bytes(&group[HASH_SIZE*g], bytes);
+                candidate[g] = (unsigned char) Scan(set->hashes, bytes, set->index[bucket[g]], set->index[bucket[g] + 1], guess[g]);
+            }
+            results[start + g] = candidate[g];
+            nr_found += candidate[g];
+        }
+    }
+
+    return nr_found;
+}
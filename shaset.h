@@ -0,0 +1,40 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaset.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the memory-mapped sets of known SHA1 hashes and the functions defined in shaset.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHASET__
+#define __SHASET__
+
+#define SHA_SET_DEFAULT_BLOOM_BITS 12         /* the default number of Bloom filter bits per hash                           */
+
+/* A sha_set is a set file mapped into memory by SHA_Set_Open. Its members point into the mapping */
+
+struct sha_set
+{
+    void *map;                                /* the mapping of the whole file                                              */
+    uint64_t map_byte_size;
+    uint64_t nr_of_hashes;                    /* the number of distinct hashes in the set                                   */
+    unsigned int index_bits;                  /* the number of leading bits of a hash selecting its bucket in the index     */
+    const uint64_t *index;                    /* the position of the first hash of every bucket, 2^index_bits + 1 entries   */
+    uint64_t nr_of_bloom_blocks;              /* the number of 64-byte blocks of the Bloom filter, 0 if it has none         */
+    unsigned int nr_of_bloom_probes;          /* the number of bits tested in a block for every hash                        */
+    const uint64_t *bloom;
+    const unsigned char *hashes;              /* the sorted hashes as 20 big-endian bytes each                              */
+};
+
+int SHA_Set_Build(const char *filename, const uint32_t *hashes, uint64_t nr_of_hashes, unsigned int bloom_bits_per_hash);
+
+int SHA_Set_Open(struct sha_set *set, const char *filename);
+
+void SHA_Set_Close(struct sha_set *set);
+
+int SHA_Set_Contains(const struct sha_set *set, const uint32_t *hash);
+
+uint64_t SHA_Set_Contains_Batch(const struct sha_set *set, const uint32_t *hashes, uint64_t nr_of_hashes, unsigned char *results);
+
+#endif
@@ -0,0 +1,129 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shasetbuild.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-25
+ *
+ * CONTENT: The set builder shasetbuild. Reads SHA1 hashes as hexadecimal text, one per line, and writes them as a set file
+ *          for SHA_Set_Open. A line may be the output of sha1sum, where the hash comes first, or a line of a hash list
+ *          in CSV format such as NSRL, where the hash is the first field and may be quoted. Lines not beginning with 40
+ *          hexadecimal digits, such as a CSV header, are counted and skipped. The statistics of the run are written as
+ *          JSON to standard error.
+ *
+ *          Usage: shasetbuild [--bloom-bits N] OUTPUT [INPUT|-]...
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "shahex.h"
+#include "shaset.h"
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--bloom-bits N] OUTPUT [INPUT|-]...\n", program);
+}
+
+/* The function Read_Hashes appends the hashes of every line of a file to hashes, and counts the lines skipped */
+
+static int Read_Hashes(const char *filename, std::vector<uint32_t> *hashes, uint64_t *skipped)
+{
+    FILE *fp = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    char line[4096];
+    uint32_t hash[5];
+
+    if (fp == NULL)
+        return EXIT_FAILURE;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        const char *hex = line[0] == '"' ? &line[1] : line;
+
+        if (strlen(hex) >= 40 && SHA_Hex_Decode(hex, 5, hash) == EXIT_SUCCESS &&
+            (hex[40] == '\0' || strchr(" \t\r\n\",*", hex[40]) != NULL))
+            hashes->insert(hashes->end(), hash, hash + 5);
+        else
+            (*skipped)++;
+
+        /* Skip the rest of a line longer than the buffer */
+
+        while (strchr(line, '\n') == NULL && fgets(line, sizeof(line), fp) != NULL)
+            ;
+    }
+
+    if (fp != stdin)
+        fclose(fp);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int bloom_bits = SHA_SET_DEFAULT_BLOOM_BITS;
+    std::vector<const char*> inputs;
+    std::vector<uint32_t> hashes;
+    const char *output = NULL;
+    uint64_t skipped = 0;
+    struct timespec start, end;
+    struct sha_set set;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bloom-bits") == 0 && i + 1 < argc)
+            bloom_bits = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-' || argv[i][1] == '\0')
+        {
+            if (output == NULL)
+                output = argv[i];
+            else
+                inputs.push_back(argv[i]);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (output == NULL || bloom_bits > 64)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (inputs.empty())
+        inputs.push_back("-");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (const char *input : inputs)
+        if (Read_Hashes(input, &hashes, &skipped) != EXIT_SUCCESS)
+        {
+            fprintf(stderr, "%s: %s: cannot be read\n", argv[0], input);
+            return EXIT_FAILURE;
+        }
+
+    if (SHA_Set_Build(output, hashes.data(), hashes.size()/5, bloom_bits) != EXIT_SUCCESS ||
+        SHA_Set_Open(&set, output) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "%s: %s: cannot be written\n", argv[0], output);
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    fprintf(stderr, "{\"hashes_read\": %llu, \"lines_skipped\": %llu, \"distinct_hashes\": %llu, \"index_bits\": %u, "
+                    "\"bloom_blocks\": %llu, \"bloom_probes\": %u, \"file_byte_size\": %llu, \"seconds\": %.3f}\n",
+            (unsigned long long) hashes.size()/5, (unsigned long long) skipped, (unsigned long long) set.nr_of_hashes,
+            set.index_bits, (unsigned long long) set.nr_of_bloom_blocks, set.nr_of_bloom_probes,
+            (unsigned long long) set.map_byte_size, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9);
+
+    SHA_Set_Close(&set);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shasparse.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-03
+ *
+ * CONTENT: Implements the sparse file backend of SHA1_File, SHA256_File and SHA224_File. Disk images and preallocated
+ *          files are often mostly holes, which read as zeros but occupy no blocks on disk. The data and hole regions of
+ *          the file are enumerated with lseek and SEEK_DATA/SEEK_HOLE, the data regions are read with pread in large
+ *          chunks and the holes are hashed from a static block of zeros without any reads. The digest is the same as
+ *          that of the library path, since the compression function sees the same bytes.
+ *
+ *          The holes are still compressed, so the time taken is bounded by the compression of the whole file, but the
+ *          bytes read are those of the data alone. On file systems that report unwritten extents as holes, such as
+ *          ext4 and XFS, preallocated regions are skipped as well. On file systems without SEEK_DATA the whole file is
+ *          one data region.
+ *
+ *          The backend is chosen by SHA_File_Set_Backend. The file functions hash a file in the library if it is not
+ *          a regular file, e.g. a pipe, or if it cannot be read here.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "shalib.h"
+#include "shasparse.h"
+
+#define BLOCK_SIZE 64                 /* defines the size of a block in BYTES                                     */
+#define CHUNK_SIZE (1 << 20)          /* defines the number of BYTES read from a data region at a time            */
+#define ZERO_BLOCKS 1024              /* defines the number of zero blocks hashed per call for a hole             */
+#define STATE_SIZE 8                  /* defines the size of the largest hash state in number of 32-bit INTEGERS  */
+
+static const unsigned char zero_blocks[ZERO_BLOCKS*BLOCK_SIZE] = {0};
+
+/* An algorithm of 64-byte blocks and 32-bit words the backend can hash */
+
+struct sparse_algorithm
+{
+    const char *name;
+    uint32_t H_init[STATE_SIZE];
+    void (*Hash_Blocks)(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+    unsigned int nr_of_words;
+};
+
+static const struct sparse_algorithm algorithms[] =
+{
+    {"sha1",   {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0, 0, 0, 0}, SHA1_Hash_Blocks, 5},
+    {"sha224", {0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4},
+               SHA256_Hash_Blocks, 7},
+    {"sha256", {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+               SHA256_Hash_Blocks, 8}
+};
+
+/* A sparse_hash holds the state of the hash and the bytes of the last partial block, which may straddle regions */
+
+struct sparse_hash
+{
+    const struct sparse_algorithm *algorithm;
+    uint32_t H[STATE_SIZE];
+    unsigned char tail[BLOCK_SIZE];
+    unsigned int tail_byte_size;
+};
+
+/* The function Feed hashes size bytes following those fed before. If data is NULL the bytes are zeros. */
+
+static void Feed(struct sparse_hash *s, const unsigned char *data, uint64_t size)
+{
+    uint64_t nr_of_blocks, n;
+
+    /* Complete the partial block first */
+
+    if (s->tail_byte_size > 0)
+    {
+        n = BLOCK_SIZE - s->tail_byte_size < size ? BLOCK_SIZE - s->tail_byte_size : size;
+        if (data != NULL)
+            memcpy(&s->tail[s->tail_byte_size], data, n);
+        else
+            memset(&s->tail[s->tail_byte_size], 0, n);
+        s->tail_byte_size += (unsigned int) n;
+        size -= n;
+        if (data != NULL)
+            data += n;
+
+        if (s->tail_byte_size < BLOCK_SIZE)
+            return;
+        s->algorithm->Hash_Blocks(s->tail, 1, s->H);
+        s->tail_byte_size = 0;
+    }
+
+    /* Hash the whole blocks in place, or from the zero blocks */
+
+    nr_of_blocks = size/BLOCK_SIZE;
+    if (data != NULL)
+    {
+        if (nr_of_blocks > 0)
+            s->algorithm->Hash_Blocks((unsigned char*) data, nr_of_blocks, s->H);
+        data += nr_of_blocks*BLOCK_SIZE;
+    }
+    else
+    {
+        for (n = nr_of_blocks; n > 0; n -= n < ZERO_BLOCKS ? n : ZERO_BLOCKS)
+            s->algorithm->Hash_Blocks((unsigned char*) zero_blocks, n < ZERO_BLOCKS ? n : ZERO_BLOCKS, s->H);
+    }
+
+    /* Keep the rest for the next call */
+
+    s->tail_byte_size = (unsigned int) (size - nr_of_blocks*BLOCK_SIZE);
+    if (data != NULL)
+        memcpy(s->tail, data, s->tail_byte_size);
+    else
+        memset(s->tail, 0, s->tail_byte_size);
+}
+
+/* The function Feed_Data reads the bytes between start and end of the file and hashes them. It returns EXIT_FAILURE if
+   the file cannot be read or has become shorter. */
+
+static int Feed_Data(struct sparse_hash *s, int fd, unsigned char *buffer, uint64_t start, uint64_t end)
+{
+    ssize_t n;
+
+    while (start < end)
+    {
+        n = pread(fd, buffer, end - start < CHUNK_SIZE ? end - start : CHUNK_SIZE, start);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return EXIT_FAILURE;
+
+        Feed(s, buffer, n);
+        start += n;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Sparse_File
+ *
+ * PURPOSE: Computes the hash of a file with the algorithm of the given name, reading its data regions alone and hashing
+ *          its holes from zero blocks
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                        I/O     DESCRIPTION
+ * --------            ----                        ---     -----------
+ * algorithm           const char*                 I       "sha1", "sha224" or "sha256"
+ * filename            char*                       I       pointer to char array containing the file name
+ * hash                uint32_t*                   O       pointer to the uint32_t array where the resulting hash is to be
+ *                                                         stored
+ * nr_of_words         unsigned int                I       the number of words of the hash, 5 for SHA1, 7 for SHA224 and 8
+ *                                                         for SHA256
+ * stats               struct sha_sparse_stats*    O       the regions found and the bytes read, or NULL
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if the algorithm is unknown, the file is not a regular file or it
+ *                cannot be read
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Sparse_File(const char *algorithm, char *filename, uint32_t *hash, unsigned int nr_of_words, struct sha_sparse_stats *stats)
+{
+    struct sha_sparse_stats local_stats;
+    struct sparse_hash s;
+    unsigned char *buffer, blocks[2*BLOCK_SIZE];
+    uint64_t file_byte_size, position, data_start, hole_start;
+    unsigned int i, nr_of_blocks;
+    struct stat status;
+    off_t offset;
+    int fd, exit_status = EXIT_SUCCESS;
+
+    if (stats == NULL)
+        stats = &local_stats;
+    memset(stats, 0, sizeof(*stats));
+
+    s.algorithm = NULL;
+    for (i = 0; i < sizeof(algorithms)/sizeof(algorithms[0]); i++)
+        if (strcmp(algorithm, algorithms[i].name) == 0 && nr_of_words == algorithms[i].nr_of_words)
+            s.algorithm = &algorithms[i];
+    if (s.algorithm == NULL)
+        return EXIT_FAILURE;
+
+    fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return EXIT_FAILURE;
+
+    buffer = (unsigned char*) malloc(CHUNK_SIZE);
+    if (buffer == NULL || fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        free(buffer);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    memcpy(s.H, s.algorithm->H_init, sizeof(s.H));
+    s.tail_byte_size = 0;
+    file_byte_size = status.st_size;
+    stats->file_byte_size = file_byte_size;
+
+    /* Alternate between holes and data regions until the end of the file */
+
+    position = 0;
+    while (position < file_byte_size && exit_status == EXIT_SUCCESS)
+    {
+#ifdef SEEK_DATA
+        offset = lseek(fd, (off_t) position, SEEK_DATA);
+        if (offset < 0)
+            data_start = errno == ENXIO ? file_byte_size : position;
+        else
+            data_start = (uint64_t) offset < file_byte_size ? (uint64_t) offset : file_byte_size;
+
+        offset = data_start < file_byte_size ? lseek(fd, (off_t) data_start, SEEK_HOLE) : -1;
+        hole_start = offset < 0 || (uint64_t) offset > file_byte_size ? file_byte_size : (uint64_t) offset;
+#else
+        offset = 0;
+        data_start = position;
+        hole_start = file_byte_size;
+#endif
+
+        if (data_start > position)
+        {
+            Feed(&s, NULL, data_start - position);
+            stats->hole_regions++;
+            stats->hole_bytes += data_start - position;
+        }
+
+        if (hole_start > data_start)
+        {
+            exit_status = Feed_Data(&s, fd, buffer, data_start, hole_start);
+            stats->data_regions++;
+            stats->data_bytes += hole_start - data_start;
+        }
+
+        position = hole_start > data_start ? hole_start : data_start;
+    }
+
+    free(buffer);
+    close(fd);
+
+    if (exit_status != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    /* Hash the last partial block and the pad */
+
+    nr_of_blocks = Set_64Byte_Final_Blocks(blocks, s.tail, s.tail_byte_size, file_byte_size);
+    s.algorithm->Hash_Blocks(blocks, nr_of_blocks, s.H);
+
+    for (i = 0; i < nr_of_words; i++)
+        hash[i] = s.H[i];
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,27 @@
+/***************************************************************************************************************************************
+ * FILENAME: shasparse.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the hashing of sparse files defined in shasparse.c, which reads the data regions of a file alone and
+ *          hashes the holes from zero blocks in memory
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHASPARSE__
+#define __SHASPARSE__
+
+/* The sha_sparse_stats holds the regions found in a file and the bytes actually read */
+
+struct sha_sparse_stats
+{
+    uint64_t file_byte_size;                  /* the size of the file in bytes                                              */
+    uint64_t data_regions;                    /* the number of data regions reported by SEEK_DATA                           */
+    uint64_t data_bytes;                      /* the bytes read from the data regions                                       */
+    uint64_t hole_regions;                    /* the number of holes reported by SEEK_HOLE                                  */
+    uint64_t hole_bytes;                      /* the bytes of the holes, hashed from zero blocks without reading            */
+};
+
+int SHA_Sparse_File(const char *algorithm, char *filename, uint32_t *hash, unsigned int nr_of_words, struct sha_sparse_stats *stats);
+
+#endif
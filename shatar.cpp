@@ -0,0 +1,106 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shatar.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-24
+ *
+ * CONTENT: The archive hasher shatar. Hashes every regular file of a tar archive, uncompressed or compressed with gzip or,
+ *          when built with SHA_ZSTD=1, zstd, through a SHA_Archive_Hasher without unpacking it, and prints one line per
+ *          member in the format of sha1sum, or sha256sum with --sha256, so that the output can be compared with that of
+ *          sha1sum over an unpacked tree. With --sizes the size of the member is printed between the hash and the path.
+ *          The statistics of the run are written as JSON to standard error.
+ *
+ *          Usage: shatar [--sha256] [--sizes] [--ring-size BYTES] ARCHIVE|-
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "shahex.h"
+#include "shaarchive.h"
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--sha256] [--sizes] [--ring-size BYTES] ARCHIVE|-\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+    SHA_Archive_Hasher::Algorithm algorithm = SHA_Archive_Hasher::SHA1;
+    size_t ring_byte_size = SHA_ARCHIVE_RING_SIZE;
+    const char *archive = NULL;
+    bool sizes = false;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sha256") == 0)
+            algorithm = SHA_Archive_Hasher::SHA256;
+        else if (strcmp(argv[i], "--sizes") == 0)
+            sizes = true;
+        else if (strcmp(argv[i], "--ring-size") == 0 && i + 1 < argc)
+            ring_byte_size = strtoull(argv[++i], NULL, 10);
+        else if (archive == NULL && (argv[i][0] != '-' || argv[i][1] == '\0'))
+            archive = argv[i];
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (archive == NULL)
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    SHA_Archive_Hasher hasher(algorithm, ring_byte_size);
+
+    int exit_status = hasher.Hash_File(archive, [sizes](const SHA_Archive_Hasher::Member &member)
+    {
+        char hex[65];
+        std::string path;
+        bool escaped = false;
+
+        /* Names with a backslash or a newline are escaped as by sha1sum */
+
+        for (char c : member.path)
+        {
+            if (c == '\\' || c == '\n')
+            {
+                path += (c == '\\') ? "\\\\" : "\\n";
+                escaped = true;
+            }
+            else
+                path += c;
+        }
+
+        SHA_Hex_Encode(member.hash, member.nr_of_words, hex, SHA_HEX_LOWERCASE);
+        if (sizes)
+            printf("%s%s  %llu  %s\n", escaped ? "\\" : "", hex, (unsigned long long) member.file_byte_size, path.c_str());
+        else
+            printf("%s%s  %s\n", escaped ? "\\" : "", hex, path.c_str());
+    });
+
+    fflush(stdout);
+
+    if (exit_status != EXIT_SUCCESS)
+        fprintf(stderr, "%s: %s: %s\n", argv[0], archive, hasher.Error().c_str());
+
+    SHA_Archive_Hasher::Stats stats = hasher.Get_Stats();
+    fprintf(stderr, "{\"members\": %llu, \"bytes_read\": %llu, \"bytes_archive\": %llu, \"bytes_hashed\": %llu, "
+                    "\"producer_waits\": %llu, \"consumer_waits\": %llu, \"seconds\": %.3f, \"mb_per_s\": %.1f}\n",
+            (unsigned long long) stats.members, (unsigned long long) stats.bytes_read,
+            (unsigned long long) stats.bytes_archive, (unsigned long long) stats.bytes_hashed,
+            (unsigned long long) stats.producer_waits, (unsigned long long) stats.consumer_waits, stats.seconds,
+            stats.seconds > 0 ? stats.bytes_archive/stats.seconds/1e6 : 0.0);
+
+    return exit_status;
+}
@@ -0,0 +1,179 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shatree.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-04
+ *
+ * CONTENT: The example program shatree for the bulk hashing of small files of shabulk.h. Hashes every regular file found
+ *          below the directories given with SHA1_Bulk_Files and prints one line per file in the format of sha1sum,
+ *          unless --quiet is given. With --make N a synthetic tree of N files of 0 to 4095 bytes, 1000 to a directory,
+ *          is first written below the directory given. With --compare the files are also hashed one by one with
+ *          SHA1_File. The files per second of every run are written as JSON to standard error.
+ *
+ *          Usage: shatree [--make N] [--threads N] [--no-io-uring] [--compare] [--quiet] DIRECTORY...
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "sha1.h"
+#include "shabulk.h"
+
+static std::vector<std::string> tree;
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--make N] [--threads N] [--no-io-uring] [--compare] [--quiet] DIRECTORY...\n", program);
+}
+
+/* The function Add_File is called by nftw for every entry of the tree and keeps the regular files */
+
+static int Add_File(const char *path, const struct stat *status, int type, struct FTW *)
+{
+    if (type == FTW_F && S_ISREG(status->st_mode))
+        tree.push_back(path);
+    return 0;
+}
+
+/* The function Make_Tree writes nr_of_files files of pseudo-random content and size below directory */
+
+static int Make_Tree(const char *directory, uint64_t nr_of_files)
+{
+    char path[4096], data[4096];
+    uint64_t i, seed = 88172645463325252ull;
+    FILE *file;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (char) (i*2654435761u >> 24);
+
+    mkdir(directory, 0755);
+    for (i = 0; i < nr_of_files; i++)
+    {
+        if (i % 1000 == 0)
+        {
+            snprintf(path, sizeof(path), "%s/d%06llu", directory, (unsigned long long) (i/1000));
+            if (mkdir(path, 0755) != 0)
+                return EXIT_FAILURE;
+        }
+
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        snprintf(path, sizeof(path), "%s/d%06llu/f%03llu", directory, (unsigned long long) (i/1000), (unsigned long long) (i % 1000));
+        file = fopen(path, "wb");
+        if (file == NULL)
+            return EXIT_FAILURE;
+        fwrite(data + seed % 64, 1, (size_t) (seed >> 32) % (sizeof(data) - 64), file);
+        fclose(file);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<const char*> directories;
+    std::vector<char*> names;
+    std::vector<uint32_t> hashes, reference;
+    std::vector<int> statuses;
+    unsigned int nr_of_threads = 0;
+    uint64_t nr_to_make = 0, mismatches = 0;
+    int backend = SHA_BULK_AUTO, exit_status;
+    bool compare = false, quiet = false;
+    struct sha_bulk_stats stats;
+    struct timespec start, end;
+    double seconds;
+    size_t i;
+
+    for (i = 1; i < (size_t) argc; i++)
+    {
+        if (strcmp(argv[i], "--make") == 0 && i + 1 < (size_t) argc)
+            nr_to_make = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < (size_t) argc)
+            nr_of_threads = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--no-io-uring") == 0)
+            backend = SHA_BULK_THREADS;
+        else if (strcmp(argv[i], "--compare") == 0)
+            compare = true;
+        else if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (argv[i][0] != '-')
+            directories.push_back(argv[i]);
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (directories.empty() || (nr_to_make > 0 && directories.size() != 1))
+    {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (nr_to_make > 0 && Make_Tree(directories[0], nr_to_make) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "%s: %s: the tree could not be written\n", argv[0], directories[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (const char *directory : directories)
+        nftw(directory, Add_File, 64, FTW_PHYS);
+    for (i = 0; i < tree.size(); i++)
+        names.push_back((char*) tree[i].c_str());
+    hashes.resize(5*tree.size());
+    statuses.resize(tree.size());
+
+    exit_status = SHA1_Bulk_Files(names.data(), names.size(), hashes.data(), statuses.data(), backend, nr_of_threads, &stats);
+
+    for (i = 0; i < tree.size() && !quiet; i++)
+    {
+        if (statuses[i] != EXIT_SUCCESS)
+        {
+            fprintf(stderr, "%s: %s: cannot be read\n", argv[0], names[i]);
+            continue;
+        }
+        for (unsigned int w = 0; w < 5; w++)
+            printf("%08x", hashes[5*i + w]);
+        printf("  %s\n", names[i]);
+    }
+    fflush(stdout);
+
+    fprintf(stderr, "{\"files\": %llu, \"failed\": %llu, \"large_files\": %llu, \"bytes\": %llu, \"io_uring\": %s, "
+                    "\"batches\": %llu, \"enters\": %llu, \"seconds\": %.3f, \"files_per_s\": %.1f",
+            (unsigned long long) stats.nr_of_files, (unsigned long long) stats.nr_of_failed,
+            (unsigned long long) stats.nr_of_large_files, (unsigned long long) stats.bytes,
+            stats.backend == SHA_BULK_IO_URING ? "true" : "false", (unsigned long long) stats.nr_of_batches,
+            (unsigned long long) stats.nr_of_enters, stats.seconds, stats.files_per_s);
+
+    /* SHA1_File one file at a time, for comparison */
+
+    if (compare)
+    {
+        reference.resize(5*tree.size());
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < tree.size(); i++)
+            if (SHA1_File(names[i], &reference[5*i]) == EXIT_SUCCESS && statuses[i] == EXIT_SUCCESS
+                && memcmp(&reference[5*i], &hashes[5*i], 5*sizeof(uint32_t)) != 0)
+                mismatches++;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9;
+
+        fprintf(stderr, ", \"sha1_file_seconds\": %.3f, \"sha1_file_files_per_s\": %.1f, \"mismatches\": %llu",
+                seconds, seconds > 0 ? tree.size()/seconds : 0.0, (unsigned long long) mismatches);
+    }
+    fprintf(stderr, "}\n");
+
+    return exit_status == EXIT_SUCCESS && mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,611 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shatune.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-10-01
+ *
+ * CONTENT: Implements an optional autotuner choosing the SHA1 batch kernel and the SHA256 block kernel for each size
+ *          class of messages by measuring them.
+ *
+ *          Which kernel is fastest depends on more than the instructions the processor supports: the scalar kernels
+ *          may beat the vector kernels on short messages, which do not fill their lanes, and AVX-512 may lower the
+ *          clock frequency enough to lose to AVX2. SHA_Tune therefore hashes a few hundred kilobytes with every
+ *          available kernel for a representative message size of every class, keeps the best of three trials and
+ *          sets the fastest kernels through SHA1_Set_Batch_Kernel and SHA256_Set_Size_Kernel.
+ *
+ *          The choices are written to a small cache file per host, together with the processor brand and the list
+ *          of available kernels. A later process finding a cache with the same processor and kernels applies the
+ *          choices without measuring. A cache that does not match, e.g. after the program has been moved to another
+ *          processor or rebuilt with other kernels, is measured over.
+ *
+ *          SHA_Tune sets process-wide tables and should be called before any other thread hashes.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+#include "shalib.h"
+#include "shabatch.h"
+#include "shatune.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define SHA_X86
+#endif
+
+#define TRUE 1
+#define FALSE 0
+
+#define TUNE_VERSION 1                        /* the version of the format of the cache file                                */
+#define TUNE_TRIALS 3                         /* the number of timed trials per kernel and size class                       */
+#define TUNE_TRIAL_BYTES (1 << 19)            /* the number of bytes hashed per trial                                       */
+#define LINE_SIZE 512                         /* the size of the longest line of the cache file                             */
+#define NAME_SIZE 32                          /* the size of the longest kernel name                                        */
+
+/* The message size measured for each size class */
+
+static const uint64_t sample_sizes[SHA_SIZE_CLASSES] = {55, 1000, 16000, 65536};
+
+/* The table of the kernels in use */
+
+static struct sha_tune_table table;
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: SIGNATURE
+ *
+ *  A cache is only applied on the processor, and with the kernels, it was measured with.
+ *
+ **************************************************************************************************************************************/
+
+/* The function Get_CPU writes the brand string of the processor, or the machine name where there is none, to cpu */
+
+static void Get_CPU(char *cpu)
+{
+    struct utsname name;
+    unsigned int i, start = 0, end;
+
+    cpu[0] = 0;
+
+#ifdef SHA_X86
+    unsigned int brand[12];
+
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004)
+    {
+        for (i = 0; i < 3; i++)
+            __get_cpuid(0x80000002 + i, &brand[4*i], &brand[4*i + 1], &brand[4*i + 2], &brand[4*i + 3]);
+        memcpy(cpu, brand, sizeof(brand));
+        cpu[sizeof(brand)] = 0;
+    }
+#endif
+
+    if (cpu[0] == 0 && uname(&name) == 0)
+        snprintf(cpu, SHA_TUNE_CPU_SIZE, "%.*s", SHA_TUNE_CPU_SIZE - 1, name.machine);
+
+    /* Trims the spaces that may pad the brand string, and keeps the string to one line */
+
+    while (cpu[start] == ' ')
+        start++;
+    end = (unsigned int) strlen(cpu);
+    while (end > start && cpu[end - 1] == ' ')
+        end--;
+    memmove(cpu, &cpu[start], end - start);
+    cpu[end - start] = 0;
+    for (i = 0; cpu[i] != 0; i++)
+        if (cpu[i] == '\n' || cpu[i] == '\r')
+            cpu[i] = ' ';
+
+    if (cpu[0] == 0)
+        strcpy(cpu, "unknown");
+}
+
+/* The function SHA256_Kernel_Name returns the name of a SHA256 kernel */
+
+static const char *SHA256_Kernel_Name(int kernel)
+{
+    return kernel == SHA_KERNEL_SHANI ? "shani" : "portable";
+}
+
+/* The function SHA256_Kernel_By_Name returns the SHA256 kernel of the given name, or SHA_KERNEL_AUTO if there is none */
+
+static int SHA256_Kernel_By_Name(const char *name)
+{
+    if (strcmp(name, "portable") == 0)
+        return SHA_KERNEL_PORTABLE;
+    if (strcmp(name, "shani") == 0)
+        return SHA_KERNEL_SHANI;
+
+    return SHA_KERNEL_AUTO;
+}
+
+/* The function Get_Kernel_List writes the names of the available SHA1 and SHA256 kernels to list */
+
+static void Get_Kernel_List(char *list, size_t list_size)
+{
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels, k;
+    size_t length = 0;
+
+    list[0] = 0;
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (k = 0; k < nr_of_kernels && length < list_size; k++)
+        length += snprintf(&list[length], list_size - length, "%s ", kernels[k].name);
+
+    if (length < list_size)
+        length += snprintf(&list[length], list_size - length, "| portable");
+    if (length < list_size && SHA256_Kernel_Available(SHA_KERNEL_SHANI))
+        snprintf(&list[length], list_size - length, " shani");
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: MEASUREMENT
+ *
+ **************************************************************************************************************************************/
+
+static uint64_t Tune_Nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+/* The function Measure_SHA1 returns the throughput in MB/s of SHA1_Batch_Kernel on texts of byte_size bytes, or 0
+   if memory could not be allocated. The batch holds at least four times the largest number of lanes. */
+
+static double Measure_SHA1(const struct sha1_kernel *kernel, uint64_t byte_size)
+{
+    uint64_t nr_of_texts = TUNE_TRIAL_BYTES/byte_size, best = UINT64_MAX, start, elapsed, i;
+    unsigned char *data;
+    char **texts;
+    uint64_t *texts_byte_size;
+    uint32_t *hashes;
+    int trial;
+
+    if (nr_of_texts < 4*SHA1_MAX_LANES)
+        nr_of_texts = 4*SHA1_MAX_LANES;
+
+    data = (unsigned char*) malloc(nr_of_texts*byte_size);
+    texts = (char**) malloc(nr_of_texts*sizeof(char*));
+    texts_byte_size = (uint64_t*) malloc(nr_of_texts*sizeof(uint64_t));
+    hashes = (uint32_t*) malloc(5*nr_of_texts*sizeof(uint32_t));
+
+    if (data == NULL || texts == NULL || texts_byte_size == NULL || hashes == NULL)
+    {
+        free(data);
+        free(texts);
+        free(texts_byte_size);
+        free(hashes);
+        return 0;
+    }
+
+    for (i = 0; i < nr_of_texts*byte_size; i++)
+        data[i] = (unsigned char) (i*2654435761u >> 24);
+    for (i = 0; i < nr_of_texts; i++)
+    {
+        texts[i] = (char*) &data[i*byte_size];
+        texts_byte_size[i] = byte_size;
+    }
+
+    /* One untimed call warms up the caches and, for the wide vector kernels, the clock frequency they run at */
+
+    SHA1_Batch_Kernel(kernel, texts, texts_byte_size, nr_of_texts, hashes);
+    for (trial = 0; trial < TUNE_TRIALS; trial++)
+    {
+        start = Tune_Nanoseconds();
+        SHA1_Batch_Kernel(kernel, texts, texts_byte_size, nr_of_texts, hashes);
+        elapsed = Tune_Nanoseconds() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    free(data);
+    free(texts);
+    free(texts_byte_size);
+    free(hashes);
+
+    return best > 0 ? (double) (nr_of_texts*byte_size)*1000.0/best : 0;
+}
+
+/* The function Measure_SHA256 returns the throughput in MB/s of a SHA256 block kernel on runs of blocks of the
+   length passed to SHA256_Hash_Blocks for a message of byte_size bytes, or 0 if memory could not be allocated */
+
+static double Measure_SHA256(int kernel, uint64_t byte_size)
+{
+    uint64_t nr_of_blocks = byte_size/64 > 0 ? byte_size/64 : 1, nr_of_runs, best = UINT64_MAX, start, elapsed, i;
+    void (*Hash_Blocks)(unsigned char *data, uint64_t nr_of_blocks, uint32_t *H);
+    uint32_t H[8] = {0};
+    unsigned char *data;
+    int trial;
+
+    Hash_Blocks = kernel == SHA_KERNEL_SHANI ? SHA256_Hash_Blocks_SHANI : SHA256_Hash_Blocks_Portable;
+    nr_of_runs = TUNE_TRIAL_BYTES/(64*nr_of_blocks);
+
+    data = (unsigned char*) malloc(64*nr_of_blocks);
+    if (data == NULL)
+        return 0;
+    for (i = 0; i < 64*nr_of_blocks; i++)
+        data[i] = (unsigned char) (i*2654435761u >> 24);
+
+    Hash_Blocks(data, nr_of_blocks, H);
+    for (trial = 0; trial < TUNE_TRIALS; trial++)
+    {
+        start = Tune_Nanoseconds();
+        for (i = 0; i < nr_of_runs; i++)
+            Hash_Blocks(data, nr_of_blocks, H);
+        elapsed = Tune_Nanoseconds() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    free(data);
+
+    return best > 0 ? (double) (nr_of_runs*nr_of_blocks*64)*1000.0/best : 0;
+}
+
+/* The function Measure_Kernels measures every available kernel for every size class and enters the fastest into
+   classes. It returns EXIT_FAILURE if memory could not be allocated. */
+
+static int Measure_Kernels(struct sha_tune_class *classes)
+{
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels, c, k;
+    double mb_per_s;
+    int kernel;
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        classes[c].limit = SHA_Size_Class_Limit(c);
+        classes[c].sha1_mb_per_s = 0;
+        classes[c].sha256_mb_per_s = 0;
+
+        for (k = 0; k < nr_of_kernels; k++)
+        {
+            mb_per_s = Measure_SHA1(&kernels[k], sample_sizes[c]);
+            if (mb_per_s == 0)
+                return EXIT_FAILURE;
+            if (mb_per_s > classes[c].sha1_mb_per_s)
+            {
+                classes[c].sha1_kernel = kernels[k].name;
+                classes[c].sha1_mb_per_s = mb_per_s;
+            }
+        }
+
+        for (kernel = SHA_KERNEL_PORTABLE; kernel <= SHA_KERNEL_SHANI; kernel++)
+        {
+            if (!SHA256_Kernel_Available(kernel))
+                continue;
+            mb_per_s = Measure_SHA256(kernel, sample_sizes[c]);
+            if (mb_per_s == 0)
+                return EXIT_FAILURE;
+            if (mb_per_s > classes[c].sha256_mb_per_s)
+            {
+                classes[c].sha256_kernel = kernel;
+                classes[c].sha256_mb_per_s = mb_per_s;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: CACHE
+ *
+ *  The cache is a text file of the form
+ *
+ *      shatune 1
+ *      cpu Intel(R) Xeon(R) CPU E5-2680 v4 @ 2.40GHz
+ *      kernels scalar scalar3 scalar2 sse2 avx2 | portable
+ *      class 0 sse2 612.3 portable 201.7
+ *      ...
+ *
+ *  with one class line per size class giving the SHA1 kernel, the SHA256 kernel and their measured MB/s.
+ *
+ **************************************************************************************************************************************/
+
+/* The function Default_Cache_Path writes the path of the cache of this host to path: $SHA_TUNE_CACHE if set, else
+   shatune-<host name> in $XDG_CACHE_HOME or $HOME/.cache. It returns FALSE if there is no such directory. */
+
+static int Default_Cache_Path(char *path)
+{
+    const char *directory;
+    char cache_directory[SHA_TUNE_PATH_SIZE];
+    char host[256];
+
+    if ((directory = getenv("SHA_TUNE_CACHE")) != NULL && directory[0] != 0)
+        return snprintf(path, SHA_TUNE_PATH_SIZE, "%s", directory) < SHA_TUNE_PATH_SIZE;
+
+    if ((directory = getenv("XDG_CACHE_HOME")) != NULL && directory[0] != 0)
+        snprintf(cache_directory, sizeof(cache_directory), "%s", directory);
+    else if ((directory = getenv("HOME")) != NULL && directory[0] != 0)
+    {
+        snprintf(cache_directory, sizeof(cache_directory), "%s/.cache", directory);
+        mkdir(cache_directory, 0755);
+    }
+    else
+        return FALSE;
+
+    if (gethostname(host, sizeof(host)) != 0)
+        strcpy(host, "localhost");
+    host[sizeof(host) - 1] = 0;
+
+    return snprintf(path, SHA_TUNE_PATH_SIZE, "%s/shatune-%s", cache_directory, host) < SHA_TUNE_PATH_SIZE;
+}
+
+/* The function Read_Line reads one line of at most LINE_SIZE - 1 characters without its newline */
+
+static int Read_Line(FILE *fp, char *line)
+{
+    size_t length;
+
+    if (fgets(line, LINE_SIZE, fp) == NULL)
+        return FALSE;
+
+    length = strlen(line);
+    if (length == 0 || line[length - 1] != '\n')
+        return FALSE;
+    line[length - 1] = 0;
+
+    return TRUE;
+}
+
+/* The function Read_Class enters the kernels of the class line of size class c into size_class. It returns FALSE if
+   the line is malformed or names a kernel that is not available. */
+
+static int Read_Class(const char *line, unsigned int c, struct sha_tune_class *size_class)
+{
+    char sha1_name[NAME_SIZE], sha256_name[NAME_SIZE];
+    const struct sha1_kernel *kernel;
+    unsigned int index;
+
+    if (sscanf(line, "class %u %31s %lf %31s %lf", &index, sha1_name, &size_class->sha1_mb_per_s, sha256_name,
+               &size_class->sha256_mb_per_s) != 5 || index != c)
+        return FALSE;
+
+    if ((kernel = SHA1_Find_Kernel(sha1_name)) == NULL)
+        return FALSE;
+
+    size_class->limit = SHA_Size_Class_Limit(c);
+    size_class->sha1_kernel = kernel->name;
+    size_class->sha256_kernel = SHA256_Kernel_By_Name(sha256_name);
+
+    return SHA256_Kernel_Available(size_class->sha256_kernel);
+}
+
+/* The function Read_Cache enters the kernels of the cache at path into classes. It returns FALSE if the file cannot
+   be read, is malformed or was written for another processor or another set of kernels. */
+
+static int Read_Cache(const char *path, const char *cpu, const char *kernel_list, struct sha_tune_class *classes)
+{
+    char line[LINE_SIZE];
+    unsigned int c, version;
+    int valid;
+    FILE *fp;
+
+    if ((fp = fopen(path, "r")) == NULL)
+        return FALSE;
+
+    valid = Read_Line(fp, line) && sscanf(line, "shatune %u", &version) == 1 && version == TUNE_VERSION &&
+            Read_Line(fp, line) && strncmp(line, "cpu ", 4) == 0 && strcmp(&line[4], cpu) == 0 &&
+            Read_Line(fp, line) && strncmp(line, "kernels ", 8) == 0 && strcmp(&line[8], kernel_list) == 0;
+
+    for (c = 0; c < SHA_SIZE_CLASSES && valid; c++)
+        valid = Read_Line(fp, line) && Read_Class(line, c, &classes[c]);
+
+    fclose(fp);
+    return valid;
+}
+
+/* The function Write_Cache writes the kernels of classes to the cache at path. The cache is written to a temporary
+   file and renamed, so that processes tuning at the same time never read half a cache. */
+
+static int Write_Cache(const char *path, const char *cpu, const char *kernel_list, const struct sha_tune_class *classes)
+{
+    char temporary_path[SHA_TUNE_PATH_SIZE + 32];
+    unsigned int c;
+    int written;
+    FILE *fp;
+
+    snprintf(temporary_path, sizeof(temporary_path), "%s.%ld.tmp", path, (long) getpid());
+    if ((fp = fopen(temporary_path, "w")) == NULL)
+        return FALSE;
+
+    fprintf(fp, "shatune %u\ncpu %s\nkernels %s\n", TUNE_VERSION, cpu, kernel_list);
+    for (c = 0; c < SHA_SIZE_CLASSES; c++)
+        fprintf(fp, "class %u %s %.1f %s %.1f\n", c, classes[c].sha1_kernel, classes[c].sha1_mb_per_s,
+                SHA256_Kernel_Name(classes[c].sha256_kernel), classes[c].sha256_mb_per_s);
+
+    written = !ferror(fp);
+    if (fclose(fp) != 0 || !written || rename(temporary_path, path) != 0)
+    {
+        remove(temporary_path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: TUNING
+ *
+ **************************************************************************************************************************************/
+
+/* The function Apply_Kernels sets the kernels of classes for every size class */
+
+static void Apply_Kernels(const struct sha_tune_class *classes)
+{
+    unsigned int c;
+
+    for (c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        SHA1_Set_Batch_Kernel(c, SHA1_Find_Kernel(classes[c].sha1_kernel));
+        SHA256_Set_Size_Kernel(c, classes[c].sha256_kernel);
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Tune
+ *
+ * PURPOSE: Chooses the SHA1 batch kernel and the SHA256 block kernel of every size class, from the cache at cache_path if
+ *          it was written on the same processor with the same kernels, and otherwise by measuring them and writing the
+ *          cache. Does nothing if the kernels have already been tuned in this process.
+ *
+ * ARGUMENT LIST:
+ *
+ * Argument             Type            IO          Description
+ * -------------        --------        --          ---------------------------------
+ * cache_path           const char*     I           The path of the cache file, NULL for the default per-host
+ *                                                  cache (see Default_Cache_Path) or "" for no cache
+ *
+ * RETURN VALUE : int, EXIT_SUCCESS, or EXIT_FAILURE if memory for the measurements could not be allocated, in which case
+ *                the default kernels are kept. A cache that cannot be written is not an error.
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Tune(const char *cache_path)
+{
+    struct sha_tune_class classes[SHA_SIZE_CLASSES];
+    char kernel_list[LINE_SIZE], path[SHA_TUNE_PATH_SIZE];
+    uint64_t start;
+
+    if (table.source != SHA_TUNE_DEFAULT)
+        return EXIT_SUCCESS;
+
+    start = Tune_Nanoseconds();
+    Get_CPU(table.cpu);
+    Get_Kernel_List(kernel_list, sizeof(kernel_list));
+
+    path[0] = 0;
+    if (cache_path == NULL)
+    {
+        if (!Default_Cache_Path(path))
+            path[0] = 0;
+    }
+    else
+        snprintf(path, sizeof(path), "%s", cache_path);
+
+    table.cache_path[0] = 0;
+    if (path[0] != 0 && Read_Cache(path, table.cpu, kernel_list, classes))
+    {
+        table.source = SHA_TUNE_CACHED;
+        strcpy(table.cache_path, path);
+    }
+    else
+    {
+        if (Measure_Kernels(classes) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+
+        table.source = SHA_TUNE_MEASURED;
+        if (path[0] != 0 && Write_Cache(path, table.cpu, kernel_list, classes))
+            strcpy(table.cache_path, path);
+    }
+
+    Apply_Kernels(classes);
+    memcpy(table.classes, classes, sizeof(classes));
+    table.tune_seconds = (Tune_Nanoseconds() - start)/1e9;
+
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_Tune_Get_Table returns the table of the kernels currently in use. Before SHA_Tune has been called
+   these are the kernels chosen by CPUID, and the throughputs are 0. */
+
+const struct sha_tune_table *SHA_Tune_Get_Table(void)
+{
+    unsigned int c;
+
+    if (table.source == SHA_TUNE_DEFAULT)
+    {
+        if (table.cpu[0] == 0)
+            Get_CPU(table.cpu);
+        for (c = 0; c < SHA_SIZE_CLASSES; c++)
+        {
+            table.classes[c].limit = SHA_Size_Class_Limit(c);
+            table.classes[c].sha1_kernel = SHA1_Get_Batch_Kernel(c)->name;
+            table.classes[c].sha1_mb_per_s = 0;
+            table.classes[c].sha256_kernel = SHA256_Get_Size_Kernel(c);
+            table.classes[c].sha256_mb_per_s = 0;
+        }
+    }
+
+    return &table;
+}
+
+/* The function Print_JSON_String writes a string to stream as a JSON string, escaping quotes, backslashes and control
+   characters. The processor name and the cache path come from the system and the environment. */
+
+static void Print_JSON_String(FILE *stream, const char *string)
+{
+    const char *c;
+
+    fputc('"', stream);
+    for (c = string; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf(stream, "\\%c", *c);
+        else if ((unsigned char) *c < 0x20)
+            fprintf(stream, "\\u%04x", (unsigned char) *c);
+        else
+            fputc(*c, stream);
+    }
+    fputc('"', stream);
+}
+
+/* The function SHA_Tune_Print_Table writes the table of the kernels currently in use to stream as one line of JSON,
+   for logging. The limit of the last size class is written as null. */
+
+void SHA_Tune_Print_Table(FILE *stream)
+{
+    const struct sha_tune_table *t = SHA_Tune_Get_Table();
+    const char *sources[] = {"default", "measured", "cached"};
+    unsigned int c;
+
+    fprintf(stream, "{\"source\":\"%s\",\"cpu\":", sources[t->source]);
+    Print_JSON_String(stream, t->cpu);
+    fprintf(stream, ",\"cache\":");
+    Print_JSON_String(stream, t->cache_path);
+    fprintf(stream, ",\"seconds\":%.3f,\"classes\":[", t->tune_seconds);
+    for (c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        if (t->classes[c].limit == UINT64_MAX)
+            fprintf(stream, "%s{\"limit\":null", c > 0 ? "," : "");
+        else
+            fprintf(stream, "%s{\"limit\":%llu", c > 0 ? "," : "", (unsigned long long) t->classes[c].limit);
+        fprintf(stream, ",\"sha1\":\"%s\",\"sha1_mb_per_s\":%.1f,\"sha256\":\"%s\",\"sha256_mb_per_s\":%.1f}",
+                t->classes[c].sha1_kernel, t->classes[c].sha1_mb_per_s, SHA256_Kernel_Name(t->classes[c].sha256_kernel),
+                t->classes[c].sha256_mb_per_s);
+    }
+    fprintf(stream, "]}\n");
+}
+
+/* The function SHA_Tune_Reset restores the default kernels of every size class, so that SHA_Tune tunes them again */
+
+void SHA_Tune_Reset(void)
+{
+    unsigned int c;
+
+    for (c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        SHA1_Set_Batch_Kernel(c, NULL);
+        SHA256_Set_Size_Kernel(c, SHA_KERNEL_AUTO);
+    }
+
+    memset(&table, 0, sizeof(table));
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************************************************************
+ * FILENAME: shatune.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the kernel autotuner and the sha_tune_table defined in shatune.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHATUNE__
+#define __SHATUNE__
+
+/* The origin of the kernels in a sha_tune_table */
+
+#define SHA_TUNE_DEFAULT 0                    /* the kernels chosen by CPUID alone, SHA_Tune has not been called            */
+#define SHA_TUNE_MEASURED 1                   /* the kernels were measured by SHA_Tune in this process                      */
+#define SHA_TUNE_CACHED 2                     /* the kernels were read from the cache file written by an earlier process    */
+
+#define SHA_TUNE_CPU_SIZE 64                  /* the size of the cpu string, including the terminating zero                 */
+#define SHA_TUNE_PATH_SIZE 512                /* the size of the cache_path string, including the terminating zero          */
+
+/* A sha_tune_class holds the kernels chosen for one size class of messages, see SHA_Size_Class */
+
+struct sha_tune_class
+{
+    uint64_t limit;                           /* the largest message size in bytes of the class                             */
+    const char *sha1_kernel;                  /* the name of the kernel used by SHA1_Batch                                  */
+    double sha1_mb_per_s;                     /* the throughput measured for the SHA1 kernel, 0 if not measured             */
+    int sha256_kernel;                        /* the kernel used by SHA256_Hash_Blocks, SHA_KERNEL_PORTABLE or _SHANI       */
+    double sha256_mb_per_s;                   /* the throughput measured for the SHA256 kernel, 0 if not measured           */
+};
+
+/* The sha_tune_table holds the kernels in use for every size class */
+
+struct sha_tune_table
+{
+    int source;                               /* SHA_TUNE_DEFAULT, SHA_TUNE_MEASURED or SHA_TUNE_CACHED                     */
+    char cpu[SHA_TUNE_CPU_SIZE];              /* the processor the measurements were made on                                */
+    char cache_path[SHA_TUNE_PATH_SIZE];      /* the cache file read or written, empty if none                              */
+    double tune_seconds;                      /* the time spent measuring, or reading the cache                             */
+    struct sha_tune_class classes[SHA_SIZE_CLASSES];
+};
+
+int SHA_Tune(const char *cache_path);
+
+const struct sha_tune_table *SHA_Tune_Get_Table(void);
+
+void SHA_Tune_Print_Table(FILE *stream);
+
+void SHA_Tune_Reset(void);
+
+#endif
@@ -0,0 +1,299 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shauring.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-27
+ *
+ * CONTENT: Implements a minimal interface to io_uring, the asynchronous I/O interface of Linux, through its system calls
+ *          so that no library is needed. The submission and completion queues are rings shared with the kernel: the
+ *          caller fills submission entries and advances the tail of the submission ring, the kernel advances the tail
+ *          of the completion ring, and the heads are advanced by whoever consumes the entries. The loads and stores of
+ *          the shared indices use acquire and release ordering so that the entries are seen complete.
+ *
+ *          Kernels without io_uring, or where it is disabled, fail in SHA_Uring_Init, and callers are expected to fall
+ *          back to blocking system calls on threads of their own. On other systems than Linux it always fails.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "shauring.h"
+
+#ifdef __linux__
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Uring_Init
+ *
+ * PURPOSE: Creates an io_uring instance and maps its rings
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * ring                sha_uring*      O       pointer to the ring to be initialised
+ * nr_of_entries       unsigned int    I       the number of submission entries, rounded up to a power of two by the
+ *                                             kernel. The completion queue holds twice as many
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if io_uring is not available
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Uring_Init(struct sha_uring *ring, unsigned int nr_of_entries)
+{
+    struct io_uring_params params;
+    unsigned char *sq, *cq;
+    int fd;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+
+    memset(&params, 0, sizeof(params));
+    fd = (int) syscall(__NR_io_uring_setup, nr_of_entries, &params);
+    if (fd < 0)
+        return EXIT_FAILURE;
+
+    ring->sq_ring_byte_size = params.sq_off.array + params.sq_entries*sizeof(unsigned int);
+    ring->cq_ring_byte_size = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+    ring->sqes_byte_size = params.sq_entries*sizeof(struct io_uring_sqe);
+
+    /* Since Linux 5.4 both rings share one mapping */
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_ring_byte_size > ring->sq_ring_byte_size)
+            ring->sq_ring_byte_size = ring->cq_ring_byte_size;
+        ring->cq_ring_byte_size = ring->sq_ring_byte_size;
+    }
+
+    sq = (unsigned char*) mmap(NULL, ring->sq_ring_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                               IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED)
+    {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        cq = sq;
+    else
+    {
+        cq = (unsigned char*) mmap(NULL, ring->cq_ring_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                   IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED)
+        {
+            munmap(sq, ring->sq_ring_byte_size);
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ring->sqes = (struct io_uring_sqe*) mmap(NULL, ring->sqes_byte_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                             fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        if (cq != sq)
+            munmap(cq, ring->cq_ring_byte_size);
+        munmap(sq, ring->sq_ring_byte_size);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    ring->fd = fd;
+    ring->sq_entries = params.sq_entries;
+    ring->cq_entries = params.cq_entries;
+    ring->sq_ring = sq;
+    ring->cq_ring = cq;
+    ring->sq_head = (unsigned int*) (sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int*) (sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned int*) (sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int*) (sq + params.sq_off.array);
+    ring->cq_head = (unsigned int*) (cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int*) (cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned int*) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+    return EXIT_SUCCESS;
+}
+
+/* The function SHA_Uring_Exit unmaps the rings and closes the instance. Operations still in flight are cancelled */
+
+void SHA_Uring_Exit(struct sha_uring *ring)
+{
+    if (ring->fd < 0)
+        return;
+
+    munmap(ring->sqes, ring->sqes_byte_size);
+    if (ring->cq_ring != ring->sq_ring)
+        munmap(ring->cq_ring, ring->cq_ring_byte_size);
+    munmap(ring->sq_ring, ring->sq_ring_byte_size);
+    close(ring->fd);
+    ring->fd = -1;
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Uring_Register_Files
+ *
+ * PURPOSE: Registers a table of empty slots for direct descriptors, into which IORING_OP_OPENAT opens files given a
+ *          file_index and from which IORING_OP_CLOSE closes them. Entries linked to the open refer to the file by its
+ *          slot with IOSQE_FIXED_FILE, so that a chain of open, read and close needs no descriptor from user space
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * ring                sha_uring*      I/O     pointer to the ring
+ * nr_of_files         unsigned int    I       the number of slots
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the kernel does not support sparse file tables (before Linux 5.5) or the table
+ *                cannot be allocated
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Uring_Register_Files(struct sha_uring *ring, unsigned int nr_of_files)
+{
+    int *fds;
+    unsigned int i;
+    int result;
+
+    fds = (int*) malloc(nr_of_files*sizeof(int));
+    if (fds == NULL)
+        return EXIT_FAILURE;
+    for (i = 0; i < nr_of_files; i++)
+        fds[i] = -1;
+
+    result = (int) syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_FILES, fds, nr_of_files);
+    free(fds);
+
+    return result < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Uring_Get_Sqe
+ *
+ * PURPOSE: Returns the next free submission entry, cleared, and queues it for the next call of SHA_Uring_Submit
+ *
+ * RETURN VALUE : struct io_uring_sqe*, or NULL if the submission queue is full, in which case SHA_Uring_Submit must be
+ *                called first
+ *
+ *******************************************************************************************************************************/
+
+struct io_uring_sqe *SHA_Uring_Get_Sqe(struct sha_uring *ring)
+{
+    unsigned int tail = *ring->sq_tail;
+    unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    unsigned int index;
+
+    if (tail - head >= ring->sq_entries)
+        return NULL;
+
+    index = tail & *ring->sq_mask;
+    memset(&ring->sqes[index], 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->nr_to_submit++;
+
+    return &ring->sqes[index];
+}
+
+/*******************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Uring_Submit
+ *
+ * PURPOSE: Passes the queued submission entries to the kernel and optionally waits for completions
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * ring                sha_uring*      I/O     pointer to the ring
+ * wait_nr             unsigned int    I       the number of completions to wait for, 0 to return at once
+ *
+ * RETURN VALUE : int, the number of entries submitted, or -errno. An interrupted wait returns 0 with the entries
+ *                submitted
+ *
+ *******************************************************************************************************************************/
+
+int SHA_Uring_Submit(struct sha_uring *ring, unsigned int wait_nr)
+{
+    unsigned int nr_to_submit = ring->nr_to_submit;
+    int result;
+
+    result = (int) syscall(__NR_io_uring_enter, ring->fd, nr_to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0,
+                           NULL, 0);
+    if (result < 0)
+        return errno == EINTR ? 0 : -errno;
+
+    ring->nr_to_submit -= (unsigned int) result;
+    return result;
+}
+
+/* The function SHA_Uring_Peek_Cqe returns the oldest completion not yet seen, or NULL if there is none */
+
+struct io_uring_cqe *SHA_Uring_Peek_Cqe(struct sha_uring *ring)
+{
+    unsigned int head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+        return NULL;
+    return &ring->cqes[head & *ring->cq_mask];
+}
+
+/* The function SHA_Uring_Cqe_Seen releases the completion returned by SHA_Uring_Peek_Cqe to the kernel */
+
+void SHA_Uring_Cqe_Seen(struct sha_uring *ring)
+{
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+#else
+
+int SHA_Uring_Init(struct sha_uring *ring, unsigned int nr_of_entries)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    return EXIT_FAILURE;
+}
+
+void SHA_Uring_Exit(struct sha_uring *ring)
+{
+}
+
+int SHA_Uring_Register_Files(struct sha_uring *ring, unsigned int nr_of_files)
+{
+    return EXIT_FAILURE;
+}
+
+struct io_uring_sqe *SHA_Uring_Get_Sqe(struct sha_uring *ring)
+{
+    return NULL;
+}
+
+int SHA_Uring_Submit(struct sha_uring *ring, unsigned int wait_nr)
+{
+    return -1;
+}
+
+struct io_uring_cqe *SHA_Uring_Peek_Cqe(struct sha_uring *ring)
+{
+    return NULL;
+}
+
+void SHA_Uring_Cqe_Seen(struct sha_uring *ring)
+{
+}
+
+#endif
@@ -0,0 +1,53 @@
+/***************************************************************************************************************************************
+ * FILENAME: shauring.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the minimal io_uring interface defined in shauring.c. The submission entries are the structures of
+ *          <linux/io_uring.h>, which callers filling them must include.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAURING__
+#define __SHAURING__
+
+/* A sha_uring is one io_uring instance with its submission and completion queues mapped into memory. It must only be
+   used by one thread at a time */
+
+struct sha_uring
+{
+    int fd;
+    unsigned int sq_entries;
+    unsigned int cq_entries;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    uint64_t sq_ring_byte_size;
+    void *cq_ring;
+    uint64_t cq_ring_byte_size;
+    uint64_t sqes_byte_size;
+    unsigned int nr_to_submit;                /* the number of entries queued since the last call of SHA_Uring_Submit       */
+};
+
+int SHA_Uring_Init(struct sha_uring *ring, unsigned int nr_of_entries);
+
+void SHA_Uring_Exit(struct sha_uring *ring);
+
+int SHA_Uring_Register_Files(struct sha_uring *ring, unsigned int nr_of_files);
+
+struct io_uring_sqe *SHA_Uring_Get_Sqe(struct sha_uring *ring);
+
+int SHA_Uring_Submit(struct sha_uring *ring, unsigned int wait_nr);
+
+struct io_uring_cqe *SHA_Uring_Peek_Cqe(struct sha_uring *ring);
+
+void SHA_Uring_Cqe_Seen(struct sha_uring *ring);
+
+#endif
@@ -0,0 +1,288 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shauuid.c
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-21
+ *
+ * CONTENT: Implements name-based version 5 UUIDs (RFC 4122, Section 4.3), which are the first 16 bytes of the SHA1 hash
+ *          of a namespace UUID followed by a name, with the version and variant bits set.
+ *
+ *          The 16 bytes of the namespace take the first four words of the first block of every hash. They are converted
+ *          to words once per namespace, and a name of up to 39 bytes fits in the same block together with the pad, so
+ *          that its UUID takes a single compression. Such names are hashed side by side in the lanes of the kernels of
+ *          shabatch.c, and the UUIDs are written both as bytes and in canonical text form directly from the words of
+ *          the hashes. Longer names are hashed one at a time with SHA1_Concat.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shalib.h"
+#include "sha1.h"
+#include "shabatch.h"
+#include "shahex.h"
+#include "shauuid.h"
+
+#define BLOCK_SIZE 64       /* defines the size of a block in BYTES                                     */
+#define WORD_SIZE 4         /* defines the size of a word in BYTES                                      */
+#define HASH_SIZE 5         /* defines the size of the hash in number of 32-bit INTEGERS                */
+
+#define UUID_WORDS (SHA_UUID_SIZE/WORD_SIZE)
+#define SHORT_NAME_SIZE (BLOCK_SIZE - SHA_UUID_SIZE - 9)   /* the largest name hashed in a single block, i.e. 39 bytes */
+
+static const uint32_t H_init[] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: NAMESPACES AND TEXT
+ *
+ **************************************************************************************************************************************/
+
+/* The function SHA_UUID_Set_Namespace_Bytes sets the namespace from the 16 bytes of its UUID */
+
+void SHA_UUID_Set_Namespace_Bytes(const unsigned char *bytes, struct sha_uuid_namespace *ns)
+{
+    unsigned int i;
+
+    memcpy(ns->bytes, bytes, SHA_UUID_SIZE);
+    for (i = 0; i < UUID_WORDS; i++)
+        ns->W[i] = Conv_Word_To_32Int(&ns->bytes[WORD_SIZE*i]);
+}
+
+/* The function SHA_UUID_Set_Namespace sets the namespace from the canonical text of its UUID, for example
+   SHA_UUID_NAMESPACE_DNS. EXIT_FAILURE is returned unless the text consists of 36 characters with hexadecimal
+   digits of either case in groups of 8, 4, 4, 4 and 12 separated by '-'                                          */
+
+int SHA_UUID_Set_Namespace(const char *text, struct sha_uuid_namespace *ns)
+{
+    char hex[2*SHA_UUID_SIZE];
+    uint32_t W[UUID_WORDS];
+    unsigned char bytes[SHA_UUID_SIZE];
+    unsigned int i, j;
+
+    if (strlen(text) != SHA_UUID_TEXT_SIZE - 1 || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-')
+        return EXIT_FAILURE;
+
+    for (i = 0, j = 0; i < SHA_UUID_TEXT_SIZE - 1; i++)
+        if (i != 8 && i != 13 && i != 18 && i != 23)
+            hex[j++] = text[i];
+
+    if (SHA_Hex_Decode(hex, UUID_WORDS, W) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    for (i = 0; i < UUID_WORDS; i++)
+        Conv_32Int_To_Word(W[i], (char*) &bytes[WORD_SIZE*i]);
+    SHA_UUID_Set_Namespace_Bytes(bytes, ns);
+
+    return EXIT_SUCCESS;
+}
+
+/* The function Format_Words writes the canonical text of the UUID given as words, followed by a null character */
+
+static void Format_Words(const uint32_t *W, char *text)
+{
+    char hex[2*SHA_UUID_SIZE + 1];
+
+    SHA_Hex_Encode(W, UUID_WORDS, hex, SHA_HEX_LOWERCASE);
+
+    memcpy(&text[0], &hex[0], 8);
+    text[8] = '-';
+    memcpy(&text[9], &hex[8], 4);
+    text[13] = '-';
+    memcpy(&text[14], &hex[12], 4);
+    text[18] = '-';
+    memcpy(&text[19], &hex[16], 4);
+    text[23] = '-';
+    memcpy(&text[24], &hex[20], 12);
+    text[36] = '\0';
+}
+
+/* The function SHA_UUID_Format writes the canonical text of the UUID given as 16 bytes, which takes
+   SHA_UUID_TEXT_SIZE bytes including the null character */
+
+void SHA_UUID_Format(const unsigned char *uuid, char *text)
+{
+    uint32_t W[UUID_WORDS];
+    unsigned int i;
+
+    for (i = 0; i < UUID_WORDS; i++)
+        W[i] = Conv_Word_To_32Int((unsigned char*) &uuid[WORD_SIZE*i]);
+    Format_Words(W, text);
+}
+
+
+/***************************************************************************************************************************************
+ *
+ *  SECTION: UUIDS
+ *
+ **************************************************************************************************************************************/
+
+/* The function Set_UUID sets the version and variant bits in the first four words of a hash and writes the UUID
+   number job as bytes and as text, whichever is wanted */
+
+static void Set_UUID(uint32_t *W, uint64_t job, unsigned char *uuids, char *texts)
+{
+    unsigned int i;
+
+    W[1] = (W[1] & 0xffff0fff) | 0x00005000;       /* version 5 in the high nibble of byte 6                    */
+    W[2] = (W[2] & 0x3fffffff) | 0x80000000;       /* variant 10 in the high bits of byte 8                     */
+
+    if (uuids != NULL)
+        for (i = 0; i < UUID_WORDS; i++)
+            Conv_32Int_To_Word(W[i], (char*) &uuids[SHA_UUID_SIZE*job + WORD_SIZE*i]);
+
+    if (texts != NULL)
+        Format_Words(W, &texts[SHA_UUID_TEXT_SIZE*job]);
+}
+
+/* The function UUID_Lanes computes the UUIDs of up to one group of short names, whose numbers in the batch are
+   given by jobs. The namespace words are copied into the first four words of each lane and the name and the pad are
+   written behind them */
+
+static void UUID_Lanes(const struct sha1_kernel *kernel, const struct sha_uuid_namespace *ns, char **names, uint64_t *names_byte_size, const uint64_t *jobs, unsigned int nr_of_jobs, unsigned char *uuids, char *texts)
+{
+    uint32_t H[HASH_SIZE*SHA1_MAX_LANES];
+    uint32_t W[(BLOCK_SIZE/WORD_SIZE)*SHA1_MAX_LANES];
+    uint32_t uuid[UUID_WORDS];
+    unsigned char block[BLOCK_SIZE];
+    unsigned int nr_of_lanes, l, i;
+    uint64_t size;
+
+    nr_of_lanes = kernel->nr_of_lanes;
+    memset(W, 0, sizeof(W));
+
+    for (l = 0; l < nr_of_jobs; l++)
+    {
+        size = names_byte_size[jobs[l]];
+
+        memset(&block[SHA_UUID_SIZE], 0, BLOCK_SIZE - SHA_UUID_SIZE);
+        memcpy(&block[SHA_UUID_SIZE], names[jobs[l]], size);
+        block[SHA_UUID_SIZE + size] = 0x80;
+
+        for (i = 0; i < UUID_WORDS; i++)
+            W[i*nr_of_lanes + l] = ns->W[i];
+        for (i = UUID_WORDS; i < BLOCK_SIZE/WORD_SIZE - 1; i++)
+            W[i*nr_of_lanes + l] = Conv_Word_To_32Int(&block[WORD_SIZE*i]);
+        W[15*nr_of_lanes + l] = (uint32_t) (8*(SHA_UUID_SIZE + size));
+    }
+
+    for (i = 0; i < HASH_SIZE; i++)
+        for (l = 0; l < nr_of_lanes; l++)
+            H[i*nr_of_lanes + l] = H_init[i];
+
+    kernel->compress(H, W);
+
+    for (l = 0; l < nr_of_jobs; l++)
+    {
+        for (i = 0; i < UUID_WORDS; i++)
+            uuid[i] = H[i*nr_of_lanes + l];
+        Set_UUID(uuid, jobs[l], uuids, texts);
+    }
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_UUID5_Batch_Kernel
+ *
+ * PURPOSE: Computes the version 5 UUIDs of a number of names in one namespace with the given multi-lane kernel. Names of
+ *          up to 39 bytes are hashed in the lanes of the kernel, longer names one at a time.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                        I/O     DESCRIPTION
+ * --------            ----                        ---     -----------
+ * kernel              struct sha1_kernel*         I       the kernel to use, see SHA1_Kernels
+ * ns                  struct sha_uuid_namespace*  I       the namespace, see SHA_UUID_Set_Namespace
+ * names               char**                      I       the pointer to the array of pointers to the names
+ * names_byte_size     uint64_t*                   I       pointer to the array containing the size in bytes of each name
+ * nr_of_names         uint64_t                    I       the number of names
+ * uuids               unsigned char*              O       pointer to where the 16 bytes of UUID i are to be stored at index
+ *                                                         16*i, or NULL
+ * texts               char*                       O       pointer to where the canonical text of UUID i, followed by a null
+ *                                                         character, is to be stored at index 37*i, or NULL
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA_UUID5_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_uuid_namespace *ns, char **names, uint64_t *names_byte_size, uint64_t nr_of_names, unsigned char *uuids, char *texts)
+{
+    uint64_t jobs[SHA1_MAX_LANES];
+    unsigned int nr_of_jobs;
+    uint32_t hash[HASH_SIZE];
+    char *strings[2];
+    uint64_t sizes[2];
+    uint64_t i;
+
+    nr_of_jobs = 0;
+    for (i = 0; i < nr_of_names; i++)
+    {
+        if (names_byte_size[i] <= SHORT_NAME_SIZE)
+        {
+            jobs[nr_of_jobs++] = i;
+            if (nr_of_jobs == kernel->nr_of_lanes)
+            {
+                UUID_Lanes(kernel, ns, names, names_byte_size, jobs, nr_of_jobs, uuids, texts);
+                nr_of_jobs = 0;
+            }
+        }
+        else
+        {
+            strings[0] = (char*) ns->bytes;
+            sizes[0] = SHA_UUID_SIZE;
+            strings[1] = names[i];
+            sizes[1] = names_byte_size[i];
+            SHA1_Concat(strings, 2, sizes, hash);
+            Set_UUID(hash, i, uuids, texts);
+        }
+    }
+
+    if (nr_of_jobs > 0)
+        UUID_Lanes(kernel, ns, names, names_byte_size, jobs, nr_of_jobs, uuids, texts);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_UUID5_Batch
+ *
+ * PURPOSE: Computes the version 5 UUIDs of a number of names with the default kernel. See SHA_UUID5_Batch_Kernel.
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA_UUID5_Batch(const struct sha_uuid_namespace *ns, char **names, uint64_t *names_byte_size, uint64_t nr_of_names, unsigned char *uuids, char *texts)
+{
+    SHA_UUID5_Batch_Kernel(SHA1_Default_Kernel(), ns, names, names_byte_size, nr_of_names, uuids, texts);
+}
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_UUID5
+ *
+ * PURPOSE: Computes the version 5 UUID of a name. See SHA_UUID5_Batch_Kernel.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE                        I/O     DESCRIPTION
+ * --------            ----                        ---     -----------
+ * ns                  struct sha_uuid_namespace*  I       the namespace, see SHA_UUID_Set_Namespace
+ * name                char*                       I       the pointer to the char array containing the name
+ * name_byte_size      uint64_t                    I       the size in bytes of the name
+ * uuid                unsigned char*              O       pointer to where the 16 bytes of the UUID are to be stored, or NULL
+ * text                char*                       O       pointer to where the 37 bytes of the canonical text are to be
+ *                                                         stored, or NULL
+ *
+ * RETURN VALUE : void
+ *
+ *********************************************************************************************************************************/
+
+void SHA_UUID5(const struct sha_uuid_namespace *ns, char *name, uint64_t name_byte_size, unsigned char *uuid, char *text)
+{
+    SHA_UUID5_Batch_Kernel(SHA1_Find_Kernel("scalar"), ns, &name, &name_byte_size, 1, uuid, text);
+}
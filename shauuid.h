@@ -0,0 +1,43 @@
+/***************************************************************************************************************************************
+ * FILENAME: shauuid.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the name-based version 5 UUID functions defined in shauuid.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAUUID__
+#define __SHAUUID__
+
+#define SHA_UUID_SIZE 16                      /* the size in bytes of a UUID                                                */
+#define SHA_UUID_TEXT_SIZE 37                 /* the size in bytes of the canonical text of a UUID with its null character  */
+
+/* The namespaces defined in RFC 4122, Appendix C */
+
+#define SHA_UUID_NAMESPACE_DNS "6ba7b810-9dad-11d1-80b4-00c04fd430c8"
+#define SHA_UUID_NAMESPACE_URL "6ba7b811-9dad-11d1-80b4-00c04fd430c8"
+#define SHA_UUID_NAMESPACE_OID "6ba7b812-9dad-11d1-80b4-00c04fd430c8"
+#define SHA_UUID_NAMESPACE_X500 "6ba7b814-9dad-11d1-80b4-00c04fd430c8"
+
+/* A sha_uuid_namespace holds a namespace UUID both as bytes and as the first four message words of every hash */
+
+struct sha_uuid_namespace
+{
+    unsigned char bytes[SHA_UUID_SIZE];       /* the namespace UUID                                                         */
+    uint32_t W[SHA_UUID_SIZE/4];              /* the namespace UUID as big-endian words                                     */
+};
+
+void SHA_UUID_Set_Namespace_Bytes(const unsigned char *bytes, struct sha_uuid_namespace *ns);
+
+int SHA_UUID_Set_Namespace(const char *text, struct sha_uuid_namespace *ns);
+
+void SHA_UUID_Format(const unsigned char *uuid, char *text);
+
+void SHA_UUID5_Batch_Kernel(const struct sha1_kernel *kernel, const struct sha_uuid_namespace *ns, char **names, uint64_t *names_byte_size, uint64_t nr_of_names, unsigned char *uuids, char *texts);
+
+void SHA_UUID5_Batch(const struct sha_uuid_namespace *ns, char **names, uint64_t *names_byte_size, uint64_t nr_of_names, unsigned char *uuids, char *texts);
+
+void SHA_UUID5(const struct sha_uuid_namespace *ns, char *name, uint64_t name_byte_size, unsigned char *uuid, char *text);
+
+#endif
@@ -0,0 +1,429 @@
+/***************************************************************************************************************************************
+ * FILE NAME: shaverify.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATED: 2016-09-22
+ *
+ * CONTENT: Implements the class SHA_Verifier, which checks the files listed in a manifest written by sha1sum or sha256sum
+ *          against their expected hashes. Reading the files in the order of the manifest makes a disk seek back and forth
+ *          when the manifest is sorted by name, so the files are first located on disk and sorted by device and by the
+ *          physical offset of their first extent as reported by the FIEMAP ioctl. File systems without FIEMAP are sorted
+ *          by inode number instead, which on most file systems correlates with the order of allocation.
+ *
+ *          The sorted files are then hashed by a fixed number of threads which take the files in sorted order, so that
+ *          the number of files read at the same time never exceeds the number of threads and the reads in flight lie
+ *          close together on disk. The outcome of every file is delivered to a callback as soon as it is known.
+ *
+ **************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "sha1.h"
+#include "sha256.h"
+#include "shahex.h"
+#include "shaverify.h"
+
+#define SHA1_HASH_SIZE 5        /* defines the size of a SHA1 hash in number of 32-bit INTEGERS             */
+#define SHA256_HASH_SIZE 8      /* defines the size of a SHA256 hash in number of 32-bit INTEGERS           */
+
+typedef std::chrono::steady_clock Clock;
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Parse_Line
+ *
+ * PURPOSE: Parses a line of a manifest of the form "HASH  NAME" or "HASH *NAME", where HASH is 40 hexadecimal digits for
+ *          SHA1 and 64 for SHA256. A line beginning with a backslash has its name escaped as by sha1sum, with "\\" for a
+ *          backslash and "\n" for a newline. The trailing newline must have been removed.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * line                char*           I       pointer to the null-terminated line
+ * entry               Entry*          O       pointer to the entry where the name and the expected hash are to be stored
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the line is malformed
+ *
+ *********************************************************************************************************************************/
+
+static int Parse_Line(const char *line, SHA_Verifier::Entry *entry)
+{
+    bool escaped = (line[0] == '\\');
+    const char *hex = line + (escaped ? 1 : 0);
+    const char *name;
+    size_t hex_length = strcspn(hex, " ");
+
+    if (hex_length == 8*SHA1_HASH_SIZE)
+        entry->nr_of_words = SHA1_HASH_SIZE;
+    else if (hex_length == 8*SHA256_HASH_SIZE)
+        entry->nr_of_words = SHA256_HASH_SIZE;
+    else
+        return EXIT_FAILURE;
+
+    if (SHA_Hex_Decode(hex, entry->nr_of_words, entry->expected) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    if (hex[hex_length] != ' ' || (hex[hex_length + 1] != ' ' && hex[hex_length + 1] != '*') || hex[hex_length + 2] == '\0')
+        return EXIT_FAILURE;
+    name = &hex[hex_length + 2];
+
+    entry->filename.clear();
+    for (; *name != '\0'; name++)
+    {
+        if (escaped && *name == '\\')
+        {
+            name++;
+            if (*name == '\\')
+                entry->filename += '\\';
+            else if (*name == 'n')
+                entry->filename += '\n';
+            else
+                return EXIT_FAILURE;
+        }
+        else
+            entry->filename += *name;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Locate_File
+ *
+ * PURPOSE: Determines the device of a file and either the physical offset of its first extent or its inode number. The
+ *          offset is used only if the file system reports it as known, which excludes files stored inline in the inode
+ *          and files whose blocks are not yet allocated.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * entry               Entry*          I/O     pointer to the entry of the file
+ * physical            bool            I       true if the physical offset is wanted and false if the inode number suffices
+ *
+ *********************************************************************************************************************************/
+
+static void Locate_File(SHA_Verifier::Entry *entry, bool physical)
+{
+    struct stat st;
+    int fd;
+
+    entry->device = 0;
+    entry->position = 0;
+    entry->physical = false;
+
+    if (!physical)
+    {
+        if (stat(entry->filename.c_str(), &st) == 0)
+        {
+            entry->device = st.st_dev;
+            entry->position = st.st_ino;
+        }
+        return;
+    }
+
+    fd = open(entry->filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    if (fstat(fd, &st) == 0)
+    {
+        uint64_t buffer[(sizeof(struct fiemap) + sizeof(struct fiemap_extent))/8];
+        struct fiemap *map = (struct fiemap*) buffer;
+
+        entry->device = st.st_dev;
+        entry->position = st.st_ino;
+
+        memset(buffer, 0, sizeof(buffer));
+        map->fm_start = 0;
+        map->fm_length = FIEMAP_MAX_OFFSET;
+        map->fm_extent_count = 1;
+
+        if (ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents == 1 &&
+            (map->fm_extents[0].fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_NOT_ALIGNED)) == 0)
+        {
+            entry->position = map->fm_extents[0].fe_physical;
+            entry->physical = true;
+        }
+    }
+
+    close(fd);
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: Verify_File
+ *
+ * PURPOSE: Hashes a file and compares the hash with the expected hash of its entry
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * entry               Entry*          I/O     pointer to the entry of the file, whose status, size and time are set
+ *
+ *********************************************************************************************************************************/
+
+static void Verify_File(SHA_Verifier::Entry *entry)
+{
+    Clock::time_point start = Clock::now();
+    uint32_t hash[SHA_VERIFY_MAX_WORDS];
+    struct stat st;
+    int exit_status;
+
+    if (stat(entry->filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        exit_status = EXIT_FAILURE;
+    else if (entry->nr_of_words == SHA1_HASH_SIZE)
+        exit_status = SHA1_File((char*) entry->filename.c_str(), hash);
+    else
+        exit_status = SHA256_File((char*) entry->filename.c_str(), hash);
+
+    if (exit_status != EXIT_SUCCESS)
+    {
+        entry->status = SHA_Verifier::UNREADABLE;
+        entry->file_byte_size = 0;
+    }
+    else
+    {
+        entry->status = memcmp(hash, entry->expected, 4*entry->nr_of_words) == 0 ? SHA_Verifier::OK : SHA_Verifier::MISMATCH;
+        entry->file_byte_size = st.st_size;
+    }
+
+    entry->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Verifier::SHA_Verifier
+ *
+ * PURPOSE: Constructs a verifier with an empty manifest
+ *
+ *********************************************************************************************************************************/
+
+SHA_Verifier::SHA_Verifier() : nr_of_lines(0), nr_of_malformed_lines(0)
+{
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Verifier::Load_Manifest
+ *
+ * PURPOSE: Appends the entries of a manifest to the files to be verified. Empty lines are skipped and malformed lines are
+ *          counted and reported in the summary of Verify.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * filename            const char*     I       the file name of the manifest, or "-" for standard input
+ *
+ * RETURN VALUE : int, EXIT_FAILURE if the manifest could not be opened
+ *
+ *********************************************************************************************************************************/
+
+int SHA_Verifier::Load_Manifest(const char *filename)
+{
+    FILE *fp;
+
+    if (strcmp(filename, "-") == 0)
+    {
+        Load_Manifest(stdin);
+        return EXIT_SUCCESS;
+    }
+
+    fp = fopen(filename, "r");
+    if (fp == NULL)
+        return EXIT_FAILURE;
+
+    Load_Manifest(fp);
+    fclose(fp);
+
+    return EXIT_SUCCESS;
+}
+
+void SHA_Verifier::Load_Manifest(FILE *fp)
+{
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    Entry entry;
+
+    entry.status = PENDING;
+    entry.file_byte_size = 0;
+    entry.seconds = 0;
+    entry.device = 0;
+    entry.position = 0;
+    entry.physical = false;
+
+    while ((length = getline(&line, &capacity, fp)) >= 0)
+    {
+        nr_of_lines++;
+
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+            line[--length] = '\0';
+        if (length == 0)
+            continue;
+
+        if (Parse_Line(line, &entry) != EXIT_SUCCESS)
+        {
+            nr_of_malformed_lines++;
+            continue;
+        }
+        entry.line = nr_of_lines;
+        entries.push_back(entry);
+    }
+
+    free(line);
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Verifier::Locate
+ *
+ * PURPOSE: Locates every file of the manifest on disk by Locate_File. The files are divided among the threads, since on a
+ *          network file system every lookup is a round trip of its own.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * physical            bool            I       true if the physical offsets are wanted and false if inode numbers suffice
+ * nr_of_threads       unsigned int    I       the number of threads to use
+ *
+ *********************************************************************************************************************************/
+
+void SHA_Verifier::Locate(bool physical, unsigned int nr_of_threads)
+{
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> next(0);
+
+    for (unsigned int t = 0; t < nr_of_threads; t++)
+        threads.emplace_back([this, &next, physical]()
+        {
+            for (uint64_t i = next++; i < entries.size(); i = next++)
+                Locate_File(&entries[i], physical);
+        });
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+
+/*********************************************************************************************************************************
+ *
+ * FUNCTION NAME: SHA_Verifier::Verify
+ *
+ * PURPOSE: Sorts the files of the manifest in the requested order and verifies them. The callback is called once for every
+ *          file as soon as it has been verified, from the thread which verified it but never from two threads at a time.
+ *          After the call, Entries returns the files in the order in which they were taken by the threads.
+ *
+ * ARGUMENTS:
+ *
+ * ARGUMENT            TYPE            I/O     DESCRIPTION
+ * --------            ----            ---     -----------
+ * order               Order           I       the order in which the files are to be read
+ * nr_of_threads       unsigned int    I       the number of threads, which bounds the number of files read at a time
+ * nr_of_slowest       unsigned int    I       the number of the slowest files to be listed in the summary
+ * callback            Callback        I       the function receiving every verified entry, or an empty function
+ * summary             Summary*        O       pointer to the summary of the verification
+ *
+ *********************************************************************************************************************************/
+
+void SHA_Verifier::Verify(Order order, unsigned int nr_of_threads, unsigned int nr_of_slowest, Callback callback, Summary *summary)
+{
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> next(0);
+    std::mutex mutex;
+
+    if (nr_of_threads == 0)
+        nr_of_threads = 1;
+
+    /* Sort the files */
+
+    if (order != MANIFEST_ORDER)
+    {
+        Locate(order == PHYSICAL_ORDER, nr_of_threads);
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+        {
+            if (a.device != b.device)
+                return a.device < b.device;
+            if (a.physical != b.physical)
+                return a.physical;
+            return a.position < b.position;
+        });
+    }
+
+    /* Verify the files */
+
+    for (unsigned int t = 0; t < nr_of_threads; t++)
+        threads.emplace_back([this, &next, &mutex, &callback]()
+        {
+            for (uint64_t i = next++; i < entries.size(); i = next++)
+            {
+                Verify_File(&entries[i]);
+                if (callback)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    callback(entries[i]);
+                }
+            }
+        });
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    /* Summarise */
+
+    summary->files = entries.size();
+    summary->ok = 0;
+    summary->mismatches = 0;
+    summary->unreadable = 0;
+    summary->malformed_lines = nr_of_malformed_lines;
+    summary->physically_ordered = 0;
+    summary->bytes = 0;
+    summary->slowest.clear();
+
+    for (const Entry &entry : entries)
+    {
+        summary->ok += (entry.status == OK);
+        summary->mismatches += (entry.status == MISMATCH);
+        summary->unreadable += (entry.status == UNREADABLE);
+        summary->physically_ordered += (order != MANIFEST_ORDER && entry.physical);
+        summary->bytes += entry.file_byte_size;
+        summary->slowest.push_back(&entry);
+    }
+
+    nr_of_slowest = std::min<uint64_t>(nr_of_slowest, entries.size());
+    std::partial_sort(summary->slowest.begin(), summary->slowest.begin() + nr_of_slowest, summary->slowest.end(),
+                      [](const Entry *a, const Entry *b) { return a->seconds > b->seconds; });
+    summary->slowest.resize(nr_of_slowest);
+
+    summary->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    summary->mb_per_s = summary->seconds > 0 ? summary->bytes/summary->seconds/1e6 : 0;
+    summary->files_per_s = summary->seconds > 0 ? summary->files/summary->seconds : 0;
+}
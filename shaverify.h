@@ -0,0 +1,96 @@
+/***************************************************************************************************************************************
+ * FILENAME: shaverify.h
+ *
+ * Copyright (c) 2016 Anders Nordenfelt
+ *
+ * CONTENT: Declares the class SHA_Verifier defined in shaverify.cpp, which verifies the files listed in a manifest in the
+ *          format of sha1sum and sha256sum, reading the files in the order of their physical location on disk
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __SHAVERIFY__
+#define __SHAVERIFY__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#define SHA_VERIFY_MAX_WORDS 8                /* the largest size of an expected hash in number of 32-bit INTEGERS          */
+
+class SHA_Verifier
+{
+public:
+
+    /* The orders in which the files of a manifest may be read */
+
+    enum Order
+    {
+        MANIFEST_ORDER,                       /* the order of the lines of the manifest                                     */
+        INODE_ORDER,                          /* by device and inode number                                                 */
+        PHYSICAL_ORDER                        /* by device and physical offset of the first extent, by inode when the file  */
+                                              /* system does not support FIEMAP                                             */
+    };
+
+    /* The outcome of the verification of a file */
+
+    enum Status
+    {
+        PENDING,                              /* the file has not been verified yet                                         */
+        OK,                                   /* the hash of the file equals the expected hash                              */
+        MISMATCH,                             /* the hash of the file differs from the expected hash                        */
+        UNREADABLE                            /* the file could not be opened or read                                       */
+    };
+
+    struct Entry
+    {
+        std::string filename;                 /* the file name as written in the manifest                                   */
+        uint32_t expected[SHA_VERIFY_MAX_WORDS];  /* the expected hash                                                      */
+        unsigned int nr_of_words;             /* the size of the expected hash, 5 for SHA1 and 8 for SHA256                 */
+        uint64_t line;                        /* the line number in the manifest                                            */
+        uint64_t device;                      /* the device and the position of the file used for sorting                   */
+        uint64_t position;
+        bool physical;                        /* true if position is a physical offset and false if it is an inode number   */
+        Status status;
+        uint64_t file_byte_size;
+        double seconds;                       /* the time spent opening, reading and hashing the file                       */
+    };
+
+    struct Summary
+    {
+        uint64_t files;                       /* the number of files verified                                               */
+        uint64_t ok;
+        uint64_t mismatches;
+        uint64_t unreadable;
+        uint64_t malformed_lines;             /* the number of lines of the manifest which could not be parsed              */
+        uint64_t physically_ordered;          /* the number of files whose physical offset was known                        */
+        uint64_t bytes;                       /* the number of bytes hashed                                                 */
+        double seconds;                       /* the time spent verifying, including determining the order                  */
+        double mb_per_s;
+        double files_per_s;
+        std::vector<const Entry*> slowest;    /* the slowest files in order of decreasing time                              */
+    };
+
+    typedef std::function<void(const Entry &entry)> Callback;
+
+    SHA_Verifier();
+
+    int Load_Manifest(const char *filename);
+    void Load_Manifest(FILE *fp);
+
+    void Verify(Order order, unsigned int nr_of_threads, unsigned int nr_of_slowest, Callback callback, Summary *summary);
+
+    const std::vector<Entry> &Entries() const { return entries; }
+
+private:
+
+    void Locate(bool physical, unsigned int nr_of_threads);
+
+    std::vector<Entry> entries;
+    uint64_t nr_of_lines;
+    uint64_t nr_of_malformed_lines;
+};
+
+#endif
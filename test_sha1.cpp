@@ -15,8 +15,32 @@
 
 
 #include "test_sha1.h"
+#include "test_sha256.h"
+#include "test_sha512.h"
+#include "test_shabatch.h"
+#include "test_shaserver.h"
+#include "test_shahasher.h"
+#include "test_shaconst.h"
+#include "test_shahex.h"
+#include "test_shaotp.h"
+#include "test_shauuid.h"
+#include "test_shaverify.h"
+#include "test_shaalg.h"
+#include "test_shaarchive.h"
+#include "test_shaset.h"
+#include "test_shacolumn.h"
+#include "test_shaasync.h"
+#include "test_shahmac.h"
+#include "test_shachain.h"
+#include "test_shatune.h"
+#include "test_shanuma.h"
+#include "test_shasparse.h"
+#include "test_shabulk.h"
+#include "test_shadata.h"
 
 /* File containing the functions to be tested. */
+#include <stdio.h>
+#include "shalib.h"
 #include "sha1.h"
 
 #define HASH_SIZE 5
@@ -164,6 +188,31 @@ void Test_SHA1::SHA1_test2()
     delete[] msg;
 }
 
+/** --------------------------------------------------------------------------
+
+Test of SHA1 with short text of length 0 to 130, covering the one- and two-block short-message path and the
+switch to the word pointer above 119 bytes, compared with SHA1_Concat of the text split in two                */
+
+void Test_SHA1::SHA1_test3()
+{
+    char msg[130];
+    uint32_t digest[HASH_SIZE], reference[HASH_SIZE];
+
+    Fill_Data(msg, sizeof(msg));
+
+    for (uint64_t size = 0; size <= 130; size++)
+    {
+        char *strings[] = {msg, msg + size/2};
+        uint64_t strings_byte_size[] = {size/2, size - size/2};
+
+        SHA1(msg, size, digest);
+        SHA1_Concat(strings, 2, strings_byte_size, reference);
+
+        for (int i = 0; i < HASH_SIZE; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+    }
+}
+
 
 
 /** --------------------------------------------------------------------------
@@ -247,6 +296,43 @@ void Test_SHA1::HMAC_SHA1_test3()
         CPPUNIT_ASSERT(digest[i] == reference[i]);
 }
 
+/** --------------------------------------------------------------------------
+
+Test of the instrumentation counters with SHA1 of the letter 'a' repeated 1'000'000 times.
+All blocks but the last two are loaded through the fast track, the second last block ends exactly
+at the end of the text and the last block consists of the pad only. If the library was compiled
+without SHA_STATS the snapshot must fail and be zero.                                              */
+
+void Test_SHA1::SHA_Stats_test1()
+{
+    const unsigned int STRING_SIZE = 1000000;
+    struct sha_stats stats;
+
+    char *msg = new char[STRING_SIZE];
+    memset(msg, 'a', STRING_SIZE);
+
+    uint32_t digest[HASH_SIZE];
+    SHA_Stats_Reset();
+    SHA1(msg, STRING_SIZE, digest);
+
+    if (SHA_Stats_Snapshot(&stats) == EXIT_SUCCESS)
+    {
+        CPPUNIT_ASSERT(stats.bytes_hashed == STRING_SIZE);
+        CPPUNIT_ASSERT(stats.blocks_compressed == 15626);
+        CPPUNIT_ASSERT(stats.fast_path_blocks == 15624);
+        CPPUNIT_ASSERT(stats.slow_path_blocks == 2);
+        CPPUNIT_ASSERT(stats.pad_blocks == 1);
+        CPPUNIT_ASSERT(stats.file_read_calls == 0);
+    }
+    else
+    {
+        CPPUNIT_ASSERT(stats.bytes_hashed == 0);
+        CPPUNIT_ASSERT(stats.blocks_compressed == 0);
+    }
+
+    delete[] msg;
+}
+
 /** -------------------------------------------------------------------------- 
 
 Main execution of the tests */
@@ -257,6 +343,27 @@ int main(int argc, char* argv[])
 
     CppUnit::TextTestRunner runner;
     runner.addTest(Test_SHA1::suite());
+    runner.addTest(Test_SHA256::suite());
+    runner.addTest(Test_SHA512::suite());
+    runner.addTest(Test_SHABatch::suite());
+    runner.addTest(Test_SHAServer::suite());
+    runner.addTest(Test_SHAHasher::suite());
+    runner.addTest(Test_SHAConst::suite());
+    runner.addTest(Test_SHAHex::suite());
+    runner.addTest(Test_SHAOTP::suite());
+    runner.addTest(Test_SHAUUID::suite());
+    runner.addTest(Test_SHAVERIFY::suite());
+    runner.addTest(Test_SHAALG::suite());
+    runner.addTest(Test_SHAARCHIVE::suite());
+    runner.addTest(Test_SHASET::suite());
+    runner.addTest(Test_SHACOLUMN::suite());
+    runner.addTest(Test_SHAASYNC::suite());
+    runner.addTest(Test_SHAHMAC::suite());
+    runner.addTest(Test_SHACHAIN::suite());
+    runner.addTest(Test_SHATUNE::suite());
+    runner.addTest(Test_SHANUMA::suite());
+    runner.addTest(Test_SHASPARSE::suite());
+    runner.addTest(Test_SHABULK::suite());
     start_time = clock();
     runner.run(std::string(""), false, true, false);
     end_time = clock();
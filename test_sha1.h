@@ -41,10 +41,12 @@ public:
     CPPUNIT_TEST( SHA1_Concat_test3 );
     CPPUNIT_TEST( SHA1_test1 );
     CPPUNIT_TEST( SHA1_test2 );
+    CPPUNIT_TEST( SHA1_test3 );
     CPPUNIT_TEST( SHA1_File_test1 );
     CPPUNIT_TEST( HMAC_SHA1_test1 );
     CPPUNIT_TEST( HMAC_SHA1_test2 );
     CPPUNIT_TEST( HMAC_SHA1_test3 );
+    CPPUNIT_TEST( SHA_Stats_test1 );
     CPPUNIT_TEST_SUITE_END();
 
     void SHA1_Concat_test1();
@@ -52,10 +54,12 @@ public:
     void SHA1_Concat_test3();
     void SHA1_test1();
     void SHA1_test2();
+    void SHA1_test3();
     void SHA1_File_test1();
     void HMAC_SHA1_test1();
     void HMAC_SHA1_test2();
     void HMAC_SHA1_test3();
+    void SHA_Stats_test1();
 
 };
 
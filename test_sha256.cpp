@@ -0,0 +1,235 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_sha256.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-04
+ *
+ * CONTENT: Defines the tests of the SHA-256 and SHA-224 functions contained in the files sha256.h and sha256.c.
+ *          The tests were constructed using the following internet resources:
+ *          http://www.di-mgt.com.au/sha_testvectors.html
+ *          https://tools.ietf.org/html/rfc4231
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_sha256.h"
+
+/* File containing the functions to be tested. */
+#include "sha256.h"
+
+#define SHA256_HASH_SIZE 8
+#define SHA224_HASH_SIZE 7
+
+/** --------------------------------------------------------------------------
+
+Test of SHA256_Concat with short text
+
+text:   "abc"
+
+digest: 0xba7816bf, 0x8f01cfea, 0x414140de, 0x5dae2223, 0xb00361a3, 0x96177a9c, 0xb410ff61, 0xf20015ad     */
+
+void Test_SHA256::SHA256_Concat_test1()
+{
+    char msg1[] = {"ab"};
+    char msg2[] = {""};
+    char msg3[] = {"c"};
+    char *msg[] = {msg1, msg2, msg3};
+    uint64_t msg_len[] = {strlen(msg1), strlen(msg2), strlen(msg3)};
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    SHA256_Concat(msg, 3, msg_len, digest);
+
+    uint32_t reference[] = {0xba7816bf, 0x8f01cfea, 0x414140de, 0x5dae2223, 0xb00361a3, 0x96177a9c, 0xb410ff61, 0xf20015ad};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA256_Concat with total text size larger than the block-size of 64 bytes, where the first string
+holds exactly one whole block and the blocks therefore alternate between the bulk and the word pointer path
+
+text:   "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+
+digest: 0xcf5b16a7, 0x78af8380, 0x036ce59e, 0x7b049237, 0x0b249b11, 0xe8f07a51, 0xafac4503, 0x7afee9d1     */
+
+void Test_SHA256::SHA256_Concat_test2()
+{
+    char msg1[] = {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"};
+    char msg2[] = {"ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"};
+    char *msg[] = {msg1, msg2};
+    uint64_t msg_len[] = {strlen(msg1), strlen(msg2)};
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    SHA256_Concat(msg, 2, msg_len, digest);
+
+    uint32_t reference[] = {0xcf5b16a7, 0x78af8380, 0x036ce59e, 0x7b049237, 0x0b249b11, 0xe8f07a51, 0xafac4503, 0x7afee9d1};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA256 with text size such that the pad occupies a block of its own
+
+text:   "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+
+digest: 0x248d6a61, 0xd20638b8, 0xe5c02693, 0x0c3e6039, 0xa33ce459, 0x64ff2167, 0xf6ecedd4, 0x19db06c1     */
+
+void Test_SHA256::SHA256_test1()
+{
+    char msg[] = {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    SHA256(msg, strlen(msg), digest);
+
+    uint32_t reference[] = {0x248d6a61, 0xd20638b8, 0xe5c02693, 0x0c3e6039, 0xa33ce459, 0x64ff2167, 0xf6ecedd4, 0x19db06c1};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA256 with long text
+
+text:   The letter 'a' repeated 1'000'000 times
+
+digest: 0xcdc76e5c, 0x9914fb92, 0x81a1c7e2, 0x84d73e67, 0xf1809a48, 0xa497200e, 0x046d39cc, 0xc7112cd0     */
+
+void Test_SHA256::SHA256_test2()
+{
+    const unsigned int STRING_SIZE = 1000000;
+
+    char *msg = new char[STRING_SIZE];
+    memset(msg, 'a', STRING_SIZE);
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    SHA256(msg, STRING_SIZE, digest);
+
+    uint32_t reference[] = {0xcdc76e5c, 0x9914fb92, 0x81a1c7e2, 0x84d73e67, 0xf1809a48, 0xa497200e, 0x046d39cc, 0xc7112cd0};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+
+    delete[] msg;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA256_File with file "testfile.txt" containing the opening monologue of Richard III
+
+digest: 0xc22eb202, 0x3fb5d201, 0x0b7d4faa, 0x39ebd4dd, 0x054905c5, 0x6c81bab9, 0xcd322ad2, 0xc6ce8bdf     */
+
+void Test_SHA256::SHA256_File_test1()
+{
+    char filename[] = {"testfile.txt"};
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    int exit_status = SHA256_File(filename, digest);
+
+    uint32_t reference[] = {0xc22eb202, 0x3fb5d201, 0x0b7d4faa, 0x39ebd4dd, 0x054905c5, 0x6c81bab9, 0xcd322ad2, 0xc6ce8bdf};
+
+    CPPUNIT_ASSERT(exit_status == EXIT_SUCCESS);
+
+    if (exit_status == EXIT_SUCCESS)
+        for(int i = 0; i < SHA256_HASH_SIZE; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA224 with short text
+
+text:   "abc"
+
+digest: 0x23097d22, 0x3405d822, 0x8642a477, 0xbda255b3, 0x2aadbce4, 0xbda0b3f7, 0xe36c9da7                 */
+
+void Test_SHA256::SHA224_test1()
+{
+    char msg[] = {"abc"};
+
+    uint32_t digest[SHA224_HASH_SIZE];
+    SHA224(msg, strlen(msg), digest);
+
+    uint32_t reference[] = {0x23097d22, 0x3405d822, 0x8642a477, 0xbda255b3, 0x2aadbce4, 0xbda0b3f7, 0xe36c9da7};
+
+    for(int i = 0; i < SHA224_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA256 with both text and key shorter than the block-size of 64 bytes (RFC 4231, test case 2)
+
+text:   "what do ya want for nothing?"
+
+key:    "Jefe"
+
+digest: 0x5bdcc146, 0xbf60754e, 0x6a042426, 0x089575c7, 0x5a003f08, 0x9d273983, 0x9dec58b9, 0x64ec3843     */
+
+void Test_SHA256::HMAC_SHA256_test1()
+{
+    char msg[] = {"what do ya want for nothing?"};
+    char key[] = {"Jefe"};
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    HMAC_SHA256(key, strlen(key), msg, strlen(msg), digest);
+
+    uint32_t reference[] = {0x5bdcc146, 0xbf60754e, 0x6a042426, 0x089575c7, 0x5a003f08, 0x9d273983, 0x9dec58b9, 0x64ec3843};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA256 with a key longer than the block size of 64 bytes (RFC 4231, test case 6)
+
+text:   "Test Using Larger Than Block-Size Key - Hash Key First"
+
+key:    0xaa repeated 131 times
+
+digest: 0x60e43159, 0x1ee0b67f, 0x0d8a26aa, 0xcbf5b77f, 0x8e0bc621, 0x3728c514, 0x0546040f, 0x0ee37f54     */
+
+void Test_SHA256::HMAC_SHA256_test2()
+{
+    char msg[] = {"Test Using Larger Than Block-Size Key - Hash Key First"};
+    char key[131];
+    memset(key, 0xaa, 131);
+
+    uint32_t digest[SHA256_HASH_SIZE];
+    HMAC_SHA256(key, 131, msg, strlen(msg), digest);
+
+    uint32_t reference[] = {0x60e43159, 0x1ee0b67f, 0x0d8a26aa, 0xcbf5b77f, 0x8e0bc621, 0x3728c514, 0x0546040f, 0x0ee37f54};
+
+    for(int i = 0; i < SHA256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA224 with both text and key shorter than the block-size of 64 bytes (RFC 4231, test case 2)
+
+text:   "what do ya want for nothing?"
+
+key:    "Jefe"
+
+digest: 0xa30e0109, 0x8bc6dbbf, 0x45690f3a, 0x7e9e6d0f, 0x8bbea2a3, 0x9e614800, 0x8fd05e44                 */
+
+void Test_SHA256::HMAC_SHA224_test1()
+{
+    char msg[] = {"what do ya want for nothing?"};
+    char key[] = {"Jefe"};
+
+    uint32_t digest[SHA224_HASH_SIZE];
+    HMAC_SHA224(key, strlen(key), msg, strlen(msg), digest);
+
+    uint32_t reference[] = {0xa30e0109, 0x8bc6dbbf, 0x45690f3a, 0x7e9e6d0f, 0x8bbea2a3, 0x9e614800, 0x8fd05e44};
+
+    for(int i = 0; i < SHA224_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
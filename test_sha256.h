@@ -0,0 +1,62 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_sha256.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-04
+ *
+ * CONTENT: Declares the tests contained in test_sha256.cpp of the SHA-256 and SHA-224 functions contained in sha256.h and sha256.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHA256__
+#define __TEST_SHA256__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHA256 : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHA256 );
+    CPPUNIT_TEST( SHA256_Concat_test1 );
+    CPPUNIT_TEST( SHA256_Concat_test2 );
+    CPPUNIT_TEST( SHA256_test1 );
+    CPPUNIT_TEST( SHA256_test2 );
+    CPPUNIT_TEST( SHA256_File_test1 );
+    CPPUNIT_TEST( SHA224_test1 );
+    CPPUNIT_TEST( HMAC_SHA256_test1 );
+    CPPUNIT_TEST( HMAC_SHA256_test2 );
+    CPPUNIT_TEST( HMAC_SHA224_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void SHA256_Concat_test1();
+    void SHA256_Concat_test2();
+    void SHA256_test1();
+    void SHA256_test2();
+    void SHA256_File_test1();
+    void SHA224_test1();
+    void HMAC_SHA256_test1();
+    void HMAC_SHA256_test2();
+    void HMAC_SHA224_test1();
+
+};
+
+#endif
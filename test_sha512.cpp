@@ -0,0 +1,298 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_sha512.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-04
+ *
+ * CONTENT: Defines the tests of the SHA-512, SHA-384 and SHA-512/256 functions contained in the files sha512.h and sha512.c.
+ *          The tests were constructed using the following internet resources:
+ *          http://www.di-mgt.com.au/sha_testvectors.html
+ *          https://tools.ietf.org/html/rfc4231
+ *          http://csrc.nist.gov/groups/ST/toolkit/examples.html
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_sha512.h"
+#include "test_shadata.h"
+
+/* File containing the functions to be tested. */
+#include "sha512.h"
+
+#define SHA512_HASH_SIZE 8
+#define SHA384_HASH_SIZE 6
+#define SHA512_256_HASH_SIZE 4
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512_Concat with short text
+
+text:   "abc"
+
+digest: 0xddaf35a193617aba, 0xcc417349ae204131, 0x12e6fa4e89a97ea2, 0x0a9eeee64b55d39a,
+        0x2192992a274fc1a8, 0x36ba3c23a3feebbd, 0x454d4423643ce80e, 0x2a9ac94fa54ca49f     */
+
+void Test_SHA512::SHA512_Concat_test1()
+{
+    char msg1[] = {"ab"};
+    char msg2[] = {""};
+    char msg3[] = {"c"};
+    char *msg[] = {msg1, msg2, msg3};
+    uint64_t msg_len[] = {strlen(msg1), strlen(msg2), strlen(msg3)};
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    SHA512_Concat(msg, 3, msg_len, digest);
+
+    uint64_t reference[] = {0xddaf35a193617aba, 0xcc417349ae204131, 0x12e6fa4e89a97ea2, 0x0a9eeee64b55d39a,
+                            0x2192992a274fc1a8, 0x36ba3c23a3feebbd, 0x454d4423643ce80e, 0x2a9ac94fa54ca49f};
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512_Concat with strings of several blocks split off the block boundaries, so that whole blocks hashed
+directly from the strings alternate with blocks loaded across them, against SHA512 of the concatenation       */
+
+void Test_SHA512::SHA512_Concat_test2()
+{
+    const unsigned int TEXT_SIZE = 1559;
+    char text[TEXT_SIZE];
+    char *msg[] = {text, text + 300, text + 301, text + 1301};
+    uint64_t msg_len[] = {300, 1, 1000, 258};
+
+    Fill_Data(text, TEXT_SIZE);
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    uint64_t reference[SHA512_HASH_SIZE];
+    SHA512_Concat(msg, 4, msg_len, digest);
+    SHA512(text, TEXT_SIZE, reference);
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512 with total text size larger than the block-size of 128 bytes once the pad is added
+
+text:   "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+
+digest: 0x8e959b75dae313da, 0x8cf4f72814fc143f, 0x8f7779c6eb9f7fa1, 0x7299aeadb6889018,
+        0x501d289e4900f7e4, 0x331b99dec4b5433a, 0xc7d329eeb6dd2654, 0x5e96e55b874be909     */
+
+void Test_SHA512::SHA512_test1()
+{
+    char msg[] = {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"};
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    SHA512(msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0x8e959b75dae313da, 0x8cf4f72814fc143f, 0x8f7779c6eb9f7fa1, 0x7299aeadb6889018,
+                            0x501d289e4900f7e4, 0x331b99dec4b5433a, 0xc7d329eeb6dd2654, 0x5e96e55b874be909};
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512 with long text
+
+text:   The letter 'a' repeated 1'000'000 times
+
+digest: 0xe718483d0ce76964, 0x4e2e42c7bc15b463, 0x8e1f98b13b204428, 0x5632a803afa973eb,
+        0xde0ff244877ea60a, 0x4cb0432ce577c31b, 0xeb009c5c2c49aa2e, 0x4eadb217ad8cc09b     */
+
+void Test_SHA512::SHA512_test2()
+{
+    const unsigned int STRING_SIZE = 1000000;
+
+    char *msg = new char[STRING_SIZE];
+    memset(msg, 'a', STRING_SIZE);
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    SHA512(msg, STRING_SIZE, digest);
+
+    uint64_t reference[] = {0xe718483d0ce76964, 0x4e2e42c7bc15b463, 0x8e1f98b13b204428, 0x5632a803afa973eb,
+                            0xde0ff244877ea60a, 0x4cb0432ce577c31b, 0xeb009c5c2c49aa2e, 0x4eadb217ad8cc09b};
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+
+    delete[] msg;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512_File with file "testfile.txt" containing the opening monologue of Richard III
+
+digest: 0xde15a18756d435a8, 0xc3130e532315f32c, 0xcaa7e7a9109e5e7f, 0x439f59edd7c7a9c7,
+        0x7702a8b951cf112a, 0x2724a40611596a1d, 0xccd1266d518baace, 0x8622a6bb8f0c66aa     */
+
+void Test_SHA512::SHA512_File_test1()
+{
+    char filename[] = {"testfile.txt"};
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    int exit_status = SHA512_File(filename, digest);
+
+    uint64_t reference[] = {0xde15a18756d435a8, 0xc3130e532315f32c, 0xcaa7e7a9109e5e7f, 0x439f59edd7c7a9c7,
+                            0x7702a8b951cf112a, 0x2724a40611596a1d, 0xccd1266d518baace, 0x8622a6bb8f0c66aa};
+
+    CPPUNIT_ASSERT(exit_status == EXIT_SUCCESS);
+
+    if (exit_status == EXIT_SUCCESS)
+        for(int i = 0; i < SHA512_HASH_SIZE; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA384 with short text
+
+text:   "abc"
+
+digest: 0xcb00753f45a35e8b, 0xb5a03d699ac65007, 0x272c32ab0eded163,
+        0x1a8b605a43ff5bed, 0x8086072ba1e7cc23, 0x58baeca134c825a7                         */
+
+void Test_SHA512::SHA384_test1()
+{
+    char msg[] = {"abc"};
+
+    uint64_t digest[SHA384_HASH_SIZE];
+    SHA384(msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0xcb00753f45a35e8b, 0xb5a03d699ac65007, 0x272c32ab0eded163,
+                            0x1a8b605a43ff5bed, 0x8086072ba1e7cc23, 0x58baeca134c825a7};
+
+    for(int i = 0; i < SHA384_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512_256 with short text
+
+text:   "abc"
+
+digest: 0x53048e2681941ef9, 0x9b2e29b76b4c7dab, 0xe4c2d0c634fc6d46, 0xe0e2f13107e7af23     */
+
+void Test_SHA512::SHA512_256_test1()
+{
+    char msg[] = {"abc"};
+
+    uint64_t digest[SHA512_256_HASH_SIZE];
+    SHA512_256(msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0x53048e2681941ef9, 0x9b2e29b76b4c7dab, 0xe4c2d0c634fc6d46, 0xe0e2f13107e7af23};
+
+    for(int i = 0; i < SHA512_256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA512_256_Concat with total text size larger than the block-size of 128 bytes once the pad is added
+
+text:   "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+
+digest: 0x3928e184fb8690f8, 0x40da3988121d31be, 0x65cb9d3ef83ee614, 0x6feac861e19b563a     */
+
+void Test_SHA512::SHA512_256_test2()
+{
+    char msg1[] = {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmgh"};
+    char msg2[] = {"ijklmnhijklmnoi"};
+    char msg3[] = {"jklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"};
+    char *msg[] = {msg1, msg2, msg3};
+    uint64_t msg_len[] = {strlen(msg1), strlen(msg2), strlen(msg3)};
+
+    uint64_t digest[SHA512_256_HASH_SIZE];
+    SHA512_256_Concat(msg, 3, msg_len, digest);
+
+    uint64_t reference[] = {0x3928e184fb8690f8, 0x40da3988121d31be, 0x65cb9d3ef83ee614, 0x6feac861e19b563a};
+
+    for(int i = 0; i < SHA512_256_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA512 with both text and key shorter than the block-size of 128 bytes (RFC 4231, test case 2)
+
+text:   "what do ya want for nothing?"
+
+key:    "Jefe"
+
+digest: 0x164b7a7bfcf819e2, 0xe395fbe73b56e0a3, 0x87bd64222e831fd6, 0x10270cd7ea250554,
+        0x9758bf75c05a994a, 0x6d034f65f8f0e6fd, 0xcaeab1a34d4a6b4b, 0x636e070a38bce737     */
+
+void Test_SHA512::HMAC_SHA512_test1()
+{
+    char msg[] = {"what do ya want for nothing?"};
+    char key[] = {"Jefe"};
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    HMAC_SHA512(key, strlen(key), msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0x164b7a7bfcf819e2, 0xe395fbe73b56e0a3, 0x87bd64222e831fd6, 0x10270cd7ea250554,
+                            0x9758bf75c05a994a, 0x6d034f65f8f0e6fd, 0xcaeab1a34d4a6b4b, 0x636e070a38bce737};
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA512 with a key longer than the block size of 128 bytes (RFC 4231, test case 6)
+
+text:   "Test Using Larger Than Block-Size Key - Hash Key First"
+
+key:    0xaa repeated 131 times
+
+digest: 0x80b24263c7c1a3eb, 0xb71493c1dd7be8b4, 0x9b46d1f41b4aeec1, 0x121b013783f8f352,
+        0x6b56d037e05f2598, 0xbd0fd2215d6a1e52, 0x95e64f73f63f0aec, 0x8b915a985d786598     */
+
+void Test_SHA512::HMAC_SHA512_test2()
+{
+    char msg[] = {"Test Using Larger Than Block-Size Key - Hash Key First"};
+    char key[131];
+    memset(key, 0xaa, 131);
+
+    uint64_t digest[SHA512_HASH_SIZE];
+    HMAC_SHA512(key, 131, msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0x80b24263c7c1a3eb, 0xb71493c1dd7be8b4, 0x9b46d1f41b4aeec1, 0x121b013783f8f352,
+                            0x6b56d037e05f2598, 0xbd0fd2215d6a1e52, 0x95e64f73f63f0aec, 0x8b915a985d786598};
+
+    for(int i = 0; i < SHA512_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC_SHA384 with both text and key shorter than the block-size of 128 bytes (RFC 4231, test case 2)
+
+text:   "what do ya want for nothing?"
+
+key:    "Jefe"
+
+digest: 0xaf45d2e376484031, 0x617f78d2b58a6b1b, 0x9c7ef464f5a01b47,
+        0xe42ec3736322445e, 0x8e2240ca5e69e2c7, 0x8b3239ecfab21649                         */
+
+void Test_SHA512::HMAC_SHA384_test1()
+{
+    char msg[] = {"what do ya want for nothing?"};
+    char key[] = {"Jefe"};
+
+    uint64_t digest[SHA384_HASH_SIZE];
+    HMAC_SHA384(key, strlen(key), msg, strlen(msg), digest);
+
+    uint64_t reference[] = {0xaf45d2e376484031, 0x617f78d2b58a6b1b, 0x9c7ef464f5a01b47,
+                            0xe42ec3736322445e, 0x8e2240ca5e69e2c7, 0x8b3239ecfab21649};
+
+    for(int i = 0; i < SHA384_HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
@@ -0,0 +1,67 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_sha512.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-04
+ *
+ * CONTENT: Declares the tests contained in test_sha512.cpp of the SHA-512, SHA-384 and SHA-512/256 functions contained in
+ *          sha512.h and sha512.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHA512__
+#define __TEST_SHA512__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHA512 : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHA512 );
+    CPPUNIT_TEST( SHA512_Concat_test1 );
+    CPPUNIT_TEST( SHA512_Concat_test2 );
+    CPPUNIT_TEST( SHA512_test1 );
+    CPPUNIT_TEST( SHA512_test2 );
+    CPPUNIT_TEST( SHA512_File_test1 );
+    CPPUNIT_TEST( SHA384_test1 );
+    CPPUNIT_TEST( SHA512_256_test1 );
+    CPPUNIT_TEST( SHA512_256_test2 );
+    CPPUNIT_TEST( HMAC_SHA512_test1 );
+    CPPUNIT_TEST( HMAC_SHA512_test2 );
+    CPPUNIT_TEST( HMAC_SHA384_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void SHA512_Concat_test1();
+    void SHA512_Concat_test2();
+    void SHA512_test1();
+    void SHA512_test2();
+    void SHA512_File_test1();
+    void SHA384_test1();
+    void SHA512_256_test1();
+    void SHA512_256_test2();
+    void HMAC_SHA512_test1();
+    void HMAC_SHA512_test2();
+    void HMAC_SHA384_test1();
+
+};
+
+#endif
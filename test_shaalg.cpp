@@ -0,0 +1,97 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaalg.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-23
+ *
+ * CONTENT: Defines the tests of the AF_ALG file backend contained in the file shaalg.c. The hashes computed by the kernel
+ *          are compared with those computed by the library from memory. On hosts without AF_ALG the tests check that
+ *          the backend cannot be selected and that the file functions still hash in the library.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaalg.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shaalg.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_File_Set_Backend with an unknown backend and with the AF_ALG backend, which may only be selected if
+the kernel provides SHA1                                                                                       */
+
+void Test_SHAALG::Backend_test1()
+{
+    CPPUNIT_ASSERT(SHA_File_Get_Backend() == SHA_FILE_BACKEND_LIBRARY);
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(7) == EXIT_FAILURE);
+
+    if (SHA_AF_ALG_Available("sha1"))
+    {
+        CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_AF_ALG) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(SHA_File_Get_Backend() == SHA_FILE_BACKEND_AF_ALG);
+    }
+    else
+    {
+        CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_AF_ALG) == EXIT_FAILURE);
+        CPPUNIT_ASSERT(SHA_File_Get_Backend() == SHA_FILE_BACKEND_LIBRARY);
+    }
+
+    CPPUNIT_ASSERT(SHA_AF_ALG_Available("no-such-algorithm") == 0);
+
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY) == EXIT_SUCCESS);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_File, SHA256_File and SHA224_File with the AF_ALG backend for files of 0 bytes to 3 MiB, crossing
+the block sizes and the size of the pipe, and for a missing file                                              */
+
+void Test_SHAALG::File_test1()
+{
+    const uint64_t sizes[] = {0, 1, 55, 64, 1000, 65537, (1 << 20) + 1, 3*(1 << 20) + 7};
+    const char filename[] = "test_shaalg.tmp";
+    std::vector<char> data(3*(1 << 20) + 7);
+    int available = SHA_AF_ALG_Available("sha1");
+
+    Fill_Data(data.data(), data.size());
+
+    SHA_File_Set_Backend(SHA_FILE_BACKEND_AF_ALG);
+
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+    {
+        uint32_t reference[8], hash[8];
+
+        Write_File(filename, &data[0], sizes[s]);
+
+        SHA1(&data[0], sizes[s], reference);
+        CPPUNIT_ASSERT(SHA1_File((char*) filename, hash) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 20) == 0);
+        CPPUNIT_ASSERT(SHA_AF_ALG_File("sha1", (char*) filename, hash, 5) == (available ? EXIT_SUCCESS : EXIT_FAILURE));
+        if (available)
+            CPPUNIT_ASSERT(memcmp(hash, reference, 20) == 0);
+
+        SHA256(&data[0], sizes[s], reference);
+        CPPUNIT_ASSERT(SHA256_File((char*) filename, hash) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 32) == 0);
+
+        SHA224(&data[0], sizes[s], reference);
+        CPPUNIT_ASSERT(SHA224_File((char*) filename, hash) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 28) == 0);
+    }
+    remove(filename);
+
+    uint32_t hash[5];
+    CPPUNIT_ASSERT(SHA_AF_ALG_File("sha1", (char*) "test_shaalg.missing", hash, 5) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA1_File((char*) "test_shaalg.missing", hash) == EXIT_FAILURE);
+
+    SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY);
+}
@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaalg.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-23
+ *
+ * CONTENT: Declares the tests contained in test_shaalg.cpp of the AF_ALG file backend contained in shaalg.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAALG__
+#define __TEST_SHAALG__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAALG : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAALG );
+    CPPUNIT_TEST( Backend_test1 );
+    CPPUNIT_TEST( File_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Backend_test1();
+    void File_test1();
+
+};
+
+#endif
@@ -0,0 +1,348 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaarchive.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-24
+ *
+ * CONTENT: Defines the tests of the class SHA_Archive_Hasher contained in the file shaarchive.cpp. The archives are built
+ *          in memory with ustar, pax and GNU long name members, compressed with zlib, or with zstd when compiled with
+ *          SHA_ZSTD, where needed, and the hash of every member is compared with the hash of its content computed by SHA1
+ *          and SHA256.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaarchive.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shaarchive.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef SHA_ZSTD
+#include <zstd.h>
+#endif
+
+#include <thread>
+#include <vector>
+
+struct Archive_Member
+{
+    std::string path;
+    std::string data;
+};
+
+/* The function Append_Member appends a header with a valid checksum, the data and its padding to an archive. The size
+   field is that of the data unless header_size is given */
+
+static void Append_Member(std::string *tar, const std::string &name, char type, const std::string &data,
+                          const std::string &prefix = "", long long header_size = -1)
+{
+    char header[512];
+    unsigned int sum = 0;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, name.data(), std::min<size_t>(name.size(), 100));
+    strcpy(&header[100], "0000644");
+    strcpy(&header[108], "0000000");
+    strcpy(&header[116], "0000000");
+    snprintf(&header[124], 12, "%011llo", header_size >= 0 ? header_size : (long long) data.size());
+    strcpy(&header[136], "00000000000");
+    header[156] = type;
+    memcpy(&header[257], "ustar", 6);
+    memcpy(&header[263], "00", 2);
+    memcpy(&header[345], prefix.data(), prefix.size());
+
+    memset(&header[148], ' ', 8);
+    for (int i = 0; i < 512; i++)
+        sum += (unsigned char) header[i];
+    snprintf(&header[148], 8, "%06o", sum);
+
+    tar->append(header, 512);
+    tar->append(data);
+    tar->append((512 - data.size() % 512) % 512, '\0');
+}
+
+static std::string Pax_Record(const std::string &key, const std::string &value)
+{
+    size_t length = key.size() + value.size() + 3;
+    size_t digits = std::to_string(length).size();
+
+    while (std::to_string(length + digits).size() != digits)
+        digits++;
+    return std::to_string(length + digits) + " " + key + "=" + value + "\n";
+}
+
+static std::string Gzip(const std::string &data)
+{
+    z_stream z;
+    std::string out(compressBound(data.size()) + 64, '\0');
+
+    memset(&z, 0, sizeof(z));
+    deflateInit2(&z, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    z.next_in = (Bytef*) data.data();
+    z.avail_in = data.size();
+    z.next_out = (Bytef*) &out[0];
+    z.avail_out = out.size();
+    deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+
+    return out;
+}
+
+#ifdef SHA_ZSTD
+static std::string Zstd(const std::string &data)
+{
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+
+    out.resize(ZSTD_compress(&out[0], out.size(), data.data(), data.size(), 3));
+    return out;
+}
+#endif
+
+/* The function Build_Archive builds an archive exercising every kind of header, and stores its regular files */
+
+static std::string Build_Archive(std::vector<Archive_Member> *members)
+{
+    std::string tar;
+    std::string long_name(200, 'n');
+
+    Append_Member(&tar, "pax_global_header", 'g', Pax_Record("comment", "global"));
+    Append_Member(&tar, "d/", '5', "");
+
+    members->push_back({"d/empty", ""});
+    Append_Member(&tar, "d/empty", '0', "");
+
+    members->push_back({"b", Make_Data(1000, 1)});
+    Append_Member(&tar, "b", '0', members->back().data);
+
+    members->push_back({"long/prefix/c", Make_Data(70000, 2)});
+    Append_Member(&tar, "c", '0', members->back().data, "long/prefix");
+
+    members->push_back({long_name, Make_Data(513, 3)});
+    Append_Member(&tar, "././@LongLink", 'L', long_name + '\0');
+    Append_Member(&tar, long_name.substr(0, 100), '0', members->back().data);
+
+    members->push_back({"pax/path name", Make_Data(5000, 4)});
+    Append_Member(&tar, "PaxHeaders/x", 'x', Pax_Record("path", "pax/path name") + Pax_Record("size", "5000"));
+    Append_Member(&tar, "x", '0', members->back().data, "", 0);
+
+    Append_Member(&tar, "link", '2', "");
+
+    members->push_back({"old", Make_Data(3, 5)});
+    Append_Member(&tar, "old", '\0', members->back().data);
+
+    tar.append(1024, '\0');
+    return tar;
+}
+
+/* The function Check_Members compares the members passed to the callback with the expected ones */
+
+static bool Check_Members(const std::vector<SHA_Archive_Hasher::Member> &found, const std::vector<Archive_Member> &expected,
+                          SHA_Archive_Hasher::Algorithm algorithm)
+{
+    if (found.size() != expected.size())
+        return false;
+
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        uint32_t hash[8];
+
+        if (found[i].path != expected[i].path || found[i].file_byte_size != expected[i].data.size())
+            return false;
+
+        if (algorithm == SHA_Archive_Hasher::SHA1)
+            SHA1((char*) expected[i].data.data(), expected[i].data.size(), hash);
+        else
+            SHA256((char*) expected[i].data.data(), expected[i].data.size(), hash);
+        if (memcmp(hash, found[i].hash, 4*found[i].nr_of_words) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Archive_Hasher::Hash_File on an uncompressed archive with SHA1 and SHA256, with a ring smaller than a
+member and with the default ring                                                                              */
+
+void Test_SHAARCHIVE::Tar_test1()
+{
+    const char filename[] = "test_shaarchive.tar";
+    std::vector<Archive_Member> expected;
+    std::string tar = Build_Archive(&expected);
+    SHA_Archive_Hasher::Algorithm algorithms[] = {SHA_Archive_Hasher::SHA1, SHA_Archive_Hasher::SHA256};
+    size_t ring_sizes[] = {1000, SHA_ARCHIVE_RING_SIZE};
+
+    Write_File(filename, tar);
+
+    for (int a = 0; a < 2; a++)
+        for (int r = 0; r < 2; r++)
+        {
+            SHA_Archive_Hasher hasher(algorithms[a], ring_sizes[r]);
+            std::vector<SHA_Archive_Hasher::Member> found;
+
+            CPPUNIT_ASSERT(hasher.Hash_File(filename, [&](const SHA_Archive_Hasher::Member &member)
+                                                      { found.push_back(member); }) == EXIT_SUCCESS);
+            CPPUNIT_ASSERT(Check_Members(found, expected, algorithms[a]));
+
+            SHA_Archive_Hasher::Stats stats = hasher.Get_Stats();
+            CPPUNIT_ASSERT(stats.members == 6);
+            CPPUNIT_ASSERT(stats.bytes_hashed == 1000 + 70000 + 513 + 5000 + 3);
+            CPPUNIT_ASSERT(stats.bytes_read == tar.size() && stats.bytes_archive == tar.size());
+        }
+
+    remove(filename);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Archive_Hasher with an archive compressed as two concatenated gzip members, read from a file and from a
+pipe                                                                                                           */
+
+void Test_SHAARCHIVE::Gzip_test1()
+{
+    const char filename[] = "test_shaarchive.tar.gz";
+    std::vector<Archive_Member> expected;
+    std::string tar = Build_Archive(&expected);
+    std::string compressed = Gzip(tar.substr(0, 40000)) + Gzip(tar.substr(40000));
+    std::vector<SHA_Archive_Hasher::Member> found;
+    SHA_Archive_Hasher hasher(SHA_Archive_Hasher::SHA1, 4096);
+    int pipe_fds[2];
+
+    Write_File(filename, compressed);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, [&](const SHA_Archive_Hasher::Member &member)
+                                              { found.push_back(member); }) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Members(found, expected, SHA_Archive_Hasher::SHA1));
+    CPPUNIT_ASSERT(hasher.Get_Stats().bytes_read == compressed.size());
+    CPPUNIT_ASSERT(hasher.Get_Stats().bytes_archive == tar.size());
+    remove(filename);
+
+    CPPUNIT_ASSERT(pipe(pipe_fds) == 0);
+    std::thread writer([&]
+    {
+        for (size_t position = 0; position < compressed.size(); position += 1000)
+            if (write(pipe_fds[1], &compressed[position], std::min<size_t>(1000, compressed.size() - position)) < 0)
+                break;
+        close(pipe_fds[1]);
+    });
+
+    found.clear();
+    CPPUNIT_ASSERT(hasher.Hash_Fd(pipe_fds[0], [&](const SHA_Archive_Hasher::Member &member)
+                                               { found.push_back(member); }) == EXIT_SUCCESS);
+    writer.join();
+    close(pipe_fds[0]);
+    CPPUNIT_ASSERT(Check_Members(found, expected, SHA_Archive_Hasher::SHA1));
+}
+
+#ifdef SHA_ZSTD
+/** --------------------------------------------------------------------------
+
+Test of SHA_Archive_Hasher with an archive compressed as two concatenated zstd frames, read from a file and from a
+pipe, and with a truncated zstd stream                                                                         */
+
+void Test_SHAARCHIVE::Zstd_test1()
+{
+    const char filename[] = "test_shaarchive.tar.zst";
+    std::vector<Archive_Member> expected;
+    std::string tar = Build_Archive(&expected);
+    std::string compressed = Zstd(tar.substr(0, 40000)) + Zstd(tar.substr(40000));
+    std::vector<SHA_Archive_Hasher::Member> found;
+    SHA_Archive_Hasher hasher(SHA_Archive_Hasher::SHA256, 4096);
+    int pipe_fds[2];
+
+    Write_File(filename, compressed);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, [&](const SHA_Archive_Hasher::Member &member)
+                                              { found.push_back(member); }) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Members(found, expected, SHA_Archive_Hasher::SHA256));
+    CPPUNIT_ASSERT(hasher.Get_Stats().bytes_read == compressed.size());
+    CPPUNIT_ASSERT(hasher.Get_Stats().bytes_archive == tar.size());
+
+    CPPUNIT_ASSERT(pipe(pipe_fds) == 0);
+    std::thread writer([&]
+    {
+        for (size_t position = 0; position < compressed.size(); position += 1000)
+            if (write(pipe_fds[1], &compressed[position], std::min<size_t>(1000, compressed.size() - position)) < 0)
+                break;
+        close(pipe_fds[1]);
+    });
+
+    found.clear();
+    CPPUNIT_ASSERT(hasher.Hash_Fd(pipe_fds[0], [&](const SHA_Archive_Hasher::Member &member)
+                                               { found.push_back(member); }) == EXIT_SUCCESS);
+    writer.join();
+    close(pipe_fds[0]);
+    CPPUNIT_ASSERT(Check_Members(found, expected, SHA_Archive_Hasher::SHA256));
+
+    /* A truncated zstd stream reports the decompression error */
+
+    Write_File(filename, compressed.substr(0, compressed.size() - 100));
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hasher.Error().find("zstd") != std::string::npos);
+    remove(filename);
+}
+#endif
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Archive_Hasher with a truncated archive, a corrupt header, a member without a name, a truncated gzip
+stream, a zstd stream when compiled without SHA_ZSTD and a missing file                                           */
+
+void Test_SHAARCHIVE::Error_test1()
+{
+    const char filename[] = "test_shaarchive.err";
+    std::vector<Archive_Member> expected;
+    std::string tar = Build_Archive(&expected);
+    SHA_Archive_Hasher hasher;
+    uint64_t nr_of_members;
+
+    /* Truncated inside the member "long/prefix/c": the members before it are still delivered */
+
+    nr_of_members = 0;
+    Write_File(filename, tar.substr(0, 8*512 + 30000));
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, [&](const SHA_Archive_Hasher::Member &) { nr_of_members++; }) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(nr_of_members == 2);
+    CPPUNIT_ASSERT(hasher.Error().find("long/prefix/c") != std::string::npos);
+
+    /* A corrupt header */
+
+    std::string corrupt = tar;
+    corrupt[1024 + 10] ^= 1;
+    Write_File(filename, corrupt);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hasher.Error().find("checksum") != std::string::npos);
+
+    /* A member without a name */
+
+    std::string unnamed;
+    Append_Member(&unnamed, "", '0', Make_Data(10, 6));
+    unnamed.append(1024, '\0');
+    Write_File(filename, unnamed);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hasher.Error().find("without a name") != std::string::npos);
+
+    /* A truncated gzip stream reports the decompression error */
+
+    std::string compressed = Gzip(tar);
+    Write_File(filename, compressed.substr(0, compressed.size() - 100));
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hasher.Error().find("gzip") != std::string::npos);
+
+#ifndef SHA_ZSTD
+    /* zstd is recognised from its magic number and rejected */
+
+    Write_File(filename, std::string("\x28\xb5\x2f\xfd", 4) + tar);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hasher.Error().find("zstd") != std::string::npos);
+#endif
+
+    remove(filename);
+    CPPUNIT_ASSERT(hasher.Hash_File(filename, SHA_Archive_Hasher::Callback()) == EXIT_FAILURE);
+}
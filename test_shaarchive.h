@@ -0,0 +1,56 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaarchive.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-24
+ *
+ * CONTENT: Declares the tests contained in test_shaarchive.cpp of the class SHA_Archive_Hasher contained in shaarchive.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAARCHIVE__
+#define __TEST_SHAARCHIVE__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAARCHIVE : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAARCHIVE );
+    CPPUNIT_TEST( Tar_test1 );
+    CPPUNIT_TEST( Gzip_test1 );
+#ifdef SHA_ZSTD
+    CPPUNIT_TEST( Zstd_test1 );
+#endif
+    CPPUNIT_TEST( Error_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Tar_test1();
+    void Gzip_test1();
+#ifdef SHA_ZSTD
+    void Zstd_test1();
+#endif
+    void Error_test1();
+
+};
+
+#endif
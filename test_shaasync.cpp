@@ -0,0 +1,175 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaasync.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-27
+ *
+ * CONTENT: Defines the tests of the coroutine hashing operations declared in shaasync.h. Files and pipes are hashed by
+ *          coroutines on an Event_Loop, with io_uring where the kernel allows it and with the blocking reads, with the
+ *          compression on the loop thread and on a Thread_Pool, and the hashes are compared with those of SHA1 and
+ *          SHA256.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaasync.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shaasync.h"
+
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+
+/* The function Check_Digest compares a digest of bytes with the words computed by SHA1 */
+
+static bool Check_Digest(const sha::Async_Digest<sha::Sha1> &result, const std::string &data)
+{
+    uint32_t hash[5];
+
+    SHA1((char*) data.data(), data.size(), hash);
+    for (int i = 0; i < 20; i++)
+        if (result.digest[i] != (uint8_t) (hash[i/4] >> (24 - 8*(i % 4))))
+            return false;
+    return result.status == EXIT_SUCCESS && result.file_byte_size == data.size();
+}
+
+/** --------------------------------------------------------------------------
+
+Test of sha1_file_async and hash_file_async on files of sizes around the chunk size, on both kinds of loop and with
+the compression on the loop and on a Thread_Pool, and of a missing file                                         */
+
+void Test_SHAASYNC::File_test1()
+{
+    const char filename[] = "test_shaasync.tmp";
+    const size_t sizes[] = {0, 1, SHA_ASYNC_CHUNK_SIZE, SHA_ASYNC_CHUNK_SIZE + 1, 3*SHA_ASYNC_CHUNK_SIZE + 77};
+    sha::Thread_Pool pool(2);
+
+    for (int use_io_uring = 0; use_io_uring < 2; use_io_uring++)
+    {
+        sha::Event_Loop loop(SHA_ASYNC_QUEUE_DEPTH, use_io_uring == 1);
+
+        for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+        {
+            std::string data = Make_Data(sizes[s], (unsigned int) s);
+            Write_File(filename, data);
+
+            CPPUNIT_ASSERT(Check_Digest(loop.run_until_complete(sha::sha1_file_async(loop, filename)), data));
+            CPPUNIT_ASSERT(Check_Digest(loop.run_until_complete(sha::sha1_file_async(loop, filename, &pool)), data));
+
+            /* The overload without a loop uses the loop running on the thread */
+
+            sha::Async_Digest<sha::Sha256> result = loop.run_until_complete([](const char *filename) -> sha::Task<sha::Async_Digest<sha::Sha256> >
+            {
+                sha::Async_Digest<sha::Sha1> first = co_await sha::sha1_file_async(filename);
+                if (first.status != EXIT_SUCCESS)
+                    co_return sha::Async_Digest<sha::Sha256>{EXIT_FAILURE, first.error_number, 0, {}};
+                co_return co_await sha::hash_file_async<sha::Sha256>(*sha::Event_Loop::current(), filename);
+            }(filename));
+
+            uint32_t hash[8];
+            SHA256((char*) data.data(), data.size(), hash);
+            CPPUNIT_ASSERT(result.status == EXIT_SUCCESS);
+            for (int i = 0; i < 32; i++)
+                CPPUNIT_ASSERT(result.digest[i] == (uint8_t) (hash[i/4] >> (24 - 8*(i % 4))));
+        }
+
+        remove(filename);
+        sha::Async_Digest<sha::Sha1> missing = loop.run_until_complete(sha::sha1_file_async(loop, filename, &pool));
+        CPPUNIT_ASSERT(missing.status == EXIT_FAILURE && missing.error_number == ENOENT);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of 300 files hashed at once by one loop and a Thread_Pool of two threads                                   */
+
+void Test_SHAASYNC::Concurrent_test1()
+{
+    const int nr_of_files = 300;
+    std::vector<std::string> filenames, contents;
+    std::vector<sha::Async_Digest<sha::Sha1> > results(nr_of_files);
+    sha::Thread_Pool pool(2);
+    sha::Event_Loop loop(64);
+
+    for (int i = 0; i < nr_of_files; i++)
+    {
+        filenames.push_back("test_shaasync_" + std::to_string(i) + ".tmp");
+        contents.push_back(Make_Data((i*7919) % 300000, i));
+        Write_File(filenames[i].c_str(), contents[i]);
+    }
+
+    for (int i = 0; i < nr_of_files; i++)
+        loop.spawn([](sha::Event_Loop &loop, const char *filename, sha::Executor *pool,
+                      sha::Async_Digest<sha::Sha1> *result) -> sha::Task<void>
+        {
+            *result = co_await sha::hash_file_async<sha::Sha1>(loop, filename, pool, 16384);
+        }(loop, filenames[i].c_str(), &pool, &results[i]));
+    loop.run();
+
+    for (int i = 0; i < nr_of_files; i++)
+    {
+        CPPUNIT_ASSERT(Check_Digest(results[i], contents[i]));
+        remove(filenames[i].c_str());
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of hash_fd_async on a pipe written in pieces by another thread, and of an Async_Hasher fed by the reads of a
+coroutine                                                                                                       */
+
+void Test_SHAASYNC::Stream_test1()
+{
+    std::string data = Make_Data(1000000, 9);
+    sha::Thread_Pool pool(1);
+
+    for (int use_io_uring = 0; use_io_uring < 2; use_io_uring++)
+    {
+        sha::Event_Loop loop(SHA_ASYNC_QUEUE_DEPTH, use_io_uring == 1);
+
+        for (int fed = 0; fed < 2; fed++)
+        {
+            int pipe_fds[2];
+
+            CPPUNIT_ASSERT(pipe(pipe_fds) == 0);
+            std::thread writer([&]
+            {
+                for (size_t position = 0; position < data.size(); position += 3000)
+                    if (write(pipe_fds[1], &data[position], std::min<size_t>(3000, data.size() - position)) < 0)
+                        break;
+                close(pipe_fds[1]);
+            });
+
+            sha::Async_Digest<sha::Sha1> result;
+            if (fed == 0)
+                result = loop.run_until_complete(sha::hash_fd_async<sha::Sha1>(loop, pipe_fds[0], false, &pool));
+            else
+                result = loop.run_until_complete([](sha::Event_Loop &loop, int fd, sha::Executor *pool)
+                                                 -> sha::Task<sha::Async_Digest<sha::Sha1> >
+                {
+                    sha::Async_Hasher<sha::Sha1> hasher(&loop, pool);
+                    sha::Async_Digest<sha::Sha1> result = {EXIT_SUCCESS, 0, 0, {}};
+                    char buffer[5000];
+                    ssize_t n;
+
+                    while ((n = co_await loop.read(fd, buffer, sizeof(buffer), SHA_ASYNC_STREAM)) > 0)
+                    {
+                        co_await hasher.update(buffer, n);
+                        result.file_byte_size += n;
+                    }
+                    result.digest = hasher.final();
+                    co_return result;
+                }(loop, pipe_fds[0], &pool));
+
+            writer.join();
+            close(pipe_fds[0]);
+            CPPUNIT_ASSERT(Check_Digest(result, data));
+        }
+    }
+}
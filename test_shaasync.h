@@ -0,0 +1,50 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaasync.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-27
+ *
+ * CONTENT: Declares the tests contained in test_shaasync.cpp of the coroutine hashing operations declared in shaasync.h
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAASYNC__
+#define __TEST_SHAASYNC__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAASYNC : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAASYNC );
+    CPPUNIT_TEST( File_test1 );
+    CPPUNIT_TEST( Concurrent_test1 );
+    CPPUNIT_TEST( Stream_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void File_test1();
+    void Concurrent_test1();
+    void Stream_test1();
+
+};
+
+#endif
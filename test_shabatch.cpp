@@ -0,0 +1,203 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shabatch.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-13
+ *
+ * CONTENT: Defines the tests of the multi-lane batch functions contained in the files shabatch.h and shabatch.c and of the
+ *          submission queue contained in the files shaqueue.h and shaqueue.cpp. The results are compared with those of
+ *          the function SHA1, which is tested against published test vectors in test_sha1.cpp.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shabatch.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabatch.h"
+#include "shaqueue.h"
+
+#include <vector>
+
+#define HASH_SIZE 5
+#define NR_OF_TEXTS 301
+
+/* Fills texts with the texts 0, 1, ..., NR_OF_TEXTS-1 of length 0, 1, ..., NR_OF_TEXTS-1, so that every position of
+   the pad and both one and two final blocks are covered, and lanes finish at different times */
+
+static void Set_Texts(std::vector<char> &data, char **texts, uint64_t *texts_byte_size)
+{
+    data.resize(NR_OF_TEXTS*NR_OF_TEXTS);
+    Fill_Data(data.data(), data.size());
+
+    for (unsigned int i = 0; i < NR_OF_TEXTS; i++)
+    {
+        texts[i] = &data[i*NR_OF_TEXTS];
+        texts_byte_size[i] = i;
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Batch with short text
+
+text:   "abc", "" and "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+
+digest: 0xa9993e36, 0x4706816a, 0xba3e2571, 0x7850c26c, 0x9cd0d89d
+        0xda39a3ee, 0x5e6b4b0d, 0x3255bfef, 0x95601890, 0xafd80709
+        0x84983e44, 0x1c3bd26e, 0xbaae4aa1, 0xf95129e5, 0xe54670f1                 */
+
+void Test_SHABatch::SHA1_Batch_test1()
+{
+    char msg1[] = {"abc"};
+    char msg2[] = {""};
+    char msg3[] = {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+    char *msg[] = {msg1, msg2, msg3};
+    uint64_t msg_len[] = {strlen(msg1), strlen(msg2), strlen(msg3)};
+
+    uint32_t digest[3*HASH_SIZE];
+    SHA1_Batch(msg, msg_len, 3, digest);
+
+    uint32_t reference[] = {0xa9993e36, 0x4706816a, 0xba3e2571, 0x7850c26c, 0x9cd0d89d,
+                            0xda39a3ee, 0x5e6b4b0d, 0x3255bfef, 0x95601890, 0xafd80709,
+                            0x84983e44, 0x1c3bd26e, 0xbaae4aa1, 0xf95129e5, 0xe54670f1};
+
+    for(int i = 0; i < 3*HASH_SIZE; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Batch_Kernel with every available kernel, for texts of length 0 to 300 compared with SHA1     */
+
+void Test_SHABatch::SHA1_Batch_Kernel_test1()
+{
+    std::vector<char> data;
+    char *texts[NR_OF_TEXTS];
+    uint64_t texts_byte_size[NR_OF_TEXTS];
+    uint32_t reference[HASH_SIZE*NR_OF_TEXTS];
+    uint32_t digest[HASH_SIZE*NR_OF_TEXTS];
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels;
+
+    Set_Texts(data, texts, texts_byte_size);
+    for (int i = 0; i < NR_OF_TEXTS; i++)
+        SHA1(texts[i], texts_byte_size[i], &reference[HASH_SIZE*i]);
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    CPPUNIT_ASSERT(nr_of_kernels >= 1);
+    CPPUNIT_ASSERT(SHA1_Find_Kernel("scalar") != NULL);
+    CPPUNIT_ASSERT(SHA1_Find_Kernel("scalar2") != NULL && SHA1_Find_Kernel("scalar3") != NULL);
+    CPPUNIT_ASSERT(SHA1_Find_Kernel("no such kernel") == NULL);
+    CPPUNIT_ASSERT(SHA1_Default_Kernel()->nr_of_lanes >= 2);
+
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        memset(digest, 0, sizeof(digest));
+        SHA1_Batch_Kernel(&kernels[k], texts, texts_byte_size, NR_OF_TEXTS, digest);
+
+        for(int i = 0; i < HASH_SIZE*NR_OF_TEXTS; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Queue with futures and callbacks submitted from several threads, compared with SHA1               */
+
+void Test_SHABatch::SHA1_Queue_test1()
+{
+    const int NR_OF_THREADS = 4;
+    std::vector<char> data;
+    char *texts[NR_OF_TEXTS];
+    uint64_t texts_byte_size[NR_OF_TEXTS];
+    uint32_t reference[HASH_SIZE*NR_OF_TEXTS];
+    uint32_t digest[HASH_SIZE*NR_OF_TEXTS];
+    std::vector<std::thread> threads;
+
+    Set_Texts(data, texts, texts_byte_size);
+    for (int i = 0; i < NR_OF_TEXTS; i++)
+        SHA1(texts[i], texts_byte_size[i], &reference[HASH_SIZE*i]);
+
+    {
+        SHA1_Queue queue(200);
+
+        /* Even threads wait for futures, odd threads count completed callbacks */
+
+        for (int t = 0; t < NR_OF_THREADS; t++)
+            threads.push_back(std::thread([&, t]
+            {
+                std::vector<std::future<SHA1_Queue::Digest> > futures;
+                std::vector<int> indices;
+
+                for (int i = t; i < NR_OF_TEXTS; i += NR_OF_THREADS)
+                {
+                    if (t % 2 == 0)
+                    {
+                        futures.push_back(queue.Submit(texts[i], texts_byte_size[i]));
+                        indices.push_back(i);
+                    }
+                    else
+                        queue.Submit(texts[i], texts_byte_size[i], [&digest, i](const SHA1_Queue::Digest &hash)
+                                     { memcpy(&digest[HASH_SIZE*i], &hash[0], sizeof(hash)); });
+                }
+
+                for (size_t j = 0; j < futures.size(); j++)
+                {
+                    SHA1_Queue::Digest hash = futures[j].get();
+                    memcpy(&digest[HASH_SIZE*indices[j]], &hash[0], sizeof(hash));
+                }
+            }));
+
+        for (int t = 0; t < NR_OF_THREADS; t++)
+            threads[t].join();
+
+        /* Leaving the scope completes the outstanding callbacks */
+    }
+
+    for(int i = 0; i < HASH_SIZE*NR_OF_TEXTS; i++)
+        CPPUNIT_ASSERT(digest[i] == reference[i]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of the statistics of SHA1_Queue. A single job is dispatched by the deadline, while a full lane group of
+jobs submitted at once is dispatched without waiting for it                                                   */
+
+void Test_SHABatch::SHA1_Queue_test2()
+{
+    char msg[] = {"abc"};
+    SHA1_Queue queue(1000);
+    unsigned int nr_of_lanes = queue.Nr_Of_Lanes();
+    std::vector<std::future<SHA1_Queue::Digest> > futures;
+
+    SHA1_Queue::Digest hash = queue.Submit(msg, strlen(msg)).get();
+    CPPUNIT_ASSERT(hash[0] == 0xa9993e36 && hash[4] == 0x9cd0d89d);
+
+    SHA1_Queue::Stats stats = queue.Get_Stats();
+    CPPUNIT_ASSERT(stats.jobs == 1);
+    CPPUNIT_ASSERT(stats.batches == 1);
+    CPPUNIT_ASSERT(stats.deadline_flushes == (nr_of_lanes > 1 ? 1u : 0u));
+    CPPUNIT_ASSERT(stats.max_queue_depth == 1);
+    CPPUNIT_ASSERT(stats.mean_lane_fill == 1.0/nr_of_lanes);
+    if (nr_of_lanes > 1)
+        CPPUNIT_ASSERT(stats.mean_latency_us >= 1000 && stats.p99_latency_us >= 1000);
+
+    queue.Reset_Stats();
+    CPPUNIT_ASSERT(queue.Get_Stats().batches == 0);
+
+    for (unsigned int i = 0; i < 4*nr_of_lanes; i++)
+        futures.push_back(queue.Submit(msg, strlen(msg)));
+    for (unsigned int i = 0; i < futures.size(); i++)
+        CPPUNIT_ASSERT(futures[i].get()[0] == 0xa9993e36);
+
+    stats = queue.Get_Stats();
+    CPPUNIT_ASSERT(stats.jobs == 4*nr_of_lanes);
+    CPPUNIT_ASSERT(stats.full_batches >= 1);
+    CPPUNIT_ASSERT(stats.max_queue_depth >= 1 && stats.max_queue_depth <= 4*nr_of_lanes);
+    CPPUNIT_ASSERT(stats.mean_lane_fill > 0 && stats.mean_lane_fill <= 1);
+    CPPUNIT_ASSERT(stats.max_latency_us >= stats.mean_latency_us);
+}
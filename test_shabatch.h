@@ -0,0 +1,53 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shabatch.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-13
+ *
+ * CONTENT: Declares the tests contained in test_shabatch.cpp of the multi-lane batch functions contained in shabatch.h and
+ *          shabatch.c and of the submission queue contained in shaqueue.h and shaqueue.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHABATCH__
+#define __TEST_SHABATCH__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHABatch : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHABatch );
+    CPPUNIT_TEST( SHA1_Batch_test1 );
+    CPPUNIT_TEST( SHA1_Batch_Kernel_test1 );
+    CPPUNIT_TEST( SHA1_Queue_test1 );
+    CPPUNIT_TEST( SHA1_Queue_test2 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void SHA1_Batch_test1();
+    void SHA1_Batch_Kernel_test1();
+    void SHA1_Queue_test1();
+    void SHA1_Queue_test2();
+
+};
+
+#endif
@@ -0,0 +1,161 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shabulk.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-04
+ *
+ * CONTENT: Defines the tests of the bulk hashing of small files contained in the file shabulk.cpp. The hashes of a few
+ *          batches of files, of sizes around the block and batch buffer boundaries, are compared with those of
+ *          SHA1_File on every backend available.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shabulk.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabulk.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <vector>
+
+/* Writes nr_of_files files of sizes that vary over the blocks and past the batch buffers into directory */
+
+static void Make_Files(const char *directory, unsigned int nr_of_files, std::vector<std::string> *filenames)
+{
+    std::vector<char> data(3*SHA_BULK_SMALL_FILE_SIZE);
+    static const uint64_t sizes[] = {0, 1, 55, 56, 64, 1000, SHA_BULK_SMALL_FILE_SIZE - 1, SHA_BULK_SMALL_FILE_SIZE,
+                                     SHA_BULK_SMALL_FILE_SIZE + 1, 3*SHA_BULK_SMALL_FILE_SIZE};
+
+    Fill_Data(data.data(), data.size());
+
+    for (unsigned int i = 0; i < nr_of_files; i++)
+    {
+        char name[32];
+        uint64_t size = i < sizeof(sizes)/sizeof(sizes[0]) ? sizes[i] : (i*i*37) % 3000;
+
+        snprintf(name, sizeof(name), "/file%04u", i);
+        filenames->push_back(std::string(directory) + name);
+
+        Write_File(filenames->back().c_str(), &data[i % 7], size);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Bulk_Files against SHA1_File with io_uring, one thread and several threads                           */
+
+void Test_SHABULK::Bulk_test1()
+{
+    const unsigned int NR_OF_FILES = 2*SHA_BULK_BATCH_SIZE + 77;
+    char directory[] = "/tmp/test_shabulk_XXXXXX";
+    std::vector<std::string> filenames;
+    std::vector<char*> names;
+    std::vector<uint32_t> hashes(5*NR_OF_FILES), reference(5*NR_OF_FILES);
+    std::vector<int> statuses(NR_OF_FILES);
+    struct sha_bulk_stats stats;
+    static const int backends[] = {SHA_BULK_AUTO, SHA_BULK_IO_URING, SHA_BULK_THREADS, SHA_BULK_THREADS};
+    static const unsigned int nr_of_threads[] = {0, 0, 1, 3};
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    Make_Files(directory, NR_OF_FILES, &filenames);
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+    {
+        names.push_back((char*) filenames[i].c_str());
+        CPPUNIT_ASSERT(SHA1_File(names[i], &reference[5*i]) == EXIT_SUCCESS);
+    }
+
+    for (unsigned int b = 0; b < sizeof(backends)/sizeof(backends[0]); b++)
+    {
+        hashes.assign(hashes.size(), 0);
+        statuses.assign(statuses.size(), -1);
+
+        /* io_uring may not be available, and then nothing is hashed */
+
+        if (SHA1_Bulk_Files(names.data(), NR_OF_FILES, hashes.data(), statuses.data(), backends[b], nr_of_threads[b],
+                            &stats) != EXIT_SUCCESS)
+        {
+            CPPUNIT_ASSERT(backends[b] == SHA_BULK_IO_URING);
+            continue;
+        }
+
+        CPPUNIT_ASSERT(hashes == reference);
+        for (unsigned int i = 0; i < NR_OF_FILES; i++)
+            CPPUNIT_ASSERT(statuses[i] == EXIT_SUCCESS);
+
+        if (backends[b] != SHA_BULK_AUTO)
+            CPPUNIT_ASSERT(stats.backend == backends[b]);
+        CPPUNIT_ASSERT(stats.nr_of_files == NR_OF_FILES);
+        CPPUNIT_ASSERT(stats.nr_of_failed == 0);
+        CPPUNIT_ASSERT(stats.nr_of_large_files == 3);
+        CPPUNIT_ASSERT(stats.nr_of_batches >= 3);
+        CPPUNIT_ASSERT((stats.nr_of_enters > 0) == (stats.backend == SHA_BULK_IO_URING));
+    }
+
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        unlink(filenames[i].c_str());
+    rmdir(directory);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Bulk_Files with missing files, directories, a FIFO and /dev/null among the files, and of an unknown
+backend, which must fail alike on every backend                                                                   */
+
+void Test_SHABULK::Failure_test1()
+{
+    const unsigned int NR_OF_FILES = 40;
+    char directory[] = "/tmp/test_shabulk_XXXXXX";
+    std::vector<std::string> filenames;
+    std::vector<char*> names;
+    std::vector<uint32_t> hashes(5*NR_OF_FILES);
+    std::vector<int> statuses(NR_OF_FILES);
+    struct sha_bulk_stats stats;
+    uint32_t reference[5];
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    Make_Files(directory, NR_OF_FILES, &filenames);
+    unlink(filenames[3].c_str());
+    unlink(filenames[20].c_str());
+    CPPUNIT_ASSERT(mkdir(filenames[20].c_str(), 0700) == 0);
+    unlink(filenames[30].c_str());
+    CPPUNIT_ASSERT(mkfifo(filenames[30].c_str(), 0600) == 0);
+    unlink(filenames[35].c_str());
+    filenames[35] = "/dev/null";
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        names.push_back((char*) filenames[i].c_str());
+
+    for (int backend = SHA_BULK_AUTO; backend <= SHA_BULK_THREADS; backend++)
+    {
+        int result = SHA1_Bulk_Files(names.data(), NR_OF_FILES, hashes.data(), statuses.data(), backend, 2, &stats);
+
+        CPPUNIT_ASSERT(result == EXIT_FAILURE);
+        if (backend == SHA_BULK_IO_URING && stats.nr_of_files == 0)
+            continue;
+
+        CPPUNIT_ASSERT(stats.nr_of_failed == 4);
+        for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        {
+            CPPUNIT_ASSERT(statuses[i] == (i == 3 || i == 20 || i == 30 || i == 35 ? EXIT_FAILURE : EXIT_SUCCESS));
+            if (statuses[i] == EXIT_SUCCESS)
+            {
+                SHA1_File(names[i], reference);
+                CPPUNIT_ASSERT(memcmp(&hashes[5*i], reference, sizeof(reference)) == 0);
+            }
+        }
+    }
+
+    CPPUNIT_ASSERT(SHA1_Bulk_Files(names.data(), NR_OF_FILES, hashes.data(), NULL, 7, 0, NULL) == EXIT_FAILURE);
+
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        if (i != 35)
+            unlink(filenames[i].c_str());
+    rmdir(filenames[20].c_str());
+    rmdir(directory);
+}
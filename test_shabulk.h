@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shabulk.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-04
+ *
+ * CONTENT: Declares the tests contained in test_shabulk.cpp of the bulk hashing of small files contained in shabulk.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHABULK__
+#define __TEST_SHABULK__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHABULK : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHABULK );
+    CPPUNIT_TEST( Bulk_test1 );
+    CPPUNIT_TEST( Failure_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Bulk_test1();
+    void Failure_test1();
+
+};
+
+#endif
@@ -0,0 +1,111 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shachain.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-30
+ *
+ * CONTENT: Defines the tests of the hash chain functions contained in the file shachain.c. The chains are compared with
+ *          chains of calls of SHA1 on the 20 bytes of the previous hash.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shachain.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabatch.h"
+#include "shachain.h"
+
+#include <algorithm>
+#include <vector>
+
+/* Computes H^n(x) with SHA1, converting the hash to bytes in every step, as the reference */
+
+static void Reference_Chain(const uint32_t *x, uint64_t nr_of_steps, uint32_t *y)
+{
+    char bytes[20];
+
+    memcpy(y, x, 5*sizeof(uint32_t));
+    for (uint64_t step = 0; step < nr_of_steps; step++)
+    {
+        for (int i = 0; i < 20; i++)
+            bytes[i] = (char) (y[i/4] >> 8*(3 - i % 4));
+        SHA1(bytes, 20, y);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Chain from 20 zero bytes, with and without checkpoints, and from other values compared with SHA1
+
+H^1:    6768033e216468247bd031a0a2d9876d79818f8f
+
+H^1000: b151153da8844acb100229ac3ef76333fc5651cd                                        */
+
+void Test_SHACHAIN::Chain_test1()
+{
+    const uint32_t zero[5] = {0, 0, 0, 0, 0};
+    const uint32_t reference_1[5] = {0x6768033e, 0x21646824, 0x7bd031a0, 0xa2d9876d, 0x79818f8f};
+    const uint32_t reference_1000[5] = {0xb151153d, 0xa8844acb, 0x100229ac, 0x3ef76333, 0xfc5651cd};
+    uint32_t x[5], y[5], reference[5], checkpoints[5*10];
+
+    SHA1_Chain(zero, 1, 0, NULL, y);
+    CPPUNIT_ASSERT(memcmp(y, reference_1, sizeof(y)) == 0);
+
+    SHA1_Chain(zero, 1000, 100, checkpoints, y);
+    CPPUNIT_ASSERT(memcmp(y, reference_1000, sizeof(y)) == 0);
+    CPPUNIT_ASSERT(memcmp(&checkpoints[5*9], reference_1000, sizeof(y)) == 0);
+    for (int k = 0; k < 10; k++)
+    {
+        Reference_Chain(zero, 100*(k + 1), reference);
+        CPPUNIT_ASSERT(memcmp(&checkpoints[5*k], reference, sizeof(reference)) == 0);
+    }
+
+    /* A chain of no steps, and a chain computed in place from a value other than zero */
+
+    for (int i = 0; i < 5; i++)
+        x[i] = 0x01234567u*(i + 1);
+    SHA1_Chain(x, 0, 0, NULL, y);
+    CPPUNIT_ASSERT(memcmp(x, y, sizeof(y)) == 0);
+
+    Reference_Chain(x, 777, reference);
+    SHA1_Chain(x, 777, 0, NULL, x);
+    CPPUNIT_ASSERT(memcmp(x, reference, sizeof(reference)) == 0);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Chain_Batch_Kernel on 37 chains of 250 steps with checkpoints every 60 steps on every kernel,
+compared with SHA1_Chain                                                                                        */
+
+void Test_SHACHAIN::Chain_Batch_test1()
+{
+    const uint64_t nr_of_chains = 37, nr_of_steps = 250, interval = 60;
+    std::vector<uint32_t> x(5*nr_of_chains), y(5*nr_of_chains), reference(5*nr_of_chains);
+    std::vector<uint32_t> checkpoints(5*nr_of_chains*4), reference_checkpoints(5*nr_of_chains*4);
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels;
+
+    for (uint64_t i = 0; i < 5*nr_of_chains; i++)
+        x[i] = (uint32_t) (i*2654435761u);
+    for (uint64_t i = 0; i < nr_of_chains; i++)
+        SHA1_Chain(&x[5*i], nr_of_steps, interval, &reference_checkpoints[5*4*i], &reference[5*i]);
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        std::fill(y.begin(), y.end(), 0);
+        std::fill(checkpoints.begin(), checkpoints.end(), 0);
+        SHA1_Chain_Batch_Kernel(&kernels[k], &x[0], nr_of_chains, nr_of_steps, interval, &checkpoints[0], &y[0]);
+
+        CPPUNIT_ASSERT(y == reference);
+        CPPUNIT_ASSERT(checkpoints == reference_checkpoints);
+    }
+
+    /* In place and without checkpoints */
+
+    SHA1_Chain_Batch(&x[0], nr_of_chains, nr_of_steps, 0, NULL, &x[0]);
+    CPPUNIT_ASSERT(x == reference);
+}
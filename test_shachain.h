@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shachain.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-30
+ *
+ * CONTENT: Declares the tests contained in test_shachain.cpp of the hash chain functions contained in shachain.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHACHAIN__
+#define __TEST_SHACHAIN__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHACHAIN : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHACHAIN );
+    CPPUNIT_TEST( Chain_test1 );
+    CPPUNIT_TEST( Chain_Batch_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Chain_test1();
+    void Chain_Batch_test1();
+
+};
+
+#endif
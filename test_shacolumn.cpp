@@ -0,0 +1,134 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shacolumn.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-26
+ *
+ * CONTENT: Defines the tests of the column hashing functions contained in the file shacolumn.cpp. The columns mix empty,
+ *          short and long rows in random order, and the hash of every row is compared with the hash computed by SHA1
+ *          for every kernel and with one and several threads.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shacolumn.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabatch.h"
+#include "shacolumn.h"
+
+#include <vector>
+
+/* The function Make_Column builds a column of nr_of_rows rows whose data starts at offset first. Most rows are short,
+   some are empty and some are longer than the rows sorted within a chunk */
+
+template <class Offset>
+static void Make_Column(uint64_t nr_of_rows, Offset first, std::vector<char> *data, std::vector<Offset> *offsets)
+{
+    uint32_t x = 12345;
+
+    offsets->assign(1, first);
+    data->assign(first, 'x');
+    for (uint64_t i = 0; i < nr_of_rows; i++)
+    {
+        uint32_t size;
+
+        x = x*1103515245 + 12345;
+        if ((x >> 16) % 100 == 0)
+            size = 4000 + (x >> 8) % 5000;
+        else if ((x >> 16) % 10 == 0)
+            size = 0;
+        else
+            size = (x >> 8) % 120;
+
+        for (uint32_t j = 0; j < size; j++)
+            data->push_back((char) (i + j*7));
+        offsets->push_back((Offset) data->size());
+    }
+}
+
+template <class Offset>
+static bool Check_Column(const std::vector<char> &data, const std::vector<Offset> &offsets, const std::vector<uint32_t> &hashes)
+{
+    uint32_t hash[5];
+
+    for (size_t i = 0; i + 1 < offsets.size(); i++)
+    {
+        SHA1((char*) &data[offsets[i]], offsets[i + 1] - offsets[i], hash);
+        if (memcmp(hash, &hashes[5*i], sizeof(hash)) != 0)
+            return false;
+    }
+    return true;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Column32 with every kernel on one thread, and with the default kernel on several threads for a column
+large enough to be split                                                                                        */
+
+void Test_SHACOLUMN::Column32_test1()
+{
+    std::vector<char> data;
+    std::vector<int32_t> offsets;
+    std::vector<uint32_t> hashes;
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels, k;
+
+    Make_Column<int32_t>(10000, 0, &data, &offsets);
+    hashes.assign(5*10000, 0);
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (k = 0; k < nr_of_kernels; k++)
+    {
+        CPPUNIT_ASSERT(SHA1_Column32(data.data(), offsets.data(), 10000, hashes.data(), 1, &kernels[k]) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(Check_Column(data, offsets, hashes));
+    }
+
+    Make_Column<int32_t>(200000, 0, &data, &offsets);
+    hashes.assign(5*200000, 0);
+    CPPUNIT_ASSERT(SHA1_Column32(data.data(), offsets.data(), 200000, hashes.data(), 4, NULL) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Column(data, offsets, hashes));
+
+    /* A column without rows writes nothing */
+
+    CPPUNIT_ASSERT(SHA1_Column32(data.data(), offsets.data(), 0, NULL, 0, NULL) == EXIT_SUCCESS);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Column64 on a column whose first offset is not 0, as for a slice of a larger column                */
+
+void Test_SHACOLUMN::Column64_test1()
+{
+    std::vector<char> data;
+    std::vector<int64_t> offsets;
+    std::vector<uint32_t> hashes(5*100000);
+
+    Make_Column<int64_t>(100000, 1000, &data, &offsets);
+    CPPUNIT_ASSERT(SHA1_Column64(data.data(), offsets.data(), 100000, hashes.data(), 0, NULL) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Column(data, offsets, hashes));
+
+    CPPUNIT_ASSERT(SHA1_Column64(data.data(), &offsets[500], 1000, &hashes[0], 2, NULL) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Column(data, std::vector<int64_t>(&offsets[500], &offsets[1501]), hashes));
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_Column32 and SHA1_Column64 with decreasing and negative offsets, for which no hash is written      */
+
+void Test_SHACOLUMN::Error_test1()
+{
+    const char data[] = "abcdefgh";
+    const int32_t decreasing[] = {0, 4, 2, 8};
+    const int64_t negative[] = {-1, 4, 8};
+    std::vector<uint32_t> hashes(5*3, 0);
+
+    CPPUNIT_ASSERT(SHA1_Column32(data, decreasing, 3, hashes.data(), 1, NULL) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA1_Column64(data, negative, 2, hashes.data(), 1, NULL) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(hashes == std::vector<uint32_t>(5*3, 0));
+
+    CPPUNIT_ASSERT(SHA1_Column32(data, decreasing, 1, hashes.data(), 1, NULL) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(Check_Column(std::vector<char>(data, data + 8), std::vector<int32_t>(decreasing, decreasing + 2), hashes));
+}
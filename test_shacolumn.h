@@ -0,0 +1,50 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shacolumn.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-26
+ *
+ * CONTENT: Declares the tests contained in test_shacolumn.cpp of the column hashing functions contained in shacolumn.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHACOLUMN__
+#define __TEST_SHACOLUMN__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHACOLUMN : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHACOLUMN );
+    CPPUNIT_TEST( Column32_test1 );
+    CPPUNIT_TEST( Column64_test1 );
+    CPPUNIT_TEST( Error_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Column32_test1();
+    void Column64_test1();
+    void Error_test1();
+
+};
+
+#endif
@@ -0,0 +1,144 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaconst.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-18
+ *
+ * CONTENT: Defines the tests of the constexpr hash functions contained in the file shaconst.h. Published test vectors
+ *          (http://www.di-mgt.com.au/sha_testvectors.html, https://tools.ietf.org/html/rfc2202 and
+ *          https://tools.ietf.org/html/rfc4231) are checked at compile time with static_assert, and the remaining
+ *          results are compared at run time with those of the C functions of sha1.c and sha256.c.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaconst.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include <stdio.h>
+#include "shalib.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "shaconst.h"
+#include "shahasher.h"
+
+/* Compile-time checks. A failure here stops the test program from compiling */
+
+static_assert(sha::ct::sha1("abc")[0] == 0xa9993e36 && sha::ct::sha1("abc")[4] == 0x9cd0d89d, "SHA1 of abc");
+static_assert(sha::ct::sha1("")[0] == 0xda39a3ee && sha::ct::sha1("")[4] == 0xafd80709, "SHA1 of the empty string");
+static_assert(sha::ct::sha256("abc")[0] == 0xba7816bf && sha::ct::sha256("abc")[7] == 0xf20015ad, "SHA256 of abc");
+static_assert(sha::ct::sha224("abc")[0] == 0x23097d22 && sha::ct::sha224("abc")[6] == 0xe36c9da7, "SHA224 of abc");
+static_assert(sha::ct::hmac_sha1("Jefe", "what do ya want for nothing?")[0] == 0xeffcdf6a, "RFC 2202, test case 2");
+static_assert(sha::ct::hmac_sha256("Jefe", "what do ya want for nothing?")[7] == 0x64ec3843, "RFC 4231, test case 2");
+
+#if defined(__cpp_consteval)
+static_assert(sha::ce::sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")[0] == 0x84983e44, "SHA1, two blocks");
+#endif
+
+/** --------------------------------------------------------------------------
+
+Test of the constexpr compression functions against SHA1_Compress of shalib.c and, through SHA256 of a single
+block, against the compression function of SHA256, for blocks of pseudo-random data                          */
+
+void Test_SHAConst::Compress_test1()
+{
+    sha::ct::block_type block = {};
+    uint32_t H[5], W[80];
+
+    for (int n = 0; n < 100; n++)
+    {
+        Fill_Data(block.data(), block.size(), n*64);
+
+        std::array<uint32_t, 5> H_ct = sha::ct::Sha1_Compression::init;
+        sha::ct::Sha1_Compression::compress(H_ct, block);
+
+        memcpy(H, sha::ct::Sha1_Compression::init.data(), sizeof(H));
+        for (int i = 0; i < 16; i++)
+            W[i] = Conv_Word_To_32Int(&block[4*i]);
+        SHA1_Compress(H, W);
+
+        for (int i = 0; i < 5; i++)
+            CPPUNIT_ASSERT(H_ct[i] == H[i]);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of sha::ct::sha1 evaluated at run time for texts of length 0 to 200, compared with SHA1                  */
+
+void Test_SHAConst::SHA1_test1()
+{
+    char text[200];
+    uint32_t reference[5];
+
+    Fill_Data(text, sizeof(text));
+
+    for (size_t size = 0; size <= 200; size++)
+    {
+        std::array<uint32_t, 5> digest = sha::ct::sha1(std::string_view(text, size));
+        SHA1(text, size, reference);
+
+        for (int i = 0; i < 5; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of sha::ct::sha256 and sha::ct::sha224 evaluated at run time for texts of length 0 to 200, compared with
+SHA256 and SHA224                                                                                             */
+
+void Test_SHAConst::SHA256_test1()
+{
+    char text[200];
+    uint32_t reference[8];
+
+    Fill_Data(text, sizeof(text));
+
+    for (size_t size = 0; size <= 200; size++)
+    {
+        std::array<uint32_t, 8> digest = sha::ct::sha256(std::string_view(text, size));
+        SHA256(text, size, reference);
+        for (int i = 0; i < 8; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+
+        std::array<uint32_t, 7> digest224 = sha::ct::sha224(std::string_view(text, size));
+        SHA224(text, size, reference);
+        for (int i = 0; i < 7; i++)
+            CPPUNIT_ASSERT(digest224[i] == reference[i]);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC midstates computed at compile time and used by sha::HMAC, with a key shorter and a key longer
+than the block size, compared with HMAC_SHA1 and HMAC_SHA256                                                  */
+
+void Test_SHAConst::HMAC_Midstate_test1()
+{
+    static constexpr char short_key[] = "constant key";
+    static constexpr char long_key[] = "a constant key that is longer than the 64 bytes of a block and is therefore hashed first";
+    static constexpr sha::ct::hmac_midstate<5> short_midstate = sha::ct::hmac_sha1_midstate(short_key);
+    static constexpr sha::ct::hmac_midstate<5> long_midstate = sha::ct::hmac_sha1_midstate(long_key);
+    static constexpr sha::ct::hmac_midstate<8> midstate256 = sha::ct::hmac_sha256_midstate(long_key);
+    char msg[] = {"what do ya want for nothing?"};
+    uint32_t reference[8];
+
+    sha::HMAC<sha::Hasher<sha::Sha1> > short_hmac(short_midstate.inner.data(), short_midstate.outer.data());
+    HMAC_SHA1((char*) short_key, strlen(short_key), msg, strlen(msg), reference);
+    CPPUNIT_ASSERT(short_hmac.update(msg).final() == sha::ct::to_bytes(std::array<uint32_t, 5>{reference[0], reference[1],
+                                                                        reference[2], reference[3], reference[4]}));
+
+    sha::HMAC<sha::Hasher<sha::Sha1> > long_hmac(long_midstate.inner.data(), long_midstate.outer.data());
+    HMAC_SHA1((char*) long_key, strlen(long_key), msg, strlen(msg), reference);
+    CPPUNIT_ASSERT(long_hmac.update(msg).final() == sha::ct::to_bytes(std::array<uint32_t, 5>{reference[0], reference[1],
+                                                                       reference[2], reference[3], reference[4]}));
+
+    sha::HMAC<sha::Hasher<sha::Sha256> > hmac256(midstate256.inner.data(), midstate256.outer.data());
+    HMAC_SHA256((char*) long_key, strlen(long_key), msg, strlen(msg), reference);
+    std::array<uint8_t, 32> digest = hmac256.update(msg).final();
+    for (int i = 0; i < 32; i++)
+        CPPUNIT_ASSERT(digest[i] == (uint8_t) (reference[i/4] >> 8*(3 - i % 4)));
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaconst.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-18
+ *
+ * CONTENT: Declares the tests contained in test_shaconst.cpp of the constexpr hash functions contained in shaconst.h
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHACONST__
+#define __TEST_SHACONST__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAConst : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAConst );
+    CPPUNIT_TEST( Compress_test1 );
+    CPPUNIT_TEST( SHA1_test1 );
+    CPPUNIT_TEST( SHA256_test1 );
+    CPPUNIT_TEST( HMAC_Midstate_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Compress_test1();
+    void SHA1_test1();
+    void SHA256_test1();
+    void HMAC_Midstate_test1();
+
+};
+
+#endif
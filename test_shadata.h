@@ -0,0 +1,51 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shadata.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-02
+ *
+ * CONTENT: Defines the functions shared by the tests, which fill texts with a reproducible byte pattern and write data
+ *          to files. The pattern is the multiplicative hash of the position, so that texts differ from their shifts
+ *          and no block of the input repeats.
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHADATA__
+#define __TEST_SHADATA__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+/* The function Fill_Data writes the byte of position seed + i to byte i of a text */
+
+static inline void Fill_Data(void *text, size_t byte_size, size_t seed = 0)
+{
+    for (size_t i = 0; i < byte_size; i++)
+        ((char*) text)[i] = (char) ((i + seed)*2654435761u >> 24);
+}
+
+static inline std::string Make_Data(size_t size, unsigned int seed = 0)
+{
+    std::string data(size, '\0');
+    Fill_Data(&data[0], size, seed);
+    return data;
+}
+
+/* The function Write_File creates or truncates a file and writes the data to it */
+
+static inline void Write_File(const char *filename, const void *data, size_t byte_size)
+{
+    FILE *fp = fopen(filename, "wb");
+    fwrite(data, 1, byte_size, fp);
+    fclose(fp);
+}
+
+static inline void Write_File(const char *filename, const std::string &data)
+{
+    Write_File(filename, data.data(), data.size());
+}
+
+#endif
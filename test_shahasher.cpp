@@ -0,0 +1,249 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahasher.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-17
+ *
+ * CONTENT: Defines the tests of the C++ front end contained in the file shahasher.h. Test vectors are taken from
+ *          http://www.di-mgt.com.au/sha_testvectors.html and https://tools.ietf.org/html/rfc2202, and the remaining
+ *          results are compared with those of the C functions of sha1.c, sha256.c and sha512.c.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shahasher.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "shahasher.h"
+
+#include <vector>
+
+/* Converts the hash words of the C functions to the bytes of a digest */
+
+template <class Word>
+static std::vector<uint8_t> To_Bytes(const Word *hash, size_t digest_size)
+{
+    std::vector<uint8_t> bytes(digest_size);
+
+    for (size_t i = 0; i < digest_size; i++)
+        bytes[i] = (uint8_t) (hash[i/sizeof(Word)] >> 8*(sizeof(Word) - 1 - i % sizeof(Word)));
+
+    return bytes;
+}
+
+template <class Digest>
+static bool Equal(const Digest &digest, const std::vector<uint8_t> &reference)
+{
+    return digest.size() == reference.size() && memcmp(digest.data(), reference.data(), digest.size()) == 0;
+}
+
+/* Hashes text with the hasher H, feeding it in pieces of growing length 1, 2, 3, ... */
+
+template <class H>
+static typename H::digest_type Hash_In_Pieces(const char *text, size_t size)
+{
+    H hasher;
+    size_t position = 0, piece = 1;
+
+    while (position < size)
+    {
+        size_t n = piece < size - position ? piece : size - position;
+        hasher.update(text + position, n);
+        position += n;
+        piece++;
+    }
+
+    return hasher.final();
+}
+
+/** --------------------------------------------------------------------------
+
+Test of Hasher<Sha1> with short text, given as a std::span of bytes
+
+text:   "abc"
+
+digest: 0xa9993e36, 0x4706816a, 0xba3e2571, 0x7850c26c, 0x9cd0d89d                 */
+
+void Test_SHAHasher::Hasher_Sha1_test1()
+{
+    char msg[] = {"abc"};
+    uint32_t reference[] = {0xa9993e36, 0x4706816a, 0xba3e2571, 0x7850c26c, 0x9cd0d89d};
+
+    sha::Hasher<sha::Sha1> hasher;
+#if __cplusplus >= 202002L
+    hasher.update(std::as_bytes(std::span<const char>(msg, 3)));
+#else
+    hasher.update(msg, 3);
+#endif
+    std::array<uint8_t, 20> digest = hasher.final();
+
+    CPPUNIT_ASSERT(Equal(digest, To_Bytes(reference, 20)));
+
+    /* The hasher is reset by final */
+
+    CPPUNIT_ASSERT(Equal(hasher.update(msg, 3).final(), To_Bytes(reference, 20)));
+}
+
+/** --------------------------------------------------------------------------
+
+Test of Hasher<Sha1> with long text fed in pieces of varying length
+
+text:   The letter 'a' repeated 1'000'000 times
+
+digest: 0x34aa973c, 0xd4c4daa4, 0xf61eeb2b, 0xdbad2731, 0x6534016f                 */
+
+void Test_SHAHasher::Hasher_Sha1_test2()
+{
+    const unsigned int STRING_SIZE = 1000000;
+    std::vector<char> msg(STRING_SIZE, 'a');
+    uint32_t reference[] = {0x34aa973c, 0xd4c4daa4, 0xf61eeb2b, 0xdbad2731, 0x6534016f};
+
+    CPPUNIT_ASSERT(Equal(Hash_In_Pieces<sha::Hasher<sha::Sha1> >(&msg[0], STRING_SIZE), To_Bytes(reference, 20)));
+}
+
+/** --------------------------------------------------------------------------
+
+Test of Hasher with every algorithm for texts of length 0 to 300 compared with the C functions              */
+
+void Test_SHAHasher::Hasher_test1()
+{
+    char text[300];
+    uint32_t hash32[8];
+    uint64_t hash64[8];
+
+    Fill_Data(text, sizeof(text));
+
+    for (size_t size = 0; size <= 300; size++)
+    {
+        SHA1(text, size, hash32);
+        CPPUNIT_ASSERT(Equal(Hash_In_Pieces<sha::Hasher<sha::Sha1> >(text, size), To_Bytes(hash32, 20)));
+        CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha1>::hash(text, size), To_Bytes(hash32, 20)));
+
+        SHA256(text, size, hash32);
+        CPPUNIT_ASSERT(Equal(Hash_In_Pieces<sha::Hasher<sha::Sha256> >(text, size), To_Bytes(hash32, 32)));
+
+        SHA224(text, size, hash32);
+        CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha224>::hash(text, size), To_Bytes(hash32, 28)));
+
+        SHA512(text, size, hash64);
+        CPPUNIT_ASSERT(Equal(Hash_In_Pieces<sha::Hasher<sha::Sha512> >(text, size), To_Bytes(hash64, 64)));
+
+        SHA384(text, size, hash64);
+        CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha384>::hash(text, size), To_Bytes(hash64, 48)));
+
+        SHA512_256(text, size, hash64);
+        CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha512_256>::hash(text, size), To_Bytes(hash64, 32)));
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of Hasher<Sha256> with the portable and, when available, the SHA-NI kernel
+
+text:   "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+
+digest: 0x248d6a61, 0xd20638b8, 0xe5c02693, 0x0c3e6039, 0xa33ce459, 0x64ff2167, 0xf6ecedd4, 0x19db06c1     */
+
+void Test_SHAHasher::Hasher_Kernel_test1()
+{
+    std::string_view msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    uint32_t reference[] = {0x248d6a61, 0xd20638b8, 0xe5c02693, 0x0c3e6039, 0xa33ce459, 0x64ff2167, 0xf6ecedd4, 0x19db06c1};
+
+    CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha256, sha::Portable>::hash(msg), To_Bytes(reference, 32)));
+
+    if (SHA256_Get_Kernel() == SHA_KERNEL_SHANI)
+        CPPUNIT_ASSERT(Equal(sha::Hasher<sha::Sha256, sha::ShaNi>::hash(msg), To_Bytes(reference, 32)));
+}
+
+/* Compares sha1_fixed<N> with SHA1 for every length N of the index sequence */
+
+template <size_t... N>
+static bool Fixed_Equals_SHA1(const char *text, std::index_sequence<N...>)
+{
+    uint32_t reference[5];
+
+    auto Equal_At = [&](size_t size, const std::array<uint32_t, 5> &digest)
+    {
+        SHA1((char*) text, size, reference);
+        return memcmp(digest.data(), reference, sizeof(reference)) == 0;
+    };
+
+    return (Equal_At(N, sha::sha1_fixed<N>(text)) && ...);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of sha::sha1_fixed with the WebSocket handshake of RFC 6455, Section 1.3, and for every length from 0 to
+119 bytes compared with SHA1
+
+text:   "dGhlIHNhbXBsZSBub25jZQ==258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+digest: 0xb37a4f2c, 0xc0624f16, 0x90f64606, 0xcf385945, 0xb2bec4ea                 */
+
+void Test_SHAHasher::Fixed_test1()
+{
+    const char handshake[] = {"dGhlIHNhbXBsZSBub25jZQ==258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+    std::array<uint32_t, 5> reference = {0xb37a4f2c, 0xc0624f16, 0x90f64606, 0xcf385945, 0xb2bec4ea};
+    char text[SHA1_SHORT_MAX_SIZE];
+
+    CPPUNIT_ASSERT(sha::sha1_fixed<60>(handshake) == reference);
+
+    Fill_Data(text, sizeof(text));
+
+    CPPUNIT_ASSERT(Fixed_Equals_SHA1(text, std::make_index_sequence<SHA1_SHORT_MAX_SIZE + 1>()));
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC<Hasher<Sha1>> with both text and key shorter than the block-size of 64 bytes (RFC 2202, test case 2).
+The same HMAC object is used for two messages
+
+text:   "what do ya want for nothing?"
+
+key:    "Jefe"
+
+digest: 0xeffcdf6a, 0xe5eb2fa2, 0xd27416d5, 0xf184df9c, 0x259a7c79                 */
+
+void Test_SHAHasher::HMAC_test1()
+{
+    uint32_t reference[] = {0xeffcdf6a, 0xe5eb2fa2, 0xd27416d5, 0xf184df9c, 0x259a7c79};
+    sha::HMAC<sha::Hasher<sha::Sha1> > hmac(std::string_view("Jefe"));
+
+    CPPUNIT_ASSERT(Equal(hmac.update("what do ya want ").update("for nothing?").final(), To_Bytes(reference, 20)));
+    CPPUNIT_ASSERT(Equal(hmac.update("what do ya want for nothing?").final(), To_Bytes(reference, 20)));
+}
+
+/** --------------------------------------------------------------------------
+
+Test of HMAC with every algorithm and keys of length 0 to 200, covering keys longer than the block, compared
+with the C functions                                                                                          */
+
+void Test_SHAHasher::HMAC_test2()
+{
+    char key[200];
+    char msg[] = {"Test Using Larger Than Block-Size Key - Hash Key First"};
+    uint32_t hash32[8];
+    uint64_t hash64[8];
+
+    Fill_Data(key, sizeof(key));
+
+    for (size_t key_size = 0; key_size <= 200; key_size++)
+    {
+        HMAC_SHA1(key, key_size, msg, strlen(msg), hash32);
+        CPPUNIT_ASSERT(Equal(sha::HMAC<sha::Hasher<sha::Sha1> >::mac(key, key_size, msg, strlen(msg)), To_Bytes(hash32, 20)));
+
+        HMAC_SHA256(key, key_size, msg, strlen(msg), hash32);
+        CPPUNIT_ASSERT(Equal(sha::HMAC<sha::Hasher<sha::Sha256> >::mac(key, key_size, msg, strlen(msg)), To_Bytes(hash32, 32)));
+
+        HMAC_SHA512(key, key_size, msg, strlen(msg), hash64);
+        CPPUNIT_ASSERT(Equal(sha::HMAC<sha::Hasher<sha::Sha512> >::mac(key, key_size, msg, strlen(msg)), To_Bytes(hash64, 64)));
+
+        HMAC_SHA384(key, key_size, msg, strlen(msg), hash64);
+        CPPUNIT_ASSERT(Equal(sha::HMAC<sha::Hasher<sha::Sha384> >::mac(key, key_size, msg, strlen(msg)), To_Bytes(hash64, 48)));
+    }
+}
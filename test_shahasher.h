@@ -0,0 +1,58 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahasher.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-17
+ *
+ * CONTENT: Declares the tests contained in test_shahasher.cpp of the C++ front end contained in shahasher.h
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAHASHER__
+#define __TEST_SHAHASHER__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAHasher : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAHasher );
+    CPPUNIT_TEST( Hasher_Sha1_test1 );
+    CPPUNIT_TEST( Hasher_Sha1_test2 );
+    CPPUNIT_TEST( Hasher_test1 );
+    CPPUNIT_TEST( Hasher_Kernel_test1 );
+    CPPUNIT_TEST( Fixed_test1 );
+    CPPUNIT_TEST( HMAC_test1 );
+    CPPUNIT_TEST( HMAC_test2 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Hasher_Sha1_test1();
+    void Hasher_Sha1_test2();
+    void Hasher_test1();
+    void Hasher_Kernel_test1();
+    void Fixed_test1();
+    void HMAC_test1();
+    void HMAC_test2();
+
+};
+
+#endif
@@ -0,0 +1,180 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahex.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-19
+ *
+ * CONTENT: Defines the tests of the hexadecimal conversions contained in the file shahex.c. Every test is run with each
+ *          kernel available on the processor, and the results are compared with those of sprintf.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shahex.h"
+
+/* Files containing the functions to be tested. */
+#include <stdio.h>
+#include <ctype.h>
+#include "sha1.h"
+#include "shahex.h"
+
+static const char *kernel_names[] = {"scalar", "ssse3", "avx2"};
+
+#define NR_OF_KERNEL_NAMES (sizeof(kernel_names)/sizeof(kernel_names[0]))
+
+/* Writes the words with sprintf, as the reference for the conversions */
+
+static void Reference_Hex(const uint32_t *words, unsigned int nr_of_words, char *hex, int letter_case)
+{
+    for (unsigned int i = 0; i < nr_of_words; i++)
+        sprintf(&hex[8*i], letter_case == SHA_HEX_UPPERCASE ? "%08X" : "%08x", words[i]);
+    hex[8*nr_of_words] = '\0';
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Hex_Encode with the SHA1 hash of short text, in both cases
+
+text:   "abc"
+
+hex:    "a9993e364706816aba3e25717850c26c9cd0d89d"                                  */
+
+void Test_SHAHex::Encode_test1()
+{
+    char msg[] = {"abc"};
+    uint32_t hash[5];
+    char hex[41];
+
+    SHA1(msg, strlen(msg), hash);
+
+    for (unsigned int k = 0; k < NR_OF_KERNEL_NAMES; k++)
+    {
+        if (SHA_Hex_Set_Kernel(kernel_names[k]) == EXIT_FAILURE)
+            continue;
+
+        SHA_Hex_Encode(hash, 5, hex, SHA_HEX_LOWERCASE);
+        CPPUNIT_ASSERT(strcmp(hex, "a9993e364706816aba3e25717850c26c9cd0d89d") == 0);
+
+        SHA_Hex_Encode(hash, 5, hex, SHA_HEX_UPPERCASE);
+        CPPUNIT_ASSERT(strcmp(hex, "A9993E364706816ABA3E25717850C26C9CD0D89D") == 0);
+    }
+
+    SHA_Hex_Set_Kernel(NULL);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Hex_Encode with pseudo-random words, for 0 to 40 words, compared with sprintf                     */
+
+void Test_SHAHex::Encode_test2()
+{
+    uint32_t words[40];
+    char hex[8*40 + 1], reference[8*40 + 1];
+
+    for (int i = 0; i < 40; i++)
+        words[i] = i*2654435761u ^ 0x9e3779b9;
+
+    for (unsigned int k = 0; k < NR_OF_KERNEL_NAMES; k++)
+    {
+        if (SHA_Hex_Set_Kernel(kernel_names[k]) == EXIT_FAILURE)
+            continue;
+
+        for (unsigned int n = 0; n <= 40; n++)
+            for (int letter_case = SHA_HEX_LOWERCASE; letter_case <= SHA_HEX_UPPERCASE; letter_case++)
+            {
+                memset(hex, '#', sizeof(hex));
+                SHA_Hex_Encode(words, n, hex, letter_case);
+                Reference_Hex(words, n, reference, letter_case);
+                CPPUNIT_ASSERT(strcmp(hex, reference) == 0);
+            }
+    }
+
+    SHA_Hex_Set_Kernel(NULL);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Hex_Decode with text of mixed case for 1 to 20 words, and with an invalid character placed at each
+position in turn                                                                                             */
+
+void Test_SHAHex::Decode_test1()
+{
+    const char invalid[] = {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\x80', '\xb0'};
+    uint32_t words[20], decoded[20];
+    char hex[8*20 + 1];
+
+    for (int i = 0; i < 20; i++)
+        words[i] = i*2654435761u ^ 0x9e3779b9;
+
+    for (unsigned int k = 0; k < NR_OF_KERNEL_NAMES; k++)
+    {
+        if (SHA_Hex_Set_Kernel(kernel_names[k]) == EXIT_FAILURE)
+            continue;
+
+        for (unsigned int n = 1; n <= 20; n++)
+        {
+            Reference_Hex(words, n, hex, SHA_HEX_LOWERCASE);
+            for (unsigned int i = 0; i < 8*n; i += 3)
+                hex[i] = (char) toupper(hex[i]);
+
+            CPPUNIT_ASSERT(SHA_Hex_Decode(hex, n, decoded) == EXIT_SUCCESS);
+            CPPUNIT_ASSERT(memcmp(decoded, words, 4*n) == 0);
+
+            for (unsigned int i = 0; i < 8*n; i++)
+            {
+                char saved = hex[i];
+                hex[i] = invalid[i % sizeof(invalid)];
+                CPPUNIT_ASSERT(SHA_Hex_Decode(hex, n, decoded) == EXIT_FAILURE);
+                hex[i] = saved;
+            }
+        }
+    }
+
+    SHA_Hex_Set_Kernel(NULL);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Hex_Encode_Batch with 100 SHA1 and SHA256 sized hashes, with and without separator                */
+
+void Test_SHAHex::Batch_test1()
+{
+    const unsigned int NR_OF_HASHES = 100;
+    uint32_t hashes[8*NR_OF_HASHES];
+    char hex[NR_OF_HASHES*(8*8 + 1) + 1], reference[8*8 + 1];
+    unsigned int sizes[] = {5, 8};
+
+    for (unsigned int i = 0; i < 8*NR_OF_HASHES; i++)
+        hashes[i] = i*2654435761u ^ 0x9e3779b9;
+
+    for (unsigned int k = 0; k < NR_OF_KERNEL_NAMES; k++)
+    {
+        if (SHA_Hex_Set_Kernel(kernel_names[k]) == EXIT_FAILURE)
+            continue;
+
+        for (unsigned int s = 0; s < 2; s++)
+        {
+            unsigned int n = sizes[s];
+
+            CPPUNIT_ASSERT(SHA_Hex_Encode_Batch(hashes, NR_OF_HASHES, n, hex, '\n', SHA_HEX_LOWERCASE) == NR_OF_HASHES*(8*n + 1));
+            for (unsigned int i = 0; i < NR_OF_HASHES; i++)
+            {
+                Reference_Hex(&hashes[n*i], n, reference, SHA_HEX_LOWERCASE);
+                CPPUNIT_ASSERT(memcmp(&hex[(8*n + 1)*i], reference, 8*n) == 0);
+                CPPUNIT_ASSERT(hex[(8*n + 1)*i + 8*n] == '\n');
+            }
+            CPPUNIT_ASSERT(hex[NR_OF_HASHES*(8*n + 1)] == '\0');
+
+            CPPUNIT_ASSERT(SHA_Hex_Encode_Batch(hashes, NR_OF_HASHES, n, hex, '\0', SHA_HEX_UPPERCASE) == NR_OF_HASHES*8*n);
+            for (unsigned int i = 0; i < NR_OF_HASHES; i++)
+            {
+                Reference_Hex(&hashes[n*i], n, reference, SHA_HEX_UPPERCASE);
+                CPPUNIT_ASSERT(memcmp(&hex[8*n*i], reference, 8*n) == 0);
+            }
+            CPPUNIT_ASSERT(hex[NR_OF_HASHES*8*n] == '\0');
+        }
+    }
+
+    SHA_Hex_Set_Kernel(NULL);
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahex.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-19
+ *
+ * CONTENT: Declares the tests contained in test_shahex.cpp of the hexadecimal conversions contained in shahex.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAHEX__
+#define __TEST_SHAHEX__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAHex : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAHex );
+    CPPUNIT_TEST( Encode_test1 );
+    CPPUNIT_TEST( Encode_test2 );
+    CPPUNIT_TEST( Decode_test1 );
+    CPPUNIT_TEST( Batch_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Encode_test1();
+    void Encode_test2();
+    void Decode_test1();
+    void Batch_test1();
+
+};
+
+#endif
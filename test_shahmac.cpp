@@ -0,0 +1,165 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahmac.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-29
+ *
+ * CONTENT: Defines the tests of the batch HMAC-SHA1 verification contained in the file shahmac.c. Test vectors are taken
+ *          from https://tools.ietf.org/html/rfc2202 (Section 3), and the remaining tags are computed by HMAC_SHA1.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shahmac.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabatch.h"
+#include "shahmac.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+/* Converts a digest computed by HMAC_SHA1 into the bytes of a tag */
+
+static void Digest_To_Tag(const uint32_t *digest, unsigned char *tag)
+{
+    for (int i = 0; i < SHA_HMAC_TAG_SIZE; i++)
+        tag[i] = (unsigned char) (digest[i/4] >> 8*(3 - i % 4));
+}
+
+static void Hex_To_Tag(const char *hex, unsigned char *tag)
+{
+    for (int i = 0; i < SHA_HMAC_TAG_SIZE; i++)
+    {
+        unsigned int byte;
+        sscanf(&hex[2*i], "%2x", &byte);
+        tag[i] = (unsigned char) byte;
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_HMAC_Verify_Batch_Kernel with the seven test cases of RFC 2202, two of which have keys of 80 bytes, on
+every kernel, with the correct tags and with one byte of every tag changed
+
+tags:   b617318655057264e28bc0b6fb378c8ef146be00, effcdf6ae5eb2fa2d27416d5f184df9c259a7c79,
+        125d7342b9ac11cd91a39af48aa17b4f63f175d3, 4c9007f4026250c6bc8414f9bf50c86c2d7235da,
+        4c1a03424b55e07fe7f27be1d58bb9324a9a5a04, aa4ae5e15272d00e95705637ce8a3b55ed402112,
+        e8e99d0f45237d786d6bbaa7965c7808bbff1a91                                                                */
+
+void Test_SHAHMAC::Verify_Batch_test1()
+{
+    const char *hex_tags[] = {"b617318655057264e28bc0b6fb378c8ef146be00", "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+                              "125d7342b9ac11cd91a39af48aa17b4f63f175d3", "4c9007f4026250c6bc8414f9bf50c86c2d7235da",
+                              "4c1a03424b55e07fe7f27be1d58bb9324a9a5a04", "aa4ae5e15272d00e95705637ce8a3b55ed402112",
+                              "e8e99d0f45237d786d6bbaa7965c7808bbff1a91"};
+    std::string keys[7], texts[7];
+    unsigned char tags[7][SHA_HMAC_TAG_SIZE];
+    struct sha_hmac_check checks[7];
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels;
+    uint64_t matches;
+
+    keys[0] = std::string(20, '\x0b');
+    texts[0] = "Hi There";
+    keys[1] = "Jefe";
+    texts[1] = "what do ya want for nothing?";
+    keys[2] = std::string(20, '\xaa');
+    texts[2] = std::string(50, '\xdd');
+    for (char c = 1; c <= 25; c++)
+        keys[3] += c;
+    texts[3] = std::string(50, '\xcd');
+    keys[4] = std::string(20, '\x0c');
+    texts[4] = "Test With Truncation";
+    keys[5] = std::string(80, '\xaa');
+    texts[5] = "Test Using Larger Than Block-Size Key - Hash Key First";
+    keys[6] = std::string(80, '\xaa');
+    texts[6] = "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data";
+
+    for (int i = 0; i < 7; i++)
+    {
+        Hex_To_Tag(hex_tags[i], tags[i]);
+        checks[i].key = keys[i].data();
+        checks[i].key_byte_size = keys[i].size();
+        checks[i].text = texts[i].data();
+        checks[i].text_byte_size = texts[i].size();
+        checks[i].tag = tags[i];
+    }
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        matches = 0;
+        CPPUNIT_ASSERT(SHA_HMAC_Verify_Batch_Kernel(&kernels[k], checks, 7, &matches) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(matches == 0x7f);
+    }
+
+    for (int i = 0; i < 7; i++)
+        tags[i][(7*i) % SHA_HMAC_TAG_SIZE] ^= 0x01;
+
+    matches = ~(uint64_t) 0;
+    CPPUNIT_ASSERT(SHA_HMAC_Verify_Batch(checks, 7, &matches) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(matches == 0);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_HMAC_Verify_Batch_Kernel on 300 messages of keys from 0 to 150 bytes and messages from 0 to 300 bytes,
+every third of them with a wrong tag, on every kernel                                                          */
+
+void Test_SHAHMAC::Verify_Batch_test2()
+{
+    const int nr_of_checks = 300;
+    std::vector<std::string> keys, texts;
+    std::vector<struct sha_hmac_check> checks(nr_of_checks);
+    unsigned char tags[nr_of_checks][SHA_HMAC_TAG_SIZE];
+    uint64_t matches[(nr_of_checks + 63)/64];
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels;
+    uint32_t digest[5];
+
+    for (int i = 0; i < nr_of_checks; i++)
+    {
+        std::string key, text;
+
+        for (int j = 0; j < (i*37) % 151; j++)
+            key += (char) (i*j + 3);
+        for (int j = 0; j < (i*53) % 301; j++)
+            text += (char) (i + 7*j);
+        keys.push_back(key);
+        texts.push_back(text);
+    }
+
+    for (int i = 0; i < nr_of_checks; i++)
+    {
+        HMAC_SHA1((char*) keys[i].data(), (unsigned int) keys[i].size(), (char*) texts[i].data(), texts[i].size(), digest);
+        Digest_To_Tag(digest, tags[i]);
+        if (i % 3 == 0)
+            tags[i][i % SHA_HMAC_TAG_SIZE] ^= 0x80;
+
+        checks[i].key = keys[i].data();
+        checks[i].key_byte_size = keys[i].size();
+        checks[i].text = texts[i].data();
+        checks[i].text_byte_size = texts[i].size();
+        checks[i].tag = tags[i];
+    }
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        memset(matches, 0xff, sizeof(matches));
+        CPPUNIT_ASSERT(SHA_HMAC_Verify_Batch_Kernel(&kernels[k], checks.data(), nr_of_checks, matches) == EXIT_SUCCESS);
+
+        for (int i = 0; i < nr_of_checks; i++)
+            CPPUNIT_ASSERT(((matches[i/64] >> (i % 64)) & 1) == (i % 3 == 0 ? 0u : 1u));
+
+        /* The bits past the last message are cleared */
+
+        CPPUNIT_ASSERT(matches[nr_of_checks/64] >> (nr_of_checks % 64) == 0);
+    }
+
+    CPPUNIT_ASSERT(SHA_HMAC_Verify_Batch(checks.data(), 0, matches) == EXIT_SUCCESS);
+}
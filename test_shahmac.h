@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shahmac.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-29
+ *
+ * CONTENT: Declares the tests contained in test_shahmac.cpp of the batch HMAC-SHA1 verification contained in shahmac.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAHMAC__
+#define __TEST_SHAHMAC__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAHMAC : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAHMAC );
+    CPPUNIT_TEST( Verify_Batch_test1 );
+    CPPUNIT_TEST( Verify_Batch_test2 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Verify_Batch_test1();
+    void Verify_Batch_test2();
+
+};
+
+#endif
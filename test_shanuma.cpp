@@ -0,0 +1,199 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shanuma.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-02
+ *
+ * CONTENT: Defines the tests of the NUMA-aware worker pool contained in the file shanuma.cpp. The pools are built on
+ *          simulated topologies, so that several nodes are exercised on any machine, and the hashes are compared with
+ *          those of SHA1, SHA1_File and SHA256_File.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shanuma.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shanuma.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vector>
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_NUMA_Topology::Detect and SHA_NUMA_Topology::Simulate with more and fewer nodes than processors      */
+
+void Test_SHANUMA::Topology_test1()
+{
+    SHA_NUMA_Topology topology = SHA_NUMA_Topology::Detect();
+    size_t nr_of_cpus = 0;
+
+    CPPUNIT_ASSERT(!topology.nodes.empty());
+    for (const SHA_NUMA_Node &node : topology.nodes)
+    {
+        CPPUNIT_ASSERT(!node.cpus.empty());
+        nr_of_cpus += node.cpus.size();
+    }
+
+    for (unsigned int nr_of_nodes = 1; nr_of_nodes <= 2*nr_of_cpus + 1; nr_of_nodes += nr_of_cpus + 1)
+    {
+        SHA_NUMA_Topology simulated = SHA_NUMA_Topology::Simulate(nr_of_nodes);
+        size_t nr_of_simulated_cpus = 0;
+
+        CPPUNIT_ASSERT(simulated.simulated);
+        CPPUNIT_ASSERT(simulated.nodes.size() == nr_of_nodes);
+        for (const SHA_NUMA_Node &node : simulated.nodes)
+        {
+            CPPUNIT_ASSERT(node.id == -1);
+            CPPUNIT_ASSERT(!node.cpus.empty());
+            nr_of_simulated_cpus += node.cpus.size();
+        }
+        CPPUNIT_ASSERT(nr_of_simulated_cpus == std::max<size_t>(nr_of_cpus, nr_of_nodes));
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_NUMA_Pool::Hash_Batch on 3 simulated nodes with texts in buffers of the arena of every node and texts on
+the heap, compared with SHA1. The bytes of the texts in the arenas are hashed by the nodes owning them.          */
+
+void Test_SHANUMA::Batch_test1()
+{
+    const uint64_t nr_of_texts = 600, buffer_size = 1 << 16;
+    SHA_NUMA_Pool pool(SHA_NUMA_Topology::Simulate(3), 2, buffer_size, 2);
+    std::vector<char> heap(nr_of_texts*200);
+    std::vector<char*> texts;
+    std::vector<uint64_t> texts_byte_size, node_bytes(3, 0);
+    std::vector<uint32_t> hashes(5*2*nr_of_texts);
+    char *buffers[3];
+    uint32_t reference[5];
+
+    CPPUNIT_ASSERT(pool.Nr_Of_Nodes() == 3);
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        buffers[k] = (char*) pool.Allocate(k);
+        CPPUNIT_ASSERT(buffers[k] != NULL);
+        CPPUNIT_ASSERT(pool.Node_Of(buffers[k]) == (int) k);
+        CPPUNIT_ASSERT(pool.Node_Of(buffers[k] + buffer_size - 1) == (int) k);
+    }
+    CPPUNIT_ASSERT(pool.Node_Of(heap.data()) == -1);
+
+    /* Every arena holds two buffers beyond those of the workers */
+
+    char *spare = (char*) pool.Allocate(0);
+    CPPUNIT_ASSERT(spare != NULL && pool.Allocate(0) == NULL);
+    pool.Release(spare);
+
+    Fill_Data(heap.data(), heap.size());
+    for (unsigned int k = 0; k < 3; k++)
+        memcpy(buffers[k], heap.data(), buffer_size);
+
+    for (uint64_t i = 0; i < nr_of_texts; i++)
+    {
+        uint64_t size = (i*37) % 200, k = i % 3;
+
+        texts.push_back(&buffers[k][(i*97) % (buffer_size - 200)]);
+        texts_byte_size.push_back(size);
+        node_bytes[k] += size;
+
+        texts.push_back(&heap[i*200]);
+        texts_byte_size.push_back(size);
+    }
+
+    pool.Reset_Stats();
+    pool.Hash_Batch(texts.data(), texts_byte_size.data(), texts.size(), hashes.data());
+    for (uint64_t i = 0; i < texts.size(); i++)
+    {
+        SHA1(texts[i], texts_byte_size[i], reference);
+        CPPUNIT_ASSERT(memcmp(&hashes[5*i], reference, sizeof(reference)) == 0);
+    }
+
+    uint64_t total = 0;
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        SHA_NUMA_Pool::Node_Stats stats = pool.Stats(k);
+
+        CPPUNIT_ASSERT(stats.id == -1 && stats.nr_of_workers == 2 && !stats.bound);
+        CPPUNIT_ASSERT(stats.bytes >= node_bytes[k]);
+        CPPUNIT_ASSERT(stats.jobs >= 1);
+        total += stats.bytes;
+    }
+    for (uint64_t i = 0; i < texts.size(); i++)
+        total -= texts_byte_size[i];
+    CPPUNIT_ASSERT(total == 0);
+
+    /* Jobs submitted to a node */
+
+    std::vector<int> ran(8, 0);
+    for (unsigned int j = 0; j < ran.size(); j++)
+        pool.Submit(j, [&ran, j] { ran[j] = 1; });
+    pool.Wait();
+    for (unsigned int j = 0; j < ran.size(); j++)
+        CPPUNIT_ASSERT(ran[j] == 1);
+
+    for (unsigned int k = 0; k < 3; k++)
+        pool.Release(buffers[k]);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_NUMA_Pool::Hash_Files with SHA1 and SHA256 on 2 simulated nodes for 25 files of 0 to 300000 bytes, read
+in buffers smaller than most files, and a missing file                                                          */
+
+void Test_SHANUMA::Files_test1()
+{
+    const unsigned int NR_OF_FILES = 25;
+    char directory[] = "/tmp/test_shanuma_XXXXXX";
+    std::vector<std::string> filenames;
+    std::vector<char> data(300000);
+    SHA_NUMA_Pool pool(SHA_NUMA_Topology::Simulate(2), 2, 4096);
+    std::vector<SHA_NUMA_Pool::File_Digest> digests;
+    uint32_t reference[8];
+    uint64_t bytes = 0;
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    Fill_Data(data.data(), data.size());
+
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+    {
+        char name[32];
+
+        snprintf(name, sizeof(name), "/file%02u", i);
+        filenames.push_back(std::string(directory) + name);
+
+        Write_File(filenames[i].c_str(), &data[0], (i*i*487) % data.size());
+        bytes += (i*i*487) % data.size();
+    }
+    filenames.push_back(std::string(directory) + "/missing");
+
+    for (int sha256 = 0; sha256 <= 1; sha256++)
+    {
+        pool.Reset_Stats();
+        pool.Hash_Files(filenames, sha256, &digests);
+
+        CPPUNIT_ASSERT(digests.size() == NR_OF_FILES + 1);
+        for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        {
+            if (sha256)
+                SHA256_File((char*) filenames[i].c_str(), reference);
+            else
+                SHA1_File((char*) filenames[i].c_str(), reference);
+            CPPUNIT_ASSERT(digests[i].status == EXIT_SUCCESS);
+            CPPUNIT_ASSERT(digests[i].file_byte_size == (i*i*487) % data.size());
+            CPPUNIT_ASSERT(digests[i].node < 2);
+            CPPUNIT_ASSERT(memcmp(digests[i].hash, reference, (sha256 ? 8 : 5)*sizeof(uint32_t)) == 0);
+        }
+        CPPUNIT_ASSERT(digests[NR_OF_FILES].status == EXIT_FAILURE);
+        CPPUNIT_ASSERT(pool.Stats(0).bytes + pool.Stats(1).bytes == bytes);
+    }
+
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        unlink(filenames[i].c_str());
+    rmdir(directory);
+}
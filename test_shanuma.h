@@ -0,0 +1,50 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shanuma.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-02
+ *
+ * CONTENT: Declares the tests contained in test_shanuma.cpp of the NUMA-aware worker pool contained in shanuma.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHANUMA__
+#define __TEST_SHANUMA__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHANUMA : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHANUMA );
+    CPPUNIT_TEST( Topology_test1 );
+    CPPUNIT_TEST( Batch_test1 );
+    CPPUNIT_TEST( Files_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Topology_test1();
+    void Batch_test1();
+    void Files_test1();
+
+};
+
+#endif
@@ -0,0 +1,202 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaotp.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-20
+ *
+ * CONTENT: Defines the tests of the one-time password functions contained in the file shaotp.c. Test vectors are taken
+ *          from https://tools.ietf.org/html/rfc4226 (Appendix D) and https://tools.ietf.org/html/rfc6238 (Appendix B),
+ *          and the remaining codes are compared with codes computed from HMAC_SHA1.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaotp.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shabatch.h"
+#include "shaotp.h"
+
+#include <vector>
+
+static char rfc_key[] = {"12345678901234567890"};
+
+/* Computes an HOTP code with HMAC_SHA1 and the dynamic truncation of RFC 4226, as the reference */
+
+static uint32_t Reference_HOTP(char *key, unsigned int key_size, uint64_t counter, unsigned int nr_of_digits)
+{
+    char msg[8];
+    uint32_t digest[5], binary, modulus;
+    unsigned char bytes[20];
+    unsigned int offset;
+
+    for (int i = 0; i < 8; i++)
+        msg[i] = (char) (counter >> 8*(7 - i));
+    HMAC_SHA1(key, key_size, msg, 8, digest);
+
+    for (int i = 0; i < 20; i++)
+        bytes[i] = (unsigned char) (digest[i/4] >> 8*(3 - i % 4));
+    offset = bytes[19] & 0x0f;
+    binary = ((uint32_t) (bytes[offset] & 0x7f) << 24) | (bytes[offset + 1] << 16) | (bytes[offset + 2] << 8) | bytes[offset + 3];
+
+    modulus = 1;
+    for (unsigned int i = 0; i < nr_of_digits; i++)
+        modulus = modulus*10;
+    return binary % modulus;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_HOTP, and of SHA_HOTP_Batch_Kernel with every available kernel, for the counters 0 to 9, and of both
+with a number of digits out of range
+
+key:    "12345678901234567890"
+
+codes:  755224, 287082, 359152, 969429, 338314, 254676, 287922, 162583, 399871, 520489     */
+
+void Test_SHAOTP::HOTP_test1()
+{
+    const uint32_t reference[] = {755224, 287082, 359152, 969429, 338314, 254676, 287922, 162583, 399871, 520489};
+    const struct sha_otp_key *keys[10];
+    struct sha_otp_key otp_key;
+    const struct sha1_kernel *kernels;
+    uint64_t counters[10];
+    uint32_t codes[10];
+    unsigned int nr_of_kernels;
+
+    SHA_OTP_Set_Key(rfc_key, strlen(rfc_key), &otp_key);
+    for (int i = 0; i < 10; i++)
+    {
+        keys[i] = &otp_key;
+        counters[i] = i;
+        CPPUNIT_ASSERT(SHA_HOTP(rfc_key, strlen(rfc_key), i, 6) == reference[i]);
+    }
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        memset(codes, 0, sizeof(codes));
+        CPPUNIT_ASSERT(SHA_HOTP_Batch_Kernel(&kernels[k], keys, counters, 10, 6, codes) == EXIT_SUCCESS);
+        for (int i = 0; i < 10; i++)
+            CPPUNIT_ASSERT(codes[i] == reference[i]);
+    }
+
+    CPPUNIT_ASSERT(SHA_HOTP(rfc_key, strlen(rfc_key), 0, 0) == SHA_OTP_INVALID_CODE);
+    CPPUNIT_ASSERT(SHA_HOTP(rfc_key, strlen(rfc_key), 0, SHA_OTP_MAX_DIGITS + 1) == SHA_OTP_INVALID_CODE);
+    CPPUNIT_ASSERT(SHA_HOTP_Batch(keys, counters, 10, 0, codes) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_HOTP_Batch(keys, counters, 10, SHA_OTP_MAX_DIGITS + 1, codes) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_HOTP_Batch(keys, counters, 10, SHA_OTP_MAX_DIGITS, codes) == EXIT_SUCCESS);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_TOTP_Verify with a time step of 30 seconds and 8 digits, at the given times and drifted by whole time steps,
+and of SHA_TOTP_Verify and SHA_TOTP_Counter with a time step of zero
+
+key:    "12345678901234567890"
+
+time:   59, 1111111109, 1111111111, 1234567890, 2000000000, 20000000000
+
+codes:  94287082, 07081804, 14050471, 89005924, 69279037, 65353130                  */
+
+void Test_SHAOTP::TOTP_test1()
+{
+    const uint64_t times[] = {59, 1111111109, 1111111111, 1234567890, 2000000000, 20000000000ULL};
+    const uint32_t reference[] = {94287082, 7081804, 14050471, 89005924, 69279037, 65353130};
+    struct sha_otp_key otp_key;
+    uint64_t counter;
+    int64_t offset;
+
+    SHA_OTP_Set_Key(rfc_key, strlen(rfc_key), &otp_key);
+
+    for (int i = 0; i < 6; i++)
+    {
+        CPPUNIT_ASSERT(SHA_TOTP_Verify(&otp_key, times[i], 30, 0, 8, reference[i], &offset) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(offset == 0);
+
+        /* The code was given two time steps before the server verifies it */
+
+        CPPUNIT_ASSERT(SHA_TOTP_Verify(&otp_key, times[i] + 60, 30, 2, 8, reference[i], &offset) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(offset == -2);
+        CPPUNIT_ASSERT(SHA_TOTP_Verify(&otp_key, times[i] + 90, 30, 2, 8, reference[i], &offset) == EXIT_FAILURE);
+
+        CPPUNIT_ASSERT(SHA_TOTP_Verify(&otp_key, times[i], 30, 2, 8, (reference[i] + 1) % 100000000, NULL) == EXIT_FAILURE);
+    }
+
+    /* A time step of zero is rejected */
+
+    CPPUNIT_ASSERT(SHA_TOTP_Verify(&otp_key, times[0], 0, 2, 8, reference[0], &offset) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_TOTP_Counter(times[0], 0, 0, &counter) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_TOTP_Counter(times[1], 1000000000, 30, &counter) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(counter == 111111111/30);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_HOTP_Verify at the lowest counters, where the window reaches below zero, and with an invalid number of
+digits                                                                                                        */
+
+void Test_SHAOTP::Verify_test1()
+{
+    struct sha_otp_key otp_key;
+    int64_t offset;
+
+    SHA_OTP_Set_Key(rfc_key, strlen(rfc_key), &otp_key);
+
+    /* The code of counter 0 is 755224 and of counter 3 is 969429 */
+
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 0, 5, 6, 755224, &offset) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(offset == 0);
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 0, 5, 6, 969429, &offset) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(offset == 3);
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 2, 1, 6, 755224, &offset) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 2, 2, 6, 755224, &offset) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(offset == -2);
+
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 0, 0, 0, 755224, &offset) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_HOTP_Verify(&otp_key, 0, 0, 10, 755224, &offset) == EXIT_FAILURE);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_HOTP_Verify_Batch with 200 users, whose keys are of length 1 to 150 bytes and whose codes drift from
+-4 to +4 counters, verified with a window of 3                                                                */
+
+void Test_SHAOTP::Verify_Batch_test1()
+{
+    const unsigned int NR_OF_USERS = 200;
+    std::vector<struct sha_otp_key> keys(NR_OF_USERS);
+    std::vector<struct sha_otp_check> checks(NR_OF_USERS);
+    char key[150];
+
+    Fill_Data(key, sizeof(key));
+
+    for (unsigned int i = 0; i < NR_OF_USERS; i++)
+    {
+        unsigned int key_size = 1 + i % 150;
+        int drift = (int) (i % 9) - 4;
+
+        SHA_OTP_Set_Key(key, key_size, &keys[i]);
+        checks[i].key = &keys[i];
+        checks[i].counter = 1000 + i;
+        checks[i].code = Reference_HOTP(key, key_size, 1000 + i + drift, 9);
+    }
+
+    CPPUNIT_ASSERT(SHA_HOTP_Verify_Batch(&checks[0], NR_OF_USERS, 3, 9) == EXIT_SUCCESS);
+
+    for (unsigned int i = 0; i < NR_OF_USERS; i++)
+    {
+        int drift = (int) (i % 9) - 4;
+
+        if (drift >= -3 && drift <= 3)
+        {
+            CPPUNIT_ASSERT(checks[i].result == EXIT_SUCCESS);
+            CPPUNIT_ASSERT(checks[i].offset == drift);
+        }
+        else
+            CPPUNIT_ASSERT(checks[i].result == EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaotp.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-20
+ *
+ * CONTENT: Declares the tests contained in test_shaotp.cpp of the one-time password functions contained in shaotp.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAOTP__
+#define __TEST_SHAOTP__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAOTP : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAOTP );
+    CPPUNIT_TEST( HOTP_test1 );
+    CPPUNIT_TEST( TOTP_test1 );
+    CPPUNIT_TEST( Verify_test1 );
+    CPPUNIT_TEST( Verify_Batch_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void HOTP_test1();
+    void TOTP_test1();
+    void Verify_test1();
+    void Verify_Batch_test1();
+
+};
+
+#endif
@@ -0,0 +1,249 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaserver.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-15
+ *
+ * CONTENT: Defines the tests of the hashing daemon contained in the files shaserver.h and shaserver.cpp and of its client
+ *          library contained in the files shaclient.h and shaclient.c. The daemon is run inside the test program on a
+ *          socket of its own, and the results are compared with those of the function SHA1.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaserver.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "sha1.h"
+#include "shaclient.h"
+#include "shaproto.h"
+#include "shaserver.h"
+
+#include <vector>
+
+#define HASH_SIZE 5
+
+/* Returns a socket path unique to the test program */
+
+static std::string Socket_Path()
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_shaserver.%d", (int) getpid());
+    return path;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Client_SHA1 with texts of length 0 to 200, where texts longer than the slot size of 128 bytes
+are hashed locally, compared with SHA1                                                                         */
+
+void Test_SHAServer::SHA_Client_SHA1_test1()
+{
+    std::string path = Socket_Path();
+    SHA1_Server server(path.c_str(), 50);
+    struct sha_client client;
+    char text[200];
+    uint32_t digest[HASH_SIZE];
+    uint32_t reference[HASH_SIZE];
+
+    Fill_Data(text, sizeof(text));
+
+    CPPUNIT_ASSERT(server.Start() == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Client_Open(&client, path.c_str(), 4, 128) == EXIT_SUCCESS);
+
+    for (int size = 0; size <= 200; size++)
+    {
+        SHA1(text, size, reference);
+        CPPUNIT_ASSERT(SHA_Client_SHA1(&client, text, size, digest) == EXIT_SUCCESS);
+        for (int i = 0; i < HASH_SIZE; i++)
+            CPPUNIT_ASSERT(digest[i] == reference[i]);
+    }
+
+    SHA_Client_Close(&client);
+    server.Stop();
+
+    CPPUNIT_ASSERT(server.Get_Stats().jobs == 129);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Client_Submit and SHA_Client_Wait with two clients keeping 8 requests each in flight, whose
+payloads are written directly into the ring                                                                    */
+
+void Test_SHAServer::SHA_Client_Submit_test1()
+{
+    const uint32_t DEPTH = 8;
+    std::string path = Socket_Path();
+    SHA1_Server server(path.c_str(), 50);
+    struct sha_client clients[2];
+    uint32_t reference[DEPTH][HASH_SIZE];
+    uint32_t digest[HASH_SIZE];
+    uint32_t slot;
+    char *payload;
+
+    CPPUNIT_ASSERT(server.Start() == EXIT_SUCCESS);
+
+    for (int c = 0; c < 2; c++)
+    {
+        CPPUNIT_ASSERT(SHA_Client_Open(&clients[c], path.c_str(), DEPTH, 100) == EXIT_SUCCESS);
+
+        /* The payload of a slot is its number repeated 10*slot times, which is also its reference */
+
+        for (uint32_t i = 0; i < DEPTH; i++)
+        {
+            CPPUNIT_ASSERT(SHA_Client_Acquire(&clients[c], &slot) == EXIT_SUCCESS);
+            payload = SHA_Client_Payload(&clients[c], slot);
+            memset(payload, (int) slot, 10*slot);
+            SHA1(payload, 10*slot, reference[slot]);
+            CPPUNIT_ASSERT(SHA_Client_Submit(&clients[c], slot, 10*slot) == EXIT_SUCCESS);
+        }
+        CPPUNIT_ASSERT(SHA_Client_Acquire(&clients[c], &slot) == EXIT_FAILURE);
+    }
+
+    for (int c = 0; c < 2; c++)
+        for (uint32_t i = 0; i < DEPTH; i++)
+        {
+            CPPUNIT_ASSERT(SHA_Client_Wait(&clients[c], &slot, digest) == EXIT_SUCCESS);
+            for (int j = 0; j < HASH_SIZE; j++)
+                CPPUNIT_ASSERT(digest[j] == reference[slot][j]);
+        }
+
+    for (int c = 0; c < 2; c++)
+    {
+        CPPUNIT_ASSERT(SHA_Client_Submit(&clients[c], 0, 101) == EXIT_FAILURE);
+        SHA_Client_Close(&clients[c]);
+    }
+
+    CPPUNIT_ASSERT(server.Get_Stats().jobs == 2*DEPTH);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of a client which floods the daemon with requests and never reads the replies, while a second client is
+still served                                                                                                   */
+
+void Test_SHAServer::SHA_Server_Stalled_test1()
+{
+    std::string path = Socket_Path();
+    SHA1_Server server(path.c_str(), 50);
+    struct sha_client stalled, client;
+    struct sha_request request;
+    uint32_t digest[HASH_SIZE];
+    uint32_t reference[HASH_SIZE];
+    char text[100];
+    int nr_sent = 0;
+
+    memset(text, 'x', sizeof(text));
+    memset(&request, 0, sizeof(request));
+    request.byte_size = 10;
+
+    CPPUNIT_ASSERT(server.Start() == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Client_Open(&stalled, path.c_str(), 2, 100) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Client_Open(&client, path.c_str(), 2, 100) == EXIT_SUCCESS);
+
+    /* Send until the socket is full, a few times over so that the replies also fill the socket of the daemon. The
+       socket stays full once the daemon has stopped reading the stalled client */
+
+    for (int round = 0; round < 5; round++)
+    {
+        while (nr_sent < 100000 && send(stalled.socket, &request, sizeof(request), MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(request))
+            nr_sent++;
+        usleep(50000);
+    }
+    CPPUNIT_ASSERT(nr_sent < 100000);
+
+    for (int size = 0; size <= 100; size += 10)
+    {
+        SHA1(text, size, reference);
+        CPPUNIT_ASSERT(SHA_Client_SHA1(&client, text, size, digest) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(digest, reference, sizeof(reference)) == 0);
+    }
+
+    CPPUNIT_ASSERT(server.Get_Stats().jobs <= (uint64_t) nr_sent + 11);
+
+    SHA_Client_Close(&client);
+    SHA_Client_Close(&stalled);
+    server.Stop();
+}
+
+/* The function Send_Hello connects to the daemon, sends a sha_hello with the given sizes and a sealed memfd of
+   memfd_byte_size bytes, and returns the status of the reply, or -1 if there is none */
+
+static int Send_Hello(const std::string &path, uint32_t nr_of_slots, uint32_t slot_byte_size, uint64_t memfd_byte_size)
+{
+    struct sockaddr_un address;
+    struct sha_hello hello;
+    struct sha_reply reply;
+    struct msghdr message;
+    struct iovec iov;
+    struct cmsghdr *control;
+    char control_buffer[CMSG_SPACE(sizeof(int))];
+    int memfd, sock, status = -1;
+
+    memfd = memfd_create("test_shaserver", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0 || ftruncate(memfd, memfd_byte_size) != 0 || fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0)
+        return -1;
+
+    hello.magic = SHA_PROTO_MAGIC;
+    hello.version = SHA_PROTO_VERSION;
+    hello.nr_of_slots = nr_of_slots;
+    hello.slot_byte_size = slot_byte_size;
+
+    memset(&message, 0, sizeof(message));
+    memset(control_buffer, 0, sizeof(control_buffer));
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control_buffer;
+    message.msg_controllen = sizeof(control_buffer);
+    control = CMSG_FIRSTHDR(&message);
+    control->cmsg_level = SOL_SOCKET;
+    control->cmsg_type = SCM_RIGHTS;
+    control->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(control), &memfd, sizeof(int));
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+
+    sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock >= 0 && connect(sock, (struct sockaddr*) &address, sizeof(address)) == 0 &&
+        sendmsg(sock, &message, MSG_NOSIGNAL) == sizeof(hello) && recv(sock, &reply, sizeof(reply), 0) == sizeof(reply))
+        status = (int) reply.status;
+
+    if (sock >= 0)
+        close(sock);
+    close(memfd);
+    return status;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of the daemon with hellos whose ring size does not fit in 64 bits or whose slots exceed the protocol limit. The
+first wraps to just below 4 GiB, which the memfd covers, so only the check of the sizes themselves rejects it      */
+
+void Test_SHAServer::SHA_Server_Hello_test1()
+{
+    std::string path = Socket_Path();
+    SHA1_Server server(path.c_str(), 50);
+    struct sha_client client;
+
+    CPPUNIT_ASSERT(server.Start() == EXIT_SUCCESS);
+
+    CPPUNIT_ASSERT(Send_Hello(path, 0xffffffffu - 62, 0xffffffffu, (uint64_t) 1 << 32) == SHA_PROTO_BAD_REQUEST);
+    CPPUNIT_ASSERT(Send_Hello(path, 1, SHA_PROTO_MAX_SLOT_BYTE_SIZE + 1, 4096) == SHA_PROTO_BAD_REQUEST);
+    CPPUNIT_ASSERT(Send_Hello(path, 2, 100, 2*SHA_SLOT_STRIDE(100)) == SHA_PROTO_OK);
+
+    CPPUNIT_ASSERT(SHA_Client_Open(&client, path.c_str(), 1, SHA_PROTO_MAX_SLOT_BYTE_SIZE + 1) == EXIT_FAILURE);
+
+    server.Stop();
+}
@@ -0,0 +1,53 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaserver.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-15
+ *
+ * CONTENT: Declares the tests contained in test_shaserver.cpp of the hashing daemon contained in shaserver.h and shaserver.cpp
+ *          and of its client library contained in shaclient.h and shaclient.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHASERVER__
+#define __TEST_SHASERVER__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAServer : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAServer );
+    CPPUNIT_TEST( SHA_Client_SHA1_test1 );
+    CPPUNIT_TEST( SHA_Client_Submit_test1 );
+    CPPUNIT_TEST( SHA_Server_Stalled_test1 );
+    CPPUNIT_TEST( SHA_Server_Hello_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void SHA_Client_SHA1_test1();
+    void SHA_Client_Submit_test1();
+    void SHA_Server_Stalled_test1();
+    void SHA_Server_Hello_test1();
+
+};
+
+#endif
@@ -0,0 +1,165 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaset.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-25
+ *
+ * CONTENT: Defines the tests of the functions of sets of known hashes contained in the file shaset.c. The sets are built
+ *          from the SHA1 hashes of numbered strings, and every hash of the set and as many hashes outside it are looked
+ *          up one at a time and in batches.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaset.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shaset.h"
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <vector>
+
+/* The function Make_Hashes computes the SHA1 hashes of the strings "first" to "first + nr_of_hashes - 1" */
+
+static std::vector<uint32_t> Make_Hashes(unsigned int first, unsigned int nr_of_hashes)
+{
+    std::vector<uint32_t> hashes(5*nr_of_hashes);
+    char text[16];
+
+    for (unsigned int i = 0; i < nr_of_hashes; i++)
+    {
+        int length = snprintf(text, sizeof(text), "%u", first + i);
+        SHA1(text, length, &hashes[5*i]);
+    }
+    return hashes;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Set_Contains on sets of 10000 hashes with and without a Bloom filter, where every hash is given twice    */
+
+void Test_SHASET::Contains_test1()
+{
+    const char filename[] = "test_shaset.set";
+    std::vector<uint32_t> members = Make_Hashes(0, 10000);
+    std::vector<uint32_t> others = Make_Hashes(10000, 10000);
+    std::vector<uint32_t> twice = members;
+    unsigned int bloom_bits[] = {0, SHA_SET_DEFAULT_BLOOM_BITS};
+    struct sha_set set;
+
+    twice.insert(twice.end(), members.begin(), members.end());
+
+    for (int b = 0; b < 2; b++)
+    {
+        CPPUNIT_ASSERT(SHA_Set_Build(filename, twice.data(), twice.size()/5, bloom_bits[b]) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(set.nr_of_hashes == 10000);
+        CPPUNIT_ASSERT(set.index[(uint64_t) 1 << set.index_bits] == 10000);
+        CPPUNIT_ASSERT(set.nr_of_bloom_blocks == (bloom_bits[b] == 0 ? 0 : (10000*SHA_SET_DEFAULT_BLOOM_BITS + 511)/512));
+
+        for (unsigned int i = 0; i < 10000; i++)
+        {
+            CPPUNIT_ASSERT(SHA_Set_Contains(&set, &members[5*i]) == 1);
+            CPPUNIT_ASSERT(SHA_Set_Contains(&set, &others[5*i]) == 0);
+        }
+
+        /* The hashes are stored in increasing order */
+
+        for (unsigned int i = 1; i < set.nr_of_hashes; i++)
+            CPPUNIT_ASSERT(memcmp(&set.hashes[20*(i - 1)], &set.hashes[20*i], 20) < 0);
+
+        SHA_Set_Close(&set);
+    }
+
+    remove(filename);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Set_Contains_Batch against SHA_Set_Contains for a mix of members and other hashes, with batch sizes which
+are not multiples of the group size                                                                            */
+
+void Test_SHASET::Contains_Batch_test1()
+{
+    const char filename[] = "test_shaset.set";
+    std::vector<uint32_t> members = Make_Hashes(0, 5000);
+    std::vector<uint32_t> queries = Make_Hashes(2500, 5000);
+    std::vector<unsigned char> results(5000);
+    uint64_t sizes[] = {0, 1, 15, 17, 5000};
+    struct sha_set set;
+
+    CPPUNIT_ASSERT(SHA_Set_Build(filename, members.data(), 5000, SHA_SET_DEFAULT_BLOOM_BITS) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_SUCCESS);
+
+    for (int s = 0; s < 5; s++)
+    {
+        uint64_t expected = 0;
+
+        for (uint64_t i = 0; i < sizes[s]; i++)
+            expected += SHA_Set_Contains(&set, &queries[5*i]);
+        CPPUNIT_ASSERT(SHA_Set_Contains_Batch(&set, queries.data(), sizes[s], results.data()) == expected);
+        for (uint64_t i = 0; i < sizes[s]; i++)
+            CPPUNIT_ASSERT(results[i] == (i < 2500 ? 1 : 0));
+    }
+
+    SHA_Set_Close(&set);
+    remove(filename);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of an empty set, a file which is not a set, a truncated set, a set whose index decreases, a set whose index
+offset lies past the end of the file and a missing file                                                           */
+
+void Test_SHASET::Error_test1()
+{
+    const char filename[] = "test_shaset.set";
+    std::vector<uint32_t> hashes = Make_Hashes(0, 100);
+    unsigned char results[100];
+    struct sha_set set;
+    uint64_t index_offset, position = 1000, wrapping_offset = 0xfffffffffffffff8ull;
+    FILE *fp;
+    int fd;
+
+    CPPUNIT_ASSERT(SHA_Set_Build(filename, hashes.data(), 0, SHA_SET_DEFAULT_BLOOM_BITS) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(set.nr_of_hashes == 0 && set.nr_of_bloom_blocks == 0);
+    CPPUNIT_ASSERT(SHA_Set_Contains(&set, &hashes[0]) == 0);
+    CPPUNIT_ASSERT(SHA_Set_Contains_Batch(&set, hashes.data(), 100, results) == 0);
+    SHA_Set_Close(&set);
+
+    CPPUNIT_ASSERT(SHA_Set_Build(filename, hashes.data(), 100, SHA_SET_DEFAULT_BLOOM_BITS) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(truncate(filename, 4096 + 20*50) == 0);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_FAILURE);
+
+    /* The first position of the index, whose offset follows the magic, the counts and the probes of the header, is set
+       past the end of the hashes */
+
+    CPPUNIT_ASSERT(SHA_Set_Build(filename, hashes.data(), 100, SHA_SET_DEFAULT_BLOOM_BITS) == EXIT_SUCCESS);
+    fd = open(filename, O_RDWR);
+    CPPUNIT_ASSERT(pread(fd, &index_offset, sizeof(index_offset), 40) == sizeof(index_offset));
+    CPPUNIT_ASSERT(pwrite(fd, &position, sizeof(position), index_offset) == sizeof(position));
+    close(fd);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_FAILURE);
+
+    /* An index offset which wraps the end of the index around to the start of the file */
+
+    CPPUNIT_ASSERT(SHA_Set_Build(filename, hashes.data(), 100, SHA_SET_DEFAULT_BLOOM_BITS) == EXIT_SUCCESS);
+    fd = open(filename, O_RDWR);
+    CPPUNIT_ASSERT(pwrite(fd, &wrapping_offset, sizeof(wrapping_offset), 40) == sizeof(wrapping_offset));
+    close(fd);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_FAILURE);
+
+    fp = fopen(filename, "w");
+    fprintf(fp, "da39a3ee5e6b4b0d3255bfef95601890afd80709  -\n");
+    fclose(fp);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_FAILURE);
+
+    remove(filename);
+    CPPUNIT_ASSERT(SHA_Set_Open(&set, filename) == EXIT_FAILURE);
+}
@@ -0,0 +1,51 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaset.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-25
+ *
+ * CONTENT: Declares the tests contained in test_shaset.cpp of the functions of sets of known hashes contained in
+ *          shaset.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHASET__
+#define __TEST_SHASET__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHASET : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHASET );
+    CPPUNIT_TEST( Contains_test1 );
+    CPPUNIT_TEST( Contains_Batch_test1 );
+    CPPUNIT_TEST( Error_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Contains_test1();
+    void Contains_Batch_test1();
+    void Error_test1();
+
+};
+
+#endif
@@ -0,0 +1,161 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shasparse.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-03
+ *
+ * CONTENT: Defines the tests of the sparse file backend contained in the file shasparse.c. Sparse files are made with
+ *          ftruncate and data written at offsets that are not aligned with the blocks, and their hashes are compared
+ *          with those of SHA1_File, SHA256_File and SHA224_File with the library backend.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shasparse.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shaalg.h"
+#include "shasparse.h"
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <vector>
+
+/* The layout of a sparse test file, a size and up to three data regions written into it */
+
+struct Sparse_Layout
+{
+    uint64_t file_byte_size;
+    uint64_t offset[3];
+    uint64_t size[3];
+};
+
+static const Sparse_Layout layouts[] =
+{
+    {0,       {0, 0, 0},                 {0, 0, 0}},
+    {55,      {0, 0, 0},                 {0, 0, 0}},
+    {3000000, {0, 0, 0},                 {0, 0, 0}},
+    {3000000, {0, 0, 0},                 {3000000, 0, 0}},
+    {3000000, {17, 1048613, 2999990},    {100, 70000, 10}},
+    {5000003, {1048576, 4194304, 0},     {4096, 1, 0}},
+    {2097152, {2097088, 0, 0},           {64, 0, 0}}
+};
+
+static const unsigned int NR_OF_LAYOUTS = sizeof(layouts)/sizeof(layouts[0]);
+
+/* Makes the sparse file of a layout, with data that differs from zero throughout its regions */
+
+static bool Make_Sparse_File(const std::string &filename, const Sparse_Layout &layout)
+{
+    std::vector<unsigned char> data;
+    bool made;
+    int fd;
+
+    fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return false;
+
+    made = ftruncate(fd, (off_t) layout.file_byte_size) == 0;
+    for (unsigned int r = 0; r < 3 && made; r++)
+    {
+        data.resize(layout.size[r]);
+        for (uint64_t i = 0; i < layout.size[r]; i++)
+            data[i] = (unsigned char) ((layout.offset[r] + i)*2654435761u >> 24) | 1;
+        if (layout.size[r] > 0)
+            made = pwrite(fd, &data[0], layout.size[r], (off_t) layout.offset[r]) == (ssize_t) layout.size[r];
+    }
+
+    close(fd);
+    return made;
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Sparse_File against SHA1_File, SHA256_File and SHA224_File for files of holes, data and both         */
+
+void Test_SHASPARSE::Sparse_test1()
+{
+    char directory[] = "/tmp/test_shasparse_XXXXXX";
+    struct sha_sparse_stats stats;
+    uint32_t hash[8], reference[8];
+    uint64_t data_bytes;
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    std::string filename = std::string(directory) + "/image";
+
+    for (unsigned int l = 0; l < NR_OF_LAYOUTS; l++)
+    {
+        CPPUNIT_ASSERT(Make_Sparse_File(filename, layouts[l]));
+
+        CPPUNIT_ASSERT(SHA1_File((char*) filename.c_str(), reference) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(SHA_Sparse_File("sha1", (char*) filename.c_str(), hash, 5, &stats) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 5*sizeof(uint32_t)) == 0);
+
+        CPPUNIT_ASSERT(SHA256_File((char*) filename.c_str(), reference) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(SHA_Sparse_File("sha256", (char*) filename.c_str(), hash, 8, NULL) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 8*sizeof(uint32_t)) == 0);
+
+        CPPUNIT_ASSERT(SHA224_File((char*) filename.c_str(), reference) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(SHA_Sparse_File("sha224", (char*) filename.c_str(), hash, 7, NULL) == EXIT_SUCCESS);
+        CPPUNIT_ASSERT(memcmp(hash, reference, 7*sizeof(uint32_t)) == 0);
+
+        /* The regions cover the file. Where the file system has holes, the bytes read are far fewer than the size */
+
+        data_bytes = layouts[l].size[0] + layouts[l].size[1] + layouts[l].size[2];
+        CPPUNIT_ASSERT(stats.file_byte_size == layouts[l].file_byte_size);
+        CPPUNIT_ASSERT(stats.data_bytes + stats.hole_bytes == layouts[l].file_byte_size);
+        CPPUNIT_ASSERT(stats.data_bytes >= data_bytes);
+        if (stats.hole_bytes > 0 && layouts[l].file_byte_size > 1000000)
+            CPPUNIT_ASSERT(stats.data_bytes < layouts[l].file_byte_size/2);
+    }
+
+    /* Unknown algorithms, wrong hash sizes, missing files and directories are refused */
+
+    CPPUNIT_ASSERT(SHA_Sparse_File("md5", (char*) filename.c_str(), hash, 4, NULL) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_Sparse_File("sha1", (char*) filename.c_str(), hash, 8, NULL) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_Sparse_File("sha1", directory, hash, 5, NULL) == EXIT_FAILURE);
+    unlink(filename.c_str());
+    CPPUNIT_ASSERT(SHA_Sparse_File("sha1", (char*) filename.c_str(), hash, 5, NULL) == EXIT_FAILURE);
+
+    rmdir(directory);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA1_File and SHA256_File with the sparse backend selected by SHA_File_Set_Backend                       */
+
+void Test_SHASPARSE::Backend_test1()
+{
+    char directory[] = "/tmp/test_shasparse_XXXXXX";
+    uint32_t hash[8], reference[8];
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    std::string filename = std::string(directory) + "/image";
+    CPPUNIT_ASSERT(Make_Sparse_File(filename, layouts[4]));
+
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA1_File((char*) filename.c_str(), reference) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_SPARSE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_File_Get_Backend() == SHA_FILE_BACKEND_SPARSE);
+    CPPUNIT_ASSERT(SHA1_File((char*) filename.c_str(), hash) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(memcmp(hash, reference, 5*sizeof(uint32_t)) == 0);
+
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA256_File((char*) filename.c_str(), reference) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_SPARSE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA256_File((char*) filename.c_str(), hash) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(memcmp(hash, reference, 8*sizeof(uint32_t)) == 0);
+
+    /* A missing file still fails */
+
+    unlink(filename.c_str());
+    CPPUNIT_ASSERT(SHA1_File((char*) filename.c_str(), hash) == EXIT_FAILURE);
+
+    CPPUNIT_ASSERT(SHA_File_Set_Backend(SHA_FILE_BACKEND_LIBRARY) == EXIT_SUCCESS);
+    rmdir(directory);
+}
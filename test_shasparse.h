@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shasparse.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-03
+ *
+ * CONTENT: Declares the tests contained in test_shasparse.cpp of the sparse file backend contained in shasparse.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHASPARSE__
+#define __TEST_SHASPARSE__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHASPARSE : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHASPARSE );
+    CPPUNIT_TEST( Sparse_test1 );
+    CPPUNIT_TEST( Backend_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Sparse_test1();
+    void Backend_test1();
+
+};
+
+#endif
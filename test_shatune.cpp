@@ -0,0 +1,246 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shatune.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-01
+ *
+ * CONTENT: Defines the tests of the kernel autotuner contained in the file shatune.c. The tuned kernels are checked to be
+ *          applied and persisted, and the hashes computed with them are compared with those of SHA1 and of the portable
+ *          SHA256 kernel.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shatune.h"
+
+/* Files containing the functions to be tested. */
+#include "shalib.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "shabatch.h"
+#include "shatune.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <vector>
+
+#define TUNE_CACHE "test_shatune.cache"
+#define ESCAPED_CACHE "test_shatune \"q\\\t.cache"
+
+/* Checks that SHA1_Batch and SHA256 give the right hashes with the kernels in use, for texts of every size class */
+
+static bool Hashes_Are_Correct()
+{
+    const uint64_t sizes[] = {0, 20, 64, 200, 1024, 3000, 16384, 40000};
+    const uint64_t nr_of_texts = 40;
+    std::vector<char> data(nr_of_texts*40000);
+    std::vector<char*> texts(nr_of_texts);
+    std::vector<uint64_t> texts_byte_size(nr_of_texts);
+    std::vector<uint32_t> hashes(5*nr_of_texts);
+    uint32_t reference[8], hash[8];
+    bool correct = true;
+
+    for (uint64_t i = 0; i < data.size(); i++)
+        data[i] = (char) (i*31 + 7);
+
+    for (unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+    {
+        for (uint64_t i = 0; i < nr_of_texts; i++)
+        {
+            texts[i] = &data[i*sizes[s]];
+            texts_byte_size[i] = sizes[s];
+        }
+        SHA1_Batch(texts.data(), texts_byte_size.data(), nr_of_texts, hashes.data());
+        for (uint64_t i = 0; i < nr_of_texts; i++)
+        {
+            SHA1(texts[i], texts_byte_size[i], reference);
+            correct = correct && memcmp(&hashes[5*i], reference, 5*sizeof(uint32_t)) == 0;
+        }
+
+        SHA256(&data[s], sizes[s], hash);
+        SHA256_Set_Kernel(SHA_KERNEL_PORTABLE);
+        SHA256(&data[s], sizes[s], reference);
+        SHA256_Set_Kernel(SHA_KERNEL_AUTO);
+        correct = correct && memcmp(hash, reference, sizeof(hash)) == 0;
+    }
+
+    return correct;
+}
+
+static std::vector<std::string> Read_Lines(const char *path)
+{
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+
+    while (std::getline(file, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+static void Write_Lines(const char *path, const std::vector<std::string> &lines)
+{
+    std::ofstream file(path);
+
+    for (unsigned int i = 0; i < lines.size(); i++)
+        file << lines[i] << "\n";
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Tune measuring the kernels and writing the cache, of a later call applying the cache without measuring,
+and of SHA_Tune_Get_Table before and after tuning                                                                */
+
+void Test_SHATUNE::Tune_test1()
+{
+    const struct sha_tune_table *table;
+    std::string kernels[SHA_SIZE_CLASSES];
+
+    SHA_Tune_Reset();
+    remove(TUNE_CACHE);
+
+    table = SHA_Tune_Get_Table();
+    CPPUNIT_ASSERT(table->source == SHA_TUNE_DEFAULT);
+    for (unsigned int c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        CPPUNIT_ASSERT(strcmp(table->classes[c].sha1_kernel, SHA1_Default_Kernel()->name) == 0);
+        CPPUNIT_ASSERT(table->classes[c].sha256_kernel == SHA256_Get_Kernel());
+    }
+
+    /* Measured and written to the cache */
+
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    table = SHA_Tune_Get_Table();
+    CPPUNIT_ASSERT(table->source == SHA_TUNE_MEASURED);
+    CPPUNIT_ASSERT(strcmp(table->cache_path, TUNE_CACHE) == 0);
+    CPPUNIT_ASSERT(table->cpu[0] != 0);
+    CPPUNIT_ASSERT(table->classes[SHA_SIZE_CLASSES - 1].limit == UINT64_MAX);
+    for (unsigned int c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        CPPUNIT_ASSERT(table->classes[c].limit == SHA_Size_Class_Limit(c));
+        CPPUNIT_ASSERT(SHA1_Get_Batch_Kernel(c) == SHA1_Find_Kernel(table->classes[c].sha1_kernel));
+        CPPUNIT_ASSERT(SHA256_Get_Size_Kernel(c) == table->classes[c].sha256_kernel);
+        CPPUNIT_ASSERT(table->classes[c].sha1_mb_per_s > 0);
+        CPPUNIT_ASSERT(table->classes[c].sha256_mb_per_s > 0);
+        kernels[c] = table->classes[c].sha1_kernel;
+    }
+    CPPUNIT_ASSERT(Read_Lines(TUNE_CACHE).size() == 3 + SHA_SIZE_CLASSES);
+    CPPUNIT_ASSERT(Hashes_Are_Correct());
+
+    /* A second call does nothing */
+
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_MEASURED);
+
+    /* A later process finds the cache */
+
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    table = SHA_Tune_Get_Table();
+    CPPUNIT_ASSERT(table->source == SHA_TUNE_CACHED);
+    for (unsigned int c = 0; c < SHA_SIZE_CLASSES; c++)
+        CPPUNIT_ASSERT(kernels[c] == SHA1_Get_Batch_Kernel(c)->name);
+
+    /* Without a cache */
+
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune("") == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_MEASURED);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->cache_path[0] == 0);
+
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA1_Get_Batch_Kernel(0) == SHA1_Default_Kernel());
+    remove(TUNE_CACHE);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Tune applying a cache edited to choose the scalar and portable kernels, and measuring over a cache of
+another processor and a truncated cache. The table is also printed, with a cache path that must be escaped in JSON */
+
+void Test_SHATUNE::Cache_test1()
+{
+    std::vector<std::string> lines, edited;
+    char printed[64] = {0};
+    char escaped[4096];
+    FILE *fp;
+
+    SHA_Tune_Reset();
+    remove(TUNE_CACHE);
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    lines = Read_Lines(TUNE_CACHE);
+    CPPUNIT_ASSERT(lines.size() == 3 + SHA_SIZE_CLASSES);
+    CPPUNIT_ASSERT(lines[1] == std::string("cpu ") + SHA_Tune_Get_Table()->cpu);
+
+    /* Edited to choose the scalar and portable kernels */
+
+    edited = lines;
+    for (unsigned int c = 0; c < SHA_SIZE_CLASSES; c++)
+        edited[3 + c] = "class " + std::to_string(c) + " scalar 1.0 portable 1.0";
+    Write_Lines(TUNE_CACHE, edited);
+
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_CACHED);
+    for (unsigned int c = 0; c < SHA_SIZE_CLASSES; c++)
+    {
+        CPPUNIT_ASSERT(strcmp(SHA1_Get_Batch_Kernel(c)->name, "scalar") == 0);
+        CPPUNIT_ASSERT(SHA256_Get_Size_Kernel(c) == SHA_KERNEL_PORTABLE);
+    }
+    CPPUNIT_ASSERT(Hashes_Are_Correct());
+
+    fp = tmpfile();
+    SHA_Tune_Print_Table(fp);
+    rewind(fp);
+    CPPUNIT_ASSERT(fread(printed, 1, sizeof(printed) - 1, fp) > 0);
+    fclose(fp);
+    CPPUNIT_ASSERT(strncmp(printed, "{\"source\":\"cached\",", 19) == 0);
+
+    /* A cache path with a quote, a backslash and a tab */
+
+    Write_Lines(ESCAPED_CACHE, edited);
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(ESCAPED_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_CACHED);
+    fp = tmpfile();
+    SHA_Tune_Print_Table(fp);
+    rewind(fp);
+    memset(escaped, 0, sizeof(escaped));
+    CPPUNIT_ASSERT(fread(escaped, 1, sizeof(escaped) - 1, fp) > 0);
+    fclose(fp);
+    CPPUNIT_ASSERT(strstr(escaped, "\"cache\":\"test_shatune \\\"q\\\\\\u0009.cache\",") != NULL);
+    remove(ESCAPED_CACHE);
+
+    /* A cache of another processor is measured over and rewritten */
+
+    edited[1] = "cpu another processor";
+    Write_Lines(TUNE_CACHE, edited);
+
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_MEASURED);
+    CPPUNIT_ASSERT(Read_Lines(TUNE_CACHE)[1] == lines[1]);
+
+    /* A truncated cache, and a cache naming a kernel that does not exist */
+
+    edited = lines;
+    edited.pop_back();
+    Write_Lines(TUNE_CACHE, edited);
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_MEASURED);
+
+    edited = lines;
+    edited[3] = "class 0 unknown 1.0 portable 1.0";
+    Write_Lines(TUNE_CACHE, edited);
+    SHA_Tune_Reset();
+    CPPUNIT_ASSERT(SHA_Tune(TUNE_CACHE) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(SHA_Tune_Get_Table()->source == SHA_TUNE_MEASURED);
+    CPPUNIT_ASSERT(Hashes_Are_Correct());
+
+    SHA_Tune_Reset();
+    remove(TUNE_CACHE);
+}
@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shatune.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-10-01
+ *
+ * CONTENT: Declares the tests contained in test_shatune.cpp of the kernel autotuner contained in shatune.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHATUNE__
+#define __TEST_SHATUNE__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHATUNE : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHATUNE );
+    CPPUNIT_TEST( Tune_test1 );
+    CPPUNIT_TEST( Cache_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Tune_test1();
+    void Cache_test1();
+
+};
+
+#endif
@@ -0,0 +1,132 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shauuid.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-21
+ *
+ * CONTENT: Defines the tests of the version 5 UUID functions contained in the file shauuid.c. The expected UUIDs are those
+ *          given by the uuid5 function of the Python standard library, and the remaining UUIDs are compared with the
+ *          SHA1 hash of the namespace and the name computed by SHA1_Concat.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shauuid.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "shalib.h"
+#include "shabatch.h"
+#include "shauuid.h"
+
+#include <vector>
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_UUID5 with names in the namespaces of RFC 4122
+
+namespace, name:    DNS, "python.org"
+                    DNS, "www.example.com"
+                    URL, "https://www.ietf.org/rfc/rfc4122.txt"
+                    OID, ""
+
+UUID:               886313e1-3b8a-5372-9b90-0c9aee199e5d
+                    2ed6657d-e927-568b-95e1-2665a8aea6a2
+                    6537e054-8e6f-5f5c-9f9a-1070caa77cd7
+                    0a68eb57-c88a-5f34-9e9d-27f85e68af4f                           */
+
+void Test_SHAUUID::UUID5_test1()
+{
+    const char *namespaces[] = {SHA_UUID_NAMESPACE_DNS, SHA_UUID_NAMESPACE_DNS, SHA_UUID_NAMESPACE_URL, SHA_UUID_NAMESPACE_OID};
+    const char *names[] = {"python.org", "www.example.com", "https://www.ietf.org/rfc/rfc4122.txt", ""};
+    const char *reference[] = {"886313e1-3b8a-5372-9b90-0c9aee199e5d", "2ed6657d-e927-568b-95e1-2665a8aea6a2",
+                               "6537e054-8e6f-5f5c-9f9a-1070caa77cd7", "0a68eb57-c88a-5f34-9e9d-27f85e68af4f"};
+    struct sha_uuid_namespace ns;
+    unsigned char uuid[SHA_UUID_SIZE];
+    char text[SHA_UUID_TEXT_SIZE], formatted[SHA_UUID_TEXT_SIZE];
+
+    for (int i = 0; i < 4; i++)
+    {
+        CPPUNIT_ASSERT(SHA_UUID_Set_Namespace(namespaces[i], &ns) == EXIT_SUCCESS);
+        SHA_UUID5(&ns, (char*) names[i], strlen(names[i]), uuid, text);
+        CPPUNIT_ASSERT(strcmp(text, reference[i]) == 0);
+
+        SHA_UUID_Format(uuid, formatted);
+        CPPUNIT_ASSERT(strcmp(formatted, reference[i]) == 0);
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_UUID5_Batch_Kernel with every available kernel for 300 names of length 0 to 99, covering names hashed
+in the lanes and names hashed one at a time                                                                     */
+
+void Test_SHAUUID::UUID5_Batch_test1()
+{
+    const unsigned int NR_OF_NAMES = 300;
+    struct sha_uuid_namespace ns;
+    const struct sha1_kernel *kernels;
+    unsigned int nr_of_kernels;
+    char data[100];
+    std::vector<char*> names(NR_OF_NAMES);
+    std::vector<uint64_t> sizes(NR_OF_NAMES);
+    std::vector<unsigned char> uuids(SHA_UUID_SIZE*NR_OF_NAMES);
+    std::vector<char> texts(SHA_UUID_TEXT_SIZE*NR_OF_NAMES);
+
+    Fill_Data(data, sizeof(data));
+    for (unsigned int i = 0; i < NR_OF_NAMES; i++)
+    {
+        sizes[i] = (i*7) % 100;
+        names[i] = &data[100 - sizes[i]];
+    }
+
+    SHA_UUID_Set_Namespace(SHA_UUID_NAMESPACE_URL, &ns);
+
+    kernels = SHA1_Kernels(&nr_of_kernels);
+    for (unsigned int k = 0; k < nr_of_kernels; k++)
+    {
+        SHA_UUID5_Batch_Kernel(&kernels[k], &ns, &names[0], &sizes[0], NR_OF_NAMES, &uuids[0], &texts[0]);
+
+        for (unsigned int i = 0; i < NR_OF_NAMES; i++)
+        {
+            char *strings[] = {(char*) ns.bytes, names[i]};
+            uint64_t string_sizes[] = {SHA_UUID_SIZE, sizes[i]};
+            uint32_t hash[5];
+            unsigned char reference[SHA_UUID_SIZE];
+            char text[SHA_UUID_TEXT_SIZE];
+
+            SHA1_Concat(strings, 2, string_sizes, hash);
+            for (int j = 0; j < 4; j++)
+                Conv_32Int_To_Word(hash[j], (char*) &reference[4*j]);
+            reference[6] = (reference[6] & 0x0f) | 0x50;
+            reference[8] = (reference[8] & 0x3f) | 0x80;
+
+            CPPUNIT_ASSERT(memcmp(&uuids[SHA_UUID_SIZE*i], reference, SHA_UUID_SIZE) == 0);
+
+            SHA_UUID_Format(reference, text);
+            CPPUNIT_ASSERT(strcmp(&texts[SHA_UUID_TEXT_SIZE*i], text) == 0);
+        }
+    }
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_UUID_Set_Namespace with valid text in upper case and with invalid text                            */
+
+void Test_SHAUUID::Namespace_test1()
+{
+    struct sha_uuid_namespace ns;
+    const unsigned char dns[] = {0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8};
+
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("6BA7B810-9DAD-11D1-80B4-00C04FD430C8", &ns) == EXIT_SUCCESS);
+    CPPUNIT_ASSERT(memcmp(ns.bytes, dns, SHA_UUID_SIZE) == 0);
+    CPPUNIT_ASSERT(ns.W[0] == 0x6ba7b810 && ns.W[3] == 0x4fd430c8);
+
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("6ba7b810-9dad-11d1-80b4-00c04fd430c", &ns) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("6ba7b810-9dad-11d1-80b4-00c04fd430c89", &ns) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("6ba7b8109-dad-11d1-80b4-00c04fd430c8", &ns) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("6ba7b810-9dad-11d1-80b4-00c04fd430cg", &ns) == EXIT_FAILURE);
+    CPPUNIT_ASSERT(SHA_UUID_Set_Namespace("{ba7b810-9dad-11d1-80b4-00c04fd430c8", &ns) == EXIT_FAILURE);
+}
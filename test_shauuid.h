@@ -0,0 +1,50 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shauuid.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-21
+ *
+ * CONTENT: Declares the tests contained in test_shauuid.cpp of the version 5 UUID functions contained in shauuid.c
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAUUID__
+#define __TEST_SHAUUID__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAUUID : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAUUID );
+    CPPUNIT_TEST( UUID5_test1 );
+    CPPUNIT_TEST( UUID5_Batch_test1 );
+    CPPUNIT_TEST( Namespace_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void UUID5_test1();
+    void UUID5_Batch_test1();
+    void Namespace_test1();
+
+};
+
+#endif
@@ -0,0 +1,158 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaverify.cpp
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-22
+ *
+ * CONTENT: Defines the tests of the class SHA_Verifier contained in the file shaverify.cpp. The manifests are written in
+ *          the format of sha1sum and sha256sum for files created in a temporary directory.
+ *
+ **************************************************************************************************************************************/
+
+
+#include "test_shaverify.h"
+#include "test_shadata.h"
+
+/* Files containing the functions to be tested. */
+#include "sha1.h"
+#include "sha256.h"
+#include "shahex.h"
+#include "shaverify.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <set>
+#include <vector>
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Verifier::Load_Manifest with lines of sha1sum and sha256sum in text and binary mode, an escaped name,
+and malformed lines                                                                                            */
+
+void Test_SHAVERIFY::Manifest_test1()
+{
+    char text[] = "a9993e364706816aba3e25717850c26c9cd0d89d  abc.txt\n"
+                  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad *abc.bin\r\n"
+                  "\n"
+                  "\\a9993e364706816aba3e25717850c26c9cd0d89d  back\\\\slash\\nnewline\n"
+                  "a9993e364706816aba3e25717850c26c9cd0d89  short.txt\n"
+                  "a9993e364706816aba3e25717850c26c9cd0d89g  invalid.txt\n"
+                  "a9993e364706816aba3e25717850c26c9cd0d89d nospace.txt\n"
+                  "a9993e364706816aba3e25717850c26c9cd0d89d  \n";
+    FILE *fp = fmemopen(text, strlen(text), "r");
+    SHA_Verifier verifier;
+    SHA_Verifier::Summary summary;
+
+    verifier.Load_Manifest(fp);
+    fclose(fp);
+
+    const std::vector<SHA_Verifier::Entry> &entries = verifier.Entries();
+    CPPUNIT_ASSERT(entries.size() == 3);
+
+    CPPUNIT_ASSERT(entries[0].filename == "abc.txt" && entries[0].nr_of_words == 5 && entries[0].line == 1);
+    CPPUNIT_ASSERT(entries[0].expected[0] == 0xa9993e36 && entries[0].expected[4] == 0x9cd0d89d);
+    CPPUNIT_ASSERT(entries[1].filename == "abc.bin" && entries[1].nr_of_words == 8 && entries[1].line == 2);
+    CPPUNIT_ASSERT(entries[1].expected[0] == 0xba7816bf && entries[1].expected[7] == 0xf20015ad);
+    CPPUNIT_ASSERT(entries[2].filename == "back\\slash\nnewline" && entries[2].line == 4);
+
+    verifier.Verify(SHA_Verifier::MANIFEST_ORDER, 1, 0, SHA_Verifier::Callback(), &summary);
+    CPPUNIT_ASSERT(summary.malformed_lines == 4);
+}
+
+/** --------------------------------------------------------------------------
+
+Test of SHA_Verifier::Verify in every order with 1 and 4 threads for 40 files of 0 to 100000 bytes, where one
+expected hash is wrong and one file is missing                                                                 */
+
+void Test_SHAVERIFY::Verify_test1()
+{
+    const unsigned int NR_OF_FILES = 40;
+    char directory[] = "/tmp/test_shaverify_XXXXXX";
+    std::vector<std::string> filenames;
+    std::string manifest;
+    std::vector<char> data(100000);
+
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    manifest = std::string(directory) + "/MANIFEST";
+
+    Fill_Data(data.data(), data.size());
+
+    FILE *fp = fopen(manifest.c_str(), "w");
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+    {
+        char name[32];
+        uint32_t hash[8];
+        char hex[65];
+        unsigned int nr_of_words = (i % 3 == 0) ? 8 : 5;
+
+        snprintf(name, sizeof(name), "/file%02u", i);
+        filenames.push_back(std::string(directory) + name);
+
+        Write_File(filenames[i].c_str(), &data[0], (i*i*61) % data.size());
+
+        if (nr_of_words == 8)
+            SHA256_File((char*) filenames[i].c_str(), hash);
+        else
+            SHA1_File((char*) filenames[i].c_str(), hash);
+        if (i == 7)
+            hash[2] ^= 1;
+        SHA_Hex_Encode(hash, nr_of_words, hex, SHA_HEX_LOWERCASE);
+
+        fprintf(fp, "%s  %s\n", hex, filenames[i].c_str());
+    }
+    fprintf(fp, "%s  %s/missing\n", "a9993e364706816aba3e25717850c26c9cd0d89d", directory);
+    fclose(fp);
+
+    SHA_Verifier::Order orders[] = {SHA_Verifier::MANIFEST_ORDER, SHA_Verifier::INODE_ORDER, SHA_Verifier::PHYSICAL_ORDER};
+    for (int k = 0; k < 3; k++)
+        for (unsigned int nr_of_threads = 1; nr_of_threads <= 4; nr_of_threads += 3)
+        {
+            SHA_Verifier verifier;
+            SHA_Verifier::Summary summary;
+            std::set<std::string> reported;
+            uint64_t nr_of_callbacks = 0;
+            uint64_t bytes = 0;
+
+            CPPUNIT_ASSERT(verifier.Load_Manifest(manifest.c_str()) == EXIT_SUCCESS);
+            verifier.Verify(orders[k], nr_of_threads, 5, [&](const SHA_Verifier::Entry &entry)
+            {
+                nr_of_callbacks++;
+                if (entry.status != SHA_Verifier::OK)
+                    reported.insert(entry.filename);
+            }, &summary);
+
+            CPPUNIT_ASSERT(nr_of_callbacks == NR_OF_FILES + 1);
+            CPPUNIT_ASSERT(reported.size() == 2);
+            CPPUNIT_ASSERT(reported.count(filenames[7]) == 1);
+            CPPUNIT_ASSERT(reported.count(std::string(directory) + "/missing") == 1);
+
+            CPPUNIT_ASSERT(summary.files == NR_OF_FILES + 1);
+            CPPUNIT_ASSERT(summary.ok == NR_OF_FILES - 1);
+            CPPUNIT_ASSERT(summary.mismatches == 1 && summary.unreadable == 1 && summary.malformed_lines == 0);
+            for (unsigned int i = 0; i < NR_OF_FILES; i++)
+                bytes += (i*i*61) % data.size();
+            CPPUNIT_ASSERT(summary.bytes == bytes);
+
+            CPPUNIT_ASSERT(summary.slowest.size() == 5);
+            for (int j = 1; j < 5; j++)
+                CPPUNIT_ASSERT(summary.slowest[j - 1]->seconds >= summary.slowest[j]->seconds);
+
+            /* The entries are sorted unless read in the order of the manifest */
+
+            const std::vector<SHA_Verifier::Entry> &entries = verifier.Entries();
+            for (size_t i = 1; i < entries.size(); i++)
+            {
+                if (orders[k] == SHA_Verifier::MANIFEST_ORDER)
+                    CPPUNIT_ASSERT(entries[i - 1].line < entries[i].line);
+                else if (entries[i - 1].device == entries[i].device && entries[i - 1].physical == entries[i].physical)
+                    CPPUNIT_ASSERT(entries[i - 1].position <= entries[i].position);
+            }
+        }
+
+    for (unsigned int i = 0; i < NR_OF_FILES; i++)
+        unlink(filenames[i].c_str());
+    unlink(manifest.c_str());
+    rmdir(directory);
+}
@@ -0,0 +1,48 @@
+/***************************************************************************************************************************************
+ * FILE NAME: test_shaverify.h
+ *
+ * Copyright (c)  2016 Anders Nordenfelt
+ *
+ * DATE: 2016-09-22
+ *
+ * CONTENT: Declares the tests contained in test_shaverify.cpp of the class SHA_Verifier contained in shaverify.cpp
+ *
+ **************************************************************************************************************************************/
+
+#ifndef __TEST_SHAVERIFY__
+#define __TEST_SHAVERIFY__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include "string.h"
+#include "stdlib.h"
+#include "time.h"
+
+#include <cppunit/TextOutputter.h>
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFailure.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test_SHAVERIFY : public CppUnit::TestCase {
+
+public:
+
+    CPPUNIT_TEST_SUITE( Test_SHAVERIFY );
+    CPPUNIT_TEST( Manifest_test1 );
+    CPPUNIT_TEST( Verify_test1 );
+    CPPUNIT_TEST_SUITE_END();
+
+    void Manifest_test1();
+    void Verify_test1();
+
+};
+
+#endif